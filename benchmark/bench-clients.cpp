@@ -0,0 +1,465 @@
+/******************************************************************************/
+/*! \file benchmark/bench-clients.cpp
+ *
+ * Synthetic X clients measuring WM latencies on a private Xvfb server.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "log.h"
+#include "bench-tools.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <thread>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+//! Operations whose latencies are measured.
+enum Operation
+{
+    OP_MANAGE,          //!< MapWindow until MapNotify
+    OP_FOCUS,           //!< _NET_ACTIVE_WINDOW until FocusIn
+    OP_PROPERTY,        //!< batch of title changes until drained by the WM
+    OP_RESIZE,          //!< ConfigureRequest until ConfigureNotify
+    OP_UNMANAGE,        //!< DestroyWindow until removed from _NET_CLIENT_LIST
+    OP_MAX
+};
+
+//! Names of the operations for result output.
+static const char* const op_name[OP_MAX] = {
+    "manage", "focus", "property", "resize", "unmanage"
+};
+
+//! Number of title changes per property churn batch.
+static const unsigned int property_batch = 16;
+
+/*!
+ * A synthetic client with its own X connection. Each cycle it creates and
+ * maps a window, activates it, retitles it, requests a resize, and destroys
+ * it again, measuring the time until the WM's reaction is observed.
+ */
+class SyntheticClient
+{
+protected:
+    //! client's own connection to the X server
+    xcb_connection_t* m_conn;
+
+    //! root window of the default screen
+    xcb_window_t m_root;
+
+    //! required atoms
+    xcb_atom_t m_net_client_list, m_net_active_window,
+               m_net_wm_name, m_utf8_string;
+
+    //! Wait for an event matching the predicate, returns false on timeout.
+    template <typename Predicate>
+    bool wait_for(Predicate pred);
+
+    //! Return the contents of _NET_CLIENT_LIST.
+    std::vector<xcb_window_t> client_list();
+
+public:
+    //! latencies of each operation in nanoseconds
+    std::vector<uint64_t> m_latency[OP_MAX];
+
+    //! number of operations which timed out
+    unsigned int m_timeouts;
+
+    //! Connect to the X server.
+    SyntheticClient();
+
+    //! Disconnect from the X server.
+    ~SyntheticClient();
+
+    //! Run cycles, at most rate cycles per second (zero: unlimited).
+    void run(unsigned int cycles, double rate);
+
+    //! Wait until _NET_CLIENT_LIST contains at least count windows.
+    bool wait_for_client_list(size_t count);
+
+    //! Wait until a WM has set _NET_SUPPORTING_WM_CHECK on the root window.
+    bool wait_for_wm()
+    {
+        return ::wait_for_wm(m_conn, m_root);
+    }
+
+    //! Delete _NET_CLIENT_LIST, which may be left by a previous WM.
+    void clear_client_list()
+    {
+        xcb_delete_property(m_conn, m_root, m_net_client_list);
+        xcb_flush(m_conn);
+    }
+
+private:
+    //! non-copyable: delete copy-constructor
+    SyntheticClient(const SyntheticClient&);
+    //! non-copyable: delete assignment operator
+    SyntheticClient& operator = (const SyntheticClient&);
+};
+
+//! Connect to the X server.
+SyntheticClient::SyntheticClient()
+    : m_timeouts(0)
+{
+    m_conn = xcb_connect(NULL, NULL);
+
+    if (xcb_connection_has_error(m_conn)) {
+        FATAL << "Could not connect to X server.";
+        exit(EXIT_FAILURE);
+    }
+
+    m_root = xcb_setup_roots_iterator(xcb_get_setup(m_conn)).data->root;
+
+    m_net_client_list = intern_atom(m_conn, "_NET_CLIENT_LIST");
+    m_net_active_window = intern_atom(m_conn, "_NET_ACTIVE_WINDOW");
+    m_net_wm_name = intern_atom(m_conn, "_NET_WM_NAME");
+    m_utf8_string = intern_atom(m_conn, "UTF8_STRING");
+
+    // watch _NET_CLIENT_LIST for unmanage notifications
+    uint32_t mask = XCB_EVENT_MASK_PROPERTY_CHANGE;
+    xcb_change_window_attributes(m_conn, m_root, XCB_CW_EVENT_MASK, &mask);
+}
+
+//! Disconnect from the X server.
+SyntheticClient::~SyntheticClient()
+{
+    xcb_disconnect(m_conn);
+}
+
+//! Wait for an event matching the predicate, returns false on timeout.
+template <typename Predicate>
+bool SyntheticClient::wait_for(Predicate pred)
+{
+    if (wait_for_event(m_conn, pred)) return true;
+
+    ++m_timeouts;
+    return false;
+}
+
+//! Return the contents of _NET_CLIENT_LIST.
+std::vector<xcb_window_t> SyntheticClient::client_list()
+{
+    autofree_ptr<xcb_get_property_reply_t> gpr(
+        xcb_get_property_reply(
+            m_conn, xcb_get_property(m_conn, 0, m_root, m_net_client_list,
+                                     XCB_ATOM_WINDOW, 0, UINT32_MAX / 4),
+            NULL)
+        );
+
+    if (!gpr) return std::vector<xcb_window_t>();
+
+    xcb_window_t* list = (xcb_window_t*)xcb_get_property_value(gpr.get());
+    int len = xcb_get_property_value_length(gpr.get()) / 4;
+
+    return std::vector<xcb_window_t>(list, list + len);
+}
+
+//! Wait until _NET_CLIENT_LIST contains at least count windows.
+bool SyntheticClient::wait_for_client_list(size_t count)
+{
+    xcb_atom_t atom = m_net_client_list;
+
+    return wait_for([this, atom, count](xcb_generic_event_t* e) {
+                        return (e->response_type & ~0x80)
+                        == XCB_PROPERTY_NOTIFY
+                        && ((xcb_property_notify_event_t*)e)->atom == atom
+                        && client_list().size() >= count;
+                    });
+}
+
+//! Run cycles, at most rate cycles per second (zero: unlimited).
+void SyntheticClient::run(unsigned int cycles, double rate)
+{
+    uint64_t next = monotonic_ns();
+    uint64_t interval = rate > 0 ? uint64_t(1e9 / rate) : 0;
+
+    for (unsigned int cycle = 0; cycle < cycles; ++cycle)
+    {
+        if (interval) {
+            uint64_t now = monotonic_ns();
+            if (now < next) usleep((next - now) / 1000);
+            next += interval;
+        }
+
+        uint64_t ts;
+
+        // *** create and map a window
+
+        xcb_window_t win = xcb_generate_id(m_conn);
+        uint32_t values[1] = {
+            XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_FOCUS_CHANGE
+        };
+
+        xcb_create_window(m_conn, XCB_COPY_FROM_PARENT, win, m_root,
+                          0, 0, 320, 240, 0,
+                          XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                          XCB_COPY_FROM_PARENT, XCB_CW_EVENT_MASK, values);
+
+        static const char wm_class[] = "benchclient\0BenchClient";
+        xcb_change_property(m_conn, XCB_PROP_MODE_REPLACE, win,
+                            XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 8,
+                            sizeof(wm_class), wm_class);
+
+        ts = monotonic_ns();
+        xcb_map_window(m_conn, win);
+
+        if (wait_for([win](xcb_generic_event_t* e) {
+                         return (e->response_type & ~0x80) == XCB_MAP_NOTIFY
+                         && ((xcb_map_notify_event_t*)e)->window == win;
+                     }))
+            m_latency[OP_MANAGE].push_back(monotonic_ns() - ts);
+
+        // *** activate the window via EWMH, unless it already got the focus
+        // by other means, e.g. the pointer entering it.
+
+        autofree_ptr<xcb_get_input_focus_reply_t> gifr(
+            xcb_get_input_focus_reply(m_conn, xcb_get_input_focus(m_conn),
+                                      NULL)
+            );
+
+        xcb_client_message_event_t cm;
+        memset(&cm, 0, sizeof(cm));
+        cm.response_type = XCB_CLIENT_MESSAGE;
+        cm.format = 32;
+        cm.window = win;
+        cm.type = m_net_active_window;
+        cm.data.data32[0] = 1; // source indication: application
+
+        if (gifr && gifr->focus != win)
+        {
+            ts = monotonic_ns();
+            xcb_send_event(m_conn, 0, m_root,
+                           XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT |
+                           XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY, (char*)&cm);
+
+            if (wait_for([win](xcb_generic_event_t* e) {
+                             return (e->response_type & ~0x80) == XCB_FOCUS_IN
+                             && ((xcb_focus_in_event_t*)e)->event == win;
+                         }))
+                m_latency[OP_FOCUS].push_back(monotonic_ns() - ts);
+        }
+
+        // *** property churn: a batch of title changes, drained by a
+        // ConfigureRequest, which the WM answers in order.
+
+        uint32_t geometry[2] = { 640, 480 };
+
+        ts = monotonic_ns();
+        for (unsigned int i = 0; i < property_batch; ++i)
+        {
+            std::string title = "bench " + to_str(cycle) + "." + to_str(i);
+            xcb_change_property(m_conn, XCB_PROP_MODE_REPLACE, win,
+                                m_net_wm_name, m_utf8_string, 8,
+                                title.size(), title.data());
+            xcb_change_property(m_conn, XCB_PROP_MODE_REPLACE, win,
+                                XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8,
+                                title.size(), title.data());
+        }
+
+        xcb_configure_window(m_conn, win,
+                             XCB_CONFIG_WINDOW_WIDTH |
+                             XCB_CONFIG_WINDOW_HEIGHT, geometry);
+
+        auto configure_notify = [win](xcb_generic_event_t* e) {
+            return (e->response_type & ~0x80) == XCB_CONFIGURE_NOTIFY
+                   && ((xcb_configure_notify_event_t*)e)->window == win;
+        };
+
+        if (wait_for(configure_notify))
+            m_latency[OP_PROPERTY].push_back(monotonic_ns() - ts);
+
+        // *** resize request
+
+        geometry[0] = 800, geometry[1] = 600;
+
+        ts = monotonic_ns();
+        xcb_configure_window(m_conn, win,
+                             XCB_CONFIG_WINDOW_WIDTH |
+                             XCB_CONFIG_WINDOW_HEIGHT, geometry);
+
+        if (wait_for(configure_notify))
+            m_latency[OP_RESIZE].push_back(monotonic_ns() - ts);
+
+        // *** destroy window
+
+        xcb_atom_t client_list = m_net_client_list;
+
+        ts = monotonic_ns();
+        xcb_destroy_window(m_conn, win);
+
+        if (wait_for([this, win, client_list](xcb_generic_event_t* e) {
+                         if ((e->response_type & ~0x80) != XCB_PROPERTY_NOTIFY
+                             || ((xcb_property_notify_event_t*)e)->atom
+                             != client_list) return false;
+
+                         std::vector<xcb_window_t> list = this->client_list();
+                         return std::find(list.begin(), list.end(), win)
+                         == list.end();
+                     }))
+            m_latency[OP_UNMANAGE].push_back(monotonic_ns() - ts);
+    }
+}
+
+//! Benchmark remanage_all_windows() at WM startup: map windows without a WM,
+//! then start the WM and wait until all are in _NET_CLIENT_LIST.
+static int run_startup(unsigned int windows, char* const* wm_argv)
+{
+    SyntheticClient client;
+
+    xcb_connection_t* conn = xcb_connect(NULL, NULL);
+    xcb_window_t root =
+        xcb_setup_roots_iterator(xcb_get_setup(conn)).data->root;
+
+    // remove stale client list of a previous WM
+    client.clear_client_list();
+
+    for (unsigned int i = 0; i < windows; ++i)
+    {
+        xcb_window_t win = xcb_generate_id(conn);
+        xcb_create_window(conn, XCB_COPY_FROM_PARENT, win, root,
+                          (i * 7) % 1500, (i * 5) % 800, 320, 240, 0,
+                          XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                          XCB_COPY_FROM_PARENT, 0, NULL);
+        xcb_map_window(conn, win);
+    }
+
+    free(xcb_get_input_focus_reply(conn, xcb_get_input_focus(conn), NULL));
+
+    uint64_t ts = monotonic_ns();
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        execvp(wm_argv[0], wm_argv);
+        _exit(EXIT_FAILURE);
+    }
+    if (pid < 0) {
+        ERROR << "fork() failed: " << strerror(errno);
+        return EXIT_FAILURE;
+    }
+
+    bool done = client.wait_for_client_list(windows);
+    uint64_t elapsed = monotonic_ns() - ts;
+
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+    xcb_disconnect(conn);
+
+    if (!done) {
+        ERROR << "WM did not manage " << windows << " windows in time.";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint64_t> lat(1, elapsed);
+    report_latency("startup", ("remanage" + to_str(windows)).c_str(),
+                   lat, windows, elapsed);
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int clients = 10, cycles = 100, startup = 0;
+    double rate = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hn:c:r:s:")) != -1)
+    {
+        switch (opt) {
+        case 'n':
+            clients = strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+            cycles = strtoul(optarg, NULL, 10);
+            break;
+        case 'r':
+            rate = strtod(optarg, NULL);
+            break;
+        case 's':
+            startup = strtoul(optarg, NULL, 10);
+            break;
+        case 'h':
+        default:
+            INFO << "Usage: " << argv[0] << " [-n clients] [-c cycles]"
+                 << " [-r cycles/s] [-s windows -- wm args...]";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (startup) {
+        if (optind >= argc) {
+            ERROR << "Startup benchmark requires the WM command line.";
+            return EXIT_FAILURE;
+        }
+        return run_startup(startup, argv + optind);
+    }
+
+    // *** run synthetic clients in parallel threads
+
+    std::vector<SyntheticClient*> list;
+    for (unsigned int i = 0; i < clients; ++i)
+        list.push_back(new SyntheticClient);
+
+    if (!list.empty() && !list[0]->wait_for_wm()) {
+        ERROR << "No EWMH compliant WM is running.";
+        return EXIT_FAILURE;
+    }
+
+    uint64_t ts = monotonic_ns();
+
+    std::vector<std::thread> threads;
+    for (SyntheticClient* c : list)
+        threads.emplace_back(&SyntheticClient::run, c, cycles, rate);
+
+    for (std::thread& t : threads)
+        t.join();
+
+    uint64_t total = monotonic_ns() - ts;
+
+    // *** merge and output latencies
+
+    unsigned int timeouts = 0;
+
+    for (int op = 0; op < OP_MAX; ++op)
+    {
+        std::vector<uint64_t> lat;
+        for (SyntheticClient* c : list)
+            lat.insert(lat.end(), c->m_latency[op].begin(),
+                       c->m_latency[op].end());
+
+        unsigned int items = lat.size();
+        if (op == OP_PROPERTY) items *= 2 * property_batch;
+
+        report_latency("clients", op_name[op], lat, items, total);
+    }
+
+    for (SyntheticClient* c : list) {
+        timeouts += c->m_timeouts;
+        delete c;
+    }
+
+    if (timeouts) {
+        WARN << timeouts << " operations timed out.";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
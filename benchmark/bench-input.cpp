@@ -0,0 +1,461 @@
+/******************************************************************************/
+/*! \file benchmark/bench-input.cpp
+ *
+ * Input-to-effect latency of WM bindings measured by injecting XTest events.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "log.h"
+#include "bench-tools.h"
+#include "geometry.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <xcb/xtest.h>
+#include <xcb/xcb_keysyms.h>
+#include <X11/keysym.h>
+
+//! Operations whose latencies are measured.
+enum Operation
+{
+    OP_FOCUS_MOUSE,     //!< pointer motion until FocusIn
+    OP_KEY_QUIT,        //!< Ctrl+q until WM_DELETE_WINDOW client message
+    OP_DRAG_MOVE,       //!< Ctrl+Button1 drag until window moved
+    OP_DRAG_RESIZE,     //!< Ctrl+Button3 drag until window resized
+    OP_MAX
+};
+
+//! Names of the operations for result output.
+static const char* const op_name[OP_MAX] = {
+    "focus_follows_mouse", "key_quit_window", "drag_move", "drag_resize"
+};
+
+//! Pointer movement during drag operations.
+static const int drag_delta = 24;
+
+/*!
+ * The Observer owns two client windows, injects input events via XTEST and
+ * timestamps the WM's reaction as seen on its windows.
+ */
+class Observer
+{
+protected:
+    //! connection to the X server
+    xcb_connection_t* m_conn;
+
+    //! root window of the default screen
+    xcb_window_t m_root;
+
+    //! keysym table
+    xcb_key_symbols_t* m_key_symbols;
+
+    //! required atoms
+    xcb_atom_t m_wm_protocols, m_wm_delete_window;
+
+    //! Find the first keycode of a keysym.
+    xcb_keycode_t keycode(xcb_keysym_t keysym);
+
+    //! Inject a fake input event.
+    void fake(uint8_t type, uint8_t detail, int16_t x = 0, int16_t y = 0)
+    {
+        xcb_test_fake_input(m_conn, type, detail, XCB_CURRENT_TIME,
+                            m_root, x, y, 0);
+    }
+
+    //! Inject a modifier + button press, motion by delta and release, and
+    //! wait for the window's geometry to change.
+    uint64_t drag(xcb_window_t win, uint8_t button, int delta);
+
+public:
+    //! the observer's client windows
+    xcb_window_t m_win[2];
+
+    //! latencies of each operation in nanoseconds
+    std::vector<uint64_t> m_latency[OP_MAX];
+
+    //! number of operations which timed out
+    unsigned int m_timeouts;
+
+    //! Connect to the X server and check for XTEST.
+    Observer();
+
+    //! Disconnect from the X server.
+    ~Observer();
+
+    //! Wait for the WM, then create and map the two client windows.
+    bool setup();
+
+    //! Return the center of a window in root coordinates.
+    Point center(xcb_window_t win);
+
+    //! Move pointer alternately into the windows, wait for FocusIn.
+    void measure_focus(unsigned int i);
+
+    //! Press Ctrl+q in a focused window, wait for WM_DELETE_WINDOW.
+    void measure_key_quit(unsigned int i);
+
+    //! Ctrl+Button1 drag, wait for the window to move.
+    void measure_drag_move(unsigned int i);
+
+    //! Ctrl+Button3 drag, wait for the window to resize.
+    void measure_drag_resize(unsigned int i);
+
+private:
+    //! non-copyable: delete copy-constructor
+    Observer(const Observer&);
+    //! non-copyable: delete assignment operator
+    Observer& operator = (const Observer&);
+};
+
+//! Connect to the X server and check for XTEST.
+Observer::Observer()
+    : m_timeouts(0)
+{
+    m_conn = xcb_connect(NULL, NULL);
+
+    if (xcb_connection_has_error(m_conn)) {
+        FATAL << "Could not connect to X server.";
+        exit(EXIT_FAILURE);
+    }
+
+    m_root = xcb_setup_roots_iterator(xcb_get_setup(m_conn)).data->root;
+
+    const xcb_query_extension_reply_t* qer =
+        xcb_get_extension_data(m_conn, &xcb_test_id);
+
+    if (!qer || !qer->present) {
+        FATAL << "XTEST extension not available.";
+        exit(EXIT_FAILURE);
+    }
+
+    m_key_symbols = xcb_key_symbols_alloc(m_conn);
+
+    m_wm_protocols = intern_atom(m_conn, "WM_PROTOCOLS");
+    m_wm_delete_window = intern_atom(m_conn, "WM_DELETE_WINDOW");
+}
+
+//! Disconnect from the X server.
+Observer::~Observer()
+{
+    xcb_key_symbols_free(m_key_symbols);
+    xcb_disconnect(m_conn);
+}
+
+//! Find the first keycode of a keysym.
+xcb_keycode_t Observer::keycode(xcb_keysym_t keysym)
+{
+    autofree_ptr<xcb_keycode_t> kc(
+        xcb_key_symbols_get_keycode(m_key_symbols, keysym)
+        );
+
+    return kc ? kc.get()[0] : XCB_NO_SYMBOL;
+}
+
+//! Wait for the WM, then create and map the two client windows.
+bool Observer::setup()
+{
+    if (!wait_for_wm(m_conn, m_root)) {
+        ERROR << "No EWMH compliant WM is running.";
+        return false;
+    }
+
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        xcb_window_t win = m_win[i] = xcb_generate_id(m_conn);
+
+        uint32_t values[1] = {
+            XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_FOCUS_CHANGE
+        };
+
+        xcb_create_window(m_conn, XCB_COPY_FROM_PARENT, win, m_root,
+                          100 + 800 * i, 100, 640, 480, 0,
+                          XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                          XCB_COPY_FROM_PARENT, XCB_CW_EVENT_MASK, values);
+
+        static const char wm_class[] = "benchinput\0BenchInput";
+        xcb_change_property(m_conn, XCB_PROP_MODE_REPLACE, win,
+                            XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 8,
+                            sizeof(wm_class), wm_class);
+
+        // support WM_DELETE_WINDOW, but never close the window
+        xcb_change_property(m_conn, XCB_PROP_MODE_REPLACE, win,
+                            m_wm_protocols, XCB_ATOM_ATOM, 32,
+                            1, &m_wm_delete_window);
+
+        xcb_map_window(m_conn, win);
+
+        if (!wait_for_event(m_conn, [win](xcb_generic_event_t* e) {
+                                return (e->response_type & ~0x80)
+                                == XCB_MAP_NOTIFY
+                                && ((xcb_map_notify_event_t*)e)->window
+                                == win;
+                            }))
+        {
+            ERROR << "WM did not map the observer's window.";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//! Return the center of a window in root coordinates.
+Point Observer::center(xcb_window_t win)
+{
+    autofree_ptr<xcb_get_geometry_reply_t> ggr(
+        xcb_get_geometry_reply(m_conn, xcb_get_geometry(m_conn, win), NULL)
+        );
+
+    autofree_ptr<xcb_translate_coordinates_reply_t> tcr(
+        xcb_translate_coordinates_reply(
+            m_conn, xcb_translate_coordinates(m_conn, win, m_root, 0, 0),
+            NULL)
+        );
+
+    if (!ggr || !tcr) return Point(0, 0);
+
+    return Point(tcr->dst_x + ggr->width / 2, tcr->dst_y + ggr->height / 2);
+}
+
+//! Move pointer alternately into the windows, wait for FocusIn.
+void Observer::measure_focus(unsigned int i)
+{
+    xcb_window_t win = m_win[i % 2];
+    Point p = center(win);
+
+    uint64_t ts = monotonic_ns();
+    fake(XCB_MOTION_NOTIFY, 0, p.x, p.y);
+
+    if (wait_for_event(m_conn, [win](xcb_generic_event_t* e) {
+                           return (e->response_type & ~0x80) == XCB_FOCUS_IN
+                           && ((xcb_focus_in_event_t*)e)->event == win;
+                       }))
+        m_latency[OP_FOCUS_MOUSE].push_back(monotonic_ns() - ts);
+    else
+        ++m_timeouts;
+}
+
+//! Press Ctrl+q in a focused window, wait for WM_DELETE_WINDOW.
+void Observer::measure_key_quit(unsigned int i)
+{
+    xcb_window_t win = m_win[i % 2];
+
+    // focus the window by moving the pointer into it
+    Point p = center(win);
+    fake(XCB_MOTION_NOTIFY, 0, p.x, p.y);
+    xcb_set_input_focus(m_conn, XCB_INPUT_FOCUS_POINTER_ROOT, win,
+                        XCB_CURRENT_TIME);
+
+    xcb_keycode_t ctrl = keycode(XK_Control_L), q = keycode(XK_q);
+
+    uint64_t ts = monotonic_ns();
+    fake(XCB_KEY_PRESS, ctrl);
+    fake(XCB_KEY_PRESS, q);
+    fake(XCB_KEY_RELEASE, q);
+    fake(XCB_KEY_RELEASE, ctrl);
+
+    xcb_atom_t wm_protocols = m_wm_protocols;
+    xcb_atom_t wm_delete_window = m_wm_delete_window;
+
+    if (wait_for_event(m_conn, [=](xcb_generic_event_t* e) {
+                           xcb_client_message_event_t* cm =
+                               (xcb_client_message_event_t*)e;
+                           return (e->response_type & ~0x80)
+                           == XCB_CLIENT_MESSAGE
+                           && cm->window == win
+                           && cm->type == wm_protocols
+                           && cm->data.data32[0] == wm_delete_window;
+                       }))
+        m_latency[OP_KEY_QUIT].push_back(monotonic_ns() - ts);
+    else
+        ++m_timeouts;
+}
+
+//! Inject a modifier + button press, motion by delta and release, and wait
+//! for the window's geometry to change.
+uint64_t Observer::drag(xcb_window_t win, uint8_t button, int delta)
+{
+    Point p = center(win);
+    fake(XCB_MOTION_NOTIFY, 0, p.x, p.y);
+
+    xcb_keycode_t ctrl = keycode(XK_Control_L);
+
+    uint64_t ts = monotonic_ns();
+    fake(XCB_KEY_PRESS, ctrl);
+    fake(XCB_BUTTON_PRESS, button);
+    fake(XCB_MOTION_NOTIFY, 0, p.x + delta, p.y + delta);
+
+    bool ok = wait_for_event(m_conn, [win](xcb_generic_event_t* e) {
+                                 return (e->response_type & ~0x80)
+                                 == XCB_CONFIGURE_NOTIFY
+                                 && ((xcb_configure_notify_event_t*)e)->window
+                                 == win;
+                             });
+
+    uint64_t latency = monotonic_ns() - ts;
+
+    fake(XCB_BUTTON_RELEASE, button);
+    fake(XCB_KEY_RELEASE, ctrl);
+    xcb_flush(m_conn);
+
+    if (!ok) {
+        ++m_timeouts;
+        return 0;
+    }
+    return latency;
+}
+
+//! Ctrl+Button1 drag, wait for the window to move.
+void Observer::measure_drag_move(unsigned int i)
+{
+    uint64_t latency =
+        drag(m_win[0], XCB_BUTTON_INDEX_1, i % 2 ? -drag_delta : drag_delta);
+
+    if (latency) m_latency[OP_DRAG_MOVE].push_back(latency);
+}
+
+//! Ctrl+Button3 drag, wait for the window to resize.
+void Observer::measure_drag_resize(unsigned int i)
+{
+    uint64_t latency =
+        drag(m_win[0], XCB_BUTTON_INDEX_3, i % 2 ? -drag_delta : drag_delta);
+
+    if (latency) m_latency[OP_DRAG_RESIZE].push_back(latency);
+}
+
+//! Background property churn on a separate connection and window.
+static void churn_main(const std::atomic<bool>* stop, double rate)
+{
+    xcb_connection_t* conn = xcb_connect(NULL, NULL);
+    xcb_window_t root =
+        xcb_setup_roots_iterator(xcb_get_setup(conn)).data->root;
+
+    xcb_atom_t net_wm_name = intern_atom(conn, "_NET_WM_NAME");
+    xcb_atom_t utf8_string = intern_atom(conn, "UTF8_STRING");
+
+    xcb_window_t win = xcb_generate_id(conn);
+    xcb_create_window(conn, XCB_COPY_FROM_PARENT, win, root,
+                      0, 600, 320, 240, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      XCB_COPY_FROM_PARENT, 0, NULL);
+    xcb_map_window(conn, win);
+
+    uint64_t interval = rate > 0 ? uint64_t(1e9 / rate) : 0;
+    uint64_t next = monotonic_ns();
+
+    for (unsigned int i = 0; !*stop; ++i)
+    {
+        std::string title = "churn " + to_str(i);
+        xcb_change_property(conn, XCB_PROP_MODE_REPLACE, win,
+                            net_wm_name, utf8_string, 8,
+                            title.size(), title.data());
+
+        if (interval) {
+            xcb_flush(conn);
+            next += interval;
+            uint64_t now = monotonic_ns();
+            if (now < next) usleep((next - now) / 1000);
+        }
+        else if (i % 64 == 0) {
+            // round trip to avoid flooding the server's queue
+            free(xcb_get_input_focus_reply(conn, xcb_get_input_focus(conn),
+                                           NULL));
+        }
+    }
+
+    xcb_disconnect(conn);
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int repeats = 1000;
+    bool loaded = false;
+    double churn_rate = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hn:LR:")) != -1)
+    {
+        switch (opt) {
+        case 'n':
+            repeats = strtoul(optarg, NULL, 10);
+            break;
+        case 'L':
+            loaded = true;
+            break;
+        case 'R':
+            churn_rate = strtod(optarg, NULL);
+            break;
+        case 'h':
+        default:
+            INFO << "Usage: " << argv[0] << " [-n repeats] [-L] [-R churn/s]";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    Observer obs;
+    if (!obs.setup()) return EXIT_FAILURE;
+
+    std::atomic<bool> stop(false);
+    std::thread churn;
+
+    if (loaded)
+        churn = std::thread(churn_main, &stop, churn_rate);
+
+    uint64_t ts[OP_MAX + 1];
+    ts[0] = monotonic_ns();
+
+    for (unsigned int i = 0; i < repeats; ++i)
+        obs.measure_focus(i);
+    ts[1] = monotonic_ns();
+
+    for (unsigned int i = 0; i < repeats; ++i)
+        obs.measure_key_quit(i);
+    ts[2] = monotonic_ns();
+
+    for (unsigned int i = 0; i < repeats; ++i)
+        obs.measure_drag_move(i);
+    ts[3] = monotonic_ns();
+
+    for (unsigned int i = 0; i < repeats; ++i)
+        obs.measure_drag_resize(i);
+    ts[4] = monotonic_ns();
+
+    if (loaded) {
+        stop = true;
+        churn.join();
+    }
+
+    std::string benchmark = loaded ? "input_loaded" : "input";
+
+    for (int op = 0; op < OP_MAX; ++op)
+    {
+        report_latency(benchmark.c_str(), op_name[op], obs.m_latency[op],
+                       obs.m_latency[op].size(), ts[op + 1] - ts[op]);
+    }
+
+    if (obs.m_timeouts) {
+        WARN << obs.m_timeouts << " operations timed out.";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
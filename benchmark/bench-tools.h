@@ -0,0 +1,146 @@
+/******************************************************************************/
+/*! \file benchmark/bench-tools.h
+ *
+ * Common helpers of the benchmark clients: waiting and result output.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#ifndef TILEWM_BENCH_TOOLS_HEADER
+#define TILEWM_BENCH_TOOLS_HEADER
+
+#include "tools.h"
+#include "xcb.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+
+//! Give up waiting for the WM after this time.
+static const uint64_t wait_timeout_ns = 5 * 1000000000llu;
+
+/*!
+ * Wait for an event on the connection matching the predicate, returns false
+ * on timeout or connection errors. Events not matching are dropped.
+ */
+template <typename Predicate>
+static inline bool wait_for_event(xcb_connection_t* conn, Predicate pred,
+                                  uint64_t timeout_ns = wait_timeout_ns)
+{
+    xcb_flush(conn);
+
+    uint64_t deadline = monotonic_ns() + timeout_ns;
+
+    while (1)
+    {
+        autofree_ptr<xcb_generic_event_t> event(xcb_poll_for_event(conn));
+
+        if (event) {
+            if (pred(event.get())) return true;
+            continue;
+        }
+
+        if (xcb_connection_has_error(conn)) return false;
+
+        uint64_t now = monotonic_ns();
+        if (now >= deadline) return false;
+
+        struct pollfd pfd;
+        pfd.fd = xcb_get_file_descriptor(conn);
+        pfd.events = POLLIN;
+        poll(&pfd, 1, (deadline - now) / 1000000 + 1);
+    }
+}
+
+//! Intern an atom, synchronously.
+static inline xcb_atom_t intern_atom(xcb_connection_t* conn, const char* name)
+{
+    autofree_ptr<xcb_intern_atom_reply_t> iar(
+        xcb_intern_atom_reply(
+            conn, xcb_intern_atom(conn, 0, strlen(name), name), NULL)
+        );
+
+    return iar ? iar->atom : xcb_atom_t(XCB_ATOM_NONE);
+}
+
+//! Wait until a WM has set _NET_SUPPORTING_WM_CHECK on the root window.
+static inline bool wait_for_wm(xcb_connection_t* conn, xcb_window_t root)
+{
+    xcb_atom_t atom = intern_atom(conn, "_NET_SUPPORTING_WM_CHECK");
+
+    for (unsigned int i = 0; i < 200; ++i)
+    {
+        autofree_ptr<xcb_get_property_reply_t> gpr(
+            xcb_get_property_reply(
+                conn, xcb_get_property(conn, 0, root, atom,
+                                       XCB_ATOM_WINDOW, 0, 1),
+                NULL)
+            );
+
+        if (gpr && xcb_get_property_value_length(gpr.get()) == 4)
+        {
+            // check that the window is alive and not left by a previous WM
+            xcb_window_t win =
+                *(xcb_window_t*)xcb_get_property_value(gpr.get());
+
+            autofree_ptr<xcb_get_window_attributes_reply_t> gwar(
+                xcb_get_window_attributes_reply(
+                    conn, xcb_get_window_attributes(conn, win), NULL)
+                );
+
+            if (gwar) return true;
+        }
+
+        usleep(50000);
+    }
+
+    return false;
+}
+
+/*!
+ * Output count, throughput and latency percentiles of an operation as a
+ * RESULT line, which can be compared between releases. The latency list is
+ * sorted in place.
+ */
+static inline void report_latency(const char* benchmark, const char* op,
+                                  std::vector<uint64_t>& lat,
+                                  unsigned int items, uint64_t total_ns)
+{
+    if (lat.empty()) return;
+
+    std::sort(lat.begin(), lat.end());
+
+    auto pct = [&lat](double p) {
+        return lat[std::min<size_t>(lat.size() - 1, lat.size() * p)] / 1000;
+    };
+
+    std::cout << "RESULT benchmark=" << benchmark << " op=" << op
+              << " count=" << lat.size()
+              << " throughput=" << (total_ns ? items * 1e9 / total_ns : 0)
+              << " p50_us=" << pct(0.5) << " p90_us=" << pct(0.9)
+              << " p99_us=" << pct(0.99) << " p999_us=" << pct(0.999)
+              << " max_us=" << lat.back() / 1000
+              << std::endl;
+}
+
+#endif // !TILEWM_BENCH_TOOLS_HEADER
+
+/******************************************************************************/
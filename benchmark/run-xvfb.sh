@@ -0,0 +1,101 @@
+#!/bin/sh
+################################################################################
+# benchmark/run-xvfb.sh
+#
+# Start a private Xvfb server and run the tilewm benchmark suite against it.
+#
+# Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+#
+# This program is free software: you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation, either version 3 of the License, or (at your option) any later
+# version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program.  If not, see <http://www.gnu.org/licenses/>.
+################################################################################
+
+# usage: run-xvfb.sh <tilewm> <bench-clients> [bench-input]
+#
+# environment variables:
+#   OUTPUTS  number of monitors (Xinerama heads), default 2
+#   CLIENTS  number of synthetic clients, default 10
+#   CYCLES   map/focus/retitle/resize/destroy cycles per client, default 100
+#   RATE     cycles per second per client, 0 = unlimited, default 0
+#   STARTUP  pre-existing window counts for the startup benchmark
+#   REPEATS  injected inputs per binding for the input benchmark, default 1000
+
+set -e
+
+TILEWM=$1
+BENCH=$2
+BENCH_INPUT=$3
+
+if [ -z "$TILEWM" ] || [ -z "$BENCH" ]; then
+    echo "usage: $0 <tilewm> <bench-clients> [bench-input]" >&2
+    exit 1
+fi
+
+OUTPUTS=${OUTPUTS:-2}
+CLIENTS=${CLIENTS:-10}
+CYCLES=${CYCLES:-100}
+RATE=${RATE:-0}
+STARTUP=${STARTUP:-"100 1000 5000"}
+REPEATS=${REPEATS:-1000}
+
+# find a free display number
+
+DPY=90
+while [ -e /tmp/.X$DPY-lock ] || [ -e /tmp/.X11-unix/X$DPY ]; do
+    DPY=$((DPY + 1))
+done
+
+# Xvfb provides a single RandR CRTC, hence multiple outputs are emulated as
+# Xinerama heads, which the WM's screen detection falls back to.
+
+SCREENS=""
+i=0
+while [ $i -lt $OUTPUTS ]; do
+    SCREENS="$SCREENS -screen $i 1920x1080x24"
+    i=$((i + 1))
+done
+
+if [ $OUTPUTS -gt 1 ]; then
+    SCREENS="$SCREENS +xinerama"
+fi
+
+Xvfb :$DPY -nolisten tcp -noreset $SCREENS >/dev/null 2>&1 &
+XVFB_PID=$!
+
+trap 'kill $WM_PID $XVFB_PID 2>/dev/null; wait' EXIT INT TERM
+
+while [ ! -e /tmp/.X11-unix/X$DPY ]; do
+    sleep 0.1
+done
+
+export DISPLAY=:$DPY
+
+# remanage_all_windows() at startup with pre-existing windows
+
+for n in $STARTUP; do
+    "$BENCH" -s $n -- "$TILEWM" -l warn
+done
+
+# synthetic clients against a running WM
+
+"$TILEWM" -l warn &
+WM_PID=$!
+
+"$BENCH" -n $CLIENTS -c $CYCLES -r $RATE
+
+# input-to-effect latency via XTEST, idle and with background property churn
+
+if [ -n "$BENCH_INPUT" ]; then
+    "$BENCH_INPUT" -n $REPEATS
+    "$BENCH_INPUT" -n $REPEATS -L
+fi
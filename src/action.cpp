@@ -25,9 +25,7 @@
 #include "client.h"
 #include "event.h"
 #include "tools.h"
-
-#include <unistd.h>
-#include <cstring>
+#include "launcher.h"
 
 //! Virtual destructor called when the binding is released.
 Action::~Action()
@@ -68,18 +66,20 @@ static void mouse_move_handler(ButtonEvent& be)
     Point click_pos = be.root_pos();
     Point win_pos = c.m_geometry.origin();
 
+    xcb_cursor_t cursor = g_xcb.get_cursor(g_xcb.CR_fleur);
+
     xcb_grab_pointer_cookie_t gpc =
-        xcb_grab_pointer(g_xcb.connection, 0, c.window(),
-                         XCB_EVENT_MASK_BUTTON_PRESS |
-                         XCB_EVENT_MASK_BUTTON_RELEASE |
-                         XCB_EVENT_MASK_BUTTON_MOTION |
-                         XCB_EVENT_MASK_POINTER_MOTION,
-                         XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC,
-                         XCB_WINDOW_NONE, g_xcb.CR_fleur.cursor,
-                         XCB_CURRENT_TIME);
+        g_xcb.req(xcb_grab_pointer(g_xcb.connection, 0, c.window(),
+                                   XCB_EVENT_MASK_BUTTON_PRESS |
+                                   XCB_EVENT_MASK_BUTTON_RELEASE |
+                                   XCB_EVENT_MASK_BUTTON_MOTION |
+                                   XCB_EVENT_MASK_POINTER_MOTION,
+                                   XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC,
+                                   XCB_WINDOW_NONE, cursor,
+                                   XCB_CURRENT_TIME));
 
     autofree_ptr<xcb_grab_pointer_reply_t> gpr(
-        xcb_grab_pointer_reply(g_xcb.connection, gpc, NULL)
+        g_xcb.reply(xcb_grab_pointer_reply, gpc, NULL)
         );
 
     if (!gpr || gpr->status != XCB_GRAB_STATUS_SUCCESS) {
@@ -126,8 +126,8 @@ static void mouse_move_handler(ButtonEvent& be)
             // ignore key press events during mouse operation.
             xcb_key_press_event_t* ev = (xcb_key_press_event_t*)event.get();
             TRACE2 << "key_press event handler: " << *ev;
-            xcb_allow_events(g_xcb.connection, XCB_ALLOW_SYNC_KEYBOARD,
-                             ev->time);
+            g_xcb.req(xcb_allow_events(g_xcb.connection,
+                                       XCB_ALLOW_SYNC_KEYBOARD, ev->time));
             break;
         }
         default:
@@ -136,7 +136,7 @@ static void mouse_move_handler(ButtonEvent& be)
         }
     }
 
-    xcb_ungrab_pointer(g_xcb.connection, XCB_CURRENT_TIME);
+    g_xcb.req(xcb_ungrab_pointer(g_xcb.connection, XCB_CURRENT_TIME));
 
     INFO << "end mouse_move_handler()";
 }
@@ -160,24 +160,23 @@ static void mouse_resize_handler(ButtonEvent& be)
     bool top = (be.pos().y < win_geo.h / 2);
 
     xcb_cursor_t cursor =
-        (left && top ? g_xcb.CR_top_left_corner.cursor :
-         !left && top ? g_xcb.CR_top_right_corner.cursor :
-         left && !top ? g_xcb.CR_bottom_left_corner.cursor :
-         !left && !top ? g_xcb.CR_bottom_right_corner.cursor :
-         g_xcb.CR_top_left_corner.cursor);
+        g_xcb.get_cursor(left && top ? g_xcb.CR_top_left_corner :
+                         !left && top ? g_xcb.CR_top_right_corner :
+                         left && !top ? g_xcb.CR_bottom_left_corner :
+                         g_xcb.CR_bottom_right_corner);
 
     xcb_grab_pointer_cookie_t gpc =
-        xcb_grab_pointer(g_xcb.connection, 0, c.window(),
-                         XCB_EVENT_MASK_BUTTON_PRESS |
-                         XCB_EVENT_MASK_BUTTON_RELEASE |
-                         XCB_EVENT_MASK_BUTTON_MOTION |
-                         XCB_EVENT_MASK_POINTER_MOTION,
-                         XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC,
-                         XCB_WINDOW_NONE, cursor,
-                         XCB_CURRENT_TIME);
+        g_xcb.req(xcb_grab_pointer(g_xcb.connection, 0, c.window(),
+                                   XCB_EVENT_MASK_BUTTON_PRESS |
+                                   XCB_EVENT_MASK_BUTTON_RELEASE |
+                                   XCB_EVENT_MASK_BUTTON_MOTION |
+                                   XCB_EVENT_MASK_POINTER_MOTION,
+                                   XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC,
+                                   XCB_WINDOW_NONE, cursor,
+                                   XCB_CURRENT_TIME));
 
     autofree_ptr<xcb_grab_pointer_reply_t> gpr(
-        xcb_grab_pointer_reply(g_xcb.connection, gpc, NULL)
+        g_xcb.reply(xcb_grab_pointer_reply, gpc, NULL)
         );
 
     if (!gpr || gpr->status != XCB_GRAB_STATUS_SUCCESS) {
@@ -250,8 +249,8 @@ static void mouse_resize_handler(ButtonEvent& be)
             // ignore key press events during mouse operation.
             xcb_key_press_event_t* ev = (xcb_key_press_event_t*)event.get();
             TRACE << "key_press event handler: " << *ev;
-            xcb_allow_events(g_xcb.connection, XCB_ALLOW_SYNC_KEYBOARD,
-                             ev->time);
+            g_xcb.req(xcb_allow_events(g_xcb.connection,
+                                       XCB_ALLOW_SYNC_KEYBOARD, ev->time));
             break;
         }
         default:
@@ -260,7 +259,7 @@ static void mouse_resize_handler(ButtonEvent& be)
         }
     }
 
-    xcb_ungrab_pointer(g_xcb.connection, XCB_CURRENT_TIME);
+    g_xcb.req(xcb_ungrab_pointer(g_xcb.connection, XCB_CURRENT_TIME));
 
     INFO << "end mouse_resize_handler()";
 }
@@ -305,33 +304,11 @@ public:
     }
 
     //! Action on keyboard press events
-    void operator () (KeyEvent&)
+    void operator () (KeyEvent& ke)
     {
-        TRACE << "action_swap()";
-
-        // fork into child program
-        if (fork()) return;
-
-        // close the X11 connection in child
-        if (g_xcb.connection) {
-            close(g_xcb.get_file_descriptor());
-        }
-
-        // start a new session in process tree
-        if (setsid() == -1) {
-            WARN << "spawn: setsid() failed: " << strerror(errno);
-        }
-
-        // construct arguments for execvp():
-        std::vector<const char*> args(m_progargs.size() + 1);
-        for (size_t i = 0; i < m_progargs.size(); ++i)
-            args[i] = m_progargs[i].c_str();
-        args.back() = NULL;
+        TRACE << "action_spawn()";
 
-        execvp(args[0], (char* const*)args.data());
-        //ERROR << "execvp() running \"" << terminal << "\" : " <<
-        // strerror(errno);
-        exit(EXIT_FAILURE);
+        Launcher::spawn(m_progargs, ke.root_pos(), ke.time());
     }
 };
 
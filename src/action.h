@@ -60,6 +60,18 @@ public:
     {
         return Point(m_event.root_x, m_event.root_y);
     }
+
+    //! Return X server timestamp of the event.
+    xcb_timestamp_t time()
+    {
+        return m_event.time;
+    }
+
+    //! Return window the event was reported on.
+    xcb_window_t window()
+    {
+        return m_event.event;
+    }
 };
 
 //! Struct to abstract all parameters passed to mouse button handlers.
@@ -95,6 +107,12 @@ public:
     {
         return Point(m_event.root_x, m_event.root_y);
     }
+
+    //! Return window the event was reported on.
+    xcb_window_t window()
+    {
+        return m_event.event;
+    }
 };
 
 //! All keyboard binding handlers must have this type
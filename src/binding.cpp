@@ -42,16 +42,19 @@ BindingList::kblist_type BindingList::s_kblist;
 //! list of all mouse button bindings
 BindingList::bblist_type BindingList::s_bblist;
 
-//! Determine the mask for the NumLock modifier.
-void BindingList::find_numlock_mask()
+//! Issue request for the keyboard modifier mapping.
+xcb_get_modifier_mapping_cookie_t BindingList::query_numlock_mask()
 {
-    s_numlock_mask = 0;
+    return g_xcb.req(xcb_get_modifier_mapping(g_xcb.connection));
+}
 
-    xcb_get_modifier_mapping_cookie_t gmmc =
-        xcb_get_modifier_mapping(g_xcb.connection);
+//! Determine the mask for the NumLock modifier from the modifier mapping.
+void BindingList::process_numlock_mask(xcb_get_modifier_mapping_cookie_t gmmc)
+{
+    s_numlock_mask = 0;
 
     autofree_ptr<xcb_get_modifier_mapping_reply_t> gmmr(
-        xcb_get_modifier_mapping_reply(g_xcb.connection, gmmc, NULL)
+        g_xcb.reply(xcb_get_modifier_mapping_reply, gmmc, NULL)
         );
 
     if (!gmmr) {
@@ -92,6 +95,12 @@ void BindingList::find_numlock_mask()
     s_modifiers[3] = s_numlock_mask | XCB_MOD_MASK_LOCK;
 }
 
+//! Determine the mask for the NumLock modifier.
+void BindingList::find_numlock_mask()
+{
+    process_numlock_mask(query_numlock_mask());
+}
+
 //! Initialize binding list.
 void BindingList::initialize()
 {
@@ -114,17 +123,17 @@ void BindingList::deinitialize()
 //! Regrab all bindings of the root window
 void BindingList::regrab_root()
 {
-    INFO << "regrab_root()";
+    XcbAccountScope scope(XcbConnection::SUB_BINDING);
 
-    find_numlock_mask();
+    INFO << "regrab_root()";
 
     // release all our key and button grab on the root
 
-    xcb_ungrab_key(g_xcb.connection,
-                   XCB_GRAB_ANY, g_xcb.root, XCB_MOD_MASK_ANY);
+    g_xcb.req(xcb_ungrab_key(g_xcb.connection,
+                             XCB_GRAB_ANY, g_xcb.root, XCB_MOD_MASK_ANY));
 
-    xcb_ungrab_button(g_xcb.connection,
-                      XCB_BUTTON_INDEX_ANY, g_xcb.root, XCB_MOD_MASK_ANY);
+    g_xcb.req(xcb_ungrab_button(g_xcb.connection, XCB_BUTTON_INDEX_ANY,
+                                g_xcb.root, XCB_MOD_MASK_ANY));
 
     // iterate over list of key bindings and request grabs
 
@@ -142,9 +151,9 @@ void BindingList::regrab_root()
         {
             for (unsigned int mods : s_modifiers)
             {
-                xcb_grab_key(g_xcb.connection, 0, g_xcb.root,
-                             kb.modifiers | mods, *code,
-                             XCB_GRAB_MODE_SYNC, XCB_GRAB_MODE_SYNC);
+                g_xcb.req(xcb_grab_key(g_xcb.connection, 0, g_xcb.root,
+                                       kb.modifiers | mods, *code,
+                                       XCB_GRAB_MODE_SYNC, XCB_GRAB_MODE_SYNC));
             }
         }
     }
@@ -157,12 +166,12 @@ void BindingList::regrab_root()
 
         for (unsigned int mods : s_modifiers)
         {
-            xcb_grab_button(g_xcb.connection, 0, g_xcb.root,
-                            XCB_EVENT_MASK_BUTTON_PRESS,
-                            XCB_GRAB_MODE_SYNC, XCB_GRAB_MODE_SYNC,
-                            XCB_WINDOW_NONE, XCB_CURSOR_NONE,
-                            bb.button,
-                            bb.modifiers | mods);
+            g_xcb.req(xcb_grab_button(g_xcb.connection, 0, g_xcb.root,
+                                      XCB_EVENT_MASK_BUTTON_PRESS,
+                                      XCB_GRAB_MODE_SYNC, XCB_GRAB_MODE_SYNC,
+                                      XCB_WINDOW_NONE, XCB_CURSOR_NONE,
+                                      bb.button,
+                                      bb.modifiers | mods));
         }
     }
 }
@@ -170,17 +179,19 @@ void BindingList::regrab_root()
 //! Regrab all bindings of a client window
 void BindingList::regrab_client(Client& c)
 {
+    XcbAccountScope scope(XcbConnection::SUB_BINDING);
+
     INFO << "regrab_client(" << c.window() << ")";
 
     xcb_window_t win = c.window();
 
     // release all our key and button grabs on the window
 
-    xcb_ungrab_key(g_xcb.connection,
-                   XCB_GRAB_ANY, win, XCB_MOD_MASK_ANY);
+    g_xcb.req(xcb_ungrab_key(g_xcb.connection,
+                             XCB_GRAB_ANY, win, XCB_MOD_MASK_ANY));
 
-    xcb_ungrab_button(g_xcb.connection,
-                      XCB_BUTTON_INDEX_ANY, win, XCB_MOD_MASK_ANY);
+    g_xcb.req(xcb_ungrab_button(g_xcb.connection,
+                                XCB_BUTTON_INDEX_ANY, win, XCB_MOD_MASK_ANY));
 
     // iterate over list of key bindings and request grabs
 
@@ -198,9 +209,9 @@ void BindingList::regrab_client(Client& c)
         {
             for (unsigned int mods : s_modifiers)
             {
-                xcb_grab_key(g_xcb.connection, 0, win,
-                             kb.modifiers | mods, *code,
-                             XCB_GRAB_MODE_SYNC, XCB_GRAB_MODE_SYNC);
+                g_xcb.req(xcb_grab_key(g_xcb.connection, 0, win,
+                                       kb.modifiers | mods, *code,
+                                       XCB_GRAB_MODE_SYNC, XCB_GRAB_MODE_SYNC));
             }
         }
     }
@@ -213,12 +224,12 @@ void BindingList::regrab_client(Client& c)
 
         for (unsigned int mods : s_modifiers)
         {
-            xcb_grab_button(g_xcb.connection, 0, win,
-                            XCB_EVENT_MASK_BUTTON_PRESS,
-                            XCB_GRAB_MODE_SYNC, XCB_GRAB_MODE_SYNC,
-                            XCB_WINDOW_NONE, XCB_CURSOR_NONE,
-                            bb.button,
-                            bb.modifiers | mods);
+            g_xcb.req(xcb_grab_button(g_xcb.connection, 0, win,
+                                      XCB_EVENT_MASK_BUTTON_PRESS,
+                                      XCB_GRAB_MODE_SYNC, XCB_GRAB_MODE_SYNC,
+                                      XCB_WINDOW_NONE, XCB_CURSOR_NONE,
+                                      bb.button,
+                                      bb.modifiers | mods));
         }
     }
 }
@@ -226,6 +237,8 @@ void BindingList::regrab_client(Client& c)
 //! Event handler for XCB_KEY_PRESS
 void BindingList::handle_event_key_press(xcb_generic_event_t* event)
 {
+    XcbAccountScope scope(XcbConnection::SUB_BINDING);
+
     xcb_key_press_event_t* ev = (xcb_key_press_event_t*)event;
     TRACE << "Event handler: " << *ev;
 
@@ -268,7 +281,8 @@ void BindingList::handle_event_key_press(xcb_generic_event_t* event)
     }
 
     // Unfreeze grab events
-    xcb_allow_events(g_xcb.connection, XCB_ALLOW_SYNC_KEYBOARD, ev->time);
+    g_xcb.req(xcb_allow_events(g_xcb.connection,
+                               XCB_ALLOW_SYNC_KEYBOARD, ev->time));
 
     INFO << "key_press event done.";
 }
@@ -276,16 +290,21 @@ void BindingList::handle_event_key_press(xcb_generic_event_t* event)
 //! Event handler for XCB_KEY_RELEASE
 void BindingList::handle_event_key_release(xcb_generic_event_t* event)
 {
+    XcbAccountScope scope(XcbConnection::SUB_BINDING);
+
     xcb_key_release_event_t* ev = (xcb_key_release_event_t*)event;
     TRACE << "Stub key_release event handler: " << *ev;
 
     // Unfreeze grab events
-    xcb_allow_events(g_xcb.connection, XCB_ALLOW_SYNC_KEYBOARD, ev->time);
+    g_xcb.req(xcb_allow_events(g_xcb.connection,
+                               XCB_ALLOW_SYNC_KEYBOARD, ev->time));
 }
 
 //! Event handler for XCB_BUTTON_PRESS
 void BindingList::handle_event_button_press(xcb_generic_event_t* event)
 {
+    XcbAccountScope scope(XcbConnection::SUB_BINDING);
+
     xcb_button_press_event_t* ev = (xcb_button_press_event_t*)event;
     TRACE << "Event handler: " << *ev;
 
@@ -325,7 +344,8 @@ void BindingList::handle_event_button_press(xcb_generic_event_t* event)
     }
 
     // Unfreeze grab events
-    xcb_allow_events(g_xcb.connection, XCB_ALLOW_SYNC_POINTER, ev->time);
+    g_xcb.req(xcb_allow_events(g_xcb.connection,
+                               XCB_ALLOW_SYNC_POINTER, ev->time));
 
     INFO << "button_press event done.";
 }
@@ -337,4 +357,24 @@ void BindingList::handle_event_button_release(xcb_generic_event_t* event)
     TRACE << "Stub button_release event handler: " << *ev;
 }
 
+//! Output latency statistics of all bindings to the log.
+void BindingList::dump_stats()
+{
+    for (KeyBinding& kb : s_kblist)
+    {
+        if (!kb.latency.count) continue;
+
+        INFO << "key binding mods " << kb.modifiers << " keysym " << kb.keysym
+             << ": " << kb.latency.str();
+    }
+
+    for (ButtonBinding& bb : s_bblist)
+    {
+        if (!bb.latency.count) continue;
+
+        INFO << "button binding mods " << bb.modifiers
+             << " button " << uint32_t(bb.button) << ": " << bb.latency.str();
+    }
+}
+
 /******************************************************************************/
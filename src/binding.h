@@ -28,6 +28,9 @@
 #include <xcb/xcb.h>
 #include <xcb/xcb_keysyms.h>
 #include "action.h"
+#include "stats.h"
+#include "tools.h"
+#include "trace.h"
 
 //! Target of the key or mouse button bindings: the root window, a specific
 //! interaction window class or all managed clients.
@@ -56,6 +59,9 @@ struct KeyBinding
     //! action handler object to call
     ActionPtr action;
 
+    //! latency histogram of calls
+    LatencyHistogram latency;
+
     //! Constructor with a plain handler functions (without class)
     KeyBinding(const binding_target_t& _target, unsigned int _modifiers,
                xcb_keysym_t _keysym, void(* _handler)(KeyEvent&))
@@ -74,10 +80,15 @@ struct KeyBinding
     //! Call the handler function or action handler.
     void call(KeyEvent& ke)
     {
+        TraceSpan span("action", ke.window(), XCB_KEY_PRESS);
+        uint64_t start = monotonic_ns();
+
         if (action)
-            return action.get()->operator () (ke);
+            action.get()->operator () (ke);
         else
-            return handler(ke);
+            handler(ke);
+
+        latency.add(monotonic_ns() - start);
     }
 };
 
@@ -101,6 +112,9 @@ struct ButtonBinding
     //! action handler object to call
     ActionPtr action;
 
+    //! latency histogram of calls
+    LatencyHistogram latency;
+
     //! Constructor with a plain handler functions (without class)
     ButtonBinding(const binding_target_t& _target, unsigned int _modifiers,
                   xcb_button_index_t _button, void(* _handler)(ButtonEvent&))
@@ -119,10 +133,15 @@ struct ButtonBinding
     //! Call the handler function or action handler.
     void call(ButtonEvent& be)
     {
+        TraceSpan span("action", be.window(), XCB_BUTTON_PRESS);
+        uint64_t start = monotonic_ns();
+
         if (action)
-            return action.get()->operator () (be);
+            action.get()->operator () (be);
         else
-            return handler(be);
+            handler(be);
+
+        latency.add(monotonic_ns() - start);
     }
 };
 
@@ -143,9 +162,6 @@ protected:
     //! without NumLock and with or without CapsLock activated.
     static std::array<int, 4> s_modifiers;
 
-    //! Determine the mask for the NumLock modifier.
-    static void find_numlock_mask();
-
     //! Return a modifier mask without NumLock or CapsLock flags.
     static unsigned int modifier_clean(unsigned int mods)
     {
@@ -171,7 +187,17 @@ public:
     //! Free binding list (free key_symbols table and mappings).
     static void deinitialize();
 
-    //! Regrab all bindings of the root window
+    //! Issue request for the keyboard modifier mapping.
+    static xcb_get_modifier_mapping_cookie_t query_numlock_mask();
+
+    //! Determine the mask for the NumLock modifier from the modifier mapping.
+    static void process_numlock_mask(xcb_get_modifier_mapping_cookie_t gmmc);
+
+    //! Determine the mask for the NumLock modifier.
+    static void find_numlock_mask();
+
+    //! Regrab all bindings of the root window, the NumLock mask must have
+    //! been determined before.
     static void regrab_root();
 
     //! Regrab all bindings of a client window
@@ -189,6 +215,9 @@ public:
     //! Event handler for XCB_BUTTON_RELEASE
     static void handle_event_button_release(xcb_generic_event_t* event);
 
+    //! Output latency statistics of all bindings to the log.
+    static void dump_stats();
+
     //! test
     static void add_test_bindings();
 };
@@ -27,9 +27,9 @@
 //! Query WM_STATE property
 xcb_get_property_cookie_t Client::query_wm_state()
 {
-    return xcb_get_property(g_xcb.connection, 0, window(),
-                            g_xcb.WM_STATE.atom,
-                            g_xcb.WM_STATE.atom, 0, 2);
+    return g_xcb.req(xcb_get_property(g_xcb.connection, 0, window(),
+                                      g_xcb.WM_STATE.atom,
+                                      g_xcb.WM_STATE.atom, 0, 2));
 }
 
 //! Process WM_STATE reply and update fields
@@ -38,7 +38,7 @@ void Client::process_wm_state(xcb_get_property_cookie_t gpc)
     // *** process WM_STATE property
 
     autofree_ptr<xcb_get_property_reply_t> gpr(
-        xcb_get_property_reply(g_xcb.connection, gpc, NULL)
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
         );
 
     if (!gpr) {
@@ -76,15 +76,20 @@ void Client::retrieve_wm_state()
 //! Query WM_CLASS property
 xcb_get_property_cookie_t Client::query_wm_class()
 {
-    return xcb_icccm_get_wm_class(g_xcb.connection, window());
+    return g_xcb.req(xcb_icccm_get_wm_class(g_xcb.connection, window()));
 }
 
 //! Process WM_CLASS reply and update fields
 void Client::process_wm_class(xcb_get_property_cookie_t gpc)
 {
+    autofree_ptr<xcb_get_property_reply_t> gpr(
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
+        );
+
+    // the decoded strings point into the reply freed by gpr
     xcb_icccm_get_wm_class_reply_t igwcr;
 
-    if (xcb_icccm_get_wm_class_reply(g_xcb.connection, gpc, &igwcr, NULL))
+    if (gpr && xcb_icccm_get_wm_class_from_reply(&igwcr, gpr.get()))
     {
         TRACE << "ICCCM: " << igwcr;
 
@@ -93,8 +98,6 @@ void Client::process_wm_class(xcb_get_property_cookie_t gpc)
 
         m_wm_class = igwcr.class_name;
         m_wm_class_instance = igwcr.instance_name;
-
-        xcb_icccm_get_wm_class_reply_wipe(&igwcr);
     }
     else
     {
@@ -116,20 +119,24 @@ void Client::retrieve_wm_class()
 //! Query WM_PROTOCOLS property
 xcb_get_property_cookie_t Client::query_wm_protocols()
 {
-    return xcb_icccm_get_wm_protocols(g_xcb.connection, window(),
-                                      g_xcb.WM_PROTOCOLS.atom);
+    return g_xcb.req(xcb_icccm_get_wm_protocols(g_xcb.connection, window(),
+                                                g_xcb.WM_PROTOCOLS.atom));
 }
 
 //! Process WM_PROTOCOLS reply and update fields
 void Client::process_wm_protocols(xcb_get_property_cookie_t gpc)
 {
+    autofree_ptr<xcb_get_property_reply_t> gpr(
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
+        );
+
+    // the decoded atom list points into the reply freed by gpr
     xcb_icccm_get_wm_protocols_reply_t igwpr;
 
     m_can_take_focus = false;
     m_can_delete_window = false;
 
-    if (xcb_icccm_get_wm_protocols_reply(g_xcb.connection,
-                                         gpc, &igwpr, NULL))
+    if (gpr && xcb_icccm_get_wm_protocols_from_reply(gpr.get(), &igwpr))
     {
         for (uint32_t i = 0; i < igwpr.atoms_len; i++)
         {
@@ -149,8 +156,6 @@ void Client::process_wm_protocols(xcb_get_property_cookie_t gpc)
                      << " - " << g_xcb.find_atom_name(igwpr.atoms[i]);
             }
         }
-
-        xcb_icccm_get_wm_protocols_reply_wipe(&igwpr);
     }
     else
     {
@@ -169,14 +174,17 @@ void Client::retrieve_wm_protocols()
 //! Query WM_HINTS property
 xcb_get_property_cookie_t Client::query_wm_hints()
 {
-    return xcb_icccm_get_wm_hints(g_xcb.connection, window());
+    return g_xcb.req(xcb_icccm_get_wm_hints(g_xcb.connection, window()));
 }
 
 //! Process WM_HINTS reply and update fields
 void Client::process_wm_hints(xcb_get_property_cookie_t gpc)
 {
-    if (xcb_icccm_get_wm_hints_reply(g_xcb.connection, gpc,
-                                     &m_wm_hints, NULL))
+    autofree_ptr<xcb_get_property_reply_t> gpr(
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
+        );
+
+    if (gpr && xcb_icccm_get_wm_hints_from_reply(&m_wm_hints, gpr.get()))
     {
         INFO << "ICCCM: " << m_wm_hints;
     }
@@ -197,15 +205,19 @@ void Client::retrieve_wm_hints()
 //! Query WM_NORMAL_HINTS property containing size hints field
 xcb_get_property_cookie_t Client::query_wm_normal_hints()
 {
-    return xcb_icccm_get_wm_normal_hints(g_xcb.connection, window());
+    return g_xcb.req(xcb_icccm_get_wm_normal_hints(g_xcb.connection,
+                                                   window()));
 }
 
 //! Process WM_NORMAL_HINTS reply and update size hints fields
 void Client::process_wm_normal_hints(xcb_get_property_cookie_t gpc)
 {
-    if (xcb_icccm_get_wm_normal_hints_reply(g_xcb.connection, gpc,
-                                            &m_wm_size_hints.m_data,
-                                            NULL))
+    autofree_ptr<xcb_get_property_reply_t> gpr(
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
+        );
+
+    if (gpr && xcb_icccm_get_wm_size_hints_from_reply(&m_wm_size_hints.m_data,
+                                                      gpr.get()))
     {
         INFO << "ICCCM: " << m_wm_size_hints.m_data;
     }
@@ -227,20 +239,26 @@ void Client::retrieve_wm_normal_hints()
 //! Query WM_TRANSIENT_FOR property
 xcb_get_property_cookie_t Client::query_wm_transient_for()
 {
-    return xcb_icccm_get_wm_transient_for(g_xcb.connection, window());
+    return g_xcb.req(xcb_icccm_get_wm_transient_for(g_xcb.connection,
+                                                    window()));
 }
 
 //! Process WM_TRANSIENT_FOR reply and update fields
 void Client::process_wm_transient_for(xcb_get_property_cookie_t gpc)
 {
-    if (xcb_icccm_get_wm_transient_for_reply(g_xcb.connection,
-                                             gpc, &m_wm_transient_for, NULL))
+    autofree_ptr<xcb_get_property_reply_t> gpr(
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
+        );
+
+    if (gpr && xcb_icccm_get_wm_transient_for_from_reply(&m_wm_transient_for,
+                                                         gpr.get()))
     {
         INFO << "ICCCM: transient for " << m_wm_transient_for;
     }
     else
     {
         WARN << "ICCCM WM_TRANSIENT_FOR could not be retrieved.";
+        m_wm_transient_for = XCB_WINDOW_NONE;
     }
 }
 
@@ -255,16 +273,16 @@ void Client::retrieve_wm_transient_for()
 //! Query _NET_WM_STATE property
 xcb_get_property_cookie_t Client::query_ewmh_state()
 {
-    return xcb_get_property(g_xcb.connection, 0, window(),
-                            g_xcb._NET_WM_STATE.atom,
-                            XCB_ATOM_ATOM, 0, UINT32_MAX);
+    return g_xcb.req(xcb_get_property(g_xcb.connection, 0, window(),
+                                      g_xcb._NET_WM_STATE.atom,
+                                      XCB_ATOM_ATOM, 0, UINT32_MAX));
 }
 
 //! Process _NET_WM_STATE reply and update fields
 void Client::process_ewmh_state(xcb_get_property_cookie_t gpc)
 {
     autofree_ptr<xcb_get_property_reply_t> gpr(
-        xcb_get_property_reply(g_xcb.connection, gpc, NULL)
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
         );
 
     if (!gpr || gpr->type != XCB_ATOM_ATOM) {
@@ -276,6 +294,7 @@ void Client::process_ewmh_state(xcb_get_property_cookie_t gpc)
 
     m_state_sticky = false;
     m_state_above = false;
+    m_state_below = false;
     m_state_fullscreen = false;
     m_state_maximized_vert = false;
     m_state_maximized_horz = false;
@@ -302,9 +321,9 @@ void Client::retrieve_ewmh_state()
 //! Query _NET_WM_WINDOW_TYPE property
 xcb_get_property_cookie_t Client::query_ewmh_window_type()
 {
-    return xcb_get_property(g_xcb.connection, 0, window(),
-                            g_xcb._NET_WM_WINDOW_TYPE.atom,
-                            XCB_ATOM_ATOM, 0, UINT32_MAX);
+    return g_xcb.req(xcb_get_property(g_xcb.connection, 0, window(),
+                                      g_xcb._NET_WM_WINDOW_TYPE.atom,
+                                      XCB_ATOM_ATOM, 0, UINT32_MAX));
 }
 
 //! Process _NET_WM_WINDOW_TYPE reply and update fields
@@ -313,7 +332,7 @@ void Client::process_ewmh_window_type(xcb_get_property_cookie_t gpc)
     m_ewmh_window_type = EWMH_WINDOW_TYPE_NORMAL;
 
     autofree_ptr<xcb_get_property_reply_t> gpr(
-        xcb_get_property_reply(g_xcb.connection, gpc, NULL)
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
         );
 
     if (!gpr || gpr->type != XCB_ATOM_ATOM) {
@@ -386,16 +405,16 @@ void Client::retrieve_ewmh_window_type()
 //! Query _NET_WM_STRUT property
 xcb_get_property_cookie_t Client::query_ewmh_strut()
 {
-    return xcb_get_property(g_xcb.connection, 0, window(),
-                            g_xcb._NET_WM_STRUT.atom,
-                            XCB_ATOM_CARDINAL, 0, 4);
+    return g_xcb.req(xcb_get_property(g_xcb.connection, 0, window(),
+                                      g_xcb._NET_WM_STRUT.atom,
+                                      XCB_ATOM_CARDINAL, 0, 4));
 }
 
 //! Process _NET_WM_STRUT reply and update fields
 void Client::process_ewmh_strut(xcb_get_property_cookie_t gpc)
 {
     autofree_ptr<xcb_get_property_reply_t> gpr(
-        xcb_get_property_reply(g_xcb.connection, gpc, NULL)
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
         );
 
     if (!gpr) {
@@ -438,16 +457,16 @@ void Client::retrieve_ewmh_strut()
 //! Query _NET_WM_STRUT_PARTIAL property
 xcb_get_property_cookie_t Client::query_ewmh_strut_partial()
 {
-    return xcb_get_property(g_xcb.connection, 0, window(),
-                            g_xcb._NET_WM_STRUT_PARTIAL.atom,
-                            XCB_ATOM_CARDINAL, 0, 12);
+    return g_xcb.req(xcb_get_property(g_xcb.connection, 0, window(),
+                                      g_xcb._NET_WM_STRUT_PARTIAL.atom,
+                                      XCB_ATOM_CARDINAL, 0, 12));
 }
 
 //! Process _NET_WM_STRUT_PARTIAL reply and update fields
 void Client::process_ewmh_strut_partial(xcb_get_property_cookie_t gpc)
 {
     autofree_ptr<xcb_get_property_reply_t> gpr(
-        xcb_get_property_reply(g_xcb.connection, gpc, NULL)
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
         );
 
     if (!gpr) {
@@ -494,4 +513,84 @@ void Client::retrieve_ewmh_strut_partial()
     process_ewmh_strut_partial(query_ewmh_strut_partial());
 }
 
+// -----------------------------------------------------------------------------
+
+//! Query _NET_WM_PID property
+xcb_get_property_cookie_t Client::query_ewmh_pid()
+{
+    return g_xcb.req(xcb_get_property(g_xcb.connection, 0, window(),
+                                      g_xcb._NET_WM_PID.atom,
+                                      XCB_ATOM_CARDINAL, 0, 1));
+}
+
+//! Process _NET_WM_PID reply and update fields
+void Client::process_ewmh_pid(xcb_get_property_cookie_t gpc)
+{
+    m_ewmh_pid = 0;
+
+    autofree_ptr<xcb_get_property_reply_t> gpr(
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
+        );
+
+    if (!gpr || gpr->type != XCB_ATOM_CARDINAL ||
+        gpr->format != 32 || gpr->length != 1)
+    {
+        DEBUG << "Could not retrieve _NET_WM_PID for window";
+        return;
+    }
+
+    TRACE << *gpr;
+
+    m_ewmh_pid = *(uint32_t*)xcb_get_property_value(gpr.get());
+
+    INFO << "EWMH _NET_WM_PID of window " << window() << " is " << m_ewmh_pid;
+}
+
+//! Retrieve _NET_WM_PID property and update fields
+void Client::retrieve_ewmh_pid()
+{
+    process_ewmh_pid(query_ewmh_pid());
+}
+
+// -----------------------------------------------------------------------------
+
+//! Query _NET_STARTUP_ID property
+xcb_get_property_cookie_t Client::query_startup_id()
+{
+    return g_xcb.req(xcb_get_property(g_xcb.connection, 0, window(),
+                                      g_xcb._NET_STARTUP_ID.atom,
+                                      g_xcb.UTF8_STRING.atom, 0, UINT32_MAX));
+}
+
+//! Process _NET_STARTUP_ID reply and update fields
+void Client::process_startup_id(xcb_get_property_cookie_t gpc)
+{
+    m_startup_id.clear();
+
+    autofree_ptr<xcb_get_property_reply_t> gpr(
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
+        );
+
+    if (!gpr || gpr->type != g_xcb.UTF8_STRING.atom || gpr->format != 8) {
+        DEBUG << "Could not retrieve _NET_STARTUP_ID for window";
+        return;
+    }
+
+    TRACE << *gpr;
+
+    m_startup_id.assign(
+        (const char*)xcb_get_property_value(gpr.get()),
+        xcb_get_property_value_length(gpr.get())
+        );
+
+    INFO << "EWMH _NET_STARTUP_ID of window " << window() << " is "
+         << m_startup_id;
+}
+
+//! Retrieve _NET_STARTUP_ID property and update fields
+void Client::retrieve_startup_id()
+{
+    process_startup_id(query_startup_id());
+}
+
 /******************************************************************************/
@@ -22,7 +22,13 @@
 
 #include "client.h"
 #include "binding.h"
+#include "desktop.h"
+#include "launcher.h"
+#include "event.h"
+#include "window-tree.h"
+#include "stacking.h"
 
+#include <algorithm>
 #include <cstring>
 #include <xcb/xcb_icccm.h>
 
@@ -55,10 +61,10 @@ void Client::initial_update(const xcb_get_window_attributes_reply_t& winattr)
     // *** get initial window geometry
 
     xcb_get_geometry_cookie_t ggc =
-        xcb_get_geometry(g_xcb.connection, window());
+        g_xcb.req(xcb_get_geometry(g_xcb.connection, window()));
 
     autofree_ptr<xcb_get_geometry_reply_t> ggr(
-        xcb_get_geometry_reply(g_xcb.connection, ggc, NULL)
+        g_xcb.reply(xcb_get_geometry_reply, ggc, NULL)
         );
 
     if (!ggr) {
@@ -106,10 +112,13 @@ void Client::initial_update(const xcb_get_window_attributes_reply_t& winattr)
     xcb_get_property_cookie_t gp_ewmh_strut = query_ewmh_strut();
     xcb_get_property_cookie_t gp_ewmh_strut_partial
         = query_ewmh_strut_partial();
+    xcb_get_property_cookie_t gp_ewmh_pid = query_ewmh_pid();
+    xcb_get_property_cookie_t gp_startup_id = query_startup_id();
 
     // initially clear _NET_WM_STATE flags (in case window doesn't support it)
     m_state_sticky = false;
     m_state_above = false;
+    m_state_below = false;
     m_state_fullscreen = false;
     m_state_maximized_vert = false;
     m_state_maximized_horz = false;
@@ -128,6 +137,8 @@ void Client::initial_update(const xcb_get_window_attributes_reply_t& winattr)
     process_ewmh_window_type(gp_ewmh_window_type);
     process_ewmh_strut(gp_ewmh_strut);
     process_ewmh_strut_partial(gp_ewmh_strut_partial);
+    process_ewmh_pid(gp_ewmh_pid);
+    process_startup_id(gp_startup_id);
 
     // *** set remainder of fields
 
@@ -135,18 +146,52 @@ void Client::initial_update(const xcb_get_window_attributes_reply_t& winattr)
 
     // *** subscribe to property change and mouse enter events
 
-    unsigned int values =
-        XCB_EVENT_MASK_PROPERTY_CHANGE |
-        XCB_EVENT_MASK_ENTER_WINDOW;
-
-    xcb_change_window_attributes(g_xcb.connection, window(),
-                                 XCB_CW_EVENT_MASK, &values);
+    m_win.set_event_mask(XCB_EVENT_MASK_PROPERTY_CHANGE |
+                         XCB_EVENT_MASK_ENTER_WINDOW);
 
     // *** subscribe to mouse and keyboard events
 
     BindingList::regrab_client(*this);
 }
 
+//! Move a newly managed window onto the Desk its launching event occurred.
+void Client::place_on_origin(const Point& origin)
+{
+    Desk* target = DeskList::find_point(origin);
+    if (!target) return;
+
+    Point center(m_geometry.x + m_geometry.w / 2,
+                 m_geometry.y + m_geometry.h / 2);
+
+    if (target->m_geometry.contains(center)) return;
+
+    Desk* current = DeskList::find_point(center);
+    const Rectangle& tg = target->m_geometry;
+
+    if (current) {
+        // keep position relative to the Desk's origin
+        m_geometry.set_origin(
+            m_geometry.origin() - current->m_geometry.origin() + tg.origin()
+            );
+    }
+    else {
+        // center window on target Desk
+        m_geometry.x = tg.x + ((int)tg.w - (int)m_geometry.w) / 2;
+        m_geometry.y = tg.y + ((int)tg.h - (int)m_geometry.h) / 2;
+    }
+
+    // clip origin to be inside the target Desk
+    if (m_geometry.x < tg.x || m_geometry.x >= tg.x + tg.w)
+        m_geometry.x = tg.x;
+    if (m_geometry.y < tg.y || m_geometry.y >= tg.y + tg.h)
+        m_geometry.y = tg.y;
+
+    INFO << "Placing window " << window() << " at launch origin " << origin
+         << ": " << m_geometry.str_pos_size();
+
+    m_win.move(m_geometry.origin());
+}
+
 //! Handle a XCB_CONFIGURE_REQUEST event, usually by ignoring it.
 void Client::configure_request(const xcb_configure_request_event_t& e)
 {
@@ -178,8 +223,21 @@ void Client::configure_request(const xcb_configure_request_event_t& e)
 
     TRACE << "sending " << ce;
 
-    xcb_send_event(g_xcb.connection, 0,
-                   window(), XCB_EVENT_MASK_STRUCTURE_NOTIFY, (char*)&ce);
+    g_xcb.req(xcb_send_event(g_xcb.connection, 0, window(),
+                             XCB_EVENT_MASK_STRUCTURE_NOTIFY, (char*)&ce));
+}
+
+//! Apply an EWMH state action to a flag.
+static void apply_state_action(bool& flag, ewmh_state_action_t action)
+{
+    if (action == EWMH_STATE_REMOVE)
+        flag = false;
+    else if (action == EWMH_STATE_ADD)
+        flag = true;
+    else if (action == EWMH_STATE_TOGGLE)
+        flag = !flag;
+    else
+        ERROR << "unknown action " << action << " requested for state";
 }
 
 //! Apply the EWMH compatible state change request.
@@ -197,6 +255,18 @@ void Client::change_ewmh_state(xcb_atom_t state, ewmh_state_action_t action)
             ERROR << "unknown action requested for state "
                   << g_xcb._NET_WM_STATE_HIDDEN.name;
     }
+    else if (state == g_xcb._NET_WM_STATE_ABOVE.atom)
+    {
+        apply_state_action(m_state_above, action);
+    }
+    else if (state == g_xcb._NET_WM_STATE_BELOW.atom)
+    {
+        apply_state_action(m_state_below, action);
+    }
+    else if (state == g_xcb._NET_WM_STATE_FULLSCREEN.atom)
+    {
+        apply_state_action(m_state_fullscreen, action);
+    }
     else {
         ERROR << "requesting action on unknown state "
               << g_xcb.find_atom_name(state);
@@ -207,7 +277,7 @@ void Client::change_ewmh_state(xcb_atom_t state, ewmh_state_action_t action)
 //! Update the EWMH _NET_WM_STATE property from flags.
 void Client::update_ewmh_state()
 {
-    xcb_atom_t values[8];
+    xcb_atom_t values[9];
     int i = 0;
 
     if (!m_is_mapped)
@@ -216,6 +286,8 @@ void Client::update_ewmh_state()
         values[i++] = g_xcb._NET_WM_STATE_STICKY.atom;
     if (m_state_above)
         values[i++] = g_xcb._NET_WM_STATE_ABOVE.atom;
+    if (m_state_below)
+        values[i++] = g_xcb._NET_WM_STATE_BELOW.atom;
     if (m_state_fullscreen)
         values[i++] = g_xcb._NET_WM_STATE_FULLSCREEN.atom;
     if (m_state_maximized_vert)
@@ -248,6 +320,8 @@ uint32_t ClientList::s_pixel_blurred;
 //! Query and manage all children of the root window.
 void ClientList::remanage_all_windows()
 {
+    XcbAccountScope scope(XcbConnection::SUB_MANAGE);
+
     TRACE << "Entering remanage_all_windows()";
 
     // *** unmark all clients in window list
@@ -257,34 +331,21 @@ void ClientList::remanage_all_windows()
         wmi.second.m_seen = false;
     }
 
-    // *** get all children of root on screen
-
-    xcb_query_tree_cookie_t qtc =
-        xcb_query_tree(g_xcb.connection, g_xcb.root);
+    // *** get all children of root on screen from the mirrored window tree,
+    // and _NET_CLIENT_LIST from the server.
 
-    autofree_ptr<xcb_query_tree_reply_t> qtr(
-        xcb_query_tree_reply(g_xcb.connection, qtc, NULL)
-        );
-
-    if (!qtr) {
-        ERROR << "remanage_all_windows(): could not query window list.";
-        return;
-    }
-
-    TRACE << *qtr;
+    xcb_get_property_cookie_t gpc =
+        g_xcb.req(xcb_get_property(g_xcb.connection, 0, g_xcb.root,
+                                   g_xcb._NET_CLIENT_LIST.atom,
+                                   XCB_ATOM_WINDOW, 0, UINT32_MAX));
 
-    xcb_window_t* child = xcb_query_tree_children(qtr.get());
-    int len = xcb_query_tree_children_length(qtr.get());
+    std::vector<xcb_window_t> child = WindowTree::stacking();
+    int len = child.size();
 
     // *** try to sort windows according to _NET_CLIENT_LIST
 
-    xcb_get_property_cookie_t gpc =
-        xcb_get_property(g_xcb.connection, 0, g_xcb.root,
-                         g_xcb._NET_CLIENT_LIST.atom,
-                         XCB_ATOM_WINDOW, 0, UINT32_MAX);
-
     autofree_ptr<xcb_get_property_reply_t> gpr(
-        xcb_get_property_reply(g_xcb.connection, gpc, NULL)
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
         );
 
     std::vector<xcb_window_t> winlist;
@@ -324,7 +385,7 @@ void ClientList::remanage_all_windows()
     else
     {
         // copy over window list
-        std::copy(child, child + len, std::back_inserter(winlist));
+        winlist = child;
     }
 
     // *** iterate over list of windows, manage unmanaged ones.
@@ -355,16 +416,36 @@ void ClientList::remanage_all_windows()
     update_net_client_list();
 }
 
+//! Locate Client of the top-most mapped window at a point, using the local
+//! window tree instead of a server round trip.
+Client* ClientList::find_window_at(const Point& p)
+{
+    const WindowTree::Node* node = WindowTree::window_at(p);
+    return (node ? find_window(node->window) : NULL);
+}
+
 //! Manage a window by creating a new Client structure for it.
 Client* ClientList::manage_window(xcb_window_t win)
 {
+    XcbAccountScope scope(XcbConnection::SUB_MANAGE);
+
     ASSERT(find_window(win) == NULL);
 
+    // popup menus and tooltips are mapped often, skip them without a round
+    // trip using the mirrored window tree.
+    const WindowTree::Node* node = WindowTree::find(win);
+
+    if (node && node->override_redirect) {
+        TRACE << "manage_window: window " << win
+              << " is override_redirect in window tree, skipping.";
+        return NULL;
+    }
+
     xcb_get_window_attributes_cookie_t gwac =
-        xcb_get_window_attributes(g_xcb.connection, win);
+        g_xcb.req(xcb_get_window_attributes(g_xcb.connection, win));
 
     autofree_ptr<xcb_get_window_attributes_reply_t> gwar(
-        xcb_get_window_attributes_reply(g_xcb.connection, gwac, NULL)
+        g_xcb.reply(xcb_get_window_attributes_reply, gwac, NULL)
         );
 
     if (!gwar) {
@@ -388,12 +469,30 @@ Client* ClientList::manage_window(xcb_window_t win)
 
     Client& c = it.first->second;
     c.initial_update(*gwar.get());
+
+    // *** match window to a program spawned by us, place it at launch origin
+
+    Launcher::Spawn spawn;
+    if (Launcher::match_window(c.m_startup_id, c.m_ewmh_pid, spawn))
+    {
+        if (!c.m_is_mapped && !c.free_placement())
+            c.place_on_origin(spawn.origin);
+    }
+
+    Stacking::insert(c);
+    DeskList::manage_client(c);
+
+    if (c.m_ewmh_strut.valid || c.m_ewmh_strut_partial.valid)
+        update_workarea();
+
     return &c;
 }
 
 //! Unmanage a window by destroying the Client structure for it.
 bool ClientList::unmanage_window(Client* c)
 {
+    XcbAccountScope scope(XcbConnection::SUB_MANAGE);
+
     ASSERT(c);
 
     windowmap_type::iterator i = s_windowmap.find(c->window());
@@ -403,14 +502,22 @@ bool ClientList::unmanage_window(Client* c)
     INFO << "Unmanaging client window " << c->window() << " client " << c;
 
     ASSERT(&i->second == c);
+    Stacking::remove(c->window());
+    DeskList::unmanage_window(c->window());
+
+    bool strut = (c->m_ewmh_strut.valid || c->m_ewmh_strut_partial.valid);
     s_windowmap.erase(i);
 
+    if (strut) update_workarea();
+
     return true;
 }
 
 //! Update EWMH _NET_CLIENT_LIST property
 void ClientList::update_net_client_list()
 {
+    XcbAccountScope scope(XcbConnection::SUB_EWMH);
+
     std::vector<xcb_window_t> winlist(s_windowmap.size());
 
     size_t i = 0;
@@ -424,6 +531,8 @@ void ClientList::update_net_client_list()
 //! Configure client to have focus.
 void ClientList::focus_window(Client* active)
 {
+    XcbAccountScope scope(XcbConnection::SUB_FOCUS);
+
     INFO << "focus_window client " << active << " win " << active->window();
 
     for (windowmap_type::value_type& wmi : s_windowmap)
@@ -439,7 +548,8 @@ void ClientList::focus_window(Client* active)
 
             // TODO: combine requests into one
             c.m_win.set_border_pixel(s_pixel_focused);
-            c.m_win.stack_above();
+            Stacking::raise(c);
+            DeskList::set_focus(c.window());
         }
         else if (c.m_has_focus)
         {
@@ -455,8 +565,237 @@ void ClientList::focus_window(Client* active)
     g_xcb.change_property(g_xcb.root, g_xcb._NET_ACTIVE_WINDOW,
                           XCB_ATOM_WINDOW, 32, 1, &win);
 
-    xcb_set_input_focus(g_xcb.connection, XCB_INPUT_FOCUS_POINTER_ROOT,
-                        win, XCB_CURRENT_TIME);
+    g_xcb.req(xcb_set_input_focus(g_xcb.connection,
+                                  XCB_INPUT_FOCUS_POINTER_ROOT,
+                                  win, XCB_CURRENT_TIME));
+}
+
+//! Combine struts of all clients and shrink the Desks' work areas.
+void ClientList::update_workarea()
+{
+    uint32_t left = 0, right = 0, top = 0, bottom = 0;
+
+    for (windowmap_type::value_type& wmi : s_windowmap)
+    {
+        Client& c = wmi.second;
+
+        // _NET_WM_STRUT_PARTIAL takes precedence over _NET_WM_STRUT
+        if (c.m_ewmh_strut_partial.valid) {
+            const ewmh_strut_partial_t& s = c.m_ewmh_strut_partial;
+            left = std::max(left, s.left);
+            right = std::max(right, s.right);
+            top = std::max(top, s.top);
+            bottom = std::max(bottom, s.bottom);
+        }
+        else if (c.m_ewmh_strut.valid) {
+            const ewmh_strut_t& s = c.m_ewmh_strut;
+            left = std::max(left, s.left);
+            right = std::max(right, s.right);
+            top = std::max(top, s.top);
+            bottom = std::max(bottom, s.bottom);
+        }
+    }
+
+    DeskList::set_struts(left, right, top, bottom);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+//! Property change handler for WM_CLASS
+static void property_wm_class(Client&, xcb_property_notify_event_t*)
+{
+    ERROR << "window requested a change of WM_CLASS. TODO";
+}
+
+//! Property change handler for WM_NAME
+static void property_wm_name(Client&, xcb_property_notify_event_t*)
+{
+    ERROR << "window requested a change of WM_NAME. TODO";
+}
+
+//! Property change handler for WM_STATE
+static void property_wm_state(Client& c, xcb_property_notify_event_t*)
+{
+    c.retrieve_wm_state();
+}
+
+//! Property change handler for WM_PROTOCOLS
+static void property_wm_protocols(Client& c, xcb_property_notify_event_t*)
+{
+    c.retrieve_wm_protocols();
+}
+
+//! Property change handler for WM_HINTS
+static void property_wm_hints(Client& c, xcb_property_notify_event_t*)
+{
+    c.retrieve_wm_hints();
+}
+
+//! Property change handler for WM_NORMAL_HINTS
+static void property_wm_normal_hints(Client& c, xcb_property_notify_event_t*)
+{
+    c.retrieve_wm_normal_hints();
+    DeskList::update_hints(c);
+}
+
+//! Property change handler for WM_TRANSIENT_FOR
+static void property_wm_transient_for(Client& c, xcb_property_notify_event_t*)
+{
+    c.retrieve_wm_transient_for();
+}
+
+//! Property change handler for _NET_WM_STATE, which we set ourselves.
+static void property_ewmh_state(Client&, xcb_property_notify_event_t*)
+{ }
+
+//! Property change handler for _NET_WM_STRUT
+static void property_ewmh_strut(Client& c, xcb_property_notify_event_t*)
+{
+    c.retrieve_ewmh_strut();
+    ClientList::update_workarea();
+}
+
+//! Property change handler for _NET_WM_STRUT_PARTIAL
+static void property_ewmh_strut_partial(Client& c,
+                                        xcb_property_notify_event_t*)
+{
+    c.retrieve_ewmh_strut_partial();
+    ClientList::update_workarea();
+}
+
+//! Property change handler for _NET_WM_WINDOW_TYPE
+static void property_ewmh_window_type(Client& c, xcb_property_notify_event_t*)
+{
+    bool was_tiled = DeskList::is_tiled(c);
+
+    c.retrieve_ewmh_window_type();
+    Stacking::update(c);
+
+    // docks and dialogs leave the tiling layout, normal windows join it
+    if (DeskList::is_tiled(c) == was_tiled) return;
+
+    if (was_tiled)
+        DeskList::unmanage_window(c.window());
+    else
+        DeskList::manage_client(c);
+}
+
+//! Client message handler for _NET_ACTIVE_WINDOW
+static void message_ewmh_active_window(xcb_client_message_event_t* ev)
+{
+    Client* c = ClientList::find_window(ev->window);
+    if (c) {
+        INFO << "_NET_ACTIVE_WINDOW for window " << c;
+        ClientList::focus_window(c);
+    }
+    else
+        WARN << "_NET_ACTIVE_WINDOW for unmanaged window?";
+}
+
+//! Client message handler for WM_CHANGE_STATE
+static void message_wm_change_state(xcb_client_message_event_t* ev)
+{
+    Client* c = ClientList::find_window(ev->window);
+    if (c) {
+        INFO << "WM_CHANGE_STATE for window " << c;
+
+        if (ev->data.data32[0] == 3)
+            c->set_mapped(false);
+        else
+            INFO << "Unknown WM_CHANGE_STATE request: "
+                 << ev->data.data32[0];
+    }
+    else
+        WARN << "WM_CHANGE_STATE for unmanaged window?";
+}
+
+//! Client message handler for _NET_WM_STATE
+static void message_ewmh_state(xcb_client_message_event_t* ev)
+{
+    Client* c = ClientList::find_window(ev->window);
+    if (c) {
+        INFO << "_NET_WM_STATE for window " << c;
+
+        // data32[0] is the action, data32[1..2] the one or two properties
+        ewmh_state_action_t action = (ewmh_state_action_t)ev->data.data32[0];
+
+        for (unsigned int i = 1; i <= 2; ++i)
+        {
+            if (ev->data.data32[i] != XCB_ATOM_NONE)
+                c->change_ewmh_state(ev->data.data32[i], action);
+        }
+
+        c->update_ewmh_state();
+        Stacking::update(*c);
+    }
+    else
+        WARN << "_NET_WM_STATE for unmanaged window?";
+}
+
+//! Error handler for requests on client windows: drop clients whose window
+//! vanished before the request was processed.
+static void error_client_window(const xcb_generic_error_t* e,
+                                const XcbConnection::RequestTag& tag)
+{
+    if (e->error_code != XCB_WINDOW) return;
+
+    // sibling-relative requests may fail due to the sibling, not the window
+    if (e->resource_id != tag.window) return;
+
+    Client* c = ClientList::find_window(tag.window);
+    if (!c) return;
+
+    INFO << "Dropping client of vanished window " << tag.window;
+
+    ClientList::unmanage_window(c);
+    ClientList::update_net_client_list();
+}
+
+//! Register handlers for client property changes and client messages.
+void ClientList::setup_event_handlers()
+{
+    // *** asynchronous errors of requests on client windows
+
+    g_xcb.register_error_handler(XcbConnection::OP_WINDOW,
+                                 error_client_window);
+
+    // *** ICCCM properties
+
+    EventLoop::register_client_property(
+        g_xcb.atom_slot(XCB_ATOM_WM_CLASS), property_wm_class);
+    EventLoop::register_client_property(
+        g_xcb.atom_slot(XCB_ATOM_WM_NAME), property_wm_name);
+    EventLoop::register_client_property(
+        g_xcb.atom_slot(g_xcb.WM_STATE), property_wm_state);
+    EventLoop::register_client_property(
+        g_xcb.atom_slot(g_xcb.WM_PROTOCOLS), property_wm_protocols);
+    EventLoop::register_client_property(
+        g_xcb.atom_slot(XCB_ATOM_WM_HINTS), property_wm_hints);
+    EventLoop::register_client_property(
+        g_xcb.atom_slot(XCB_ATOM_WM_NORMAL_HINTS), property_wm_normal_hints);
+    EventLoop::register_client_property(
+        g_xcb.atom_slot(XCB_ATOM_WM_TRANSIENT_FOR), property_wm_transient_for);
+
+    // *** EWMH properties
+
+    EventLoop::register_client_property(
+        g_xcb.atom_slot(g_xcb._NET_WM_STATE), property_ewmh_state);
+    EventLoop::register_client_property(
+        g_xcb.atom_slot(g_xcb._NET_WM_STRUT), property_ewmh_strut);
+    EventLoop::register_client_property(
+        g_xcb.atom_slot(g_xcb._NET_WM_STRUT_PARTIAL),
+        property_ewmh_strut_partial);
+    EventLoop::register_client_property(
+        g_xcb.atom_slot(g_xcb._NET_WM_WINDOW_TYPE), property_ewmh_window_type);
+
+    // *** client messages
+
+    EventLoop::register_client_message(
+        g_xcb.atom_slot(g_xcb._NET_ACTIVE_WINDOW), message_ewmh_active_window);
+    EventLoop::register_client_message(
+        g_xcb.atom_slot(g_xcb.WM_CHANGE_STATE), message_wm_change_state);
+    EventLoop::register_client_message(
+        g_xcb.atom_slot(g_xcb._NET_WM_STATE), message_ewmh_state);
 }
 
 /******************************************************************************/
@@ -60,6 +60,8 @@ public:
     bool m_state_sticky;
     //! EWHM window state flag for _NET_WM_STATE_ABOVE (keep on top)
     bool m_state_above;
+    //! EWHM window state flag for _NET_WM_STATE_BELOW (keep below)
+    bool m_state_below;
     //! EWHM window state flag for _NET_WM_STATE_FULLSCREEN
     bool m_state_fullscreen;
     //! EWHM window state flag for _NET_WM_STATE_MAXIMIZED_VERT
@@ -99,6 +101,11 @@ public:
     //! Variable Indicating the EWMH property _NET_WM_WINDOW_TYPE value.
     ewmh_window_type_t m_ewmh_window_type;
 
+    //! EWMH _NET_WM_PID of the client process, or zero if unknown.
+    uint32_t m_ewmh_pid;
+    //! EWMH _NET_STARTUP_ID startup notification identifier
+    std::string m_startup_id;
+
     //! flag whether the window has focus
     bool m_has_focus;
 
@@ -199,6 +206,20 @@ public:
     //! Retrieve _NET_WM_STRUT_PARTIAL property and update fields
     void retrieve_ewmh_strut_partial();
 
+    //! Query _NET_WM_PID property
+    xcb_get_property_cookie_t query_ewmh_pid();
+    //! Process _NET_WM_PID reply and update fields
+    void process_ewmh_pid(xcb_get_property_cookie_t gpc);
+    //! Retrieve _NET_WM_PID property and update fields
+    void retrieve_ewmh_pid();
+
+    //! Query _NET_STARTUP_ID property
+    xcb_get_property_cookie_t query_startup_id();
+    //! Process _NET_STARTUP_ID reply and update fields
+    void process_startup_id(xcb_get_property_cookie_t gpc);
+    //! Retrieve _NET_STARTUP_ID property and update fields
+    void retrieve_startup_id();
+
     // \}
 
     //! Whether the client is allowed free configuration placement.
@@ -210,6 +231,9 @@ public:
     //! Perform initial query/update of all fields of the Client structure
     void initial_update(const xcb_get_window_attributes_reply_t& a);
 
+    //! Move a newly managed window onto the Desk its launching event occurred.
+    void place_on_origin(const Point& origin);
+
     //! Handle a XCB_CONFIGURE_REQUEST event, usually by ignoring it.
     void configure_request(const xcb_configure_request_event_t& e);
 };
@@ -242,6 +266,16 @@ public:
         return (i != s_windowmap.end() ? &i->second : NULL);
     }
 
+    //! Locate Client of the top-most mapped window at a point, using the
+    //! local window tree instead of a server round trip.
+    static Client * find_window_at(const Point& p);
+
+    //! Return number of managed clients.
+    static size_t size()
+    {
+        return s_windowmap.size();
+    }
+
     //! Query and manage all children of the root window.
     static void remanage_all_windows();
 
@@ -256,6 +290,13 @@ public:
 
     //! Configure client to have focus.
     static void focus_window(Client* active);
+
+    //! Combine struts of all clients and shrink the Desks' work areas.
+    static void update_workarea();
+
+    //! Register handlers for client property changes, client messages and
+    //! errors of requests on client windows.
+    static void setup_event_handlers();
 };
 
 #endif // !TILEWM_CLIENT_HEADER
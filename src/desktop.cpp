@@ -22,12 +22,18 @@
  ******************************************************************************/
 
 #include "desktop.h"
+#include "client.h"
 #include "screen.h"
 #include "xcb.h"
 
+#include <algorithm>
+
 //! the list of Desks (both active and inactive)
 DeskList::desklist_type DeskList::m_list;
 
+//! space reserved by docks at the left, right, top and bottom root edges
+uint32_t DeskList::s_struts[4] = { 0, 0, 0, 0 };
+
 //! Setup new Desks and Desktops for newly created Screens.
 void DeskList::setup()
 {
@@ -86,6 +92,7 @@ bool DeskList::setup_screen(const Screen& s)
                  << " -> reactivating.";
 
             d.active = true;
+            update_workarea(d);
             return true;
         }
     }
@@ -96,6 +103,7 @@ bool DeskList::setup_screen(const Screen& s)
     d.m_geometry = s.geometry;
     d.active = true;
     d.initialize();
+    update_workarea(d);
     m_list.push_back(d);
 
     INFO << "Screen " << s.name
@@ -133,4 +141,153 @@ void DeskList::update_ewmh()
                           XCB_ATOM_CARDINAL, 32, 4, layout);
 }
 
+//! Recalculate work area of a Desk from the reserved struts.
+void DeskList::update_workarea(Desk& d)
+{
+    // struts are relative to the edges of the root window
+    uint32_t rw = g_xcb.screen->width_in_pixels;
+    uint32_t rh = g_xcb.screen->height_in_pixels;
+
+    uint32_t left = std::min(s_struts[0], rw);
+    uint32_t right = std::min(s_struts[1], rw - left);
+    uint32_t top = std::min(s_struts[2], rh);
+    uint32_t bottom = std::min(s_struts[3], rh - top);
+
+    Rectangle free(left, top, rw - left - right, rh - top - bottom);
+
+    d.m_workarea = d.m_geometry.intersection(free);
+}
+
+//! Check whether a client is arranged by the tiling layout.
+bool DeskList::is_tiled(const Client& c)
+{
+    return (c.m_ewmh_window_type == EWMH_WINDOW_TYPE_NORMAL &&
+            c.m_wm_transient_for == XCB_WINDOW_NONE);
+}
+
+//! Insert a client into the layout of the Desk it is placed on, if it is
+//! tiled.
+void DeskList::manage_client(Client& c)
+{
+    if (!is_tiled(c)) return;
+
+    Desk* d = find_point(c.m_geometry.origin());
+
+    if (!d || !d->active)
+    {
+        desklist_type::iterator it =
+            std::find_if(m_list.begin(), m_list.end(),
+                         [](const Desk& k) { return k.active; });
+
+        if (it == m_list.end()) return;
+        d = &*it;
+    }
+
+    Layout& l = d->current().m_layout;
+    l.insert(c.window());
+    l.set_hints(c.window(), c.m_wm_size_hints.solver_hints(c.m_border_width));
+}
+
+//! Remove a window from the layout containing it.
+void DeskList::unmanage_window(xcb_window_t win)
+{
+    for (Desk& d : m_list)
+    {
+        for (Desktop& t : d.m_list)
+        {
+            if (t.m_layout.remove(win)) return;
+        }
+    }
+}
+
+//! Update size hints of a client in the layout containing it.
+void DeskList::update_hints(Client& c)
+{
+    SizeSolver::Hints h = c.m_wm_size_hints.solver_hints(c.m_border_width);
+
+    for (Desk& d : m_list)
+    {
+        for (Desktop& t : d.m_list)
+        {
+            if (!t.m_layout.contains(c.window())) continue;
+
+            t.m_layout.set_hints(c.window(), h);
+            return;
+        }
+    }
+}
+
+//! Set window next to which new windows are inserted.
+void DeskList::set_focus(xcb_window_t win)
+{
+    for (Desk& d : m_list)
+    {
+        if (!d.active) continue;
+
+        Layout& l = d.current().m_layout;
+        if (!l.contains(win)) continue;
+
+        l.set_focus(win);
+        return;
+    }
+}
+
+//! Set space reserved by docks, shrinking the work area of all Desks.
+void DeskList::set_struts(uint32_t left, uint32_t right,
+                          uint32_t top, uint32_t bottom)
+{
+    uint32_t s[4] = { left, right, top, bottom };
+    if (std::equal(s, s + 4, s_struts)) return;
+
+    std::copy(s, s + 4, s_struts);
+
+    INFO << "DeskList: struts left " << left << " right " << right
+         << " top " << top << " bottom " << bottom;
+
+    for (Desk& d : m_list)
+        update_workarea(d);
+}
+
+//! Recalculate dirty parts of the layouts of visible desktops and move the
+//! affected clients.
+void DeskList::relayout()
+{
+    XcbAccountScope scope(XcbConnection::SUB_LAYOUT);
+
+    Layout::placementlist_type placements;
+
+    for (Desk& d : m_list)
+    {
+        if (!d.active) continue;
+
+        Layout& l = d.current().m_layout;
+        l.set_area(d.m_workarea);
+
+        if (!l.dirty()) continue;
+        l.layout(placements);
+    }
+
+    for (const Layout::Placement& p : placements)
+    {
+        Client* c = ClientList::find_window(p.window);
+        if (!c) continue;
+
+        // the layout area includes the window border
+        Rectangle r = p.area;
+        r.w = std::max(r.w - 2 * c->m_border_width, 1);
+        r.h = std::max(r.h - 2 * c->m_border_width, 1);
+
+        if (c->m_geometry == r) continue;
+
+        TRACE << "relayout: window " << p.window << " to " << r.str_pos_size();
+
+        c->m_geometry = r;
+        c->m_win.move_resize(r);
+    }
+
+    if (placements.size()) {
+        DEBUG << "relayout: " << placements.size() << " windows placed";
+    }
+}
+
 /******************************************************************************/
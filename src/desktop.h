@@ -26,13 +26,14 @@
 
 #include <vector>
 #include "geometry.h"
+#include "layout.h"
 #include "log.h"
 
 class Screen;
+class Client;
 
 /*!
- * A Desktop object, which will contain layout information and a stacked client
- * list.
+ * A Desktop object, which contains the tiling layout of its clients.
  */
 class Desktop
 {
@@ -40,6 +41,9 @@ public:
     //! Identifier name of desktop, usually 1,2,3,... or custom names.
     std::string m_name;
 
+    //! Tiling layout tree of clients on the desktop.
+    Layout m_layout;
+
     //! Return the default desktop name for desktop i
     static std::string get_default_name(size_t i)
     {
@@ -82,6 +86,12 @@ public:
     //! Currently visible desktop
     int m_cdesktop;
 
+    //! Return currently visible desktop
+    Desktop& current()
+    {
+        return m_list[m_cdesktop];
+    }
+
     void initialize()
     {
         m_cdesktop = 0;
@@ -107,6 +117,12 @@ protected:
     //! the list of Desks (both active and inactive)
     static desklist_type m_list;
 
+    //! space reserved by docks at the left, right, top and bottom root edges
+    static uint32_t s_struts[4];
+
+    //! Recalculate work area of a Desk from the reserved struts.
+    static void update_workarea(Desk& d);
+
 public:
     //! Search for a Desk with the origin (px,py).
     static Desk * find_origin(uint16_t px, uint16_t py)
@@ -144,6 +160,30 @@ public:
 
     //! Update basic EWMH properties to indicate virtual desktops.
     static void update_ewmh();
+
+    //! Check whether a client is arranged by the tiling layout.
+    static bool is_tiled(const Client& c);
+
+    //! Insert a client into the layout of the Desk it is placed on, if it
+    //! is tiled.
+    static void manage_client(Client& c);
+
+    //! Remove a window from the layout containing it.
+    static void unmanage_window(xcb_window_t win);
+
+    //! Update size hints of a client in the layout containing it.
+    static void update_hints(Client& c);
+
+    //! Set window next to which new windows are inserted.
+    static void set_focus(xcb_window_t win);
+
+    //! Set space reserved by docks, shrinking the work area of all Desks.
+    static void set_struts(uint32_t left, uint32_t right,
+                           uint32_t top, uint32_t bottom);
+
+    //! Recalculate dirty parts of the layouts of visible desktops and move
+    //! the affected clients.
+    static void relayout();
 };
 
 #endif // !TILEWM_DESKTOP_HEADER
@@ -24,6 +24,17 @@
 #include "xcb-window.h"
 #include "client.h"
 #include "binding.h"
+#include "ewmh.h"
+#include "window-tree.h"
+#include "stacking.h"
+#include "desktop.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
 
 //! the global event handler table (called after override event table)
 EventLoop::eventtable_type EventLoop::s_eventtable;
@@ -59,6 +70,8 @@ static void handle_event_error(xcb_generic_event_t* event)
               << " minor_code: " << uint32_t(e->minor_code)
               << " sequence: " << e->sequence
               << " resource_id: " << e->resource_id;
+
+        g_xcb.route_error(e);
     }
 }
 
@@ -138,7 +151,12 @@ static void handle_event_visibility_notify(xcb_generic_event_t* event)
 static void handle_event_create_notify(xcb_generic_event_t* event)
 {
     xcb_create_notify_event_t* ev = (xcb_create_notify_event_t*)event;
-    TRACE << "Stub event handler: " << *ev;
+    TRACE << "Event handler: " << *ev;
+
+    // events sent by clients via SendEvent, like the synthetic UnmapNotify
+    // of ICCCM withdrawal, do not describe the server's window tree.
+    if (!XCB_EVENT_SENT(ev))
+        WindowTree::create_notify(*ev);
 }
 
 //! Event handler stub for XCB_DESTROY_NOTIFY
@@ -147,6 +165,9 @@ static void handle_event_destroy_notify(xcb_generic_event_t* event)
     xcb_destroy_notify_event_t* ev = (xcb_destroy_notify_event_t*)event;
     TRACE << "Event handler: " << *ev;
 
+    if (!XCB_EVENT_SENT(ev))
+        WindowTree::destroy_notify(*ev);
+
     Client* c = ClientList::find_window(ev->window);
     if (c)
     {
@@ -169,6 +190,9 @@ static void handle_event_unmap_notify(xcb_generic_event_t* event)
     xcb_unmap_notify_event_t* ev = (xcb_unmap_notify_event_t*)event;
     TRACE << "Event handler: " << *ev;
 
+    if (!XCB_EVENT_SENT(ev))
+        WindowTree::unmap_notify(*ev);
+
     Client* c = ClientList::find_window(ev->window);
     if (c)
     {
@@ -193,6 +217,9 @@ static void handle_event_map_notify(xcb_generic_event_t* event)
     xcb_map_notify_event_t* ev = (xcb_map_notify_event_t*)event;
     TRACE << "Event handler: " << *ev;
 
+    if (!XCB_EVENT_SENT(ev))
+        WindowTree::map_notify(*ev);
+
     Client* c = ClientList::find_window(ev->window);
     if (!c)
     {
@@ -240,18 +267,24 @@ static void handle_event_map_request(xcb_generic_event_t* event)
     c->m_win.set_wm_state(XCB_ICCCM_WM_STATE_NORMAL);
 }
 
-//! Event handler stub for XCB_REPARENT_NOTIFY
+//! Event handler for XCB_REPARENT_NOTIFY
 static void handle_event_reparent_notify(xcb_generic_event_t* event)
 {
     xcb_reparent_notify_event_t* ev = (xcb_reparent_notify_event_t*)event;
-    TRACE << "Stub event handler: " << *ev;
+    TRACE << "Event handler: " << *ev;
+
+    if (!XCB_EVENT_SENT(ev))
+        WindowTree::reparent_notify(*ev);
 }
 
-//! Event handler stub for XCB_CONFIGURE_NOTIFY
+//! Event handler for XCB_CONFIGURE_NOTIFY
 static void handle_event_configure_notify(xcb_generic_event_t* event)
 {
     xcb_configure_notify_event_t* ev = (xcb_configure_notify_event_t*)event;
-    TRACE << "Stub event handler: " << *ev;
+    TRACE << "Event handler: " << *ev;
+
+    if (!XCB_EVENT_SENT(ev))
+        WindowTree::configure_notify(*ev);
 }
 
 //! Event handler for XCB_CONFIGURE_REQUEST. A configure request means a window
@@ -270,48 +303,44 @@ static void handle_event_configure_request(xcb_generic_event_t* event)
     }
     else
     {
-        // unknown window -> allow configure request
+        // unknown window -> allow configure request: fill in all fields and
+        // forward those selected by the client.
 
-        uint16_t i = 0, mask = 0;
-        uint32_t values[7];
+        typedef XcbConfigureValues<XcbConfigureWindow::valid_mask> values_type;
 
-        if (ev->value_mask & XCB_CONFIG_WINDOW_X) {
-            mask |= XCB_CONFIG_WINDOW_X;
-            values[i++] = ev->x;
-        }
-        if (ev->value_mask & XCB_CONFIG_WINDOW_Y) {
-            mask |= XCB_CONFIG_WINDOW_Y;
-            values[i++] = ev->y;
-        }
-        if (ev->value_mask & XCB_CONFIG_WINDOW_WIDTH) {
-            mask |= XCB_CONFIG_WINDOW_WIDTH;
-            values[i++] = ev->width;
-        }
-        if (ev->value_mask & XCB_CONFIG_WINDOW_HEIGHT) {
-            mask |= XCB_CONFIG_WINDOW_HEIGHT;
-            values[i++] = ev->height;
-        }
-        if (ev->value_mask & XCB_CONFIG_WINDOW_BORDER_WIDTH) {
-            mask |= XCB_CONFIG_WINDOW_BORDER_WIDTH;
-            values[i++] = ev->border_width;
-        }
-        if (ev->value_mask & XCB_CONFIG_WINDOW_SIBLING) {
-            mask |= XCB_CONFIG_WINDOW_SIBLING;
-            values[i++] = ev->sibling;
-        }
-        if (ev->value_mask & XCB_CONFIG_WINDOW_STACK_MODE) {
-            mask |= XCB_CONFIG_WINDOW_STACK_MODE;
-            values[i++] = ev->stack_mode;
-        }
+        values_type all;
+        all.set<XCB_CONFIG_WINDOW_X>(ev->x);
+        all.set<XCB_CONFIG_WINDOW_Y>(ev->y);
+        all.set<XCB_CONFIG_WINDOW_WIDTH>(ev->width);
+        all.set<XCB_CONFIG_WINDOW_HEIGHT>(ev->height);
+        all.set<XCB_CONFIG_WINDOW_BORDER_WIDTH>(ev->border_width);
+        all.set<XCB_CONFIG_WINDOW_SIBLING>(ev->sibling);
+        all.set<XCB_CONFIG_WINDOW_STACK_MODE>(ev->stack_mode);
+
+        uint32_t values[values_type::size];
+        uint32_t mask = all.select(ev->value_mask, values);
 
         if (mask != 0)
-            xcb_configure_window(g_xcb.connection, ev->window, mask, values);
+            g_xcb.req(xcb_configure_window(g_xcb.connection, ev->window,
+                                           mask, values));
     }
 }
 
-//! Event handler stub for XCB_PROPERTY_NOTIFY
+//! Event handler for XCB_CIRCULATE_NOTIFY
+static void handle_event_circulate_notify(xcb_generic_event_t* event)
+{
+    xcb_circulate_notify_event_t* ev = (xcb_circulate_notify_event_t*)event;
+    TRACE << "Event handler: " << *ev;
+
+    if (!XCB_EVENT_SENT(ev))
+        WindowTree::circulate_notify(*ev);
+}
+
+//! Event handler for XCB_PROPERTY_NOTIFY, dispatches via atom tables.
 static void handle_event_property_notify(xcb_generic_event_t* event)
 {
+    XcbAccountScope scope(XcbConnection::SUB_MANAGE);
+
     xcb_property_notify_event_t* ev = (xcb_property_notify_event_t*)event;
     TRACE << "Event handler: " << *ev;
 
@@ -321,71 +350,28 @@ static void handle_event_property_notify(xcb_generic_event_t* event)
         // known window -> possibly handle property change
         TRACE << "property_notify for window " << c;
 
-        if (ev->atom == XCB_ATOM_WM_CLASS)
-        {
-            ERROR << "window requested a change of WM_CLASS. TODO";
-        }
-        else if (ev->atom == XCB_ATOM_WM_NAME)
-        {
-            ERROR << "window requested a change of WM_NAME. TODO";
-        }
-        else if (ev->atom == g_xcb.WM_STATE.atom)
-        {
-            c->retrieve_wm_state();
-        }
-        else if (ev->atom == g_xcb.WM_PROTOCOLS.atom)
-        {
-            c->retrieve_wm_protocols();
-        }
-        else if (ev->atom == XCB_ATOM_WM_HINTS)
-        {
-            c->retrieve_wm_hints();
-        }
-        else if (ev->atom == XCB_ATOM_WM_NORMAL_HINTS)
-        {
-            c->retrieve_wm_normal_hints();
-        }
-        else if (ev->atom == XCB_ATOM_WM_TRANSIENT_FOR)
-        {
-            c->retrieve_wm_transient_for();
-        }
-        else if (ev->atom == g_xcb._NET_WM_STATE.atom)
-        { }
-        else if (ev->atom == g_xcb._NET_WM_STRUT.atom)
-        {
-            c->retrieve_ewmh_strut();
-        }
-        else if (ev->atom == g_xcb._NET_WM_WINDOW_TYPE.atom)
-        {
-            c->retrieve_ewmh_window_type();
-        }
-        else if (ev->atom == g_xcb._NET_WM_STRUT_PARTIAL.atom)
-        {
-            c->retrieve_ewmh_strut_partial();
-        }
+        client_property_handler_type h =
+            EventLoop::find_client_property(ev->atom);
+
+        if (h)
+            h(*c, ev);
         else
-        {
             INFO << "unknown atom: "
                  << ev->atom << " - " << g_xcb.find_atom_name(ev->atom);
-        }
     }
     else if (ev->window == g_xcb.root)
     {
         // root window
         TRACE << "property_notify for root window";
 
-        if (ev->atom == g_xcb._NET_SUPPORTING_WM_CHECK.atom) { }
-        else if (ev->atom == g_xcb._NET_SUPPORTED.atom) { }
-        else if (ev->atom == g_xcb._NET_NUMBER_OF_DESKTOPS.atom) { }
-        else if (ev->atom == g_xcb._NET_DESKTOP_NAMES.atom) { }
-        else if (ev->atom == g_xcb._NET_DESKTOP_LAYOUT.atom) { }
-        else if (ev->atom == g_xcb._NET_CLIENT_LIST.atom) { }
-        else if (ev->atom == g_xcb._NET_ACTIVE_WINDOW.atom) { }
+        root_property_handler_type h =
+            EventLoop::find_root_property(ev->atom);
+
+        if (h)
+            h(ev);
         else
-        {
             INFO << "unknown atom: "
                  << ev->atom << " - " << g_xcb.find_atom_name(ev->atom);
-        }
     }
     else
     {
@@ -397,52 +383,21 @@ static void handle_event_property_notify(xcb_generic_event_t* event)
     }
 }
 
-//! Event handler for XCB_CLIENT_MESSAGE
+//! Event handler for XCB_CLIENT_MESSAGE, dispatches via atom table.
 static void handle_event_client_message(xcb_generic_event_t* event)
 {
+    XcbAccountScope scope(XcbConnection::SUB_EWMH);
+
     xcb_client_message_event_t* ev = (xcb_client_message_event_t*)event;
     TRACE << "Event handler: " << *ev;
 
-    if (ev->type == g_xcb._NET_ACTIVE_WINDOW.atom)
-    {
-        Client* c = ClientList::find_window(ev->window);
-        if (c) {
-            INFO << "_NET_ACTIVE_WINDOW for window " << c;
-            ClientList::focus_window(c);
-        }
-        else
-            WARN << "_NET_ACTIVE_WINDOW for unmanaged window?";
-    }
-    else if (ev->type == g_xcb.WM_CHANGE_STATE.atom)
-    {
-        Client* c = ClientList::find_window(ev->window);
-        if (c) {
-            INFO << "WM_CHANGE_STATE for window " << c;
-
-            if (ev->data.data32[0] == 3)
-                c->set_mapped(false);
-            else
-                INFO << "Unknown WM_CHANGE_STATE request: "
-                     << ev->data.data32[0];
-        }
-        else
-            WARN << "WM_CHANGE_STATE for unmanaged window?";
-    }
-    else if (ev->type == g_xcb._NET_WM_STATE.atom)
-    {
-        Client* c = ClientList::find_window(ev->window);
-        if (c) {
-            INFO << "_NET_WM_STATE for window " << c;
-            c->retrieve_ewmh_state();
-        }
-        else
-            WARN << "_NET_WM_STATE for unmanaged window?";
-    }
+    client_message_handler_type h = EventLoop::find_client_message(ev->type);
+
+    if (h)
+        h(ev);
     else
-    {
         WARN << "unknown atom: "
              << ev->type << " - " << g_xcb.find_atom_name(ev->type);
-    }
 }
 
 //! Event handler stub for XCB_MAPPING_NOTIFY
@@ -452,6 +407,15 @@ static void handle_event_mapping_notify(xcb_generic_event_t* event)
     TRACE << "Stub event handler: " << *ev;
 }
 
+//! dispatch table atom slot -> handler of property changes on clients
+std::vector<client_property_handler_type> EventLoop::s_client_property_table;
+
+//! dispatch table atom slot -> handler of property changes on root
+std::vector<root_property_handler_type> EventLoop::s_root_property_table;
+
+//! dispatch table atom slot -> handler of client messages
+std::vector<client_message_handler_type> EventLoop::s_client_message_table;
+
 //! Populate global event handler table
 void EventLoop::setup_global_eventtable()
 {
@@ -483,9 +447,184 @@ void EventLoop::setup_global_eventtable()
     s_eventtable[XCB_REPARENT_NOTIFY] = handle_event_reparent_notify;     // 21
     s_eventtable[XCB_CONFIGURE_NOTIFY] = handle_event_configure_notify;   // 22
     s_eventtable[XCB_CONFIGURE_REQUEST] = handle_event_configure_request; // 23
+    s_eventtable[XCB_CIRCULATE_NOTIFY] = handle_event_circulate_notify;   // 26
     s_eventtable[XCB_PROPERTY_NOTIFY] = handle_event_property_notify;     // 28
     s_eventtable[XCB_CLIENT_MESSAGE] = handle_event_client_message;       // 33
     s_eventtable[XCB_MAPPING_NOTIFY] = handle_event_mapping_notify;       // 34
+
+    // let subsystems register their property and client message handlers
+    ClientList::setup_event_handlers();
+    Ewmh::setup_event_handlers();
+}
+
+//! self-pipe used to deliver asynchronous signals into the event loop
+int EventLoop::s_signal_pipe[2] = { -1, -1 };
+
+//! Signal handler writing the signal number into the self-pipe.
+void EventLoop::signal_handler(int signum)
+{
+    int saved_errno = errno;
+
+    char c = signum;
+    if (write(s_signal_pipe[1], &c, 1)) { }
+
+    errno = saved_errno;
+}
+
+//! Install signal handlers for SIGUSR1 (dump log ring) and SIGUSR2 (dump
+//! statistics).
+void EventLoop::setup_signals()
+{
+    if (pipe2(s_signal_pipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        ERROR << "Could not create signal pipe: " << strerror(errno);
+        return;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = signal_handler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+
+    sigaction(SIGUSR1, &sa, NULL);
+    sigaction(SIGUSR2, &sa, NULL);
+}
+
+//! Process signals delivered via the self-pipe.
+void EventLoop::process_signals()
+{
+    char c;
+    while (read(s_signal_pipe[0], &c, 1) == 1)
+    {
+        if (c == SIGUSR1) {
+            INFO << "SIGUSR1 received, dumping log ring.";
+            LogRing::dump(std::cerr);
+        }
+        else if (c == SIGUSR2) {
+            INFO << "SIGUSR2 received, dumping statistics.";
+            EventStats::dump();
+            BindingList::dump_stats();
+            g_xcb.dump_accounting();
+            Launcher::dump_stats();
+            WindowTree::dump_stats();
+            Stacking::dump_stats();
+        }
+    }
+}
+
+//! events read ahead from the queue while processing errors
+std::deque<xcb_generic_event_t*> EventLoop::s_queued;
+
+//! Route all errors already received to their handlers, without waiting.
+void EventLoop::process_queued_errors()
+{
+    xcb_generic_event_t* event;
+
+    while ((event = xcb_poll_for_queued_event(g_xcb.connection)))
+    {
+        if (EventRecorder::enabled())
+            EventRecorder::record_event(event);
+
+        if (XCB_EVENT_RESPONSE_TYPE(event) == 0) {
+            handle_event_error(event);
+            free(event);
+        }
+        else
+            s_queued.push_back(event);
+    }
+}
+
+//! Apply the layout and stacking changes of all processed events and flush.
+void EventLoop::flush_changes()
+{
+    // combine all stacking changes of the processed events
+    DeskList::relayout();
+    Stacking::restack();
+
+    g_xcb.flush();
+    EventStats::record_flush();
+}
+
+//! Poll for an event that will be processed outside the global event loop.
+autofree_ptr<xcb_generic_event_t> EventLoop::wait()
+{
+    if (!s_queued.empty())
+    {
+        // return events read ahead first, they were already recorded
+        xcb_generic_event_t* event = s_queued.front();
+        s_queued.pop_front();
+        WindowTree::verify(event);
+        return autofree_ptr<xcb_generic_event_t>(event);
+    }
+
+    while (!s_terminate)
+    {
+        if (Launcher::has_pending())
+            Launcher::receive_reports();
+
+        // pick up atom names requested for logging
+        g_xcb.process_atom_names();
+
+        flush_changes();
+
+        if (g_xcb.connection_has_error()) {
+            FATAL << "X11 connection got interrupted";
+            exit(EXIT_FAILURE);
+        }
+
+        xcb_generic_event_t* event = xcb_poll_for_event(g_xcb.connection);
+
+        if (event) {
+            if (EventRecorder::enabled())
+                EventRecorder::record_event(event);
+
+            WindowTree::verify(event);
+            return autofree_ptr<xcb_generic_event_t>(event);
+        }
+
+        // all events were processed: compare or issue a consistency check
+        WindowTree::verify(NULL);
+        g_xcb.flush();
+
+        // polling for the check's reply may have read events from the
+        // socket into xcb's queue, poll() would not wake up for them.
+        event = xcb_poll_for_queued_event(g_xcb.connection);
+
+        if (event) {
+            if (EventRecorder::enabled())
+                EventRecorder::record_event(event);
+
+            WindowTree::verify(event);
+            return autofree_ptr<xcb_generic_event_t>(event);
+        }
+
+        // sleep until the X connection, the signal pipe or, while spawn
+        // reports are outstanding, the launcher become readable. poll()
+        // ignores negative file descriptors.
+        struct pollfd pfd[3];
+        pfd[0].fd = g_xcb.get_file_descriptor();
+        pfd[1].fd = s_signal_pipe[0];
+        pfd[2].fd = Launcher::has_pending() ? Launcher::fd() : -1;
+
+        for (struct pollfd& p : pfd) {
+            p.events = POLLIN;
+            p.revents = 0;
+        }
+
+        if (poll(pfd, 3, -1) < 0 && errno != EINTR)
+        {
+            FATAL << "poll() failed: " << strerror(errno);
+            exit(EXIT_FAILURE);
+        }
+
+        if (pfd[1].revents & POLLIN)
+            process_signals();
+
+        if (pfd[2].revents & (POLLIN | POLLHUP))
+            Launcher::receive_reports();
+    }
+
+    return autofree_ptr<xcb_generic_event_t>();
 }
 
 //! Process all events until terminate() is called.
@@ -26,13 +26,31 @@
 #include "xcb.h"
 #include "log.h"
 #include "screen.h"
+#include "launcher.h"
+#include "stats.h"
+#include "tools.h"
+#include "trace.h"
 #include <array>
+#include <deque>
+#include <vector>
 #include <xcb/xcb_event.h>
 #include <xcb/randr.h>
 
 //! All event handlers called by the EventLoop class have this type
 typedef void (* event_handler_type)(xcb_generic_event_t* event);
 
+class Client;
+
+//! Handler of PropertyNotify events on a managed client window
+typedef void (* client_property_handler_type)(
+    Client& c, xcb_property_notify_event_t* ev);
+
+//! Handler of PropertyNotify events on the root window
+typedef void (* root_property_handler_type)(xcb_property_notify_event_t* ev);
+
+//! Handler of ClientMessage events
+typedef void (* client_message_handler_type)(xcb_client_message_event_t* ev);
+
 /*!
  * EventLoop is a wrapper for xcb_wait_for_event() calls and contains an global
  * event handler table to call the configured handlers.
@@ -47,12 +65,55 @@ protected:
     //! the global event handler table.
     static eventtable_type s_eventtable;
 
+    //! dispatch table atom slot -> handler of property changes on clients
+    static std::vector<client_property_handler_type> s_client_property_table;
+
+    //! dispatch table atom slot -> handler of property changes on root
+    static std::vector<root_property_handler_type> s_root_property_table;
+
+    //! dispatch table atom slot -> handler of client messages
+    static std::vector<client_message_handler_type> s_client_message_table;
+
+    //! Enter a handler into a dispatch table at the given atom slot.
+    template <typename Handler>
+    static void register_handler(std::vector<Handler>& table,
+                                 unsigned int slot, Handler handler)
+    {
+        ASSERT(slot < g_xcb.atom_slot_count());
+        if (table.size() < g_xcb.atom_slot_count())
+            table.resize(g_xcb.atom_slot_count(), NULL);
+        if (table[slot])
+            WARN << "Replacing handler of atom slot " << slot;
+        table[slot] = handler;
+    }
+
+    //! Look up the handler of an atom in a dispatch table, or return NULL.
+    template <typename Handler>
+    static Handler find_handler(const std::vector<Handler>& table,
+                                xcb_atom_t atom)
+    {
+        unsigned int slot = g_xcb.atom_slot(atom);
+        return slot < table.size() ? table[slot] : NULL;
+    }
+
+    //! events read ahead from the queue while processing errors
+    static std::deque<xcb_generic_event_t*> s_queued;
+
     //! global (graceful) termination flag.
     static bool s_terminate;
 
     //! first id of a RandR event
     static uint8_t s_randr_first_event;
 
+    //! self-pipe used to deliver asynchronous signals into the event loop
+    static int s_signal_pipe[2];
+
+    //! Signal handler writing the signal number into the self-pipe.
+    static void signal_handler(int signum);
+
+    //! Process signals delivered via the self-pipe.
+    static void process_signals();
+
 public:
     //! Set global graceful termination flag
     static void terminate()
@@ -66,11 +127,57 @@ public:
     //! Populate global event handler table
     static void setup_global_eventtable();
 
+    //! Register a handler for property changes on managed client windows.
+    //! The atom slot is determined via XcbConnection::atom_slot().
+    static void register_client_property(unsigned int slot,
+                                         client_property_handler_type h)
+    {
+        register_handler(s_client_property_table, slot, h);
+    }
+
+    //! Register a handler for property changes on the root window.
+    static void register_root_property(unsigned int slot,
+                                       root_property_handler_type h)
+    {
+        register_handler(s_root_property_table, slot, h);
+    }
+
+    //! Register a handler for client messages of a type.
+    static void register_client_message(unsigned int slot,
+                                        client_message_handler_type h)
+    {
+        register_handler(s_client_message_table, slot, h);
+    }
+
+    //! Return registered handler for property changes of an atom on managed
+    //! client windows, or NULL.
+    static client_property_handler_type find_client_property(xcb_atom_t atom)
+    {
+        return find_handler(s_client_property_table, atom);
+    }
+
+    //! Return registered handler for property changes of an atom on the root
+    //! window, or NULL.
+    static root_property_handler_type find_root_property(xcb_atom_t atom)
+    {
+        return find_handler(s_root_property_table, atom);
+    }
+
+    //! Return registered handler for client messages of a type, or NULL.
+    static client_message_handler_type find_client_message(xcb_atom_t type)
+    {
+        return find_handler(s_client_message_table, type);
+    }
+
     //! Process an event according to the global event handler table
     static void process_global(xcb_generic_event_t* event)
     {
         if (!event) return;
 
+        TraceSpan span("process_global", event);
+
+        uint64_t start = monotonic_ns();
+        XcbConnection::Accounting xstart = g_xcb.accounting_total;
         uint8_t evtype = XCB_EVENT_RESPONSE_TYPE(event);
 
         if (evtype < s_eventtable.size() && s_eventtable[evtype])
@@ -80,25 +187,24 @@ public:
             ScreenList::randr_screen_change_notify(event);
         else
             ERROR << "Unknown event type " << uint32_t(evtype);
-    }
 
-    //! Poll for an event that will be processed outside the global event loop.
-    static autofree_ptr<xcb_generic_event_t> wait()
-    {
-        if (s_terminate)
-            return autofree_ptr<xcb_generic_event_t>();
+        EventStats::record_event(event, start, xstart, monotonic_ns());
+    }
 
-        g_xcb.flush();
+    //! Install signal handlers for SIGUSR1 (dump log ring) and SIGUSR2 (dump
+    //! statistics).
+    static void setup_signals();
 
-        if (g_xcb.connection_has_error()) {
-            FATAL << "X11 connection got interrupted";
-            exit(EXIT_FAILURE);
-        }
+    //! Apply the layout and stacking changes of all processed events and flush
+    //! the resulting requests, as done before waiting for further events.
+    static void flush_changes();
 
-        xcb_generic_event_t* event = xcb_wait_for_event(g_xcb.connection);
+    //! Poll for an event that will be processed outside the global event loop.
+    static autofree_ptr<xcb_generic_event_t> wait();
 
-        return autofree_ptr<xcb_generic_event_t>(event);
-    }
+    //! Route all errors already received to their handlers, without waiting.
+    //! Other events are kept and returned by wait() in order.
+    static void process_queued_errors();
 
     //! Process all events until terminate() is called.
     static void loop_global();
@@ -21,6 +21,8 @@
  ******************************************************************************/
 
 #include "ewmh.h"
+#include "event.h"
+#include "xcb-window.h"
 
 //! The window manager name to set.
 const std::string Ewmh::s_wmname = "TileWM";
@@ -28,18 +30,13 @@ const std::string Ewmh::s_wmname = "TileWM";
 //! Set up and publish available supported EWMH methods.
 void Ewmh::setup()
 {
-    // *** create a tiny sentinel window for _NET_SUPPORTING_WM_CHECK
+    XcbAccountScope scope(XcbConnection::SUB_EWMH);
 
-    xcb_window_t win = g_xcb.generate_id();
+    // *** create a tiny sentinel window for _NET_SUPPORTING_WM_CHECK
 
-    xcb_create_window(g_xcb.connection,
-                      XCB_COPY_FROM_PARENT,
-                      win,
-                      g_xcb.root,
-                      0, 0, 1, 1, 0,
-                      XCB_WINDOW_CLASS_INPUT_OUTPUT,
-                      XCB_COPY_FROM_PARENT,
-                      0, NULL);
+    xcb_window_t win =
+        XcbWindow::create(g_xcb.root, Rectangle(0, 0, 1, 1), 0,
+                          XcbAttributeValues<0>()).window();
 
     g_xcb.change_property(g_xcb.root, g_xcb._NET_SUPPORTING_WM_CHECK.atom,
                           XCB_ATOM_WINDOW, 32, 1, &win);
@@ -62,13 +59,15 @@ void Ewmh::setup()
 //! Tear down supporting structures.
 void Ewmh::teardown()
 {
+    XcbAccountScope scope(XcbConnection::SUB_EWMH);
+
     xcb_get_property_cookie_t gpc =
-        xcb_get_property(g_xcb.connection, 0, g_xcb.root,
-                         g_xcb._NET_SUPPORTING_WM_CHECK.atom,
-                         XCB_ATOM_WINDOW, 0, 1);
+        g_xcb.req(xcb_get_property(g_xcb.connection, 0, g_xcb.root,
+                                   g_xcb._NET_SUPPORTING_WM_CHECK.atom,
+                                   XCB_ATOM_WINDOW, 0, 1));
 
     autofree_ptr<xcb_get_property_reply_t> gpr(
-        xcb_get_property_reply(g_xcb.connection, gpc, NULL)
+        g_xcb.reply(xcb_get_property_reply, gpc, NULL)
         );
 
     if (!gpr || gpr->type != XCB_ATOM_WINDOW) {
@@ -76,7 +75,7 @@ void Ewmh::teardown()
     }
     else {
         xcb_window_t win = *((xcb_window_t*)xcb_get_property_value(gpr.get()));
-        xcb_destroy_window(g_xcb.connection, win);
+        g_xcb.req(xcb_destroy_window(g_xcb.connection, win));
     }
 
     g_xcb.delete_property(g_xcb.root, g_xcb._NET_SUPPORTING_WM_CHECK);
@@ -84,4 +83,29 @@ void Ewmh::teardown()
     g_xcb.delete_property(g_xcb.root, g_xcb._NET_SUPPORTED);
 }
 
+//! Property change handler for root properties published by us or by other
+//! EWMH participants, which need no action.
+static void property_root_ignore(xcb_property_notify_event_t*)
+{ }
+
+//! Register handlers for changes of the root properties we publish.
+void Ewmh::setup_event_handlers()
+{
+    static const XcbConnection::XcbAtom* const ignored[] = {
+        &g_xcb._NET_SUPPORTING_WM_CHECK,
+        &g_xcb._NET_SUPPORTED,
+        &g_xcb._NET_NUMBER_OF_DESKTOPS,
+        &g_xcb._NET_DESKTOP_NAMES,
+        &g_xcb._NET_DESKTOP_LAYOUT,
+        &g_xcb._NET_CLIENT_LIST,
+        &g_xcb._NET_ACTIVE_WINDOW,
+    };
+
+    for (const XcbConnection::XcbAtom* a : ignored)
+    {
+        EventLoop::register_root_property(
+            g_xcb.atom_slot(*a), property_root_ignore);
+    }
+}
+
 /******************************************************************************/
@@ -41,6 +41,9 @@ public:
 
     //! Tear down supporting structures.
     static void teardown();
+
+    //! Register handlers for changes of the root properties we publish.
+    static void setup_event_handlers();
 };
 
 #endif // !TILEWM_EWMH_HEADER
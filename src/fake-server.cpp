@@ -0,0 +1,1041 @@
+/******************************************************************************/
+/*! \file src/fake-server.cpp
+ *
+ * In-process fake X server for offline simulations of the WM.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "fake-server.h"
+#include "log.h"
+#include "xcb.h"
+#include "event.h"
+#include "tools.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+//! Read exactly size bytes from the socket.
+bool XServerSocket::read_full(void* data, size_t size)
+{
+    char* p = (char*)data;
+
+    while (size > 0)
+    {
+        ssize_t rb = read(m_fd, p, size);
+        if (rb < 0 && errno == EINTR) continue;
+        if (rb <= 0) return false;
+
+        p += rb, size -= rb;
+    }
+    return true;
+}
+
+//! Write exactly size bytes to the socket.
+bool XServerSocket::write_full(const void* data, size_t size)
+{
+    const char* p = (const char*)data;
+
+    while (size > 0)
+    {
+        ssize_t wb = write(m_fd, p, size);
+        if (wb < 0 && errno == EINTR) continue;
+        if (wb <= 0) return false;
+
+        p += wb, size -= wb;
+    }
+    return true;
+}
+
+//! Read the client's connection setup request.
+bool XServerSocket::read_setup_request()
+{
+    char header[12];
+    if (!read_full(header, sizeof(header))) return false;
+
+    uint16_t name_len, data_len;
+    memcpy(&name_len, header + 6, 2);
+    memcpy(&data_len, header + 8, 2);
+
+    std::vector<char> auth(((name_len + 3) & ~3) + ((data_len + 3) & ~3));
+    return read_full(auth.data(), auth.size());
+}
+
+//! Read the next request from the socket.
+bool XServerSocket::read_request()
+{
+    m_request.resize(4);
+    if (!read_full(m_request.data(), 4)) return false;
+
+    uint32_t length;
+    uint16_t length16;
+    memcpy(&length16, m_request.data() + 2, 2);
+
+    size_t header = 4;
+
+    if (length16 == 0) {
+        // BIG-REQUESTS: 32-bit length follows
+        m_request.resize(8);
+        if (!read_full(m_request.data() + 4, 4)) return false;
+        memcpy(&length, m_request.data() + 4, 4);
+        header = 8;
+    }
+    else {
+        length = length16;
+    }
+
+    if (length * 4 < header) return false;
+
+    m_request.resize(length * 4);
+    if (!read_full(m_request.data() + header, length * 4 - header))
+        return false;
+
+    ++m_seq;
+    return true;
+}
+
+//! Send an event or reply with the current sequence number patched in.
+bool XServerSocket::send_with_seq(const void* data, size_t size)
+{
+    // events are padded to 32 bytes
+    std::vector<char> buf(std::max<size_t>(size, 32));
+    memcpy(buf.data(), data, size);
+
+    if ((buf[0] & 0x7F) != XCB_KEYMAP_NOTIFY)
+        memcpy(buf.data() + 2, &m_seq, 2);
+
+    return write_full(buf.data(), buf.size());
+}
+
+//! Send a reply, fills in sequence number and length.
+bool XServerSocket::send_reply(const void* data, size_t size)
+{
+    // replies are at least 32 bytes and padded to a multiple of four.
+    size_t total = 32 + ((std::max<size_t>(size, 32) - 32 + 3) & ~3);
+
+    std::vector<char> buf(total);
+    memcpy(buf.data(), data, size);
+
+    xcb_generic_reply_t* r = (xcb_generic_reply_t*)buf.data();
+    r->response_type = 1; // X_Reply
+    r->sequence = m_seq;
+    r->length = (total - 32) / 4;
+
+    return write_full(buf.data(), buf.size());
+}
+
+//! Send an error for the last request read.
+bool XServerSocket::send_error(uint8_t code, uint32_t resource)
+{
+    xcb_generic_error_t e;
+    memset(&e, 0, sizeof(e));
+    e.response_type = 0;
+    e.error_code = code;
+    e.sequence = m_seq;
+    e.resource_id = resource;
+    e.minor_code = m_request[1];
+    e.major_code = m_request[0];
+
+    return write_full(&e, 32);
+}
+
+//! Check whether a core protocol request has a reply.
+bool XServerSocket::core_expects_reply(uint8_t major)
+{
+    switch (major)
+    {
+    case 3: case 14: case 15: case 16: case 17: case 20: case 21:
+    case 23: case 26: case 31: case 38: case 39: case 40: case 43:
+    case 44: case 47: case 48: case 49: case 50: case 52: case 73:
+    case 83: case 84: case 85: case 86: case 87: case 91: case 92:
+    case 97: case 98: case 99: case 101: case 103: case 106: case 108:
+    case 110: case 116: case 117: case 118: case 119:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+const uint16_t FakeXServer::screen_width;
+const uint16_t FakeXServer::screen_height;
+const xcb_window_t FakeXServer::root;
+const xcb_window_t FakeXServer::first_client_id;
+
+//! Construct fake server on one end of a socketpair.
+FakeXServer::FakeXServer(int fd)
+    : XServerSocket(fd),
+      m_focus(XCB_INPUT_FOCUS_POINTER_ROOT),
+      m_next_client_id(first_client_id),
+      m_time(1), m_requests(0)
+{
+    for (unsigned int i = 0; i < XcbConnection::predefined_atom_count; ++i)
+    {
+        m_atom_names.push_back(XcbConnection::predefined_atom_names[i]);
+        if (i) m_atoms[XcbConnection::predefined_atom_names[i]] = i;
+    }
+
+    Window& r = m_windows[root];
+    r.parent = XCB_WINDOW_NONE;
+    r.geometry = Rectangle(0, 0, screen_width, screen_height);
+    r.border_width = 0;
+    r.mapped = true;
+    r.override_redirect = false;
+    r.event_mask = 0;
+}
+
+//! Build and send the connection setup data.
+bool FakeXServer::send_setup()
+{
+    static const char vendor[] = "tilewm fake";
+    size_t vendor_len = (sizeof(vendor) - 1 + 3) & ~3;
+
+    std::vector<char> buf(sizeof(xcb_setup_t) + vendor_len
+                          + sizeof(xcb_format_t)
+                          + sizeof(xcb_screen_t) + sizeof(xcb_depth_t)
+                          + sizeof(xcb_visualtype_t));
+    char* p = buf.data();
+
+    xcb_setup_t* s = (xcb_setup_t*)p;
+    s->status = 1;
+    s->protocol_major_version = 11;
+    s->protocol_minor_version = 0;
+    s->length = (buf.size() - 8) / 4;
+    s->release_number = 1;
+    s->resource_id_base = 0x200000;
+    s->resource_id_mask = 0x1FFFFF;
+    s->vendor_len = sizeof(vendor) - 1;
+    s->maximum_request_length = 0xFFFF;
+    s->roots_len = 1;
+    s->pixmap_formats_len = 1;
+    s->image_byte_order = XCB_IMAGE_ORDER_LSB_FIRST;
+    s->bitmap_format_bit_order = XCB_IMAGE_ORDER_LSB_FIRST;
+    s->bitmap_format_scanline_unit = 32;
+    s->bitmap_format_scanline_pad = 32;
+    s->min_keycode = 8;
+    s->max_keycode = 255;
+    p += sizeof(xcb_setup_t);
+
+    memcpy(p, vendor, sizeof(vendor) - 1);
+    p += vendor_len;
+
+    xcb_format_t* f = (xcb_format_t*)p;
+    f->depth = 24;
+    f->bits_per_pixel = 32;
+    f->scanline_pad = 32;
+    p += sizeof(xcb_format_t);
+
+    xcb_screen_t* scr = (xcb_screen_t*)p;
+    scr->root = root;
+    scr->default_colormap = 0x20;
+    scr->white_pixel = 0xFFFFFF;
+    scr->black_pixel = 0;
+    scr->width_in_pixels = screen_width;
+    scr->height_in_pixels = screen_height;
+    scr->width_in_millimeters = screen_width / 4;
+    scr->height_in_millimeters = screen_height / 4;
+    scr->min_installed_maps = scr->max_installed_maps = 1;
+    scr->root_visual = 0x21;
+    scr->root_depth = 24;
+    scr->allowed_depths_len = 1;
+    p += sizeof(xcb_screen_t);
+
+    xcb_depth_t* d = (xcb_depth_t*)p;
+    d->depth = 24;
+    d->visuals_len = 1;
+    p += sizeof(xcb_depth_t);
+
+    xcb_visualtype_t* v = (xcb_visualtype_t*)p;
+    v->visual_id = 0x21;
+    v->_class = XCB_VISUAL_CLASS_TRUE_COLOR;
+    v->bits_per_rgb_value = 8;
+    v->colormap_entries = 256;
+    v->red_mask = 0xFF0000;
+    v->green_mask = 0x00FF00;
+    v->blue_mask = 0x0000FF;
+
+    return write_full(buf.data(), buf.size());
+}
+
+//! Serve requests of the WM until it disconnects.
+void FakeXServer::run()
+{
+    if (!read_setup_request()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!send_setup()) return;
+    }
+
+    while (read_request())
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        handle_request();
+        ++m_requests;
+    }
+}
+
+//! Find a window or send a BadWindow error.
+FakeXServer::Window* FakeXServer::find_window(xcb_window_t win)
+{
+    std::map<xcb_window_t, Window>::iterator it = m_windows.find(win);
+    if (it != m_windows.end()) return &it->second;
+
+    send_error(XCB_WINDOW, win);
+    return NULL;
+}
+
+//! Apply CreateWindow/ChangeWindowAttributes value list.
+void FakeXServer::apply_attributes(Window& w, uint32_t mask,
+                                   const uint32_t* values)
+{
+    for (uint32_t bit = 1; bit <= XCB_CW_CURSOR; bit <<= 1)
+    {
+        if (!(mask & bit)) continue;
+
+        if (bit == XCB_CW_OVERRIDE_REDIRECT)
+            w.override_redirect = (*values != 0);
+        else if (bit == XCB_CW_EVENT_MASK)
+            w.event_mask = *values;
+
+        ++values;
+    }
+}
+
+//! Send an event if the WM selected it.
+void FakeXServer::deliver(const Window& w, uint32_t mask,
+                          uint32_t substructure_mask,
+                          const void* event, size_t size)
+{
+    bool selected = (w.event_mask & mask) != 0;
+
+    if (!selected && substructure_mask && w.parent != XCB_WINDOW_NONE)
+        selected = (m_windows[w.parent].event_mask & substructure_mask) != 0;
+
+    if (selected)
+        send_with_seq(event, size);
+}
+
+//! Map a window and notify the WM.
+void FakeXServer::do_map(xcb_window_t win, Window& w)
+{
+    if (w.mapped) return;
+    w.mapped = true;
+
+    xcb_map_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_MAP_NOTIFY;
+    ev.event = w.parent;
+    ev.window = win;
+    ev.override_redirect = w.override_redirect;
+
+    deliver(w, XCB_EVENT_MASK_STRUCTURE_NOTIFY,
+            XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY, &ev, sizeof(ev));
+}
+
+//! Unmap a window and notify the WM.
+void FakeXServer::do_unmap(xcb_window_t win, Window& w)
+{
+    if (!w.mapped) return;
+    w.mapped = false;
+
+    xcb_unmap_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_UNMAP_NOTIFY;
+    ev.event = w.parent;
+    ev.window = win;
+
+    deliver(w, XCB_EVENT_MASK_STRUCTURE_NOTIFY,
+            XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY, &ev, sizeof(ev));
+}
+
+//! Destroy a window and its children, and notify the WM.
+void FakeXServer::do_destroy(xcb_window_t win)
+{
+    std::map<xcb_window_t, Window>::iterator it = m_windows.find(win);
+    if (it == m_windows.end() || win == root) return;
+
+    Window& w = it->second;
+    do_unmap(win, w);
+
+    // destroy children first, copy as the list is modified
+    std::vector<xcb_window_t> children = w.children;
+    for (xcb_window_t c : children)
+        do_destroy(c);
+
+    xcb_destroy_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_DESTROY_NOTIFY;
+    ev.event = w.parent;
+    ev.window = win;
+
+    deliver(w, XCB_EVENT_MASK_STRUCTURE_NOTIFY,
+            XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY, &ev, sizeof(ev));
+
+    std::vector<xcb_window_t>& siblings = m_windows[w.parent].children;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), win));
+
+    if (m_focus == win) m_focus = XCB_INPUT_FOCUS_POINTER_ROOT;
+
+    m_windows.erase(it);
+}
+
+//! Apply ConfigureWindow value list and notify the WM.
+void FakeXServer::apply_configure(xcb_window_t win, Window& w,
+                                  uint16_t mask, const uint32_t* values)
+{
+    if (mask & XCB_CONFIG_WINDOW_X) w.geometry.x = *values++;
+    if (mask & XCB_CONFIG_WINDOW_Y) w.geometry.y = *values++;
+    if (mask & XCB_CONFIG_WINDOW_WIDTH) w.geometry.w = *values++;
+    if (mask & XCB_CONFIG_WINDOW_HEIGHT) w.geometry.h = *values++;
+    if (mask & XCB_CONFIG_WINDOW_BORDER_WIDTH) w.border_width = *values++;
+
+    xcb_window_t sibling = XCB_WINDOW_NONE;
+    if (mask & XCB_CONFIG_WINDOW_SIBLING) sibling = *values++;
+
+    if (mask & XCB_CONFIG_WINDOW_STACK_MODE)
+    {
+        std::vector<xcb_window_t>& siblings = m_windows[w.parent].children;
+        siblings.erase(std::find(siblings.begin(), siblings.end(), win));
+
+        std::vector<xcb_window_t>::iterator pos =
+            std::find(siblings.begin(), siblings.end(), sibling);
+
+        if (pos == siblings.end())
+            pos = (*values == XCB_STACK_MODE_BELOW ? siblings.begin()
+                   : siblings.end());
+        else if (*values != XCB_STACK_MODE_BELOW)
+            ++pos;
+
+        siblings.insert(pos, win);
+    }
+
+    // sibling directly below the window, or none if it is at the bottom
+    const std::vector<xcb_window_t>& siblings = m_windows[w.parent].children;
+    std::vector<xcb_window_t>::const_iterator si =
+        std::find(siblings.begin(), siblings.end(), win);
+
+    xcb_configure_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_CONFIGURE_NOTIFY;
+    ev.event = w.parent;
+    ev.window = win;
+    ev.above_sibling = XCB_WINDOW_NONE;
+    if (si != siblings.begin()) ev.above_sibling = *(si - 1);
+    ev.x = w.geometry.x;
+    ev.y = w.geometry.y;
+    ev.width = w.geometry.w;
+    ev.height = w.geometry.h;
+    ev.border_width = w.border_width;
+    ev.override_redirect = w.override_redirect;
+
+    deliver(w, XCB_EVENT_MASK_STRUCTURE_NOTIFY,
+            XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY, &ev, sizeof(ev));
+}
+
+//! Change a property and notify the WM.
+void FakeXServer::do_change_property(xcb_window_t win, Window& w,
+                                     uint8_t mode, xcb_atom_t property,
+                                     xcb_atom_t type, uint8_t format,
+                                     const void* data, size_t size)
+{
+    Property& p = w.props[property];
+
+    if (mode == XCB_PROP_MODE_REPLACE || p.data.empty()) {
+        p.type = type;
+        p.format = format;
+        p.data.assign((const char*)data, size);
+    }
+    else if (mode == XCB_PROP_MODE_PREPEND) {
+        p.data.insert(0, (const char*)data, size);
+    }
+    else {
+        p.data.append((const char*)data, size);
+    }
+
+    xcb_property_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_PROPERTY_NOTIFY;
+    ev.window = win;
+    ev.atom = property;
+    ev.time = m_time++;
+    ev.state = XCB_PROPERTY_NEW_VALUE;
+
+    deliver(w, XCB_EVENT_MASK_PROPERTY_CHANGE, 0, &ev, sizeof(ev));
+}
+
+//! Delete a property and notify the WM.
+void FakeXServer::do_delete_property(xcb_window_t win, Window& w,
+                                     xcb_atom_t property)
+{
+    if (!w.props.erase(property)) return;
+
+    xcb_property_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_PROPERTY_NOTIFY;
+    ev.window = win;
+    ev.atom = property;
+    ev.time = m_time++;
+    ev.state = XCB_PROPERTY_DELETE;
+
+    deliver(w, XCB_EVENT_MASK_PROPERTY_CHANGE, 0, &ev, sizeof(ev));
+}
+
+//! Intern an atom name.
+xcb_atom_t FakeXServer::do_intern(const std::string& name)
+{
+    std::map<std::string, xcb_atom_t>::iterator it = m_atoms.find(name);
+    if (it != m_atoms.end()) return it->second;
+
+    xcb_atom_t atom = m_atom_names.size();
+    m_atom_names.push_back(name);
+    m_atoms[name] = atom;
+    return atom;
+}
+
+//! Handle the last request read.
+void FakeXServer::handle_request()
+{
+    const char* req = m_request.data();
+
+    switch (uint8_t(req[0]))
+    {
+    case XCB_CREATE_WINDOW: {
+        const xcb_create_window_request_t* r =
+            (const xcb_create_window_request_t*)req;
+
+        Window* parent = find_window(r->parent);
+        if (!parent) break;
+
+        Window& w = m_windows[r->wid];
+        w.parent = r->parent;
+        w.geometry = Rectangle(r->x, r->y, r->width, r->height);
+        w.border_width = r->border_width;
+        w.mapped = false;
+        w.override_redirect = false;
+        w.event_mask = 0;
+        apply_attributes(w, r->value_mask, (const uint32_t*)(r + 1));
+
+        m_windows[r->parent].children.push_back(r->wid);
+
+        xcb_create_notify_event_t ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.response_type = XCB_CREATE_NOTIFY;
+        ev.parent = r->parent;
+        ev.window = r->wid;
+        ev.x = r->x;
+        ev.y = r->y;
+        ev.width = r->width;
+        ev.height = r->height;
+        ev.border_width = r->border_width;
+        ev.override_redirect = w.override_redirect;
+
+        deliver(w, 0, XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY, &ev, sizeof(ev));
+        break;
+    }
+    case XCB_CHANGE_WINDOW_ATTRIBUTES: {
+        const xcb_change_window_attributes_request_t* r =
+            (const xcb_change_window_attributes_request_t*)req;
+
+        Window* w = find_window(r->window);
+        if (!w) break;
+
+        apply_attributes(*w, r->value_mask, (const uint32_t*)(r + 1));
+        break;
+    }
+    case XCB_GET_WINDOW_ATTRIBUTES: {
+        const xcb_get_window_attributes_request_t* r =
+            (const xcb_get_window_attributes_request_t*)req;
+
+        Window* w = find_window(r->window);
+        if (!w) break;
+
+        xcb_get_window_attributes_reply_t rep;
+        memset(&rep, 0, sizeof(rep));
+        rep.visual = 0x21;
+        rep._class = XCB_WINDOW_CLASS_INPUT_OUTPUT;
+        rep.map_state = w->mapped ? XCB_MAP_STATE_VIEWABLE
+                        : XCB_MAP_STATE_UNMAPPED;
+        rep.override_redirect = w->override_redirect;
+        rep.colormap = 0x20;
+        rep.all_event_masks = w->event_mask;
+        rep.your_event_mask = w->event_mask;
+
+        send_reply(&rep, sizeof(rep));
+        break;
+    }
+    case XCB_DESTROY_WINDOW: {
+        const xcb_destroy_window_request_t* r =
+            (const xcb_destroy_window_request_t*)req;
+
+        if (find_window(r->window))
+            do_destroy(r->window);
+        break;
+    }
+    case XCB_MAP_WINDOW: {
+        const xcb_map_window_request_t* r =
+            (const xcb_map_window_request_t*)req;
+
+        Window* w = find_window(r->window);
+        if (w) do_map(r->window, *w);
+        break;
+    }
+    case XCB_UNMAP_WINDOW: {
+        const xcb_unmap_window_request_t* r =
+            (const xcb_unmap_window_request_t*)req;
+
+        Window* w = find_window(r->window);
+        if (w) do_unmap(r->window, *w);
+        break;
+    }
+    case XCB_CONFIGURE_WINDOW: {
+        const xcb_configure_window_request_t* r =
+            (const xcb_configure_window_request_t*)req;
+
+        const uint32_t* values = (const uint32_t*)(r + 1);
+
+        Window* w = find_window(r->window);
+        if (!w) break;
+
+        // a sibling given for stacking must exist
+        if (r->value_mask & XCB_CONFIG_WINDOW_SIBLING)
+        {
+            xcb_window_t sibling = values[
+                __builtin_popcount(r->value_mask &
+                                   (XCB_CONFIG_WINDOW_SIBLING - 1))];
+
+            if (!find_window(sibling)) break;
+        }
+
+        apply_configure(r->window, *w, r->value_mask, values);
+        break;
+    }
+    case XCB_GET_GEOMETRY: {
+        const xcb_get_geometry_request_t* r =
+            (const xcb_get_geometry_request_t*)req;
+
+        Window* w = find_window(r->drawable);
+        if (!w) break;
+
+        xcb_get_geometry_reply_t rep;
+        memset(&rep, 0, sizeof(rep));
+        rep.depth = 24;
+        rep.root = root;
+        rep.x = w->geometry.x;
+        rep.y = w->geometry.y;
+        rep.width = w->geometry.w;
+        rep.height = w->geometry.h;
+        rep.border_width = w->border_width;
+
+        send_reply(&rep, sizeof(rep));
+        break;
+    }
+    case XCB_QUERY_TREE: {
+        const xcb_query_tree_request_t* r =
+            (const xcb_query_tree_request_t*)req;
+
+        Window* w = find_window(r->window);
+        if (!w) break;
+
+        std::vector<char> buf(sizeof(xcb_query_tree_reply_t)
+                              + 4 * w->children.size());
+
+        xcb_query_tree_reply_t* rep = (xcb_query_tree_reply_t*)buf.data();
+        rep->root = root;
+        rep->parent = w->parent;
+        rep->children_len = w->children.size();
+        if (!w->children.empty()) {
+            memcpy(rep + 1, w->children.data(), 4 * w->children.size());
+        }
+
+        send_reply(buf.data(), buf.size());
+        break;
+    }
+    case XCB_INTERN_ATOM: {
+        const xcb_intern_atom_request_t* r =
+            (const xcb_intern_atom_request_t*)req;
+
+        std::string name((const char*)(r + 1), r->name_len);
+
+        xcb_intern_atom_reply_t rep;
+        memset(&rep, 0, sizeof(rep));
+
+        if (!r->only_if_exists || m_atoms.count(name))
+            rep.atom = do_intern(name);
+
+        send_reply(&rep, sizeof(rep));
+        break;
+    }
+    case XCB_GET_ATOM_NAME: {
+        const xcb_get_atom_name_request_t* r =
+            (const xcb_get_atom_name_request_t*)req;
+
+        if (r->atom == 0 || r->atom >= m_atom_names.size()) {
+            send_error(XCB_ATOM, r->atom);
+            break;
+        }
+
+        const std::string& name = m_atom_names[r->atom];
+
+        std::vector<char> buf(sizeof(xcb_get_atom_name_reply_t) + name.size());
+        xcb_get_atom_name_reply_t* rep = (xcb_get_atom_name_reply_t*)buf.data();
+        rep->name_len = name.size();
+        memcpy(rep + 1, name.data(), name.size());
+
+        send_reply(buf.data(), buf.size());
+        break;
+    }
+    case XCB_CHANGE_PROPERTY: {
+        const xcb_change_property_request_t* r =
+            (const xcb_change_property_request_t*)req;
+
+        Window* w = find_window(r->window);
+        if (!w) break;
+
+        do_change_property(r->window, *w, r->mode, r->property, r->type,
+                           r->format, r + 1, r->data_len * (r->format / 8));
+        break;
+    }
+    case XCB_DELETE_PROPERTY: {
+        const xcb_delete_property_request_t* r =
+            (const xcb_delete_property_request_t*)req;
+
+        Window* w = find_window(r->window);
+        if (w) do_delete_property(r->window, *w, r->property);
+        break;
+    }
+    case XCB_GET_PROPERTY: {
+        const xcb_get_property_request_t* r =
+            (const xcb_get_property_request_t*)req;
+
+        Window* w = find_window(r->window);
+        if (!w) break;
+
+        xcb_get_property_reply_t rep;
+        memset(&rep, 0, sizeof(rep));
+
+        propmap_type::iterator pi = w->props.find(r->property);
+        if (pi == w->props.end()) {
+            send_reply(&rep, sizeof(rep));
+            break;
+        }
+
+        const Property& p = pi->second;
+        rep.format = p.format;
+        rep.type = p.type;
+
+        if (r->type != XCB_GET_PROPERTY_TYPE_ANY && r->type != p.type) {
+            rep.bytes_after = p.data.size();
+            send_reply(&rep, sizeof(rep));
+            break;
+        }
+
+        size_t offset = 4 * (size_t)r->long_offset;
+        if (offset > p.data.size()) {
+            send_error(XCB_VALUE, r->long_offset);
+            break;
+        }
+
+        size_t n = std::min(p.data.size() - offset,
+                            4 * (size_t)r->long_length);
+
+        rep.bytes_after = p.data.size() - offset - n;
+        rep.value_len = n / (p.format / 8);
+
+        std::vector<char> buf(sizeof(rep) + n);
+        memcpy(buf.data(), &rep, sizeof(rep));
+        memcpy(buf.data() + sizeof(rep), p.data.data() + offset, n);
+
+        send_reply(buf.data(), buf.size());
+
+        if (r->_delete && rep.bytes_after == 0)
+            do_delete_property(r->window, *w, r->property);
+        break;
+    }
+    case XCB_GRAB_POINTER: {
+        xcb_grab_pointer_reply_t rep;
+        memset(&rep, 0, sizeof(rep));
+        rep.status = XCB_GRAB_STATUS_SUCCESS;
+        send_reply(&rep, sizeof(rep));
+        break;
+    }
+    case XCB_SET_INPUT_FOCUS: {
+        const xcb_set_input_focus_request_t* r =
+            (const xcb_set_input_focus_request_t*)req;
+        m_focus = r->focus;
+        break;
+    }
+    case XCB_GET_INPUT_FOCUS: {
+        xcb_get_input_focus_reply_t rep;
+        memset(&rep, 0, sizeof(rep));
+        rep.focus = m_focus;
+        send_reply(&rep, sizeof(rep));
+        break;
+    }
+    case XCB_ALLOC_COLOR: {
+        const xcb_alloc_color_request_t* r =
+            (const xcb_alloc_color_request_t*)req;
+
+        xcb_alloc_color_reply_t rep;
+        memset(&rep, 0, sizeof(rep));
+        rep.red = r->red, rep.green = r->green, rep.blue = r->blue;
+        rep.pixel = ((r->red >> 8) << 16) | ((r->green >> 8) << 8)
+                    | (r->blue >> 8);
+        send_reply(&rep, sizeof(rep));
+        break;
+    }
+    case XCB_QUERY_EXTENSION:
+    case XCB_GET_KEYBOARD_MAPPING: {
+        // no extensions, empty keyboard mapping
+        char rep[32];
+        memset(rep, 0, sizeof(rep));
+        send_reply(rep, sizeof(rep));
+        break;
+    }
+    case XCB_GET_MODIFIER_MAPPING: {
+        // one unassigned keycode for each of the eight modifiers
+        char rep[32 + 8];
+        memset(rep, 0, sizeof(rep));
+        ((xcb_get_modifier_mapping_reply_t*)rep)->keycodes_per_modifier = 1;
+        send_reply(rep, sizeof(rep));
+        break;
+    }
+    default:
+        if (core_expects_reply(req[0]) || uint8_t(req[0]) >= 128)
+            send_error(XCB_IMPLEMENTATION);
+        break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+//! Create a top-level client window.
+xcb_window_t FakeXServer::create_window(const Rectangle& geometry,
+                                        bool override_redirect)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    xcb_window_t win = m_next_client_id++;
+
+    Window& w = m_windows[win];
+    w.parent = root;
+    w.geometry = geometry;
+    w.border_width = 0;
+    w.mapped = false;
+    w.override_redirect = override_redirect;
+    w.event_mask = 0;
+
+    m_windows[root].children.push_back(win);
+
+    xcb_create_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_CREATE_NOTIFY;
+    ev.parent = root;
+    ev.window = win;
+    ev.x = geometry.x;
+    ev.y = geometry.y;
+    ev.width = geometry.w;
+    ev.height = geometry.h;
+    ev.override_redirect = override_redirect;
+
+    deliver(w, 0, XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY, &ev, sizeof(ev));
+
+    return win;
+}
+
+//! Map a client window, which sends a MapRequest to the WM.
+void FakeXServer::map_window(xcb_window_t win)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Window& w = m_windows[win];
+    Window& parent = m_windows[w.parent];
+
+    if (!w.override_redirect &&
+        (parent.event_mask & XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT))
+    {
+        xcb_map_request_event_t ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.response_type = XCB_MAP_REQUEST;
+        ev.parent = w.parent;
+        ev.window = win;
+
+        send_with_seq(&ev, sizeof(ev));
+    }
+    else
+    {
+        do_map(win, w);
+    }
+}
+
+//! Request a new geometry, which sends a ConfigureRequest to the WM.
+void FakeXServer::configure_window(xcb_window_t win, const Rectangle& geometry)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Window& w = m_windows[win];
+    Window& parent = m_windows[w.parent];
+
+    uint16_t mask = XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y |
+                    XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT;
+
+    if (!w.override_redirect &&
+        (parent.event_mask & XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT))
+    {
+        xcb_configure_request_event_t ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.response_type = XCB_CONFIGURE_REQUEST;
+        ev.parent = w.parent;
+        ev.window = win;
+        ev.x = geometry.x;
+        ev.y = geometry.y;
+        ev.width = geometry.w;
+        ev.height = geometry.h;
+        ev.border_width = w.border_width;
+        ev.value_mask = mask;
+
+        send_with_seq(&ev, sizeof(ev));
+    }
+    else
+    {
+        uint32_t values[4] = {
+            uint32_t(geometry.x), uint32_t(geometry.y),
+            geometry.w, geometry.h
+        };
+        apply_configure(win, w, mask, values);
+    }
+}
+
+//! Unmap a client window.
+void FakeXServer::unmap_window(xcb_window_t win)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    do_unmap(win, m_windows[win]);
+}
+
+//! Destroy a client window.
+void FakeXServer::destroy_window(xcb_window_t win)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    do_destroy(win);
+}
+
+//! Intern an atom.
+xcb_atom_t FakeXServer::intern_atom(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return do_intern(name);
+}
+
+//! Replace a property of a client window.
+void FakeXServer::change_property(xcb_window_t win, xcb_atom_t property,
+                                  xcb_atom_t type, uint8_t format,
+                                  const void* data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    do_change_property(win, m_windows[win], XCB_PROP_MODE_REPLACE,
+                       property, type, format, data, size);
+}
+
+//! Send a client message about a client window to the WM, like clients do by
+//! SendEvent to the root window.
+void FakeXServer::send_client_message(xcb_window_t win, xcb_atom_t type,
+                                      const uint32_t data[5])
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    xcb_client_message_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_CLIENT_MESSAGE | 0x80; // sent by SendEvent
+    ev.format = 32;
+    ev.window = win;
+    ev.type = type;
+    memcpy(ev.data.data32, data, sizeof(ev.data.data32));
+
+    if (m_windows[root].event_mask & XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT)
+        send_with_seq(&ev, sizeof(ev));
+}
+
+//! Send a synthetic UnmapNotify about a client window to the WM, like clients
+//! withdrawing a window do by SendEvent to the root window.
+void FakeXServer::send_unmap_notify(xcb_window_t win)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    xcb_unmap_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_UNMAP_NOTIFY | 0x80; // sent by SendEvent
+    ev.event = root;
+    ev.window = win;
+
+    if (m_windows[root].event_mask & (XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT |
+                                      XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY))
+        send_with_seq(&ev, sizeof(ev));
+}
+
+//! Return whether a window is mapped.
+bool FakeXServer::is_mapped(xcb_window_t win)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::map<xcb_window_t, Window>::iterator it = m_windows.find(win);
+    return (it != m_windows.end() && it->second.mapped);
+}
+
+//! Process all pending events in the WM until it is idle.
+uint64_t FakeXServer::settle(uint64_t& cpu_ns)
+{
+    uint64_t count = 0;
+
+    while (1)
+    {
+        // the deferred work of the handlers is part of their CPU time
+        uint64_t start = thread_cpu_ns();
+        EventLoop::flush_changes();
+        cpu_ns += thread_cpu_ns() - start;
+
+        // a round trip guarantees that all events caused by earlier
+        // requests of the WM have been queued by xcb.
+        free(xcb_get_input_focus_reply(
+                 g_xcb.connection,
+                 xcb_get_input_focus(g_xcb.connection), NULL));
+
+        uint64_t n = 0;
+        xcb_generic_event_t* event;
+
+        while ((event = xcb_poll_for_queued_event(g_xcb.connection)))
+        {
+            uint64_t start = thread_cpu_ns();
+            EventLoop::process_global(event);
+            cpu_ns += thread_cpu_ns() - start;
+
+            free(event);
+            ++n;
+        }
+
+        if (n == 0) break;
+        count += n;
+    }
+
+    return count;
+}
+
+/******************************************************************************/
@@ -0,0 +1,284 @@
+/******************************************************************************/
+/*! \file src/fake-server.h
+ *
+ * In-process fake X server for offline simulations of the WM.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#ifndef TILEWM_FAKE_SERVER_HEADER
+#define TILEWM_FAKE_SERVER_HEADER
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <xcb/xcb.h>
+
+#include "geometry.h"
+
+/*!
+ * Server side of an X11 protocol connection on a socket: reads the
+ * connection setup and requests of a single client (the WM) and sends
+ * replies, errors and events with the correct sequence numbers. This is the
+ * common base of the replay stub server and the FakeXServer.
+ */
+class XServerSocket
+{
+protected:
+    //! socket connected to the WM
+    int m_fd;
+
+    //! sequence number of the last request read
+    uint16_t m_seq;
+
+    //! the last request read
+    std::vector<char> m_request;
+
+    //! Read exactly size bytes from the socket.
+    bool read_full(void* data, size_t size);
+
+    //! Write exactly size bytes to the socket.
+    bool write_full(const void* data, size_t size);
+
+    //! Read the client's connection setup request.
+    bool read_setup_request();
+
+    //! Read the next request from the socket.
+    bool read_request();
+
+    //! Send an event or reply with the current sequence number patched in,
+    //! events are padded to 32 bytes.
+    bool send_with_seq(const void* data, size_t size);
+
+    //! Send a reply, fills in sequence number and length. The reply is
+    //! padded to at least 32 bytes and a multiple of four bytes.
+    bool send_reply(const void* data, size_t size);
+
+    //! Send an error for the last request read.
+    bool send_error(uint8_t code, uint32_t resource = 0);
+
+    //! Check whether a core protocol request has a reply.
+    static bool core_expects_reply(uint8_t major);
+
+public:
+    //! Attach to one end of a connected socket.
+    explicit XServerSocket(int fd)
+        : m_fd(fd), m_seq(0)
+    { }
+};
+
+/*!
+ * The FakeXServer is a small in-process X server model for deterministic
+ * offline simulations and benchmarks of the WM. The WM connects to it via
+ * XcbConnection::open_connection_fd() on a socketpair, hence the WM runs
+ * completely unmodified against it. The server models the window tree,
+ * geometry, map state, attributes, atoms and properties, and generates the
+ * events the WM selected. Requests not modelled are ignored, or answered
+ * with an error if they expect a reply.
+ *
+ * Simulated clients are driven from the WM's thread via create_window(),
+ * map_window(), change_property(), etc. and settle() then processes all
+ * resulting events in the WM until it is idle, while measuring the CPU time
+ * spent in the WM's event handlers.
+ */
+class FakeXServer : public XServerSocket
+{
+public:
+    //! A property of a window.
+    struct Property
+    {
+        //! type atom of the property
+        xcb_atom_t type;
+        //! format: 8, 16 or 32 bits.
+        uint8_t format;
+        //! property data
+        std::string data;
+    };
+
+    //! typedef of property map
+    typedef std::map<xcb_atom_t, Property> propmap_type;
+
+    //! A window in the server's window tree.
+    struct Window
+    {
+        //! parent window
+        xcb_window_t parent;
+        //! children in stacking order, bottom first.
+        std::vector<xcb_window_t> children;
+        //! geometry of the window
+        Rectangle geometry;
+        //! border width
+        uint16_t border_width;
+        //! whether the window is mapped
+        bool mapped;
+        //! override_redirect attribute
+        bool override_redirect;
+        //! event mask selected by the WM on this window
+        uint32_t event_mask;
+        //! properties of the window
+        propmap_type props;
+    };
+
+    //! screen size of the fake server
+    static const uint16_t screen_width = 1920, screen_height = 1080;
+
+    //! window id of the root window
+    static const xcb_window_t root = 0x100;
+
+    //! first window id given to simulated clients, outside the WM's range.
+    static const xcb_window_t first_client_id = 0x4000000;
+
+protected:
+    //! lock protecting the model and the socket's write side
+    std::mutex m_mutex;
+
+    //! window tree
+    std::map<xcb_window_t, Window> m_windows;
+
+    //! map atom name -> atom
+    std::map<std::string, xcb_atom_t> m_atoms;
+
+    //! list of atom names, index by atom
+    std::vector<std::string> m_atom_names;
+
+    //! window which has the input focus
+    xcb_window_t m_focus;
+
+    //! next window id for simulated clients
+    xcb_window_t m_next_client_id;
+
+    //! fake server timestamp
+    xcb_timestamp_t m_time;
+
+    //! number of requests handled
+    uint64_t m_requests;
+
+    //! Build and send the connection setup data.
+    bool send_setup();
+
+    //! Handle the last request read.
+    void handle_request();
+
+    //! Find a window or send a BadWindow error.
+    Window * find_window(xcb_window_t win);
+
+    //! Apply CreateWindow/ChangeWindowAttributes value list.
+    void apply_attributes(Window& w, uint32_t mask, const uint32_t* values);
+
+    //! Apply ConfigureWindow value list and notify the WM.
+    void apply_configure(xcb_window_t win, Window& w,
+                         uint16_t mask, const uint32_t* values);
+
+    //! Send an event if the WM selected mask on the window or
+    //! substructure_mask on its parent.
+    void deliver(const Window& w, uint32_t mask, uint32_t substructure_mask,
+                 const void* event, size_t size);
+
+    //! Map a window and notify the WM.
+    void do_map(xcb_window_t win, Window& w);
+
+    //! Unmap a window and notify the WM.
+    void do_unmap(xcb_window_t win, Window& w);
+
+    //! Destroy a window and its children, and notify the WM.
+    void do_destroy(xcb_window_t win);
+
+    //! Change a property and notify the WM.
+    void do_change_property(xcb_window_t win, Window& w, uint8_t mode,
+                            xcb_atom_t property, xcb_atom_t type,
+                            uint8_t format, const void* data, size_t size);
+
+    //! Delete a property and notify the WM.
+    void do_delete_property(xcb_window_t win, Window& w, xcb_atom_t property);
+
+    //! Intern an atom name.
+    xcb_atom_t do_intern(const std::string& name);
+
+public:
+    //! Construct fake server on one end of a socketpair.
+    explicit FakeXServer(int fd);
+
+    //! Serve requests of the WM until it disconnects, run in a thread.
+    void run();
+
+    //! \name Simulated client actions, called from the WM's thread.
+    //! \{
+
+    //! Create a top-level client window.
+    xcb_window_t create_window(const Rectangle& geometry,
+                               bool override_redirect = false);
+
+    //! Map a client window, which sends a MapRequest to the WM.
+    void map_window(xcb_window_t win);
+
+    //! Request a new geometry, which sends a ConfigureRequest to the WM.
+    void configure_window(xcb_window_t win, const Rectangle& geometry);
+
+    //! Unmap a client window.
+    void unmap_window(xcb_window_t win);
+
+    //! Destroy a client window.
+    void destroy_window(xcb_window_t win);
+
+    //! Intern an atom.
+    xcb_atom_t intern_atom(const std::string& name);
+
+    //! Replace a property of a client window.
+    void change_property(xcb_window_t win, xcb_atom_t property,
+                         xcb_atom_t type, uint8_t format,
+                         const void* data, size_t size);
+
+    //! Send a client message about a client window to the WM, like clients
+    //! do by SendEvent to the root window.
+    void send_client_message(xcb_window_t win, xcb_atom_t type,
+                             const uint32_t data[5]);
+
+    //! Send a synthetic UnmapNotify about a client window to the WM, like
+    //! clients withdrawing a window do by SendEvent to the root window.
+    void send_unmap_notify(xcb_window_t win);
+
+    //! \}
+
+    //! Process all pending events in the WM until it is idle, returns the
+    //! number of events processed. The thread CPU time spent in event
+    //! handlers is added to cpu_ns.
+    uint64_t settle(uint64_t& cpu_ns);
+
+    //! Return the window with the input focus.
+    xcb_window_t focus()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_focus;
+    }
+
+    //! Return whether a window is mapped.
+    bool is_mapped(xcb_window_t win);
+
+    //! Return number of requests handled.
+    uint64_t requests()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_requests;
+    }
+};
+
+#endif // !TILEWM_FAKE_SERVER_HEADER
+
+/******************************************************************************/
@@ -141,6 +141,18 @@ struct Rectangle
     //! Return bottom left point
     Point buttom_right() const { return Point(x + w, y + h); }
 
+    //! Test equality of two Rectangles
+    bool operator == (const Rectangle& r) const
+    {
+        return (x == r.x && y == r.y && w == r.w && h == r.h);
+    }
+
+    //! Test inequality of two Rectangles
+    bool operator != (const Rectangle& r) const
+    {
+        return !(*this == r);
+    }
+
     //! Returns true if the rectangles intersect.
     bool intersects(const Rectangle& r) const
     {
@@ -0,0 +1,422 @@
+/******************************************************************************/
+/*! \file src/launcher.cpp
+ *
+ * Pre-forked launcher helper process which spawns programs for the WM.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "launcher.h"
+#include "log.h"
+#include "xcb.h"
+#include "tools.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+//! socket connected to the helper process, or -1 if not running.
+int Launcher::s_fd = -1;
+
+//! process id of the helper process.
+pid_t Launcher::s_pid = -1;
+
+//! sequential identifier of the next spawn request
+uint32_t Launcher::s_next_id = 0;
+
+//! number of spawn requests not yet answered by the helper
+unsigned int Launcher::s_pending = 0;
+
+//! list of spawned programs awaiting their first window
+Launcher::spawnlist_type Launcher::s_spawnlist;
+
+//! map command -> spawn-to-first-map latency statistics
+Launcher::statsmap_type Launcher::s_statsmap;
+
+//! Spawn entries without a window after this time are dropped.
+static const uint64_t spawn_expire_ns = 60 * 1000000000llu;
+
+//! Fork and exec a NULL-terminated argv inside the helper. A close-on-exec
+//! pipe is used to detect whether exec() failed in the child.
+static pid_t helper_fork_exec(char* const* argv, const char* startup_id,
+                              int32_t* error)
+{
+    int pfd[2];
+    if (pipe2(pfd, O_CLOEXEC) != 0) {
+        *error = errno;
+        return -1;
+    }
+
+    pid_t pid = fork();
+
+    if (pid < 0) {
+        *error = errno;
+        close(pfd[0]), close(pfd[1]);
+        return -1;
+    }
+
+    if (pid == 0)
+    {
+        close(pfd[0]);
+
+        // restore default child handling for the spawned program
+        signal(SIGCHLD, SIG_DFL);
+
+        // start a new session in process tree
+        setsid();
+
+        if (*startup_id)
+            setenv("DESKTOP_STARTUP_ID", startup_id, 1);
+
+        execvp(argv[0], argv);
+
+        int e = errno;
+        if (write(pfd[1], &e, sizeof(e))) { }
+        _exit(EXIT_FAILURE);
+    }
+
+    close(pfd[1]);
+
+    // wait until exec() succeeded (pipe closed) or failed (errno received)
+    int e;
+    ssize_t rb;
+    while ((rb = read(pfd[0], &e, sizeof(e))) < 0 && errno == EINTR) { }
+    close(pfd[0]);
+
+    if (rb == sizeof(e)) {
+        *error = e;
+        return -1;
+    }
+
+    *error = 0;
+    return pid;
+}
+
+//! Main loop of the helper process: receive argv and fork/exec.
+void Launcher::helper_main(int fd)
+{
+    // spawned children are reaped automatically by the kernel
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SIG_IGN;
+    sa.sa_flags = SA_NOCLDWAIT;
+    sigaction(SIGCHLD, &sa, NULL);
+
+    static char buffer[65536];
+
+    while (1)
+    {
+        ssize_t rb = recv(fd, buffer, sizeof(buffer) - 1, 0);
+
+        if (rb < 0 && errno == EINTR) continue;
+        if (rb <= 0) break; // WM closed socket or terminated
+
+        if (rb <= (ssize_t)sizeof(uint32_t)) continue;
+        buffer[rb] = 0;
+
+        Report r;
+        memcpy(&r.id, buffer, sizeof(r.id));
+
+        // split NUL-separated startup id and argument list
+        char* startup_id = buffer + sizeof(r.id);
+
+        std::vector<char*> args;
+        for (char* p = startup_id + strlen(startup_id) + 1; p < buffer + rb;
+             p += strlen(p) + 1)
+        {
+            args.push_back(p);
+        }
+        if (args.empty()) continue;
+        args.push_back(NULL);
+
+        r.pid = helper_fork_exec(args.data(), startup_id, &r.error);
+
+        while (send(fd, &r, sizeof(r), MSG_NOSIGNAL) < 0 && errno == EINTR)
+        { }
+    }
+
+    _exit(EXIT_SUCCESS);
+}
+
+//! Fork the helper process, must be called before opening connections.
+bool Launcher::start()
+{
+    ASSERT(s_fd < 0);
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) != 0) {
+        WARN << "launcher: socketpair() failed: " << strerror(errno);
+        return false;
+    }
+
+    pid_t pid = fork();
+
+    if (pid < 0) {
+        WARN << "launcher: fork() failed: " << strerror(errno);
+        close(sv[0]), close(sv[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        close(sv[0]);
+        helper_main(sv[1]);
+    }
+
+    close(sv[1]);
+
+    // the WM must never block on the helper
+    fcntl(sv[0], F_SETFL, fcntl(sv[0], F_GETFL) | O_NONBLOCK);
+
+    s_fd = sv[0];
+    s_pid = pid;
+
+    INFO << "launcher: started helper process " << pid;
+    return true;
+}
+
+//! Terminate the helper process.
+void Launcher::stop()
+{
+    if (s_fd < 0) return;
+
+    // closing the socket terminates the helper's loop
+    close(s_fd);
+    s_fd = -1;
+
+    waitpid(s_pid, NULL, 0);
+    s_pid = -1;
+}
+
+//! Spawn a program via the helper, or directly if that fails.
+void Launcher::spawn(const std::vector<std::string>& args,
+                     const Point& origin, uint32_t timestamp)
+{
+    if (args.empty()) return;
+
+    uint64_t now = monotonic_ns();
+    expire_spawnlist(now);
+
+    // remember spawn for matching the program's first window
+    Spawn sp;
+    sp.id = s_next_id++;
+    sp.command = args[0];
+    sp.startup_id = "tilewm-" + to_str(getpid()) + "-" + to_str(sp.id)
+                    + "_TIME" + to_str(timestamp);
+    sp.pid = -1;
+    sp.time = now;
+    sp.origin = origin;
+
+    if (s_fd >= 0)
+    {
+        // construct message: request id followed by NUL-terminated startup id
+        // and arguments
+        std::string msg(sizeof(sp.id), 0);
+        memcpy(&msg[0], &sp.id, sizeof(sp.id));
+
+        msg += sp.startup_id;
+        msg += '\0';
+
+        for (const std::string& a : args) {
+            msg += a;
+            msg += '\0';
+        }
+
+        if (send(s_fd, msg.data(), msg.size(), MSG_DONTWAIT | MSG_NOSIGNAL)
+            == (ssize_t)msg.size())
+        {
+            DEBUG << "launcher: request " << sp.id << " for " << args[0];
+
+            ++s_pending;
+            s_spawnlist.push_back(sp);
+            return;
+        }
+
+        WARN << "launcher: could not send request: " << strerror(errno)
+             << ", forking directly.";
+
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EMSGSIZE)
+            stop();
+    }
+
+    sp.pid = spawn_direct(args, sp.startup_id);
+    if (sp.pid >= 0)
+        s_spawnlist.push_back(sp);
+}
+
+//! Fork and exec a program directly from the WM process.
+pid_t Launcher::spawn_direct(const std::vector<std::string>& args,
+                             const std::string& startup_id)
+{
+    pid_t pid = fork();
+
+    if (pid < 0) {
+        ERROR << "spawn: fork() failed: " << strerror(errno);
+        return -1;
+    }
+
+    if (pid > 0) return pid;
+
+    // close the X11 connection and helper socket in child
+    if (g_xcb.connection) {
+        close(g_xcb.get_file_descriptor());
+    }
+    if (s_fd >= 0) {
+        close(s_fd);
+    }
+
+    // start a new session in process tree
+    if (setsid() == -1) {
+        WARN << "spawn: setsid() failed: " << strerror(errno);
+    }
+
+    if (!startup_id.empty())
+        setenv("DESKTOP_STARTUP_ID", startup_id.c_str(), 1);
+
+    // construct arguments for execvp():
+    std::vector<const char*> argv(args.size() + 1);
+    for (size_t i = 0; i < args.size(); ++i)
+        argv[i] = args[i].c_str();
+    argv.back() = NULL;
+
+    execvp(argv[0], (char* const*)argv.data());
+    _exit(EXIT_FAILURE);
+}
+
+//! Drop spawn entries which never showed a window.
+void Launcher::expire_spawnlist(uint64_t now)
+{
+    spawnlist_type::iterator it = s_spawnlist.begin();
+
+    while (it != s_spawnlist.end())
+    {
+        if (now - it->time < spawn_expire_ns) {
+            ++it;
+            continue;
+        }
+
+        DEBUG << "launcher: no window seen for request " << it->id
+              << " (" << it->command << ")";
+
+        it = s_spawnlist.erase(it);
+    }
+}
+
+//! Match the startup id or PID of a newly managed window against the spawned
+//! programs.
+bool Launcher::match_window(const std::string& startup_id, uint32_t pid,
+                            Spawn& out)
+{
+    if (s_spawnlist.empty()) return false;
+
+    // collect outstanding PID reports first
+    if (has_pending()) receive_reports();
+
+    spawnlist_type::iterator it = s_spawnlist.begin();
+
+    for ( ; it != s_spawnlist.end(); ++it)
+    {
+        if (!startup_id.empty() && startup_id == it->startup_id) break;
+        if (pid != 0 && it->pid > 0 && (pid_t)pid == it->pid) break;
+    }
+
+    if (it == s_spawnlist.end()) return false;
+
+    out = *it;
+    s_spawnlist.erase(it);
+
+    // record spawn-to-first-map latency for the command
+    uint64_t latency = monotonic_ns() - out.time;
+
+    statsmap_type::iterator si = s_statsmap.find(out.command);
+    if (si == s_statsmap.end()) {
+        Stats st = { 0, 0, 0 };
+        si = s_statsmap.insert(std::make_pair(out.command, st)).first;
+    }
+
+    Stats& st = si->second;
+    st.count++;
+    st.total_ns += latency;
+    st.max_ns = std::max(st.max_ns, latency);
+
+    INFO << "launcher: first window of " << out.command
+         << " after " << latency / 1000 << " us";
+
+    return true;
+}
+
+//! Output spawn-to-first-map latency statistics.
+void Launcher::dump_stats()
+{
+    for (statsmap_type::value_type& si : s_statsmap)
+    {
+        const Stats& st = si.second;
+
+        INFO << "launcher: " << si.first << " spawned " << st.count << " times,"
+             << " spawn-to-map avg " << st.total_ns / st.count / 1000 << " us"
+             << " max " << st.max_ns / 1000 << " us";
+    }
+}
+
+//! Receive pending PID reports from the helper without blocking.
+void Launcher::receive_reports()
+{
+    while (s_fd >= 0)
+    {
+        Report r;
+        ssize_t rb = recv(s_fd, &r, sizeof(r), MSG_DONTWAIT);
+
+        if (rb < 0 && errno == EINTR) continue;
+
+        if (rb == 0) {
+            WARN << "launcher: helper process terminated.";
+            stop();
+            s_pending = 0;
+            break;
+        }
+
+        if (rb != sizeof(r)) break;
+
+        if (s_pending) --s_pending;
+
+        for (spawnlist_type::iterator it = s_spawnlist.begin();
+             it != s_spawnlist.end(); ++it)
+        {
+            if (it->id != r.id) continue;
+
+            if (r.pid < 0)
+                s_spawnlist.erase(it);
+            else
+                it->pid = r.pid;
+            break;
+        }
+
+        if (r.pid < 0) {
+            ERROR << "launcher: request " << r.id << " failed: "
+                  << strerror(r.error);
+        }
+        else {
+            INFO << "launcher: request " << r.id << " started pid " << r.pid;
+        }
+    }
+}
+
+/******************************************************************************/
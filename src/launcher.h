@@ -0,0 +1,162 @@
+/******************************************************************************/
+/*! \file src/launcher.h
+ *
+ * Pre-forked launcher helper process which spawns programs for the WM.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TILEWM_LAUNCHER_HEADER
+#define TILEWM_LAUNCHER_HEADER
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "geometry.h"
+
+/*!
+ * The Launcher forks a small helper process early at startup, which is
+ * connected to the WM via a socketpair. Spawning a program then only requires
+ * a non-blocking write of the argv to the helper, which does the expensive
+ * fork()/exec() outside the WM's input path and reports the PIDs back. If the
+ * helper is not running or its queue is full, programs are forked directly.
+ *
+ * Each spawned program receives a DESKTOP_STARTUP_ID, which together with the
+ * reported PID is used to match its first window back to the launching event.
+ */
+class Launcher
+{
+protected:
+    //! socket connected to the helper process, or -1 if not running.
+    static int s_fd;
+
+    //! process id of the helper process.
+    static pid_t s_pid;
+
+    //! sequential identifier of the next spawn request
+    static uint32_t s_next_id;
+
+    //! number of spawn requests not yet answered by the helper
+    static unsigned int s_pending;
+
+    //! Main loop of the helper process: receive argv and fork/exec.
+    static void helper_main(int fd);
+
+public:
+    //! Information about a spawned program awaiting its first window.
+    struct Spawn
+    {
+        //! identifier of the spawn request
+        uint32_t id;
+        //! program name used for statistics
+        std::string command;
+        //! DESKTOP_STARTUP_ID passed to the program
+        std::string startup_id;
+        //! process id of the spawned child, once known.
+        pid_t pid;
+        //! monotonic timestamp of the spawn request
+        uint64_t time;
+        //! root window position of the launching event
+        Point origin;
+    };
+
+    //! Spawn-to-first-map latency statistics of a command.
+    struct Stats
+    {
+        //! number of matched first windows
+        unsigned int count;
+        //! sum of latencies in nanoseconds
+        uint64_t total_ns;
+        //! maximum latency in nanoseconds
+        uint64_t max_ns;
+    };
+
+protected:
+    //! typedef of list of spawned programs awaiting their first window
+    typedef std::vector<Spawn> spawnlist_type;
+
+    //! list of spawned programs awaiting their first window
+    static spawnlist_type s_spawnlist;
+
+    //! typedef of map command -> latency statistics
+    typedef std::map<std::string, Stats> statsmap_type;
+
+    //! map command -> spawn-to-first-map latency statistics
+    static statsmap_type s_statsmap;
+
+    //! Drop spawn entries which never showed a window.
+    static void expire_spawnlist(uint64_t now);
+
+public:
+    //! Message sent back by the helper for each spawn request.
+    struct Report
+    {
+        //! identifier of the spawn request
+        uint32_t id;
+        //! process id of the spawned child, or -1 on failure.
+        int32_t pid;
+        //! errno of failed fork() or exec(), otherwise zero.
+        int32_t error;
+    };
+
+    //! Fork the helper process, must be called before opening connections.
+    static bool start();
+
+    //! Terminate the helper process.
+    static void stop();
+
+    //! Spawn a program via the helper, or directly if that fails. The origin
+    //! and X timestamp of the launching event are used for startup
+    //! notification.
+    static void spawn(const std::vector<std::string>& args,
+                      const Point& origin, uint32_t timestamp);
+
+    //! Fork and exec a program directly from the WM process.
+    static pid_t spawn_direct(const std::vector<std::string>& args,
+                              const std::string& startup_id);
+
+    //! Match the startup id or PID of a newly managed window against the
+    //! spawned programs. On success, the spawn entry is removed, its
+    //! latency recorded and returned in out.
+    static bool match_window(const std::string& startup_id, uint32_t pid,
+                             Spawn& out);
+
+    //! Output spawn-to-first-map latency statistics.
+    static void dump_stats();
+
+    //! Receive pending PID reports from the helper without blocking.
+    static void receive_reports();
+
+    //! Return the socket to the helper process, or -1 if it is not running.
+    static int fd()
+    {
+        return s_fd;
+    }
+
+    //! Return true if spawn requests are waiting for their reports.
+    static bool has_pending()
+    {
+        return (s_pending != 0);
+    }
+};
+
+#endif // !TILEWM_LAUNCHER_HEADER
+
+/******************************************************************************/
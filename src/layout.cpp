@@ -0,0 +1,347 @@
+/******************************************************************************/
+/*! \file src/layout.cpp
+ *
+ * Tiling layout tree of splits and stacks with incremental re-layout.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "layout.h"
+#include "log.h"
+
+#include <algorithm>
+
+const uint32_t Layout::npos;
+
+//! Construct an empty layout with a horizontally split root.
+Layout::Layout()
+    : m_focus(npos)
+{
+    m_root = alloc(SPLIT_H, npos);
+}
+
+//! Allocate a new node.
+uint32_t Layout::alloc(type_t type, uint32_t parent)
+{
+    uint32_t n;
+
+    if (!m_free.empty()) {
+        n = m_free.back();
+        m_free.pop_back();
+    }
+    else {
+        n = m_nodes.size();
+        m_nodes.resize(n + 1);
+    }
+
+    Node& node = m_nodes[n];
+    node.type = type;
+    node.parent = parent;
+    node.children.clear();
+    node.window = XCB_WINDOW_NONE;
+    node.area = Rectangle(0, 0, 0, 0);
+    node.dirty = true;
+    node.dirty_below = false;
+    node.hints = SizeSolver::Hints();
+
+    return n;
+}
+
+//! Return a node to the free list.
+void Layout::release(uint32_t n)
+{
+    m_nodes[n].children.clear();
+    m_free.push_back(n);
+}
+
+//! Mark children of container n for recalculation and flag path to root.
+void Layout::mark_dirty(uint32_t n)
+{
+    m_nodes[n].dirty = true;
+
+    for (uint32_t p = m_nodes[n].parent;
+         p != npos && !m_nodes[p].dirty_below; p = m_nodes[p].parent)
+    {
+        m_nodes[p].dirty_below = true;
+    }
+}
+
+//! Return first leaf in subtree n, or npos.
+uint32_t Layout::first_leaf(uint32_t n) const
+{
+    while (m_nodes[n].type != LEAF)
+    {
+        if (m_nodes[n].children.empty()) return npos;
+        n = m_nodes[n].children.front();
+    }
+    return n;
+}
+
+//! Set area covered by the layout, e.g. the Desk's work area.
+void Layout::set_area(const Rectangle& area)
+{
+    Node& r = m_nodes[m_root];
+    if (r.area == area) return;
+
+    r.area = area;
+    mark_dirty(m_root);
+}
+
+//! Insert a window next to the focused one, or at the end of the root.
+void Layout::insert(xcb_window_t win)
+{
+    if (contains(win)) return;
+
+    uint32_t parent = m_root;
+    if (m_focus != npos) parent = m_nodes[m_focus].parent;
+
+    uint32_t leaf = alloc(LEAF, parent);
+    m_nodes[leaf].window = win;
+
+    std::vector<uint32_t>& children = m_nodes[parent].children;
+    std::vector<uint32_t>::iterator pos =
+        std::find(children.begin(), children.end(), m_focus);
+
+    children.insert(pos == children.end() ? pos : pos + 1, leaf);
+
+    m_leafmap[win] = leaf;
+    m_focus = leaf;
+
+    mark_dirty(parent);
+}
+
+//! Remove a window, collapsing containers left with a single child.
+bool Layout::remove(xcb_window_t win)
+{
+    leafmap_type::iterator it = m_leafmap.find(win);
+    if (it == m_leafmap.end()) return false;
+
+    uint32_t leaf = it->second;
+    m_leafmap.erase(it);
+
+    uint32_t p = m_nodes[leaf].parent;
+
+    std::vector<uint32_t>& children = m_nodes[p].children;
+    std::vector<uint32_t>::iterator pos =
+        std::find(children.begin(), children.end(), leaf);
+    size_t index = pos - children.begin();
+    children.erase(pos);
+
+    release(leaf);
+
+    // collapse containers with less than two children, except the root
+    while (p != m_root && m_nodes[p].children.size() <= 1)
+    {
+        uint32_t gp = m_nodes[p].parent;
+        std::vector<uint32_t>& gc = m_nodes[gp].children;
+        std::vector<uint32_t>::iterator gpos =
+            std::find(gc.begin(), gc.end(), p);
+
+        index = gpos - gc.begin();
+
+        if (m_nodes[p].children.empty()) {
+            gc.erase(gpos);
+        }
+        else {
+            uint32_t only = m_nodes[p].children.front();
+            m_nodes[only].parent = gp;
+            *gpos = only;
+        }
+
+        release(p);
+        p = gp;
+    }
+
+    // move focus to the neighbour which took the window's place
+    if (m_focus == leaf)
+    {
+        const std::vector<uint32_t>& pc = m_nodes[p].children;
+
+        if (pc.empty())
+            m_focus = npos;
+        else
+            m_focus = first_leaf(pc[std::min(index, pc.size() - 1)]);
+    }
+
+    mark_dirty(p);
+    return true;
+}
+
+//! Set window next to which new windows are inserted.
+void Layout::set_focus(xcb_window_t win)
+{
+    leafmap_type::iterator it = m_leafmap.find(win);
+    if (it == m_leafmap.end()) return;
+
+    m_focus = it->second;
+}
+
+//! Set size hints of a window used when splitting its container's area.
+void Layout::set_hints(xcb_window_t win, const SizeSolver::Hints& hints)
+{
+    leafmap_type::iterator it = m_leafmap.find(win);
+    if (it == m_leafmap.end()) return;
+
+    Node& leaf = m_nodes[it->second];
+    if (leaf.hints == hints) return;
+
+    leaf.hints = hints;
+    mark_dirty(leaf.parent);
+}
+
+//! Wrap a window in a new container of given type, such that following
+//! inserts next to it go into that container.
+bool Layout::split(xcb_window_t win, type_t type)
+{
+    leafmap_type::iterator it = m_leafmap.find(win);
+    if (it == m_leafmap.end() || type == LEAF) return false;
+
+    uint32_t leaf = it->second;
+    uint32_t parent = m_nodes[leaf].parent;
+
+    uint32_t c = alloc(type, parent);
+
+    std::vector<uint32_t>& children = m_nodes[parent].children;
+    *std::find(children.begin(), children.end(), leaf) = c;
+
+    m_nodes[c].children.push_back(leaf);
+    m_nodes[leaf].parent = c;
+
+    // the window keeps its area until another one is inserted
+    m_nodes[c].area = m_nodes[leaf].area;
+    m_nodes[c].dirty = false;
+
+    m_focus = leaf;
+    return true;
+}
+
+//! Change the type of the container holding a window.
+bool Layout::set_container_type(xcb_window_t win, type_t type)
+{
+    leafmap_type::iterator it = m_leafmap.find(win);
+    if (it == m_leafmap.end() || type == LEAF) return false;
+
+    uint32_t parent = m_nodes[it->second].parent;
+    if (m_nodes[parent].type == type) return true;
+
+    m_nodes[parent].type = type;
+    mark_dirty(parent);
+    return true;
+}
+
+//! Recalculate areas of the whole subtree n and emit its leaves.
+void Layout::arrange(uint32_t n, placementlist_type& out)
+{
+    Node& node = m_nodes[n];
+    node.dirty = node.dirty_below = false;
+
+    if (node.type == LEAF) {
+        Placement p = { node.window, node.area };
+        out.push_back(p);
+        return;
+    }
+
+    const Rectangle& a = node.area;
+    size_t k = node.children.size();
+    int offset = 0;
+
+    bool split = (node.type == SPLIT_H || node.type == SPLIT_V);
+    bool horizontal = (node.type == SPLIT_H);
+
+    // distribute the split span among children respecting size hints
+    SizeSolver::itemlist_type items;
+
+    if (split)
+    {
+        int32_t cross = horizontal ? a.h : a.w;
+        items.resize(k);
+
+        for (size_t i = 0; i < k; ++i)
+        {
+            const Node& c = m_nodes[node.children[i]];
+            if (c.type == LEAF)
+                items[i] = c.hints.item(horizontal, cross);
+        }
+
+        SizeSolver::solve(horizontal ? a.w : a.h, items);
+    }
+
+    for (size_t i = 0; i < k; ++i)
+    {
+        Rectangle r = a;
+
+        if (split)
+        {
+            uint16_t& size = horizontal ? r.w : r.h;
+            uint16_t& cross = horizontal ? r.h : r.w;
+
+            size = items[i].size;
+
+            if (horizontal)
+                r.x = a.x + offset;
+            else
+                r.y = a.y + offset;
+
+            offset += size;
+
+            // shrink windows to valid sizes in the other direction
+            const Node& c = m_nodes[node.children[i]];
+            if (c.type == LEAF)
+            {
+                SizeSolver::itemlist_type one(
+                    1, c.hints.item(!horizontal, size));
+                SizeSolver::solve(cross, one);
+                cross = one[0].size;
+            }
+        }
+
+        Node& child = m_nodes[node.children[i]];
+
+        if (child.dirty || child.area != r) {
+            child.area = r;
+            arrange(node.children[i], out);
+        }
+        else if (child.dirty_below) {
+            visit(node.children[i], out);
+        }
+    }
+}
+
+//! Descend along flagged paths and arrange dirty subtrees.
+void Layout::visit(uint32_t n, placementlist_type& out)
+{
+    Node& node = m_nodes[n];
+
+    if (node.dirty) {
+        arrange(n, out);
+        return;
+    }
+
+    if (!node.dirty_below) return;
+    node.dirty_below = false;
+
+    for (uint32_t c : node.children)
+        visit(c, out);
+}
+
+//! Recalculate dirty subtrees and append new placements of windows.
+void Layout::layout(placementlist_type& out)
+{
+    visit(m_root, out);
+}
+
+/******************************************************************************/
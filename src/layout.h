@@ -0,0 +1,193 @@
+/******************************************************************************/
+/*! \file src/layout.h
+ *
+ * Tiling layout tree of splits and stacks with incremental re-layout.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TILEWM_LAYOUT_HEADER
+#define TILEWM_LAYOUT_HEADER
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include <xcb/xcb.h>
+
+#include "geometry.h"
+#include "size-solver.h"
+
+/*!
+ * A Layout is the tiling tree of one Desktop. Inner nodes are containers
+ * which split their area horizontally or vertically among their children, or
+ * stack all children on the full area. Leaves hold one client window each.
+ * Split areas are distributed by the SizeSolver respecting the windows' size
+ * hints.
+ *
+ * Nodes are kept by index in a vector, hence a Layout can be copied together
+ * with its Desktop. Changes mark only the container whose children are
+ * affected as dirty and flag the path to the root. layout() then descends
+ * only along flagged paths and recomputes geometry of dirty subtrees, so
+ * opening or closing a window costs time proportional to the affected
+ * subtree, not to the whole desktop.
+ */
+class Layout
+{
+public:
+    //! Types of layout tree nodes.
+    enum type_t {
+        //! leaf holding a client window
+        LEAF,
+        //! children are placed side by side, left to right
+        SPLIT_H,
+        //! children are placed on top of each other, top to bottom
+        SPLIT_V,
+        //! all children get the full area, only the top-most is visible
+        STACK
+    };
+
+    //! New geometry calculated for a client window.
+    struct Placement
+    {
+        //! client window
+        xcb_window_t window;
+        //! area assigned to the window including its border
+        Rectangle area;
+    };
+
+    //! typedef of list of placements
+    typedef std::vector<Placement> placementlist_type;
+
+protected:
+    //! invalid node index
+    static const uint32_t npos = uint32_t(-1);
+
+    //! Node of the layout tree.
+    struct Node
+    {
+        //! container type or leaf
+        type_t type;
+        //! index of parent node, npos for root
+        uint32_t parent;
+        //! indexes of child nodes of containers
+        std::vector<uint32_t> children;
+        //! client window of leaves
+        xcb_window_t window;
+        //! area assigned to this node
+        Rectangle area;
+        //! whether the areas of this node's children must be recalculated
+        bool dirty;
+        //! whether any node below is dirty
+        bool dirty_below;
+        //! size hints of the client window of leaves
+        SizeSolver::Hints hints;
+    };
+
+    //! node storage, unused entries are on the free list
+    std::vector<Node> m_nodes;
+
+    //! indexes of unused nodes
+    std::vector<uint32_t> m_free;
+
+    //! typedef of map window -> leaf index
+    typedef std::map<xcb_window_t, uint32_t> leafmap_type;
+
+    //! map window -> leaf index
+    leafmap_type m_leafmap;
+
+    //! index of root container
+    uint32_t m_root;
+
+    //! leaf next to which new windows are inserted, or npos.
+    uint32_t m_focus;
+
+    //! Allocate a new node.
+    uint32_t alloc(type_t type, uint32_t parent);
+
+    //! Return a node to the free list.
+    void release(uint32_t n);
+
+    //! Mark children of container n for recalculation and flag path to root.
+    void mark_dirty(uint32_t n);
+
+    //! Return first leaf in subtree n, or npos.
+    uint32_t first_leaf(uint32_t n) const;
+
+    //! Recalculate areas of the whole subtree n and emit its leaves.
+    void arrange(uint32_t n, placementlist_type& out);
+
+    //! Descend along flagged paths and arrange dirty subtrees.
+    void visit(uint32_t n, placementlist_type& out);
+
+public:
+    //! Construct an empty layout with a horizontally split root.
+    Layout();
+
+    //! Set area covered by the layout, e.g. the Desk's work area.
+    void set_area(const Rectangle& area);
+
+    //! Return area covered by the layout.
+    const Rectangle & area() const
+    {
+        return m_nodes[m_root].area;
+    }
+
+    //! Insert a window next to the focused one, or at the end of the root.
+    void insert(xcb_window_t win);
+
+    //! Remove a window, collapsing containers left with a single child.
+    bool remove(xcb_window_t win);
+
+    //! Check whether a window is in this layout.
+    bool contains(xcb_window_t win) const
+    {
+        return m_leafmap.count(win) != 0;
+    }
+
+    //! Return number of windows in the layout.
+    size_t size() const
+    {
+        return m_leafmap.size();
+    }
+
+    //! Set window next to which new windows are inserted.
+    void set_focus(xcb_window_t win);
+
+    //! Set size hints of a window used when splitting its container's area.
+    void set_hints(xcb_window_t win, const SizeSolver::Hints& hints);
+
+    //! Wrap a window in a new container of given type, such that following
+    //! inserts next to it go into that container.
+    bool split(xcb_window_t win, type_t type);
+
+    //! Change the type of the container holding a window.
+    bool set_container_type(xcb_window_t win, type_t type);
+
+    //! Whether layout() has anything to do.
+    bool dirty() const
+    {
+        const Node& r = m_nodes[m_root];
+        return r.dirty || r.dirty_below;
+    }
+
+    //! Recalculate dirty subtrees and append new placements of windows.
+    void layout(placementlist_type& out);
+};
+
+#endif // !TILEWM_LAYOUT_HEADER
+
+/******************************************************************************/
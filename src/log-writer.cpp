@@ -0,0 +1,300 @@
+/******************************************************************************/
+/*! \file src/log-writer.cpp
+ *
+ * Background thread writing finished log lines to a file or pipe.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "log-writer.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+//! the byte queue containing [uint32_t length][line] entries
+char LogWriter::s_queue[LogWriter::queue_size];
+
+//! total bytes written into the queue by the producer
+std::atomic<size_t> LogWriter::s_head(0);
+
+//! total bytes consumed from the queue by the writer thread
+std::atomic<size_t> LogWriter::s_tail(0);
+
+//! total queue bytes consumed and written to the file
+std::atomic<size_t> LogWriter::s_written(0);
+
+//! number of lines dropped because the queue was full
+std::atomic<unsigned int> LogWriter::s_dropped(0);
+
+//! whether the writer thread is sleeping on the condition variable
+std::atomic<bool> LogWriter::s_sleeping(false);
+
+//! flag to terminate the writer thread
+std::atomic<bool> LogWriter::s_stop(false);
+
+//! mutex protecting the sleep of the writer thread
+std::mutex LogWriter::s_mutex;
+
+//! condition variable used to wake up the writer thread
+std::condition_variable LogWriter::s_cv;
+
+//! the writer thread, never destroyed while running.
+std::thread* LogWriter::s_thread = NULL;
+
+//! output file descriptor, or -1 if not running.
+int LogWriter::s_fd = -1;
+
+//! path of output file, empty for stderr.
+std::string LogWriter::s_path;
+
+//! rotate log file when reaching this size, zero to disable.
+uint64_t LogWriter::s_rotate_size = 0;
+
+//! current size of log file
+uint64_t LogWriter::s_file_size = 0;
+
+//! Open output file and determine current size.
+bool LogWriter::open_file()
+{
+    if (s_path.empty()) {
+        s_fd = STDERR_FILENO;
+        s_file_size = 0;
+        return true;
+    }
+
+    s_fd = open(s_path.c_str(),
+                O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (s_fd < 0) return false;
+
+    struct stat st;
+    s_file_size = (fstat(s_fd, &st) == 0) ? st.st_size : 0;
+
+    return true;
+}
+
+//! Write a buffer completely to the output file.
+void LogWriter::write_out(const char* data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t wb = write(s_fd, data, size);
+
+        if (wb < 0 && errno == EINTR) continue;
+        if (wb <= 0) return; // nowhere to report errors, drop the data.
+
+        data += wb, size -= wb;
+        s_file_size += wb;
+    }
+
+    if (s_rotate_size == 0 || s_path.empty() || s_file_size < s_rotate_size)
+        return;
+
+    // rotate log file to path.1
+    close(s_fd);
+
+    std::string old_path = s_path + ".1";
+    rename(s_path.c_str(), old_path.c_str());
+
+    if (!open_file())
+        s_fd = STDERR_FILENO;
+}
+
+//! Copy bytes out of the queue at the given position.
+void LogWriter::queue_read(size_t pos, char* data, size_t size)
+{
+    size_t off = pos % queue_size;
+    size_t part = std::min(size, queue_size - off);
+
+    memcpy(data, s_queue + off, part);
+    memcpy(data + part, s_queue, size - part);
+}
+
+//! Main function of the writer thread.
+void LogWriter::thread_main()
+{
+    static char buffer[buffer_size];
+    size_t fill = 0;
+
+    while (1)
+    {
+        size_t head = s_head.load(std::memory_order_acquire);
+        size_t tail = s_tail.load(std::memory_order_relaxed);
+
+        while (tail != head)
+        {
+            uint32_t len;
+            queue_read(tail, (char*)&len, sizeof(len));
+
+            if (fill + len > buffer_size) {
+                write_out(buffer, fill);
+                fill = 0;
+            }
+
+            if (len > buffer_size) {
+                // overlong line: write directly via temporary
+                std::string line(len, 0);
+                queue_read(tail + sizeof(len), &line[0], len);
+                write_out(line.data(), line.size());
+            }
+            else {
+                queue_read(tail + sizeof(len), buffer + fill, len);
+                fill += len;
+            }
+
+            tail += sizeof(len) + len;
+            s_tail.store(tail, std::memory_order_release);
+        }
+
+        unsigned int dropped = s_dropped.exchange(0);
+        if (dropped)
+        {
+            char msg[64];
+            int n = snprintf(msg, sizeof(msg),
+                             "LogWriter: dropped %u log lines\n", dropped);
+
+            if (fill + n > buffer_size) {
+                write_out(buffer, fill);
+                fill = 0;
+            }
+            memcpy(buffer + fill, msg, n);
+            fill += n;
+        }
+
+        if (fill) {
+            write_out(buffer, fill);
+            fill = 0;
+        }
+
+        s_written.store(tail, std::memory_order_release);
+
+        if (s_stop.load() && s_head.load() == tail)
+            break;
+
+        // sleep until woken by producer, or timeout for dropped counter
+        std::unique_lock<std::mutex> lock(s_mutex);
+        s_sleeping.store(true);
+
+        if (s_head.load() == tail && !s_stop.load())
+            s_cv.wait_for(lock, std::chrono::milliseconds(100));
+
+        s_sleeping.store(false);
+    }
+}
+
+//! Start writer thread writing to path ("-" for stderr), rotating files at
+//! rotate_size bytes.
+bool LogWriter::start(const std::string& path, uint64_t rotate_size)
+{
+    ASSERT(!s_thread);
+
+    s_path = (path == "-") ? std::string() : path;
+    s_rotate_size = rotate_size;
+
+    if (!open_file()) {
+        ERROR << "Could not open log file " << path << ": " << strerror(errno);
+        return false;
+    }
+
+    s_stop = false;
+    s_thread = new std::thread(thread_main);
+    return true;
+}
+
+//! Write all pending lines and terminate the writer thread.
+void LogWriter::stop()
+{
+    if (!s_thread) return;
+
+    {
+        std::unique_lock<std::mutex> lock(s_mutex);
+        s_stop = true;
+        s_cv.notify_one();
+    }
+
+    s_thread->join();
+    delete s_thread;
+    s_thread = NULL;
+
+    if (s_fd != STDERR_FILENO)
+        close(s_fd);
+    s_fd = -1;
+}
+
+//! Enqueue a log line without blocking, the newline is added.
+bool LogWriter::push(const char* data, size_t size)
+{
+    uint32_t len = size + 1;
+
+    size_t head = s_head.load(std::memory_order_relaxed);
+    size_t tail = s_tail.load(std::memory_order_acquire);
+
+    if (sizeof(len) + len > queue_size - (head - tail)) {
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // copy length, line and newline, wrapping around the queue end
+    const char* parts[3] = { (const char*)&len, data, "\n" };
+    size_t sizes[3] = { sizeof(len), size, 1 };
+
+    size_t pos = head;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        size_t off = pos % queue_size;
+        size_t part = std::min(sizes[i], queue_size - off);
+
+        memcpy(s_queue + off, parts[i], part);
+        memcpy(s_queue, parts[i] + part, sizes[i] - part);
+        pos += sizes[i];
+    }
+
+    s_head.store(pos, std::memory_order_seq_cst);
+
+    if (s_sleeping.load()) {
+        std::unique_lock<std::mutex> lock(s_mutex);
+        s_cv.notify_one();
+    }
+
+    return true;
+}
+
+//! Wait (bounded) until all enqueued lines have been written.
+void LogWriter::flush()
+{
+    if (!s_thread) return;
+
+    size_t head = s_head.load();
+
+    {
+        std::unique_lock<std::mutex> lock(s_mutex);
+        s_cv.notify_one();
+    }
+
+    for (unsigned int i = 0; i < 1000; ++i)
+    {
+        if (s_written.load(std::memory_order_acquire) >= head) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+/******************************************************************************/
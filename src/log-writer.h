@@ -0,0 +1,127 @@
+/******************************************************************************/
+/*! \file src/log-writer.h
+ *
+ * Background thread writing finished log lines to a file or pipe.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TILEWM_LOG_WRITER_HEADER
+#define TILEWM_LOG_WRITER_HEADER
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <stdint.h>
+
+/*!
+ * The LogWriter takes finished log lines from the event thread via a
+ * lock-free single-producer single-consumer byte queue and writes them from a
+ * background thread with large buffered writes. Hence the event loop never
+ * blocks on a slow log file or pipe. If the queue is full, lines are dropped
+ * and the number of dropped lines is reported later. Log files can be rotated
+ * when reaching a size limit.
+ */
+class LogWriter
+{
+protected:
+    //! size of the byte queue, must be a power of two.
+    static const size_t queue_size = 1024 * 1024;
+
+    //! size of the write buffer of the background thread
+    static const size_t buffer_size = 64 * 1024;
+
+    //! the byte queue containing [uint32_t length][line] entries
+    static char s_queue[queue_size];
+
+    //! total bytes written into the queue by the producer
+    static std::atomic<size_t> s_head;
+
+    //! total bytes consumed from the queue by the writer thread
+    static std::atomic<size_t> s_tail;
+
+    //! total queue bytes consumed and written to the file
+    static std::atomic<size_t> s_written;
+
+    //! number of lines dropped because the queue was full
+    static std::atomic<unsigned int> s_dropped;
+
+    //! whether the writer thread is sleeping on the condition variable
+    static std::atomic<bool> s_sleeping;
+
+    //! flag to terminate the writer thread
+    static std::atomic<bool> s_stop;
+
+    //! mutex protecting the sleep of the writer thread
+    static std::mutex s_mutex;
+
+    //! condition variable used to wake up the writer thread
+    static std::condition_variable s_cv;
+
+    //! the writer thread, never destroyed while running.
+    static std::thread* s_thread;
+
+    //! output file descriptor, or -1 if not running.
+    static int s_fd;
+
+    //! path of output file, empty for stderr.
+    static std::string s_path;
+
+    //! rotate log file when reaching this size, zero to disable.
+    static uint64_t s_rotate_size;
+
+    //! current size of log file
+    static uint64_t s_file_size;
+
+    //! Open output file and determine current size.
+    static bool open_file();
+
+    //! Write a buffer completely to the output file.
+    static void write_out(const char* data, size_t size);
+
+    //! Copy bytes out of the queue at the given position.
+    static void queue_read(size_t pos, char* data, size_t size);
+
+    //! Main function of the writer thread.
+    static void thread_main();
+
+public:
+    //! Start writer thread writing to path ("-" for stderr), rotating files
+    //! at rotate_size bytes.
+    static bool start(const std::string& path, uint64_t rotate_size);
+
+    //! Write all pending lines and terminate the writer thread.
+    static void stop();
+
+    //! Check whether the writer thread is running.
+    static bool active()
+    {
+        return (s_thread != NULL);
+    }
+
+    //! Enqueue a log line without blocking, the newline is added.
+    static bool push(const char* data, size_t size);
+
+    //! Wait (bounded) until all enqueued lines have been written.
+    static void flush();
+};
+
+#endif // !TILEWM_LOG_WRITER_HEADER
+
+/******************************************************************************/
@@ -21,8 +21,13 @@
  ******************************************************************************/
 
 #include "log.h"
+#include "log-writer.h"
 
 #include <strings.h>
+#include <time.h>
+
+//! Maximum level of all log sinks, used to gate LOG statements.
+log_level_t Log::s_level = LOG_TRACE;
 
 //! Currently configured maximum level written to stderr
 log_level_t Log::s_stderr_level = LOG_TRACE;
@@ -30,21 +35,206 @@ log_level_t Log::s_stderr_level = LOG_TRACE;
 //! Whether to use ANSI terminal color on stderr
 bool Log::s_stderr_color = true;
 
-//! Change the current logging level written to stderr.
-bool Log::set_stderr_level(const char* str)
+//! Currently configured maximum level recorded in the LogRing
+log_level_t Log::s_ring_level = LOG_TRACE;
+
+//! Thread-local stream reused for all log lines.
+thread_local LogStream Log::t_stream;
+
+//! Whether t_stream is currently used by a Log object.
+thread_local bool Log::t_stream_used = false;
+
+//! Double the buffer size if the put area is full.
+LogStreamBuf::int_type LogStreamBuf::overflow(int_type ch)
+{
+    size_t n = size();
+
+    m_buffer.resize(2 * m_buffer.size());
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    pbump(n);
+
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(ch);
+}
+
+//! On destruction of the object: output the line to all log sinks.
+Log::~Log()
+{
+    if (m_record)
+        LogRing::commit(m_record, m_seq);
+
+    if (m_text && LogWriter::active())
+    {
+        LogWriter::push(m_os->buf().data(), m_os->buf().size());
+
+        if (m_level == LOG_FATAL)
+            LogWriter::flush();
+    }
+    else if (m_text)
+    {
+        if (s_stderr_color)
+            std::cerr << ansi_color(m_level);
+
+        std::cerr.write(m_os->buf().data(), m_os->buf().size());
+
+        if (s_stderr_color)
+            std::cerr << "\x1B[0m";
+
+        std::cerr << std::endl;
+    }
+
+    if (m_level == LOG_FATAL && m_record)
+        LogRing::dump(std::cerr);
+
+    if (m_os == &t_stream)
+        t_stream_used = false;
+    else
+        delete m_os;
+}
+
+//! Parse a log level string, returns LOG_MAX if invalid.
+log_level_t Log::parse_level(const char* str)
 {
     for (unsigned int i = 0; i < LOG_MAX; ++i)
     {
         log_level_t l = (log_level_t)i;
 
         if (strcasecmp(str, level_string(l)) == 0)
+            return l;
+    }
+
+    return LOG_MAX;
+}
+
+//! Change the current logging level written to stderr.
+bool Log::set_stderr_level(const char* str)
+{
+    log_level_t l = parse_level(str);
+    if (l == LOG_MAX) return false;
+
+    set_stderr_level(l);
+    return true;
+}
+
+//! Change the current logging level recorded in the LogRing.
+bool Log::set_ring_level(const char* str)
+{
+    log_level_t l = parse_level(str);
+    if (l == LOG_MAX) return false;
+
+    set_ring_level(l);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+//! the record slots
+LogRing::Record LogRing::s_ring[LogRing::num_slots];
+
+//! counter of claimed records
+std::atomic<uint64_t> LogRing::s_pos(0);
+
+//! Decoder of character strings recorded in the LogRing.
+void log_decode_string(std::ostream& os, const void* data, size_t size)
+{
+    os.write((const char*)data, size);
+}
+
+//! Claim and initialize a new record with sequence number seq.
+LogRing::Record* LogRing::begin(log_level_t level,
+                                const char* function, unsigned int line,
+                                uint64_t& seq)
+{
+    seq = s_pos.fetch_add(1, std::memory_order_relaxed);
+
+    Record* r = &s_ring[seq % num_slots];
+
+    // mark slot as being written
+    r->seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    r->time = ts.tv_sec * 1000000000llu + ts.tv_nsec;
+    r->function = function;
+    r->line = line;
+    r->level = level;
+    r->truncated = 0;
+    r->size = 0;
+
+    return r;
+}
+
+//! Format all records in the ring to an ostream.
+void LogRing::dump(std::ostream& os)
+{
+    uint64_t end = s_pos.load(std::memory_order_acquire);
+    uint64_t begin = end > num_slots ? end - num_slots : 0;
+
+    os << "--- begin of log ring dump, " << end - begin << " records ---"
+       << std::endl;
+
+    // recorded manipulators change the format state of os while decoding,
+    // hence each record starts from and restores the state of the caller.
+    std::ios format(NULL);
+    format.copyfmt(os);
+
+    Record r;
+
+    for (uint64_t seq = begin; seq < end; ++seq)
+    {
+        const Record& slot = s_ring[seq % num_slots];
+
+        // copy record and check that it was not overwritten meanwhile
+        if (slot.seq.load(std::memory_order_acquire) != seq + 1) continue;
+
+        r.time = slot.time;
+        r.function = slot.function;
+        r.line = slot.line;
+        r.level = slot.level;
+        r.truncated = slot.truncated;
+        r.size = slot.size;
+        memcpy(r.args, slot.args, r.size);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq + 1) continue;
+
+        os << '[' << r.time / 1000000000 << '.';
+        os.width(6), os.fill('0');
+        os << (r.time % 1000000000) / 1000 << "] ";
+
+        os << r.function << ':' << r.line << ' '
+           << Log::level_string((log_level_t)r.level) << " - ";
+        os.copyfmt(format);
+
+        // decode packed arguments
+        const size_t hdr = sizeof(log_decoder_type) + sizeof(uint16_t);
+
+        for (size_t p = 0; p + hdr <= r.size; )
         {
-            set_stderr_level(l);
-            return true;
+            log_decoder_type decoder;
+            uint16_t size;
+            memcpy(&decoder, r.args + p, sizeof(decoder));
+            memcpy(&size, r.args + p + sizeof(decoder), sizeof(size));
+
+            decoder(os, r.args + p + hdr, size);
+            p += hdr + size;
         }
+
+        os.copyfmt(format);
+
+        if (r.truncated)
+            os << " [...]";
+
+        os << std::endl;
     }
 
-    return false;
+    os << "--- end of log ring dump ---" << std::endl;
 }
 
 /******************************************************************************/
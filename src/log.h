@@ -23,8 +23,15 @@
 #ifndef TILEWM_LOG_HEADER
 #define TILEWM_LOG_HEADER
 
-#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <ostream>
 #include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
 
 // *****************************************************************************
 // *** A set of C++ ostream-compatible logging functions.
@@ -36,26 +43,296 @@ enum log_level_t {
     LOG_MAX
 };
 
+//! Compile-time maximum log level: all LOG statements above it are removed
+//! entirely by the compiler. Set via the TILEWM_LOG_MAX_LEVEL cmake option.
+#ifndef TILEWM_LOG_MAX_LEVEL
+#define TILEWM_LOG_MAX_LEVEL LOG_TRACE3
+#endif
+
+/*!
+ * A growing std::streambuf over a character vector, which can be reset
+ * without releasing its memory. One of these is kept per thread and reused for
+ * all log lines.
+ */
+class LogStreamBuf : public std::streambuf
+{
+protected:
+    //! character buffer, grown on overflow
+    std::vector<char> m_buffer;
+
+public:
+    //! Allocate initial buffer
+    LogStreamBuf()
+        : m_buffer(256)
+    {
+        clear();
+    }
+
+    //! Rewind the put area to the beginning of the buffer.
+    void clear()
+    {
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    }
+
+    //! Return pointer to characters written.
+    const char * data() const
+    {
+        return pbase();
+    }
+
+    //! Return number of characters written.
+    size_t size() const
+    {
+        return pptr() - pbase();
+    }
+
+protected:
+    //! Double the buffer size if the put area is full.
+    int_type overflow(int_type ch);
+};
+
+/*!
+ * An ostream writing into a LogStreamBuf.
+ */
+class LogStream : public std::ostream
+{
+protected:
+    //! the underlying reusable buffer
+    LogStreamBuf m_buf;
+
+public:
+    //! Construct ostream on the internal buffer.
+    LogStream()
+        : std::ostream(&m_buf)
+    { }
+
+    //! Return reference to underlying buffer
+    LogStreamBuf & buf()
+    {
+        return m_buf;
+    }
+
+    //! Rewind the buffer and restore default format state for a new line.
+    void reset()
+    {
+        m_buf.clear();
+        std::ostream::clear();
+        flags(std::ios_base::dec | std::ios_base::skipws);
+        width(0);
+        precision(6);
+        fill(' ');
+    }
+};
+
+//! Function to format a binary argument recorded in the LogRing.
+typedef void (* log_decoder_type)(std::ostream& os, const void* data,
+                                  size_t size);
+
+//! Decoder of raw trivially copyable values recorded in the LogRing.
+template <typename Type>
+void log_decode_raw(std::ostream& os, const void* data, size_t)
+{
+    // copy into aligned storage: records are packed
+    typename std::aligned_storage<sizeof(Type), alignof(Type)>::type v;
+    memcpy(&v, data, sizeof(Type));
+    os << *reinterpret_cast<const Type*>(&v);
+}
+
+//! Decoder of character strings recorded in the LogRing.
+void log_decode_string(std::ostream& os, const void* data, size_t size);
+
+/*!
+ * The LogRing is a fixed-size in-memory flight recorder of the most recent log
+ * lines. Each line occupies one slot, which is claimed lock-free by an atomic
+ * counter. Instead of formatting, the arguments of a line are stored as raw
+ * binary copies together with a decoder function. The ring is only formatted
+ * when dumped, which happens on SIGUSR1 and on FATAL messages.
+ */
+class LogRing
+{
+public:
+    //! number of record slots in the ring
+    static const size_t num_slots = 4096;
+
+    //! bytes available for the arguments of one record
+    static const size_t args_size = 216;
+
+    //! A record slot in the ring.
+    struct Record
+    {
+        //! sequence number + 1 when complete, zero while being written.
+        std::atomic<uint64_t> seq;
+        //! monotonic timestamp in nanoseconds
+        uint64_t time;
+        //! call site function name
+        const char* function;
+        //! call site line
+        uint32_t line;
+        //! log level of the record
+        uint8_t level;
+        //! whether arguments were truncated
+        uint8_t truncated;
+        //! number of bytes used in args
+        uint16_t size;
+        //! packed arguments: [decoder][uint16_t size][data]...
+        char args[args_size];
+    };
+
+protected:
+    //! the record slots
+    static Record s_ring[num_slots];
+
+    //! counter of claimed records
+    static std::atomic<uint64_t> s_pos;
+
+public:
+    //! Claim and initialize a new record with sequence number seq.
+    static Record * begin(log_level_t level,
+                          const char* function, unsigned int line,
+                          uint64_t& seq);
+
+    //! Append a binary argument to a record.
+    static void append(Record* r, log_decoder_type decoder,
+                       const void* data, size_t size)
+    {
+        const size_t hdr = sizeof(decoder) + sizeof(uint16_t);
+
+        if (r->size + hdr >= args_size) {
+            r->truncated = 1;
+            return;
+        }
+
+        if (r->size + hdr + size > args_size) {
+            // strings can be cut, other values are dropped.
+            if (decoder != log_decode_string) {
+                r->truncated = 1;
+                return;
+            }
+            size = args_size - r->size - hdr;
+            r->truncated = 1;
+        }
+
+        uint16_t size16 = size;
+        char* p = r->args + r->size;
+        memcpy(p, &decoder, sizeof(decoder));
+        memcpy(p + sizeof(decoder), &size16, sizeof(size16));
+        memcpy(p + hdr, data, size);
+        r->size += hdr + size;
+    }
+
+    //! Publish a completely written record.
+    static void commit(Record* r, uint64_t seq)
+    {
+        r->seq.store(seq + 1, std::memory_order_release);
+    }
+
+    //! Format all records in the ring to an ostream.
+    static void dump(std::ostream& os);
+};
+
 /*!
  * Logging helper class: an object of this Log class is created for each
  * generated line. On destruction, the collected log line is outputted into the
  * currently configured log sinks.
+ *
+ * The LOG macros check the level before constructing a Log object, hence
+ * arguments of disabled log lines are never evaluated. Lines are formatted into
+ * a thread-local LogStream, only log lines issued while another line is being
+ * constructed get a freshly allocated one. Lines recorded only by the LogRing
+ * are not formatted at all.
  */
 class Log
 {
 protected:
-    //! The log information is collected into the string ostream.
-    std::ostringstream m_os;
+    //! The log information is collected into this stream, or NULL if unused.
+    LogStream* m_os;
+
+    //! Whether the line is written to stderr.
+    bool m_text;
+
+    //! Record in the LogRing, or NULL if not recorded.
+    LogRing::Record* m_record;
+
+    //! Sequence number of the record in the LogRing
+    uint64_t m_seq;
 
     //! Level of this log line
     log_level_t m_level;
 
+    //! Maximum level of all log sinks, used to gate LOG statements.
+    static log_level_t s_level;
+
     //! Currently configured maximum level written to stderr
     static log_level_t s_stderr_level;
 
     //! Whether to use ANSI terminal color on stderr
     static bool s_stderr_color;
 
+    //! Currently configured maximum level recorded in the LogRing
+    static log_level_t s_ring_level;
+
+    //! Thread-local stream reused for all log lines.
+    static thread_local LogStream t_stream;
+
+    //! Whether t_stream is currently used by a Log object.
+    static thread_local bool t_stream_used;
+
+    //! Recalculate s_level from levels of all sinks.
+    static void update_level()
+    {
+        s_level = std::max(s_stderr_level, s_ring_level);
+    }
+
+    //! Acquire thread-local or a new stream.
+    void open_stream()
+    {
+        if (!t_stream_used) {
+            t_stream_used = true;
+            m_os = &t_stream;
+            // format state of the previous line must not leak
+            t_stream.reset();
+        }
+        else {
+            // nested log line, e.g. from within an operator <<
+            m_os = new LogStream;
+        }
+    }
+
+    //! Append a trivially copyable value.
+    template <typename Type>
+    typename std::enable_if<std::is_trivially_copyable<Type>::value>::type
+    record(const Type& v)
+    {
+        if (m_os) *m_os << v;
+        if (m_record)
+            LogRing::append(m_record, log_decode_raw<Type>, &v, sizeof(v));
+    }
+
+    //! Append any other value: format it and record the string.
+    template <typename Type>
+    typename std::enable_if<!std::is_trivially_copyable<Type>::value>::type
+    record(const Type& v)
+    {
+        if (!m_os) open_stream();
+
+        size_t begin = m_os->buf().size();
+        *m_os << v;
+
+        if (m_record) {
+            LogRing::append(m_record, log_decode_string,
+                            m_os->buf().data() + begin,
+                            m_os->buf().size() - begin);
+        }
+    }
+
+    //! Append a character string.
+    void record_string(const char* str, size_t size)
+    {
+        if (m_os) m_os->write(str, size);
+        if (m_record)
+            LogRing::append(m_record, log_decode_string, str, size);
+    }
+
 private:
     Log(const Log&);              //!< non-copyable
     Log& operator = (const Log&); //!< non-copyable
@@ -63,34 +340,69 @@ private:
 public:
     //! Start constructing a new log line.
     Log(log_level_t level, const char* function, unsigned int line)
-        : m_level(level)
+        : m_os(NULL), m_text(level <= s_stderr_level), m_record(NULL),
+          m_level(level)
     {
-        m_os << function << ':' << line << ' ' << level_string(level) << " - ";
+        if (m_text) {
+            open_stream();
+            *m_os << function << ':' << line << ' ' << level_string(level)
+                  << " - ";
+        }
+
+        if (level <= s_ring_level)
+            m_record = LogRing::begin(level, function, line, m_seq);
     }
 
-    //! Return the ostreamstring to the user to append more information.
-    std::ostringstream & get()
+    //! Append a value to the log line.
+    template <typename Type>
+    Log& operator << (const Type& v)
     {
-        return m_os;
+        record(v);
+        return *this;
     }
 
-    //! On destruction of the object: output the line to all log sinks.
-    ~Log()
+    //! Append a character string to the log line.
+    Log& operator << (const char* str)
     {
-        if (m_level <= s_stderr_level)
-        {
-            if (s_stderr_color)
-                std::cerr << ansi_color(m_level);
+        record_string(str, strlen(str));
+        return *this;
+    }
 
-            std::cerr << m_os.str();
+    //! Append a character string to the log line.
+    Log& operator << (char* str)
+    {
+        record_string(str, strlen(str));
+        return *this;
+    }
 
-            if (s_stderr_color)
-                std::cerr << "\x1B[0m";
+    //! Append a std::string to the log line.
+    Log& operator << (const std::string& str)
+    {
+        record_string(str.data(), str.size());
+        return *this;
+    }
 
-            std::cerr << std::endl;
-        }
+    //! Apply an ostream manipulator to the log line.
+    Log& operator << (std::ostream& (*manip)(std::ostream&))
+    {
+        record(manip);
+        return *this;
+    }
+
+    //! Apply an ios_base manipulator to the log line.
+    Log& operator << (std::ios_base& (*manip)(std::ios_base&))
+    {
+        record(manip);
+        return *this;
+    }
+
+    //! On destruction of the object: output the line to all log sinks.
+    ~Log();
 
-        // TODO: make circular log buffer
+    //! Check whether a log line of the level will be written to any sink.
+    static bool enabled(log_level_t level)
+    {
+        return (level <= TILEWM_LOG_MAX_LEVEL && level <= s_level);
     }
 
     //! Get the current logging level written to stderr.
@@ -103,11 +415,25 @@ public:
     static void set_stderr_level(log_level_t level)
     {
         s_stderr_level = level;
+        update_level();
     }
 
     //! Change the current logging level written to stderr.
     static bool set_stderr_level(const char* str);
 
+    //! Change the current logging level recorded in the LogRing.
+    static void set_ring_level(log_level_t level)
+    {
+        s_ring_level = level;
+        update_level();
+    }
+
+    //! Change the current logging level recorded in the LogRing.
+    static bool set_ring_level(const char* str);
+
+    //! Parse a log level string, returns LOG_MAX if invalid.
+    static log_level_t parse_level(const char* str);
+
     //! Return the log level as a string.
     static const char * level_string(log_level_t level)
     {
@@ -133,7 +459,20 @@ public:
     }
 };
 
-#define LOG(level, file, line)   Log(level, file, line).get()
+/*!
+ * Helper to turn the Log expression of a LOG statement into void, such that it
+ * can be used as the second branch of the level check ?: operator. The
+ * operator & binds weaker than << but stronger than ?:.
+ */
+struct LogVoidify
+{
+    //! Discard the Log object
+    void operator & (const Log&) { }
+};
+
+#define LOG(level, file, line)                        \
+    !Log::enabled(level) ? (void)0 :                  \
+    LogVoidify() & Log(level, file, line)
 
 // *** Logger Interfaces : INFO << text << var;
 
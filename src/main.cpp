@@ -23,22 +23,32 @@
 #include "log.h"
 #include "xcb.h"
 #include "event.h"
-#include "screen.h"
 #include "binding.h"
 #include "client.h"
 #include "ewmh.h"
-#include "desktop.h"
+#include "launcher.h"
+#include "log-writer.h"
+#include "stats.h"
+#include "trace.h"
+#include "recorder.h"
+#include "startup.h"
 
 #include <unistd.h>
-#include <xcb/xinerama.h>
-#include <xcb/randr.h>
 
 int main(int argc, char* argv[])
 {
     // *** first parse command line
 
+    bool use_launcher = true;
+
+    const char* log_file = NULL;
+    uint64_t log_rotate_size = 0;
+
+    const char* trace_file = NULL;
+    const char* record_file = NULL;
+
     int opt;
-    while ((opt = getopt(argc, argv, "hl:")) != -1)
+    while ((opt = getopt(argc, argv, "hl:r:o:R:S:T:E:F")) != -1)
     {
         switch (opt) {
         case 'l':
@@ -47,57 +57,84 @@ int main(int argc, char* argv[])
                 exit(EXIT_FAILURE);
             }
             break;
+        case 'r':
+            if (!Log::set_ring_level(optarg)) {
+                ERROR << "Invalid log level \"" << optarg << "\"";
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'o':
+            log_file = optarg;
+            break;
+        case 'R':
+            log_rotate_size = strtoul(optarg, NULL, 10) * 1024 * 1024;
+            break;
+        case 'S':
+            EventStats::set_slow_threshold(strtoul(optarg, NULL, 10));
+            break;
+        case 'T':
+            trace_file = optarg;
+            break;
+        case 'E':
+            record_file = optarg;
+            break;
+        case 'F':
+            use_launcher = false;
+            break;
         case 'h':
         default:
-            INFO << "Usage: " << argv[0] << " [-h]";
+            INFO << "Usage: " << argv[0]
+                 << " [-h] [-l level] [-r level] [-o file] [-R MiB]"
+                 << " [-S usec] [-T file] [-E file] [-F]";
             exit(EXIT_FAILURE);
         }
     }
 
     INFO << "Welcome to TileWM";
 
-    // *** open XCB/Xlib connection and register as window manager
+    // *** fork launcher helper while our process is still small
 
-    g_xcb.open_connection();
+    if (use_launcher)
+        Launcher::start();
 
-    if (!g_xcb.setup_wm()) {
-        g_xcb.close_connection();
-        return EXIT_FAILURE;
-    }
+    // *** start background log writer after forking the helper
 
-    // Fetch named cached atoms
-    g_xcb.load_atomlist();
+    if (log_file && !LogWriter::start(log_file, log_rotate_size))
+        return EXIT_FAILURE;
 
-    // Fetch cached cursors
-    g_xcb.load_cursorlist();
+    // *** preallocate trace buffer if requested
 
-    // Initialize keyboard and mouse binding list
-    BindingList::initialize();
-    BindingList::add_test_bindings();
+    if (trace_file && !Tracer::start(trace_file)) {
+        LogWriter::stop();
+        return EXIT_FAILURE;
+    }
 
-    // Let XCB prefetch all the extensions we might need
-    xcb_prefetch_extension_data(g_xcb.connection, &xcb_randr_id);
-    xcb_prefetch_extension_data(g_xcb.connection, &xcb_xinerama_id);
+    // *** record events and replies from the start of the connection
 
-    // *** detect monitors and setup up desktops
-    ScreenList::detect();
-    DeskList::setup();
+    if (record_file && !EventRecorder::start(record_file)) {
+        Tracer::stop();
+        LogWriter::stop();
+        return EXIT_FAILURE;
+    }
 
-    // *** grab root key bindings
-    BindingList::regrab_root();
+    // *** open XCB connection and register as window manager
 
-    // *** set up EWMH properties
-    Ewmh::setup();
+    g_xcb.open_connection();
 
-    // *** set up client list
-    ClientList::s_pixel_focused = g_xcb.allocate_color(65535, 0, 0);
-    ClientList::s_pixel_blurred = g_xcb.allocate_color(0, 0, 65535);
+    if (!Startup::initialize(true)) {
+        g_xcb.close_connection();
+        EventRecorder::stop();
+        Tracer::stop();
+        Launcher::stop();
+        LogWriter::stop();
+        return EXIT_FAILURE;
+    }
 
-    ClientList::remanage_all_windows();
+    Startup::dump();
 
-    // *** set up global event table and run loop!
+    // *** run event loop!
 
-    EventLoop::setup_global_eventtable();
+    EventLoop::setup_signals();
     EventLoop::loop_global();
 
     // *** graceful termination requested
@@ -106,6 +143,14 @@ int main(int argc, char* argv[])
     BindingList::deinitialize();
     g_xcb.unload_cursorlist();
     g_xcb.close_connection();
+    EventRecorder::stop();
+    EventStats::dump();
+    Launcher::dump_stats();
+    BindingList::dump_stats();
+    g_xcb.dump_accounting();
+    Tracer::stop();
+    Launcher::stop();
+    LogWriter::stop();
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,271 @@
+/******************************************************************************/
+/*! \file src/recorder.cpp
+ *
+ * Recording of X events and replies into a binary file for replay.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "recorder.h"
+#include "xcb-format.h"
+#include "log.h"
+#include "tools.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//! magic bytes of record files
+const char EventRecorder::magic[8] = { 'T', 'I', 'L', 'E', 'W', 'M', 'E', 'V' };
+
+//! memory map of the record file, or NULL if not recording.
+char* EventRecorder::s_map = NULL;
+
+//! size of the memory map
+size_t EventRecorder::s_map_size = 0;
+
+//! current end of records in the memory map
+size_t EventRecorder::s_pos = 0;
+
+//! file descriptor of the record file
+int EventRecorder::s_fd = -1;
+
+//! Round up to a multiple of 8 bytes.
+static inline size_t pad8(size_t size)
+{
+    return (size + 7) & ~size_t(7);
+}
+
+//! Create and map record file of given maximum size.
+bool EventRecorder::start(const std::string& path, size_t max_size)
+{
+    ASSERT(!s_map);
+
+    s_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (s_fd < 0) {
+        ERROR << "Could not open record file " << path << ": "
+              << strerror(errno);
+        return false;
+    }
+
+    // sparse preallocation, unwritten parts read as REC_END
+    if (ftruncate(s_fd, max_size) != 0) {
+        ERROR << "Could not resize record file " << path << ": "
+              << strerror(errno);
+        close(s_fd), s_fd = -1;
+        return false;
+    }
+
+    void* map = mmap(NULL, max_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     s_fd, 0);
+    if (map == MAP_FAILED) {
+        ERROR << "Could not map record file " << path << ": "
+              << strerror(errno);
+        close(s_fd), s_fd = -1;
+        return false;
+    }
+
+    s_map = (char*)map;
+    s_map_size = max_size;
+
+    FileHeader fh;
+    memcpy(fh.magic, magic, sizeof(magic));
+    fh.version = version;
+    fh.header_size = sizeof(fh);
+
+    memcpy(s_map, &fh, sizeof(fh));
+    s_pos = pad8(sizeof(fh));
+
+    INFO << "Recording events into " << path;
+    return true;
+}
+
+//! Stop recording and truncate file to the records written.
+void EventRecorder::stop()
+{
+    if (!s_map) return;
+
+    munmap(s_map, s_map_size);
+    s_map = NULL;
+
+    if (ftruncate(s_fd, s_pos) != 0) {
+        WARN << "Could not truncate record file: " << strerror(errno);
+    }
+
+    close(s_fd);
+    s_fd = -1;
+
+    INFO << "Recorded " << s_pos << " bytes of events and replies";
+}
+
+//! Append a record consisting of two parts, stops recording when full.
+void EventRecorder::append(record_type_t type, const void* data, size_t size,
+                           const void* data2, size_t size2)
+{
+    size_t total = sizeof(RecordHeader) + pad8(size + size2);
+
+    // keep space for a terminating REC_END header
+    if (s_pos + total + sizeof(RecordHeader) > s_map_size) {
+        WARN << "Record file full, stopping recording.";
+        stop();
+        return;
+    }
+
+    RecordHeader* rh = (RecordHeader*)(s_map + s_pos);
+    rh->size = size + size2;
+    rh->time = monotonic_ns();
+
+    char* p = (char*)(rh + 1);
+    memcpy(p, data, size);
+    if (size2) memcpy(p + size, data2, size2);
+
+    // write type last, such that an interrupted record reads as REC_END
+    __sync_synchronize();
+    rh->type = type;
+
+    s_pos += total;
+}
+
+//! Record the connection setup data.
+void EventRecorder::record_setup(const xcb_setup_t* setup)
+{
+    append(REC_SETUP, setup, 8 + 4 * setup->length);
+}
+
+//! Record the result of an extension query.
+void EventRecorder::record_extension(const char* name,
+                                     const xcb_query_extension_reply_t* reply)
+{
+    xcb_query_extension_reply_t r;
+
+    if (reply)
+        r = *reply;
+    else
+        memset(&r, 0, sizeof(r));
+
+    append(REC_EXTENSION, &r, sizeof(r), name, strlen(name) + 1);
+}
+
+//! Record an event received by the event loop.
+void EventRecorder::record_event(const xcb_generic_event_t* event)
+{
+    uint8_t packed[64];
+    size_t size = xcb_pack_event(packed, sizeof(packed), event);
+
+    if (size != 0)
+        append(REC_PACKED_EVENT, packed, size);
+    else // the wire format of events is 32 bytes, without full_sequence
+        append(REC_EVENT, event, 32);
+}
+
+//! Record a reply received by the WM, NULL for a failed request.
+void EventRecorder::record_reply(const void* reply)
+{
+    if (!reply) {
+        append(REC_REPLY, NULL, 0);
+        return;
+    }
+
+    const xcb_generic_reply_t* r = (const xcb_generic_reply_t*)reply;
+    append(REC_REPLY, r, 32 + 4 * r->length);
+}
+
+// -----------------------------------------------------------------------------
+
+//! Unmap file
+EventRecordReader::~EventRecordReader()
+{
+    if (m_data) munmap((void*)m_data, m_size);
+}
+
+//! Map record file and check header.
+bool EventRecordReader::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        ERROR << "Could not open record file " << path << ": "
+              << strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        (size_t)st.st_size < sizeof(EventRecorder::FileHeader))
+    {
+        ERROR << "Record file " << path << " is too short";
+        close(fd);
+        return false;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        ERROR << "Could not map record file " << path << ": "
+              << strerror(errno);
+        return false;
+    }
+
+    m_data = (const char*)map;
+    m_size = st.st_size;
+
+    const EventRecorder::FileHeader* fh =
+        (const EventRecorder::FileHeader*)m_data;
+
+    if (memcmp(fh->magic, EventRecorder::magic, sizeof(fh->magic)) != 0 ||
+        fh->version != EventRecorder::version)
+    {
+        ERROR << "File " << path << " is not a tilewm record file";
+        return false;
+    }
+
+    rewind();
+    return true;
+}
+
+//! Return next record or NULL at the end of the file.
+const EventRecorder::RecordHeader* EventRecordReader::next()
+{
+    if (m_pos + sizeof(EventRecorder::RecordHeader) > m_size)
+        return NULL;
+
+    const EventRecorder::RecordHeader* rh =
+        (const EventRecorder::RecordHeader*)(m_data + m_pos);
+
+    if (rh->type == EventRecorder::REC_END) return NULL;
+
+    size_t total = sizeof(*rh) + pad8(rh->size);
+    if (m_pos + total > m_size) return NULL;
+
+    m_pos += total;
+    return rh;
+}
+
+//! Restart reading at the first record.
+void EventRecordReader::rewind()
+{
+    const EventRecorder::FileHeader* fh =
+        (const EventRecorder::FileHeader*)m_data;
+
+    m_pos = pad8(fh->header_size);
+}
+
+/******************************************************************************/
@@ -0,0 +1,170 @@
+/******************************************************************************/
+/*! \file src/recorder.h
+ *
+ * Recording of X events and replies into a binary file for replay.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#ifndef TILEWM_RECORDER_HEADER
+#define TILEWM_RECORDER_HEADER
+
+#include <string>
+#include <stdint.h>
+#include <xcb/xcb.h>
+
+/*!
+ * The EventRecorder appends all raw X events received by the event loop and
+ * all replies to queries made by the WM to a memory-mapped binary file. The
+ * connection setup data and the extension query results are recorded as
+ * well, such that tilewm-replay can serve the exact same inputs to the WM
+ * via a stub X connection.
+ *
+ * The file consists of a FileHeader followed by records, each made of a
+ * RecordHeader and its payload padded to 8 bytes. The file is preallocated
+ * sparsely, a record type of zero terminates the list. Core events are
+ * stored packed via their field descriptors (see xcb-format.h), which usually
+ * halves their record size, all others verbatim.
+ */
+class EventRecorder
+{
+public:
+    //! types of records
+    enum record_type_t {
+        REC_END = 0, REC_SETUP, REC_EXTENSION, REC_EVENT, REC_REPLY,
+        REC_PACKED_EVENT
+    };
+
+    //! Header at the start of the file.
+    struct FileHeader
+    {
+        //! magic bytes "TILEWMEV"
+        char magic[8];
+        //! format version
+        uint32_t version;
+        //! size of this header
+        uint32_t header_size;
+    };
+
+    //! Header of each record.
+    struct RecordHeader
+    {
+        //! type of record
+        uint32_t type;
+        //! size of payload, without padding. Zero for failed replies.
+        uint32_t size;
+        //! monotonic timestamp in nanoseconds
+        uint64_t time;
+    };
+
+    //! magic bytes of record files
+    static const char magic[8];
+
+    //! current format version
+    static const uint32_t version = 6;
+
+    //! default maximum size of record file
+    static const size_t default_size = 256 * 1024 * 1024;
+
+protected:
+    //! memory map of the record file, or NULL if not recording.
+    static char* s_map;
+
+    //! size of the memory map
+    static size_t s_map_size;
+
+    //! current end of records in the memory map
+    static size_t s_pos;
+
+    //! file descriptor of the record file
+    static int s_fd;
+
+    //! Append a record consisting of two parts, stops recording when full.
+    static void append(record_type_t type, const void* data, size_t size,
+                       const void* data2 = NULL, size_t size2 = 0);
+
+public:
+    //! Create and map record file of given maximum size.
+    static bool start(const std::string& path, size_t max_size = default_size);
+
+    //! Stop recording and truncate file to the records written.
+    static void stop();
+
+    //! Check whether recording is enabled.
+    static bool enabled()
+    {
+        return (s_map != NULL);
+    }
+
+    //! Record the connection setup data.
+    static void record_setup(const xcb_setup_t* setup);
+
+    //! Record the result of an extension query.
+    static void record_extension(const char* name,
+                                 const xcb_query_extension_reply_t* reply);
+
+    //! Record an event received by the event loop.
+    static void record_event(const xcb_generic_event_t* event);
+
+    //! Record a reply received by the WM, NULL for a failed request.
+    static void record_reply(const void* reply);
+};
+
+/*!
+ * Sequential reader of a memory-mapped record file.
+ */
+class EventRecordReader
+{
+protected:
+    //! memory map of the file
+    const char* m_data;
+
+    //! size of the file
+    size_t m_size;
+
+    //! position of the next record
+    size_t m_pos;
+
+public:
+    //! Construct unopened reader
+    EventRecordReader()
+        : m_data(NULL), m_size(0), m_pos(0)
+    { }
+
+    //! Unmap file
+    ~EventRecordReader();
+
+    //! Map record file and check header.
+    bool open(const std::string& path);
+
+    //! Return next record or NULL at the end of the file.
+    const EventRecorder::RecordHeader * next();
+
+    //! Return pointer to payload of a record.
+    static const char * payload(const EventRecorder::RecordHeader* r)
+    {
+        return (const char*)(r + 1);
+    }
+
+    //! Restart reading at the first record.
+    void rewind();
+};
+
+#endif // !TILEWM_RECORDER_HEADER
+
+/******************************************************************************/
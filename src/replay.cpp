@@ -0,0 +1,337 @@
+/******************************************************************************/
+/*! \file src/replay.cpp
+ *
+ * Replay driver feeding a record file through the WM via a stub X server.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "log.h"
+#include "xcb.h"
+#include "event.h"
+#include "binding.h"
+#include "client.h"
+#include "ewmh.h"
+#include "recorder.h"
+#include "xcb-format.h"
+#include "startup.h"
+#include "stats.h"
+#include "tools.h"
+#include "fake-server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+/*!
+ * The StubServer speaks just enough of the X11 protocol on one end of a
+ * socketpair to serve a record file to the WM: it sends the recorded
+ * connection setup and events, and answers each request expecting a reply
+ * with the next recorded reply. Extension queries are answered from the
+ * recorded extension data, while requests issued inside xcb-util (keyboard
+ * mapping) and libxcb (input focus sync) get synthesized empty replies,
+ * since these are not recorded.
+ */
+class StubServer : public XServerSocket
+{
+protected:
+    //! reader of the record file
+    EventRecordReader& m_reader;
+
+    //! map extension name -> recorded query extension reply
+    std::map<std::string, std::string> m_extension;
+
+    //! map major opcode -> extension name
+    std::map<uint8_t, std::string> m_major;
+
+    //! Check whether the last request read expects a reply.
+    bool expects_reply() const;
+
+    //! Answer requests whose replies are not recorded, returns true if the
+    //! last request was answered.
+    bool answer_synthesized();
+
+public:
+    //! number of events sent
+    uint64_t m_events;
+
+    //! number of recorded replies sent
+    uint64_t m_replies;
+
+    //! number of synthesized replies sent
+    uint64_t m_synthesized;
+
+    //! Construct server on socket fd for the given record file.
+    StubServer(int fd, EventRecordReader& reader);
+
+    //! Serve all records, then close the write side of the socket.
+    void run();
+};
+
+//! Construct server on socket fd for the given record file.
+StubServer::StubServer(int fd, EventRecordReader& reader)
+    : XServerSocket(fd), m_reader(reader),
+      m_events(0), m_replies(0), m_synthesized(0)
+{
+    // collect extension data up front, clients may prefetch it early.
+    const EventRecorder::RecordHeader* rh;
+
+    while ((rh = m_reader.next()))
+    {
+        if (rh->type != EventRecorder::REC_EXTENSION) continue;
+
+        const char* p = EventRecordReader::payload(rh);
+        m_extension[p + 32] = std::string(p, 32);
+    }
+
+    m_reader.rewind();
+}
+
+//! Check whether the last request read expects a reply.
+bool StubServer::expects_reply() const
+{
+    uint8_t major = m_request[0], minor = m_request[1];
+
+    if (major < 128)
+        return core_expects_reply(major);
+
+    std::map<uint8_t, std::string>::const_iterator it = m_major.find(major);
+    if (it == m_major.end()) return false;
+
+    if (it->second == "XINERAMA") {
+        // all Xinerama requests have replies
+        return true;
+    }
+    if (it->second == "RANDR")
+    {
+        switch (minor)
+        {
+        case 0: case 2: case 5: case 6: case 8: case 9: case 10: case 11:
+        case 15: case 16: case 20: case 21: case 22: case 23: case 25:
+        case 27: case 28: case 29: case 31:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    return false;
+}
+
+//! Answer requests whose replies are not recorded.
+bool StubServer::answer_synthesized()
+{
+    uint8_t major = m_request[0];
+
+    char reply[32];
+    memset(reply, 0, sizeof(reply));
+    reply[0] = 1; // X_Reply
+
+    if (major == XCB_QUERY_EXTENSION)
+    {
+        uint16_t name_len;
+        memcpy(&name_len, m_request.data() + 4, 2);
+        std::string name(m_request.data() + 8,
+                         std::min<size_t>(name_len, m_request.size() - 8));
+
+        std::map<std::string, std::string>::const_iterator it =
+            m_extension.find(name);
+
+        if (it != m_extension.end()) {
+            memcpy(reply, it->second.data(), 32);
+
+            const xcb_query_extension_reply_t* qer =
+                (const xcb_query_extension_reply_t*)reply;
+            if (qer->present)
+                m_major[qer->major_opcode] = name;
+        }
+        // otherwise: extension not present
+    }
+    else if (major == XCB_GET_INPUT_FOCUS ||
+             major == XCB_GET_KEYBOARD_MAPPING ||
+             major == XCB_GET_ATOM_NAME)
+    {
+        // empty focus, keyboard mapping or atom name
+    }
+    else
+        return false;
+
+    ++m_synthesized;
+    return send_with_seq(reply, sizeof(reply));
+}
+
+//! Serve all records, then close the write side of the socket.
+void StubServer::run()
+{
+    const EventRecorder::RecordHeader* rh;
+
+    if (!read_setup_request()) goto done;
+
+    while ((rh = m_reader.next()))
+    {
+        const char* p = EventRecordReader::payload(rh);
+
+        if (rh->type == EventRecorder::REC_SETUP)
+        {
+            if (!write_full(p, rh->size)) goto done;
+        }
+        else if (rh->type == EventRecorder::REC_EVENT)
+        {
+            if (!send_with_seq(p, rh->size)) goto done;
+            ++m_events;
+        }
+        else if (rh->type == EventRecorder::REC_PACKED_EVENT)
+        {
+            xcb_generic_event_t event;
+            if (!xcb_unpack_event((const uint8_t*)p, rh->size, &event)) {
+                ERROR << "replay: corrupt packed event record";
+                goto done;
+            }
+
+            if (!send_with_seq(&event, 32)) goto done;
+            ++m_events;
+        }
+        else if (rh->type == EventRecorder::REC_REPLY)
+        {
+            // read requests until the one waiting for this reply arrives
+            while (1)
+            {
+                if (!read_request()) goto done;
+                if (answer_synthesized()) continue;
+                if (expects_reply()) break;
+            }
+
+            if (rh->size == 0)
+            {
+                // failed request: answer with BadImplementation error
+                if (!send_error(XCB_IMPLEMENTATION)) goto done;
+            }
+            else
+            {
+                if (!send_with_seq(p, rh->size)) goto done;
+            }
+
+            ++m_replies;
+        }
+    }
+
+done:
+    // signal end of trace to the WM
+    shutdown(m_fd, SHUT_WR);
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    // *** parse command line
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hl:S:")) != -1)
+    {
+        switch (opt) {
+        case 'l':
+            if (!Log::set_stderr_level(optarg)) {
+                ERROR << "Invalid log level \"" << optarg << "\"";
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'S':
+            EventStats::set_slow_threshold(strtoul(optarg, NULL, 10));
+            break;
+        case 'h':
+        default:
+            INFO << "Usage: " << argv[0] << " [-h] [-l level] [-S usec] file";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (optind + 1 != argc) {
+        ERROR << "Usage: " << argv[0] << " [-h] [-l level] [-S usec] file";
+        exit(EXIT_FAILURE);
+    }
+
+    EventRecordReader reader;
+    if (!reader.open(argv[optind]))
+        return EXIT_FAILURE;
+
+    // *** connect WM to stub server running in a thread
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) {
+        ERROR << "socketpair() failed: " << strerror(errno);
+        return EXIT_FAILURE;
+    }
+
+    StubServer server(sv[1], reader);
+    std::thread server_thread(&StubServer::run, &server);
+
+    g_xcb.open_connection_fd(sv[0]);
+
+    // *** same startup sequence as main(), except for cursors, which are
+    // loaded by xcb-cursor without recording
+
+    if (!Startup::initialize(false)) {
+        ERROR << "Recorded WM setup failed.";
+        return EXIT_FAILURE;
+    }
+
+    // *** feed all recorded events through the global event handler
+
+    uint64_t start = monotonic_ns();
+    uint64_t count = 0;
+
+    while (1)
+    {
+        EventLoop::flush_changes();
+
+        xcb_generic_event_t* event = xcb_wait_for_event(g_xcb.connection);
+        if (!event) break;
+
+        EventLoop::process_global(event);
+        free(event);
+        ++count;
+    }
+
+    uint64_t ns = monotonic_ns() - start;
+
+    server_thread.join();
+
+    INFO << "Replayed " << count << " events in " << ns / 1000 << " us = "
+         << (ns ? count * 1000000000llu / ns : 0) << " events/s, served "
+         << server.m_replies << " recorded and " << server.m_synthesized
+         << " synthesized replies";
+
+    EventStats::dump();
+    BindingList::dump_stats();
+    g_xcb.dump_accounting();
+
+    BindingList::deinitialize();
+    g_xcb.close_connection();
+    close(sv[1]);
+
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
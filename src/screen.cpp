@@ -82,7 +82,7 @@ bool ScreenList::detect_xinerama()
     // *** Figure out if Xinerama extension is available and active
 
     const xcb_query_extension_reply_t* qer =
-        xcb_get_extension_data(g_xcb.connection, &xcb_xinerama_id);
+        g_xcb.get_extension_data(&xcb_xinerama_id);
 
     if (qer) TRACE << *qer;
 
@@ -92,10 +92,10 @@ bool ScreenList::detect_xinerama()
     }
 
     xcb_xinerama_is_active_cookie_t xiac =
-        xcb_xinerama_is_active(g_xcb.connection);
+        g_xcb.req(xcb_xinerama_is_active(g_xcb.connection));
 
     autofree_ptr<xcb_xinerama_is_active_reply_t> xiar(
-        xcb_xinerama_is_active_reply(g_xcb.connection, xiac, NULL)
+        g_xcb.reply(xcb_xinerama_is_active_reply, xiac, NULL)
         );
 
     if (xiar) TRACE << *xiar;
@@ -108,10 +108,10 @@ bool ScreenList::detect_xinerama()
     // *** Xinerama is present and active, query for screens
 
     xcb_xinerama_query_screens_cookie_t xqsc =
-        xcb_xinerama_query_screens(g_xcb.connection);
+        g_xcb.req(xcb_xinerama_query_screens(g_xcb.connection));
 
     autofree_ptr<xcb_xinerama_query_screens_reply_t> xqsr(
-        xcb_xinerama_query_screens_reply(g_xcb.connection, xqsc, NULL)
+        g_xcb.reply(xcb_xinerama_query_screens_reply, xqsc, NULL)
         );
 
     if (!xqsr) {
@@ -174,11 +174,11 @@ bool ScreenList::detect_randr11()
     // *** RandR extension 1.1 is present and active
 
     xcb_randr_get_screen_resources_current_cookie_t rsrcc =
-        xcb_randr_get_screen_resources_current(g_xcb.connection, g_xcb.root);
+        g_xcb.req(xcb_randr_get_screen_resources_current(g_xcb.connection,
+                                                         g_xcb.root));
 
     autofree_ptr<xcb_randr_get_screen_resources_current_reply_t> rsrr(
-        xcb_randr_get_screen_resources_current_reply(g_xcb.connection,
-                                                     rsrcc, NULL)
+        g_xcb.reply(xcb_randr_get_screen_resources_current_reply, rsrcc, NULL)
         );
 
     if (!rsrr) {
@@ -205,13 +205,14 @@ bool ScreenList::detect_randr11()
     std::vector<xcb_randr_get_crtc_info_cookie_t> rcic(num);
 
     for (int i = 0; i < num; ++i)
-        rcic[i] = xcb_randr_get_crtc_info(g_xcb.connection, crtcs[i], cts);
+        rcic[i] = g_xcb.req(xcb_randr_get_crtc_info(g_xcb.connection,
+                                                    crtcs[i], cts));
 
     // Receive info response for each CRTC
     for (int i = 0; i < num; ++i)
     {
         autofree_ptr<xcb_randr_get_crtc_info_reply_t> rcir(
-            xcb_randr_get_crtc_info_reply(g_xcb.connection, rcic[i], NULL)
+            g_xcb.reply(xcb_randr_get_crtc_info_reply, rcic[i], NULL)
             );
 
         if (!rcir) {
@@ -274,13 +275,14 @@ bool ScreenList::detect_randr12()
     // *** RandR extension 1.2 is present and active
 
     xcb_randr_get_screen_resources_current_cookie_t rsrcc =
-        xcb_randr_get_screen_resources_current(g_xcb.connection, g_xcb.root);
+        g_xcb.req(xcb_randr_get_screen_resources_current(g_xcb.connection,
+                                                         g_xcb.root));
 
     xcb_randr_get_output_primary_cookie_t ropc =
-        xcb_randr_get_output_primary(g_xcb.connection, g_xcb.root);
+        g_xcb.req(xcb_randr_get_output_primary(g_xcb.connection, g_xcb.root));
 
     autofree_ptr<xcb_randr_get_output_primary_reply_t> ropr(
-        xcb_randr_get_output_primary_reply(g_xcb.connection, ropc, NULL)
+        g_xcb.reply(xcb_randr_get_output_primary_reply, ropc, NULL)
         );
 
     if (!ropr) {
@@ -292,8 +294,7 @@ bool ScreenList::detect_randr12()
     }
 
     autofree_ptr<xcb_randr_get_screen_resources_current_reply_t> rsrr(
-        xcb_randr_get_screen_resources_current_reply(g_xcb.connection,
-                                                     rsrcc, NULL)
+        g_xcb.reply(xcb_randr_get_screen_resources_current_reply, rsrcc, NULL)
         );
 
     if (!rsrr) {
@@ -320,13 +321,17 @@ bool ScreenList::detect_randr12()
     std::vector<xcb_randr_get_output_info_cookie_t> roic(num);
 
     for (int i = 0; i < num; ++i)
-        roic[i] = xcb_randr_get_output_info(g_xcb.connection, outputs[i], cts);
+        roic[i] = g_xcb.req(xcb_randr_get_output_info(g_xcb.connection,
+                                                      outputs[i], cts));
+
+    // Receive info response for each output and send CRTC info requests
+    std::vector<std::string> crtc_output;
+    std::vector<xcb_randr_get_crtc_info_cookie_t> rcic;
 
-    // Receive info response for each output
     for (int i = 0; i < num; ++i)
     {
         autofree_ptr<xcb_randr_get_output_info_reply_t> roir(
-            xcb_randr_get_output_info_reply(g_xcb.connection, roic[i], NULL)
+            g_xcb.reply(xcb_randr_get_output_info_reply, roic[i], NULL)
             );
 
         if (!roir) {
@@ -350,11 +355,18 @@ bool ScreenList::detect_randr12()
             continue;
         }
 
-        xcb_randr_get_crtc_info_cookie_t rcic =
-            xcb_randr_get_crtc_info(g_xcb.connection, roir->crtc, cts);
+        crtc_output.push_back(output_name);
+        rcic.push_back(g_xcb.req(xcb_randr_get_crtc_info(g_xcb.connection,
+                                                         roir->crtc, cts)));
+    }
+
+    // Receive CRTC info responses, which were sent together
+    for (size_t i = 0; i < rcic.size(); ++i)
+    {
+        const std::string& output_name = crtc_output[i];
 
         autofree_ptr<xcb_randr_get_crtc_info_reply_t> rcir(
-            xcb_randr_get_crtc_info_reply(g_xcb.connection, rcic, NULL)
+            g_xcb.reply(xcb_randr_get_crtc_info_reply, rcic[i], NULL)
             );
 
         if (!rcir) {
@@ -407,7 +419,7 @@ bool ScreenList::detect_randr()
     // *** Figure out if RandR extension is available and active
 
     const xcb_query_extension_reply_t* qer =
-        xcb_get_extension_data(g_xcb.connection, &xcb_randr_id);
+        g_xcb.get_extension_data(&xcb_randr_id);
 
     if (qer) TRACE << *qer;
 
@@ -416,57 +428,42 @@ bool ScreenList::detect_randr()
         return false;
     }
 
-    // *** first query for RandR version 1.2
+    // *** query for RandR version 1.2, the server answers with the highest
+    // version it supports up to the requested one.
 
-    xcb_randr_query_version_cookie_t rqvc2 =
-        xcb_randr_query_version(g_xcb.connection, 1, 2);
+    xcb_randr_query_version_cookie_t rqvc =
+        g_xcb.req(xcb_randr_query_version(g_xcb.connection, 1, 2));
 
-    autofree_ptr<xcb_randr_query_version_reply_t> rqvr2(
-        xcb_randr_query_version_reply(g_xcb.connection, rqvc2, NULL)
+    autofree_ptr<xcb_randr_query_version_reply_t> rqvr(
+        g_xcb.reply(xcb_randr_query_version_reply, rqvc, NULL)
         );
 
-    if (rqvr2) {
-        TRACE << *rqvr2;
+    if (rqvr) {
+        TRACE << *rqvr;
         INFO << "Found RandR extension version "
-             << rqvr2->major_version << '.' << rqvr2->minor_version;
-
-        if (!detect_randr12()) return false;
-
-        s_randr_version = 0x0102;
-
-        // save first event for received RandR updates
-        EventLoop::set_randr_first_event(qer->first_event);
-
-        xcb_randr_select_input(g_xcb.connection, g_xcb.root,
-                               XCB_RANDR_NOTIFY_MASK_SCREEN_CHANGE);
-        return true;
-    }
-
-    // *** then query for RandR version 1.1
-
-    xcb_randr_query_version_cookie_t rqvc1 =
-        xcb_randr_query_version(g_xcb.connection, 1, 1);
-
-    autofree_ptr<xcb_randr_query_version_reply_t> rqvr1(
-        xcb_randr_query_version_reply(g_xcb.connection, rqvc1, NULL)
-        );
+             << rqvr->major_version << '.' << rqvr->minor_version;
 
-    if (rqvr1) {
-        TRACE << *rqvr1;
-        INFO << "Found RandR extension version "
-             << rqvr1->major_version << '.' << rqvr1->minor_version;
-
-        if (!detect_randr11()) return false;
-
-        s_randr_version = 0x0101;
-
-        // save first event for received RandR updates
-        EventLoop::set_randr_first_event(qer->first_event);
+        if (rqvr->major_version > 1 || rqvr->minor_version >= 2)
+        {
+            if (!detect_randr12()) return false;
+            s_randr_version = 0x0102;
+        }
+        else if (rqvr->minor_version >= 1)
+        {
+            if (!detect_randr11()) return false;
+            s_randr_version = 0x0101;
+        }
 
-        xcb_randr_select_input(g_xcb.connection, g_xcb.root,
-                               XCB_RANDR_NOTIFY_MASK_SCREEN_CHANGE);
+        if (s_randr_version)
+        {
+            // save first event for received RandR updates
+            EventLoop::set_randr_first_event(qer->first_event);
 
-        return true;
+            g_xcb.req(xcb_randr_select_input(
+                          g_xcb.connection, g_xcb.root,
+                          XCB_RANDR_NOTIFY_MASK_SCREEN_CHANGE));
+            return true;
+        }
     }
 
     ERROR << "RandR extension 1.2 or 1.1 not found, disabling.";
@@ -477,6 +474,8 @@ bool ScreenList::detect_randr()
 //! Receive XCB_RANDR_SCREEN_CHANGE_NOTIFY events
 void ScreenList::randr_screen_change_notify(xcb_generic_event_t* event)
 {
+    XcbAccountScope scope(XcbConnection::SUB_SCREEN);
+
     xcb_randr_screen_change_notify_event_t* e
         = (xcb_randr_screen_change_notify_event_t*)event;
 
@@ -517,6 +516,8 @@ void ScreenList::detect_default()
 //! Run initial screen detection: RandR, Xinerama and then default.
 void ScreenList::detect()
 {
+    XcbAccountScope scope(XcbConnection::SUB_SCREEN);
+
     if (detect_randr()) return;
 
     if (detect_xinerama()) return;
@@ -0,0 +1,215 @@
+/******************************************************************************/
+/*! \file src/simulate.cpp
+ *
+ * Deterministic offline simulation of large sessions against the fake X server.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "log.h"
+#include "xcb.h"
+#include "event.h"
+#include "binding.h"
+#include "client.h"
+#include "stats.h"
+#include "tools.h"
+#include "fake-server.h"
+#include "startup.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+//! Accumulated statistics of one simulation phase.
+struct Phase
+{
+    //! name of the phase
+    const char* name;
+    //! number of events processed by the WM
+    uint64_t events;
+    //! thread CPU time spent in the WM's event handlers
+    uint64_t cpu_ns;
+    //! number of requests handled by the fake server
+    uint64_t requests;
+};
+
+//! Output statistics of a simulation phase.
+static void report(const Phase& p)
+{
+    INFO << "sim: " << p.name << ": " << p.events << " events, "
+         << p.requests << " requests, WM cpu " << p.cpu_ns / 1000 << " us = "
+         << (p.events ? p.cpu_ns / p.events : 0) << " ns/event";
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int num_windows = 10000;
+
+    // *** parse command line
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hl:n:S:")) != -1)
+    {
+        switch (opt) {
+        case 'l':
+            if (!Log::set_stderr_level(optarg)) {
+                ERROR << "Invalid log level \"" << optarg << "\"";
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'n':
+            num_windows = strtoul(optarg, NULL, 10);
+            break;
+        case 'S':
+            EventStats::set_slow_threshold(strtoul(optarg, NULL, 10));
+            break;
+        case 'h':
+        default:
+            INFO << "Usage: " << argv[0] << " [-h] [-l level] [-n windows]"
+                 << " [-S usec]";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // *** connect WM to fake server running in a thread
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) {
+        ERROR << "socketpair() failed: " << strerror(errno);
+        return EXIT_FAILURE;
+    }
+
+    FakeXServer server(sv[1]);
+    std::thread server_thread(&FakeXServer::run, &server);
+
+    g_xcb.open_connection_fd(sv[0]);
+
+    // *** same startup sequence as main(), except for cursors
+
+    if (!Startup::initialize(false)) {
+        ERROR << "WM setup on fake server failed.";
+        return EXIT_FAILURE;
+    }
+
+    // *** simulate clients
+
+    static const char wm_class[] = "simclient\0SimClient";
+
+    // WM_NORMAL_HINTS with PMinSize and PResizeInc
+    uint32_t size_hints[18];
+    memset(size_hints, 0, sizeof(size_hints));
+    size_hints[0] = (1 << 4) | (1 << 6);
+    size_hints[5] = 100, size_hints[6] = 50;
+    size_hints[9] = 8, size_hints[10] = 16;
+
+    std::vector<xcb_window_t> windows;
+    Phase phase;
+
+    // phase 1: create and map windows
+
+    phase = Phase { "map", 0, 0, server.requests() };
+
+    for (unsigned int i = 0; i < num_windows; ++i)
+    {
+        xcb_window_t win = server.create_window(
+            Rectangle(i % 1000, i % 700, 400 + i % 200, 300 + i % 100));
+
+        server.change_property(win, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 8,
+                               wm_class, sizeof(wm_class));
+        server.change_property(win, XCB_ATOM_WM_NORMAL_HINTS,
+                               XCB_ATOM_WM_SIZE_HINTS, 32,
+                               size_hints, sizeof(size_hints));
+        server.map_window(win);
+
+        phase.events += server.settle(phase.cpu_ns);
+        windows.push_back(win);
+    }
+
+    phase.requests = server.requests() - phase.requests;
+    report(phase);
+
+    INFO << "sim: " << ClientList::size() << " managed clients, "
+         << std::count_if(windows.begin(), windows.end(),
+                     [&server](xcb_window_t w) { return server.is_mapped(w); })
+         << " mapped windows";
+
+    // phase 2: property churn, e.g. by terminals resizing their increments
+
+    phase = Phase { "property", 0, 0, server.requests() };
+
+    for (unsigned int i = 0; i < num_windows; ++i)
+    {
+        size_hints[9] = 8 + i % 4;
+        server.change_property(windows[i], XCB_ATOM_WM_NORMAL_HINTS,
+                               XCB_ATOM_WM_SIZE_HINTS, 32,
+                               size_hints, sizeof(size_hints));
+
+        phase.events += server.settle(phase.cpu_ns);
+    }
+
+    phase.requests = server.requests() - phase.requests;
+    report(phase);
+
+    // phase 3: clients requesting new geometries
+
+    phase = Phase { "configure", 0, 0, server.requests() };
+
+    for (unsigned int i = 0; i < num_windows; ++i)
+    {
+        server.configure_window(
+            windows[i], Rectangle(i % 500, i % 300, 640, 480));
+
+        phase.events += server.settle(phase.cpu_ns);
+    }
+
+    phase.requests = server.requests() - phase.requests;
+    report(phase);
+
+    // phase 4: destroy all windows
+
+    phase = Phase { "destroy", 0, 0, server.requests() };
+
+    for (unsigned int i = 0; i < num_windows; ++i)
+    {
+        server.destroy_window(windows[i]);
+
+        phase.events += server.settle(phase.cpu_ns);
+    }
+
+    phase.requests = server.requests() - phase.requests;
+    report(phase);
+
+    INFO << "sim: " << ClientList::size() << " managed clients remaining";
+
+    EventStats::dump();
+    g_xcb.dump_accounting();
+
+    BindingList::deinitialize();
+    g_xcb.close_connection();
+
+    server_thread.join();
+    close(sv[1]);
+
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
@@ -0,0 +1,262 @@
+/******************************************************************************/
+/*! \file src/size-solver.cpp
+ *
+ * Integer batch solver distributing a span among windows with size hints.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "size-solver.h"
+
+#include <algorithm>
+
+const int32_t SizeSolver::unlimited;
+
+//! Clamp a 64-bit intermediate value into the int32_t range.
+static inline int32_t clamp32(int64_t v)
+{
+    return (int32_t)std::max<int64_t>(
+        0, std::min<int64_t>(v, SizeSolver::unlimited));
+}
+
+//! Restrict the item by an aspect ratio to a fixed cross size: the ratio
+//! (size - base) / cross must be in [lo_num/lo_den, hi_num/hi_den].
+//! Non-positive fractions disable the bound.
+void SizeSolver::Item::limit_aspect(int32_t base, int32_t cross,
+                                    int32_t lo_num, int32_t lo_den,
+                                    int32_t hi_num, int32_t hi_den)
+{
+    if (cross <= 0) return;
+
+    if (lo_num > 0 && lo_den > 0) {
+        // round up to keep the ratio above the lower bound
+        int64_t v = ((int64_t)cross * lo_num + lo_den - 1) / lo_den;
+        min = std::max(min, clamp32(base + v));
+    }
+
+    if (hi_num > 0 && hi_den > 0) {
+        int64_t v = (int64_t)cross * hi_num / hi_den;
+        max = std::min(max, clamp32(base + v));
+    }
+}
+
+//! Compare all fields.
+bool SizeSolver::Hints::operator == (const Hints& h) const
+{
+    return (min_w == h.min_w && min_h == h.min_h &&
+            max_w == h.max_w && max_h == h.max_h &&
+            base_w == h.base_w && base_h == h.base_h &&
+            inc_w == h.inc_w && inc_h == h.inc_h &&
+            aspect_base_w == h.aspect_base_w &&
+            aspect_base_h == h.aspect_base_h &&
+            min_aspect_num == h.min_aspect_num &&
+            min_aspect_den == h.min_aspect_den &&
+            max_aspect_num == h.max_aspect_num &&
+            max_aspect_den == h.max_aspect_den &&
+            border == h.border);
+}
+
+//! Construct Item for the outer width given the outer height, or for the
+//! outer height given the outer width.
+SizeSolver::Item SizeSolver::Hints::item(bool horizontal, int32_t cross) const
+{
+    Item it;
+    cross -= 2 * border;
+
+    if (horizontal)
+    {
+        it = Item(min_w, max_w, base_w, inc_w);
+        it.limit_aspect(aspect_base_w, cross - aspect_base_h,
+                        min_aspect_num, min_aspect_den,
+                        max_aspect_num, max_aspect_den);
+    }
+    else
+    {
+        // height / width is bounded by the inverse fractions
+        it = Item(min_h, max_h, base_h, inc_h);
+        it.limit_aspect(aspect_base_h, cross - aspect_base_w,
+                        max_aspect_den, max_aspect_num,
+                        min_aspect_den, min_aspect_num);
+    }
+
+    // solver works on outer sizes including the border
+    it.min += 2 * border;
+    it.base += 2 * border;
+    if (it.max != unlimited)
+        it.max = clamp32((int64_t)it.max + 2 * border);
+
+    return it;
+}
+
+//! Assign sizes in [lo[i],hi[i]] summing up to span with the sizes being as
+//! equal as possible. Requires sum of lo <= span <= sum of hi.
+void SizeSolver::water_fill(int64_t span, const std::vector<int32_t>& lo,
+                            const std::vector<int32_t>& hi,
+                            itemlist_type& items)
+{
+    size_t n = items.size();
+
+    // sorted breakpoints of the filling level: 2*i for lo[i], 2*i+1 for hi[i]
+    std::vector<std::pair<int32_t, size_t> > events;
+    events.reserve(2 * n);
+
+    int64_t filled = 0;
+    for (size_t i = 0; i < n; ++i) {
+        events.push_back(std::make_pair(lo[i], 2 * i));
+        events.push_back(std::make_pair(hi[i], 2 * i + 1));
+        filled += lo[i];
+    }
+
+    std::sort(events.begin(), events.end());
+
+    // raise level until the sum of clamped sizes reaches the span
+    int64_t level = events.front().first;
+    size_t active = 0;
+
+    for (size_t k = 0; k < events.size() && filled < span; ++k)
+    {
+        int32_t v = events[k].first;
+
+        if (v > level && active > 0) {
+            int64_t next = filled + (int64_t)active * (v - level);
+            if (next >= span) break;
+            filled = next;
+        }
+        level = std::max<int64_t>(level, v);
+
+        if (events[k].second % 2 == 0)
+            ++active;
+        else
+            --active;
+    }
+
+    // remaining pixels below one full level step go to the first windows
+    int64_t rest = 0;
+    if (filled < span && active > 0) {
+        level += (span - filled) / active;
+        rest = (span - filled) % active;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        int64_t s = std::max<int64_t>(lo[i], std::min<int64_t>(level, hi[i]));
+
+        if (rest > 0 && lo[i] <= level && level < hi[i])
+            ++s, --rest;
+
+        items[i].size = (int32_t)s;
+    }
+}
+
+//! Assign sizes to all items summing up to at most span. Returns false if span
+//! is smaller than the sum of minimums, in which case windows are shrunk
+//! evenly ignoring increments.
+bool SizeSolver::solve(int32_t span, itemlist_type& items)
+{
+    size_t n = items.size();
+    if (n == 0) return true;
+
+    span = std::max(span, 0);
+
+    // valid size range of each item snapped to its increments
+    std::vector<int32_t> lo(n), hi(n);
+    int64_t sum_lo = 0, sum_hi = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        Item& it = items[i];
+        it.inc = std::max(it.inc, 1);
+        it.base = std::max(it.base, 0);
+
+        int64_t l = std::max(it.min, it.base) - it.base;
+        l = it.base + (l + it.inc - 1) / it.inc * it.inc;
+
+        int64_t h = l;
+        if (it.max > l)
+            h = it.base + ((int64_t)it.max - it.base) / it.inc * it.inc;
+
+        // conflicting hints: minimum wins over maximum
+        lo[i] = clamp32(l);
+        hi[i] = std::max(lo[i], clamp32(h));
+
+        sum_lo += lo[i];
+        sum_hi += hi[i];
+    }
+
+    if (span < sum_lo)
+    {
+        // too small: shrink all evenly below their minimum size
+        std::vector<int32_t> zero(n, 0);
+        water_fill(span, zero, lo, items);
+        return false;
+    }
+
+    if (span >= sum_hi)
+    {
+        for (size_t i = 0; i < n; ++i)
+            items[i].size = hi[i];
+        return true;
+    }
+
+    water_fill(span, lo, hi, items);
+
+    // snap sizes down to increments
+    int64_t rest = span;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        Item& it = items[i];
+        it.size = lo[i] + (it.size - lo[i]) / it.inc * it.inc;
+        rest -= it.size;
+    }
+
+    // hand out the pixels lost by snapping one step to each window, smallest
+    // increments first
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(),
+                     [&items](size_t a, size_t b) {
+                         return items[a].inc < items[b].inc;
+                     });
+
+    for (size_t i : order)
+    {
+        Item& it = items[i];
+        if (it.inc > rest) break;
+
+        if (it.size + it.inc <= hi[i]) {
+            it.size += it.inc;
+            rest -= it.inc;
+        }
+    }
+
+    // then let windows with small increments absorb what is left
+    for (size_t i : order)
+    {
+        Item& it = items[i];
+        if (it.inc > rest) break;
+
+        int64_t steps = std::min<int64_t>(rest, hi[i] - it.size) / it.inc;
+        it.size += steps * it.inc;
+        rest -= steps * it.inc;
+    }
+
+    return true;
+}
+
+/******************************************************************************/
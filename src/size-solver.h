@@ -0,0 +1,144 @@
+/******************************************************************************/
+/*! \file src/size-solver.h
+ *
+ * Integer batch solver distributing a span among windows with size hints.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TILEWM_SIZE_SOLVER_HEADER
+#define TILEWM_SIZE_SOLVER_HEADER
+
+#include <limits>
+#include <vector>
+#include <stdint.h>
+
+/*!
+ * SizeSolver distributes a span, e.g. the height of a column, among N windows
+ * such that each size satisfies the window's minimum, maximum, base size and
+ * increment hints. The space is shared fairly by water-filling: all windows
+ * grow evenly until they reach their maximum, and if the span is too small
+ * for all minimums, windows shrink evenly below their minimums.
+ *
+ * All computation is done on integers and takes O(N log N) time, instead of
+ * retrying to clamp one window after another.
+ */
+class SizeSolver
+{
+public:
+    //! Value used for unlimited maximum sizes.
+    static const int32_t unlimited = std::numeric_limits<int32_t>::max();
+
+    //! Size constraints of one window along the solved axis. Valid sizes are
+    //! base + k * inc for k >= 0 within [min,max].
+    struct Item
+    {
+        //! minimum size
+        int32_t min;
+        //! maximum size
+        int32_t max;
+        //! base size of increments
+        int32_t base;
+        //! size increment, at least 1
+        int32_t inc;
+        //! solution: size assigned to the window
+        int32_t size;
+
+        //! Construct unconstrained item.
+        Item()
+            : min(0), max(unlimited), base(0), inc(1), size(0)
+        { }
+
+        //! Construct item from plain integers.
+        Item(int32_t _min, int32_t _max, int32_t _base, int32_t _inc)
+            : min(_min), max(_max), base(_base), inc(_inc), size(0)
+        { }
+
+        //! Restrict the item by an aspect ratio to a fixed cross size: the
+        //! ratio (size - base) / cross must be in [lo_num/lo_den,
+        //! hi_num/hi_den]. Non-positive fractions disable the bound.
+        void limit_aspect(int32_t base, int32_t cross,
+                          int32_t lo_num, int32_t lo_den,
+                          int32_t hi_num, int32_t hi_den);
+    };
+
+    //! typedef of list of items
+    typedef std::vector<Item> itemlist_type;
+
+    /*!
+     * Size hints of a window for both axes, including its border, from which
+     * Items are constructed for a given cross size.
+     */
+    struct Hints
+    {
+        //! minimum width and height
+        int32_t min_w, min_h;
+        //! maximum width and height
+        int32_t max_w, max_h;
+        //! base width and height of increments
+        int32_t base_w, base_h;
+        //! width and height increments
+        int32_t inc_w, inc_h;
+        //! base size subtracted prior to aspect checks
+        int32_t aspect_base_w, aspect_base_h;
+        //! minimum aspect ratio width / height, zero if not set
+        int32_t min_aspect_num, min_aspect_den;
+        //! maximum aspect ratio width / height, zero if not set
+        int32_t max_aspect_num, max_aspect_den;
+        //! border width added on both sides
+        int32_t border;
+
+        //! Construct unconstrained hints.
+        Hints()
+            : min_w(0), min_h(0), max_w(unlimited), max_h(unlimited),
+              base_w(0), base_h(0), inc_w(1), inc_h(1),
+              aspect_base_w(0), aspect_base_h(0),
+              min_aspect_num(0), min_aspect_den(0),
+              max_aspect_num(0), max_aspect_den(0),
+              border(0)
+        { }
+
+        //! Compare all fields.
+        bool operator == (const Hints& h) const;
+
+        //! Compare all fields.
+        bool operator != (const Hints& h) const
+        {
+            return !operator == (h);
+        }
+
+        //! Construct Item for the outer width given the outer height, or for
+        //! the outer height given the outer width.
+        Item item(bool horizontal, int32_t cross) const;
+    };
+
+    //! Assign sizes to all items summing up to at most span. Returns false if
+    //! span is smaller than the sum of minimums, in which case windows are
+    //! shrunk evenly ignoring increments.
+    static bool solve(int32_t span, itemlist_type& items);
+
+protected:
+    //! Assign sizes in [lo[i],hi[i]] summing up to span with the sizes being
+    //! as equal as possible. Requires sum of lo <= span <= sum of hi.
+    static void water_fill(int64_t span, const std::vector<int32_t>& lo,
+                           const std::vector<int32_t>& hi,
+                           itemlist_type& items);
+};
+
+#endif // !TILEWM_SIZE_SOLVER_HEADER
+
+/******************************************************************************/
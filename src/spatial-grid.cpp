@@ -0,0 +1,231 @@
+/******************************************************************************/
+/*! \file src/spatial-grid.cpp
+ *
+ * Uniform grid index over window rectangles for point and area queries.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "spatial-grid.h"
+
+#include <algorithm>
+
+const unsigned int SpatialGrid::default_cell_shift;
+
+//! Return cell index of coordinate v relative to the grid, clamped to [0,n).
+static inline unsigned int clamp_cell(int v, unsigned int shift,
+                                      unsigned int n)
+{
+    if (v < 0) return 0;
+    unsigned int c = (unsigned int)v >> shift;
+    return (c < n ? c : n - 1);
+}
+
+//! Construct an empty grid covering extent.
+SpatialGrid::SpatialGrid(const Rectangle& extent, unsigned int shift)
+    : m_shift(shift)
+{
+    set_extent(extent);
+}
+
+//! Calculate the range of cells [c0,c1] x [r0,r1] covered by a rectangle.
+void SpatialGrid::cell_range(const Rectangle& r,
+                             unsigned int& c0, unsigned int& c1,
+                             unsigned int& r0, unsigned int& r1) const
+{
+    int x = r.x - m_extent.x, y = r.y - m_extent.y;
+
+    c0 = clamp_cell(x, m_shift, m_cols);
+    c1 = clamp_cell(x + std::max<int>(r.w, 1) - 1, m_shift, m_cols);
+    r0 = clamp_cell(y, m_shift, m_rows);
+    r1 = clamp_cell(y + std::max<int>(r.h, 1) - 1, m_shift, m_rows);
+}
+
+//! Add item to all cells overlapped by its rectangle.
+void SpatialGrid::link(const Item& it)
+{
+    unsigned int c0, c1, r0, r1;
+    cell_range(it.rect, c0, c1, r0, r1);
+
+    for (unsigned int row = r0; row <= r1; ++row)
+    {
+        for (unsigned int col = c0; col <= c1; ++col)
+            m_cells[row * m_cols + col].push_back(it);
+    }
+}
+
+//! Remove item from all cells overlapped by its rectangle.
+void SpatialGrid::unlink(const Item& it)
+{
+    unsigned int c0, c1, r0, r1;
+    cell_range(it.rect, c0, c1, r0, r1);
+
+    for (unsigned int row = r0; row <= r1; ++row)
+    {
+        for (unsigned int col = c0; col <= c1; ++col)
+        {
+            std::vector<Item>& cell = m_cells[row * m_cols + col];
+
+            for (Item& ci : cell)
+            {
+                if (ci.id != it.id) continue;
+
+                // order in cells is irrelevant: swap with last and pop
+                ci = cell.back();
+                cell.pop_back();
+                break;
+            }
+        }
+    }
+}
+
+//! Change the area covered by the grid, rebuilds all cells.
+void SpatialGrid::set_extent(const Rectangle& extent)
+{
+    unsigned int size = 1 << m_shift;
+
+    m_extent = extent;
+    m_cols = std::max(1u, (extent.w + size - 1) >> m_shift);
+    m_rows = std::max(1u, (extent.h + size - 1) >> m_shift);
+
+    m_cells.clear();
+    m_cells.resize(m_cols * m_rows);
+
+    for (itemmap_type::value_type& i : m_itemmap)
+        link(i.second);
+}
+
+//! Insert or update an entry's rectangle and stacking key.
+void SpatialGrid::insert(id_type id, const Rectangle& rect, uint64_t z)
+{
+    std::pair<itemmap_type::iterator, bool> ins =
+        m_itemmap.insert(std::make_pair(id, Item()));
+
+    Item& it = ins.first->second;
+
+    if (!ins.second) {
+        if (it.z == z && it.rect == rect) return;
+        unlink(it);
+    }
+
+    it.id = id;
+    it.z = z;
+    it.rect = rect;
+
+    link(it);
+}
+
+//! Change only the stacking key of an entry.
+void SpatialGrid::set_z(id_type id, uint64_t z)
+{
+    itemmap_type::iterator i = m_itemmap.find(id);
+    if (i == m_itemmap.end()) return;
+
+    Item& it = i->second;
+    it.z = z;
+
+    unsigned int c0, c1, r0, r1;
+    cell_range(it.rect, c0, c1, r0, r1);
+
+    for (unsigned int row = r0; row <= r1; ++row)
+    {
+        for (unsigned int col = c0; col <= c1; ++col)
+        {
+            for (Item& ci : m_cells[row * m_cols + col])
+            {
+                if (ci.id == id) ci.z = z;
+            }
+        }
+    }
+}
+
+//! Remove an entry, if it exists.
+void SpatialGrid::erase(id_type id)
+{
+    itemmap_type::iterator i = m_itemmap.find(id);
+    if (i == m_itemmap.end()) return;
+
+    unlink(i->second);
+    m_itemmap.erase(i);
+}
+
+//! Remove all entries.
+void SpatialGrid::clear()
+{
+    m_itemmap.clear();
+
+    for (std::vector<Item>& cell : m_cells)
+        cell.clear();
+}
+
+//! Return the top-most entry containing the point, or zero.
+SpatialGrid::id_type SpatialGrid::topmost(const Point& p) const
+{
+    unsigned int col = clamp_cell(p.x - m_extent.x, m_shift, m_cols);
+    unsigned int row = clamp_cell(p.y - m_extent.y, m_shift, m_rows);
+
+    const Item* best = NULL;
+
+    for (const Item& ci : m_cells[row * m_cols + col])
+    {
+        if (!ci.rect.contains(p)) continue;
+        if (!best || ci.z > best->z) best = &ci;
+    }
+
+    return (best ? best->id : 0);
+}
+
+//! Collect all entries intersecting the rectangle, bottom first.
+void SpatialGrid::intersecting(const Rectangle& r,
+                               std::vector<id_type>& out) const
+{
+    unsigned int c0, c1, r0, r1;
+    cell_range(r, c0, c1, r0, r1);
+
+    std::vector<std::pair<uint64_t, id_type> > found;
+
+    for (unsigned int row = r0; row <= r1; ++row)
+    {
+        for (unsigned int col = c0; col <= c1; ++col)
+        {
+            for (const Item& ci : m_cells[row * m_cols + col])
+            {
+                if (!ci.rect.intersects(r)) continue;
+
+                // report each entry only in the first cell shared by the
+                // entry and the query, instead of deduplicating afterwards.
+                unsigned int ic0, ic1, ir0, ir1;
+                cell_range(ci.rect, ic0, ic1, ir0, ir1);
+
+                if (col != std::max(c0, ic0) || row != std::max(r0, ir0))
+                    continue;
+
+                found.push_back(std::make_pair(ci.z, ci.id));
+            }
+        }
+    }
+
+    std::sort(found.begin(), found.end());
+
+    out.clear();
+    out.reserve(found.size());
+
+    for (const std::pair<uint64_t, id_type>& f : found)
+        out.push_back(f.second);
+}
+
+/******************************************************************************/
@@ -0,0 +1,127 @@
+/******************************************************************************/
+/*! \file src/spatial-grid.h
+ *
+ * Uniform grid index over window rectangles for point and area queries.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TILEWM_SPATIAL_GRID_HEADER
+#define TILEWM_SPATIAL_GRID_HEADER
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+#include "geometry.h"
+
+/*!
+ * SpatialGrid is a uniform grid of square cells over the screen area. Each
+ * cell lists all rectangles overlapping it, together with the rectangle and a
+ * stacking key, such that a point query scans only the few entries of one
+ * cell without further lookups. Rectangles reaching outside the grid's extent
+ * are clamped into the border cells, hence any coordinates can be stored.
+ *
+ * Entries are identified by a non-zero id, which usually is a window id. The
+ * stacking key orders entries bottom to top.
+ */
+class SpatialGrid
+{
+public:
+    //! typedef of entry identifiers, zero is reserved for "none".
+    typedef uint32_t id_type;
+
+    //! default cell size is 1 << 7 = 128 pixels
+    static const unsigned int default_cell_shift = 7;
+
+protected:
+    //! Entry stored in the cells it overlaps.
+    struct Item
+    {
+        //! identifier of entry
+        id_type id;
+        //! stacking key, higher is on top
+        uint64_t z;
+        //! area covered
+        Rectangle rect;
+    };
+
+    //! typedef of map id -> item for finding the cells of an entry
+    typedef std::map<id_type, Item> itemmap_type;
+
+    //! map id -> item of all entries
+    itemmap_type m_itemmap;
+
+    //! area covered by the grid
+    Rectangle m_extent;
+
+    //! log2 of the cell size
+    unsigned int m_shift;
+
+    //! number of columns and rows of cells
+    unsigned int m_cols, m_rows;
+
+    //! cells in row-major order, each listing overlapping entries
+    std::vector<std::vector<Item> > m_cells;
+
+    //! Calculate the range of cells [c0,c1] x [r0,r1] covered by a rectangle.
+    void cell_range(const Rectangle& r,
+                    unsigned int& c0, unsigned int& c1,
+                    unsigned int& r0, unsigned int& r1) const;
+
+    //! Add item to all cells overlapped by its rectangle.
+    void link(const Item& it);
+
+    //! Remove item from all cells overlapped by its rectangle.
+    void unlink(const Item& it);
+
+public:
+    //! Construct an empty grid covering extent.
+    explicit SpatialGrid(const Rectangle& extent = Rectangle(0, 0, 0, 0),
+                         unsigned int shift = default_cell_shift);
+
+    //! Change the area covered by the grid, rebuilds all cells.
+    void set_extent(const Rectangle& extent);
+
+    //! Insert or update an entry's rectangle and stacking key.
+    void insert(id_type id, const Rectangle& rect, uint64_t z);
+
+    //! Change only the stacking key of an entry.
+    void set_z(id_type id, uint64_t z);
+
+    //! Remove an entry, if it exists.
+    void erase(id_type id);
+
+    //! Remove all entries.
+    void clear();
+
+    //! Return number of entries.
+    size_t size() const
+    {
+        return m_itemmap.size();
+    }
+
+    //! Return the top-most entry containing the point, or zero.
+    id_type topmost(const Point& p) const;
+
+    //! Collect all entries intersecting the rectangle, bottom first.
+    void intersecting(const Rectangle& r, std::vector<id_type>& out) const;
+};
+
+#endif // !TILEWM_SPATIAL_GRID_HEADER
+
+/******************************************************************************/
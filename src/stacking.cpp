@@ -0,0 +1,303 @@
+/******************************************************************************/
+/*! \file src/stacking.cpp
+ *
+ * Intended stacking order of clients in layers and minimal restacking.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "stacking.h"
+#include "log.h"
+#include "client.h"
+#include "window-tree.h"
+#include "xcb-window.h"
+
+#include <algorithm>
+
+//! windows of each layer in intended order, bottom first.
+Stacking::winlist_type Stacking::s_layer[LAYER_MAX];
+
+//! map window -> layer of all stacked windows
+Stacking::layermap_type Stacking::s_layermap;
+
+//! whether the intended order changed since the last restack()
+bool Stacking::s_dirty = false;
+
+//! number of restack passes and ConfigureWindow requests issued
+unsigned int Stacking::s_restack_count = 0;
+unsigned int Stacking::s_move_count = 0;
+
+//! Determine the layer a client belongs to from its type and state.
+Stacking::layer_t Stacking::layer_of(Client& c)
+{
+    if (c.m_ewmh_window_type == EWMH_WINDOW_TYPE_DESKTOP)
+        return LAYER_DESKTOP;
+    if (c.m_state_fullscreen)
+        return LAYER_FULLSCREEN;
+    if (c.m_ewmh_window_type == EWMH_WINDOW_TYPE_DOCK)
+        return LAYER_DOCK;
+    if (c.m_state_above)
+        return LAYER_ABOVE;
+    if (c.m_state_below)
+        return LAYER_BELOW;
+
+    return LAYER_NORMAL;
+}
+
+//! Insert window into a layer, ordered by its current stacking position.
+void Stacking::insert_ordered(xcb_window_t win, layer_t layer)
+{
+    winlist_type& list = s_layer[layer];
+
+    const WindowTree::Node* node = WindowTree::find(win);
+    if (!node) {
+        list.push_back(win);
+        return;
+    }
+
+    // keep the existing relative order to avoid needless restacking
+    winlist_type::iterator it = list.begin();
+
+    for ( ; it != list.end(); ++it)
+    {
+        const WindowTree::Node* n = WindowTree::find(*it);
+        if (n && n->stack_key > node->stack_key) break;
+    }
+
+    list.insert(it, win);
+}
+
+//! Remove window from a layer's list.
+void Stacking::erase(xcb_window_t win, layer_t layer)
+{
+    winlist_type& list = s_layer[layer];
+    list.erase(std::find(list.begin(), list.end(), win));
+}
+
+//! Add a newly managed client at its current position within its layer.
+void Stacking::insert(Client& c)
+{
+    xcb_window_t win = c.window();
+    if (s_layermap.count(win)) return;
+
+    layer_t layer = layer_of(c);
+    s_layermap[win] = layer;
+
+    insert_ordered(win, layer);
+    s_dirty = true;
+}
+
+//! Remove an unmanaged window.
+void Stacking::remove(xcb_window_t win)
+{
+    layermap_type::iterator it = s_layermap.find(win);
+    if (it == s_layermap.end()) return;
+
+    // removal never requires restacking the others
+    erase(win, it->second);
+    s_layermap.erase(it);
+}
+
+//! Move client into the layer given by its current type and state.
+void Stacking::update(Client& c)
+{
+    layermap_type::iterator it = s_layermap.find(c.window());
+    if (it == s_layermap.end()) return;
+
+    layer_t layer = layer_of(c);
+    if (layer == it->second) return;
+
+    DEBUG << "stacking: window " << c.window() << " moves from layer "
+          << it->second << " to " << layer;
+
+    erase(c.window(), it->second);
+    it->second = layer;
+    s_layer[layer].push_back(c.window());
+    s_dirty = true;
+}
+
+//! Raise client to the top of its layer.
+void Stacking::raise(Client& c)
+{
+    layermap_type::iterator it = s_layermap.find(c.window());
+    if (it == s_layermap.end()) return;
+
+    winlist_type& list = s_layer[it->second];
+    if (list.back() == c.window()) return;
+
+    erase(c.window(), it->second);
+    list.push_back(c.window());
+    s_dirty = true;
+}
+
+//! Lower client to the bottom of its layer.
+void Stacking::lower(Client& c)
+{
+    layermap_type::iterator it = s_layermap.find(c.window());
+    if (it == s_layermap.end()) return;
+
+    winlist_type& list = s_layer[it->second];
+    if (list.front() == c.window()) return;
+
+    erase(c.window(), it->second);
+    list.insert(list.begin(), c.window());
+    s_dirty = true;
+}
+
+//! Return the intended stacking order of all layers, bottom first.
+void Stacking::intended(winlist_type& out)
+{
+    out.clear();
+    out.reserve(s_layermap.size());
+
+    for (unsigned int l = 0; l < LAYER_MAX; ++l)
+        out.insert(out.end(), s_layer[l].begin(), s_layer[l].end());
+}
+
+//! Calculate moves which transform the current order into the intended one,
+//! leaving a longest increasing subsequence in place.
+void Stacking::plan(const winlist_type& current, const winlist_type& want,
+                    std::vector<Move>& moves)
+{
+    static const size_t npos = size_t(-1);
+
+    moves.clear();
+
+    // *** map current order to sequence of intended positions
+
+    std::map<xcb_window_t, size_t> rank;
+    for (size_t i = 0; i < want.size(); ++i)
+        rank[want[i]] = i;
+
+    std::vector<size_t> seq;
+    seq.reserve(current.size());
+
+    for (xcb_window_t w : current)
+    {
+        std::map<xcb_window_t, size_t>::const_iterator it = rank.find(w);
+        if (it != rank.end()) seq.push_back(it->second);
+    }
+
+    // *** longest increasing subsequence by patience sorting: tails[k] is
+    // the index of the smallest tail of increasing subsequences of length k+1
+
+    std::vector<size_t> tails, prev(seq.size(), npos);
+
+    for (size_t i = 0; i < seq.size(); ++i)
+    {
+        size_t lo = 0, hi = tails.size();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (seq[tails[mid]] < seq[i]) lo = mid + 1;
+            else hi = mid;
+        }
+
+        if (lo > 0) prev[i] = tails[lo - 1];
+
+        if (lo == tails.size())
+            tails.push_back(i);
+        else
+            tails[lo] = i;
+    }
+
+    std::vector<bool> stable(want.size(), false);
+
+    for (size_t i = tails.empty() ? npos : tails.back(); i != npos;
+         i = prev[i])
+    {
+        stable[seq[i]] = true;
+    }
+
+    size_t anchor = std::find(stable.begin(), stable.end(), true)
+                    - stable.begin();
+
+    // *** place all other windows bottom-up directly above their intended
+    // predecessor, which is already in its final relative position.
+
+    for (size_t i = 0; i < want.size(); ++i)
+    {
+        if (stable[i]) continue;
+
+        Move m;
+        m.window = want[i];
+
+        if (i > 0) {
+            m.sibling = want[i - 1];
+            m.mode = XCB_STACK_MODE_ABOVE;
+        }
+        else if (anchor < want.size()) {
+            // the bottom window goes below the lowest unmoved one
+            m.sibling = want[anchor];
+            m.mode = XCB_STACK_MODE_BELOW;
+        }
+        else {
+            continue;
+        }
+
+        moves.push_back(m);
+    }
+}
+
+//! Issue minimal restack requests if the intended order changed.
+void Stacking::restack()
+{
+    if (!s_dirty) return;
+    s_dirty = false;
+
+    XcbAccountScope scope(XcbConnection::SUB_STACKING);
+
+    // only windows known as children of root can be restacked as siblings
+    winlist_type want, current;
+    intended(want);
+
+    want.erase(std::remove_if(want.begin(), want.end(),
+                              [](xcb_window_t w) {
+                                  return !WindowTree::find(w);
+                              }),
+               want.end());
+
+    for (xcb_window_t w : WindowTree::stacking())
+    {
+        if (s_layermap.count(w)) current.push_back(w);
+    }
+
+    std::vector<Move> moves;
+    plan(current, want, moves);
+
+    ++s_restack_count;
+    s_move_count += moves.size();
+
+    for (const Move& m : moves)
+    {
+        TRACE << "stacking: window " << m.window
+              << (m.mode == XCB_STACK_MODE_ABOVE ? " above " : " below ")
+              << m.sibling;
+
+        XcbWindow(m.window).stack(m.sibling, m.mode);
+        WindowTree::expect_stack(m.window, m.sibling, m.mode);
+    }
+}
+
+//! Output restacking statistics.
+void Stacking::dump_stats()
+{
+    INFO << "stacking: " << s_layermap.size() << " windows, "
+         << s_restack_count << " restacks issued "
+         << s_move_count << " ConfigureWindow requests";
+}
+
+/******************************************************************************/
@@ -0,0 +1,125 @@
+/******************************************************************************/
+/*! \file src/stacking.h
+ *
+ * Intended stacking order of clients in layers and minimal restacking.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TILEWM_STACKING_HEADER
+#define TILEWM_STACKING_HEADER
+
+#include <map>
+#include <vector>
+#include <xcb/xcb.h>
+
+class Client;
+
+/*!
+ * Stacking keeps the intended stacking order of all managed clients locally,
+ * separated into layers which are stacked on top of each other. Changes only
+ * modify the local lists and mark them dirty. Before the event loop flushes
+ * the connection, restack() compares the intended order with the actual
+ * order in the WindowTree mirror and issues the minimal number of
+ * sibling-relative ConfigureWindow requests: all windows on a longest common
+ * subsequence of both orders stay in place, only the others are moved. Thus
+ * raising one window costs one request and several changes in one event
+ * batch are combined, which keeps Expose traffic down for overlapping
+ * windows.
+ */
+class Stacking
+{
+public:
+    //! Stacking layers, bottom to top.
+    enum layer_t {
+        LAYER_DESKTOP, LAYER_BELOW, LAYER_NORMAL, LAYER_ABOVE, LAYER_DOCK,
+        LAYER_FULLSCREEN, LAYER_MAX
+    };
+
+    //! One sibling-relative restack operation.
+    struct Move
+    {
+        //! window to restack
+        xcb_window_t window;
+        //! sibling window it is placed next to
+        xcb_window_t sibling;
+        //! XCB_STACK_MODE_ABOVE or XCB_STACK_MODE_BELOW the sibling
+        xcb_stack_mode_t mode;
+    };
+
+    //! typedef of list of windows, bottom first.
+    typedef std::vector<xcb_window_t> winlist_type;
+
+protected:
+    //! windows of each layer in intended order, bottom first.
+    static winlist_type s_layer[LAYER_MAX];
+
+    //! typedef of map window -> layer
+    typedef std::map<xcb_window_t, layer_t> layermap_type;
+
+    //! map window -> layer of all stacked windows
+    static layermap_type s_layermap;
+
+    //! whether the intended order changed since the last restack()
+    static bool s_dirty;
+
+    //! number of restack passes and ConfigureWindow requests issued
+    static unsigned int s_restack_count, s_move_count;
+
+    //! Determine the layer a client belongs to from its type and state.
+    static layer_t layer_of(Client& c);
+
+    //! Insert window into a layer, ordered by its current stacking position.
+    static void insert_ordered(xcb_window_t win, layer_t layer);
+
+    //! Remove window from a layer's list.
+    static void erase(xcb_window_t win, layer_t layer);
+
+public:
+    //! Add a newly managed client at its current position within its layer.
+    static void insert(Client& c);
+
+    //! Remove an unmanaged window.
+    static void remove(xcb_window_t win);
+
+    //! Move client into the layer given by its current type and state.
+    static void update(Client& c);
+
+    //! Raise client to the top of its layer.
+    static void raise(Client& c);
+
+    //! Lower client to the bottom of its layer.
+    static void lower(Client& c);
+
+    //! Return the intended stacking order of all layers, bottom first.
+    static void intended(winlist_type& out);
+
+    //! Calculate moves which transform the current order into the intended
+    //! one, leaving a longest increasing subsequence in place.
+    static void plan(const winlist_type& current, const winlist_type& want,
+                     std::vector<Move>& moves);
+
+    //! Issue minimal restack requests if the intended order changed.
+    static void restack();
+
+    //! Output restacking statistics.
+    static void dump_stats();
+};
+
+#endif // !TILEWM_STACKING_HEADER
+
+/******************************************************************************/
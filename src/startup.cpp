@@ -0,0 +1,186 @@
+/******************************************************************************/
+/*! \file src/startup.cpp
+ *
+ * Pipelined window manager startup sequence with per-phase timing.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "startup.h"
+#include "log.h"
+#include "xcb.h"
+#include "tools.h"
+#include "screen.h"
+#include "binding.h"
+#include "client.h"
+#include "ewmh.h"
+#include "desktop.h"
+#include "event.h"
+#include "window-tree.h"
+
+#include <xcb/xinerama.h>
+#include <xcb/randr.h>
+
+//! list of finished phases in order
+Startup::phaselist_type Startup::s_phaselist;
+
+//! start time of the current phase
+uint64_t Startup::s_phase_start = 0;
+
+//! XCB counters at the start of the current phase
+uint64_t Startup::s_phase_requests = 0;
+uint64_t Startup::s_phase_replies = 0;
+uint64_t Startup::s_phase_wait_ns = 0;
+
+//! Start timing the first phase.
+void Startup::begin()
+{
+    s_phaselist.clear();
+
+    s_phase_start = monotonic_ns();
+    s_phase_requests = g_xcb.accounting_total.requests;
+    s_phase_replies = g_xcb.accounting_total.replies;
+    s_phase_wait_ns = g_xcb.accounting_total.wait_ns;
+}
+
+//! Finish the current phase and start the next one.
+void Startup::phase(const char* name)
+{
+    uint64_t now = monotonic_ns();
+    const XcbConnection::Accounting& at = g_xcb.accounting_total;
+
+    Phase p;
+    p.name = name;
+    p.ns = now - s_phase_start;
+    p.requests = at.requests - s_phase_requests;
+    p.replies = at.replies - s_phase_replies;
+    p.wait_ns = at.wait_ns - s_phase_wait_ns;
+
+    DEBUG << "startup: finished phase " << name
+          << " after " << p.ns / 1000 << " us";
+
+    s_phaselist.push_back(p);
+
+    s_phase_start = now;
+    s_phase_requests = at.requests;
+    s_phase_replies = at.replies;
+    s_phase_wait_ns = at.wait_ns;
+}
+
+//! Run the startup sequence on an open connection.
+bool Startup::initialize(bool use_cursors)
+{
+    begin();
+
+    // cursors are loaded from the theme on first use
+    g_xcb.cursor_enabled = use_cursors;
+
+    // *** issue all independent queries without waiting for any reply
+
+    g_xcb.query_setup_wm();
+
+    std::vector<xcb_intern_atom_cookie_t> atomreq = g_xcb.query_atomlist();
+
+    // allocating the key symbol table sends the keyboard mapping request
+    BindingList::initialize();
+
+    xcb_get_modifier_mapping_cookie_t gmmc = BindingList::query_numlock_mask();
+
+    // let XCB prefetch all the extensions we might need
+    xcb_prefetch_extension_data(g_xcb.connection, &xcb_randr_id);
+    xcb_prefetch_extension_data(g_xcb.connection, &xcb_xinerama_id);
+
+    xcb_alloc_color_cookie_t acc_focused =
+        g_xcb.query_allocate_color(65535, 0, 0);
+    xcb_alloc_color_cookie_t acc_blurred =
+        g_xcb.query_allocate_color(0, 0, 65535);
+
+    xcb_query_tree_cookie_t qtc = WindowTree::query_tree();
+
+    phase("query");
+
+    // *** collect replies, the first one waits for the whole batch
+
+    g_xcb.process_atomlist(atomreq);
+
+    BindingList::process_numlock_mask(gmmc);
+
+    ClientList::s_pixel_focused = g_xcb.process_allocate_color(acc_focused);
+    ClientList::s_pixel_blurred = g_xcb.process_allocate_color(acc_blurred);
+
+    WindowTree::process_tree(qtc);
+
+    // an error of the unchecked WM setup request arrived before the replies
+    EventLoop::process_queued_errors();
+
+    if (!g_xcb.process_setup_wm()) {
+        BindingList::deinitialize();
+        return false;
+    }
+
+    phase("replies");
+
+    // *** detect monitors and setup up desktops
+
+    BindingList::add_test_bindings();
+
+    ScreenList::detect();
+    DeskList::setup();
+
+    phase("screens");
+
+    // *** grab root key bindings and set up EWMH properties
+
+    BindingList::regrab_root();
+    Ewmh::setup();
+
+    phase("setup");
+
+    // *** manage already existing windows
+
+    ClientList::remanage_all_windows();
+
+    phase("remanage");
+
+    EventLoop::setup_global_eventtable();
+
+    return true;
+}
+
+//! Output per-phase timing breakdown of the startup sequence.
+void Startup::dump()
+{
+    uint64_t total_ns = 0, total_replies = 0;
+
+    for (const Phase& p : s_phaselist)
+    {
+        INFO << "startup: phase " << p.name
+             << " took " << p.ns / 1000 << " us,"
+             << " requests " << p.requests
+             << " replies " << p.replies
+             << " waiting " << p.wait_ns / 1000 << " us";
+
+        total_ns += p.ns;
+        total_replies += p.replies;
+    }
+
+    INFO << "startup: total " << total_ns / 1000 << " us with "
+         << total_replies << " replies";
+}
+
+/******************************************************************************/
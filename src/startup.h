@@ -0,0 +1,96 @@
+/******************************************************************************/
+/*! \file src/startup.h
+ *
+ * Pipelined window manager startup sequence with per-phase timing.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#ifndef TILEWM_STARTUP_HEADER
+#define TILEWM_STARTUP_HEADER
+
+#include <vector>
+#include <stdint.h>
+
+/*!
+ * The Startup sequence brings the window manager up on a freshly opened
+ * connection. Independent queries (substructure redirect, named atoms,
+ * keyboard mapping, modifier mapping, extension data and colors) are all
+ * issued first and their replies collected afterwards, such that they share a
+ * single round trip to the X server instead of one each.
+ *
+ * Each phase of the sequence is timed, and the number of requests and replies
+ * are taken from the XCB accounting. The breakdown is logged by dump().
+ */
+class Startup
+{
+public:
+    //! Timing and request counters of a startup phase.
+    struct Phase
+    {
+        //! name of the phase
+        const char* name;
+        //! wall time spent in the phase in nanoseconds
+        uint64_t ns;
+        //! number of requests issued
+        uint64_t requests;
+        //! number of replies waited for
+        uint64_t replies;
+        //! time spent waiting for replies in nanoseconds
+        uint64_t wait_ns;
+    };
+
+protected:
+    //! typedef of list of finished phases
+    typedef std::vector<Phase> phaselist_type;
+
+    //! list of finished phases in order
+    static phaselist_type s_phaselist;
+
+    //! start time of the current phase
+    static uint64_t s_phase_start;
+
+    //! XCB counters at the start of the current phase
+    static uint64_t s_phase_requests, s_phase_replies, s_phase_wait_ns;
+
+    //! Start timing the first phase.
+    static void begin();
+
+    //! Finish the current phase and start the next one.
+    static void phase(const char* name);
+
+public:
+    //! Run the startup sequence on an open connection: register as window
+    //! manager, detect screens, set up EWMH and manage existing windows.
+    //! Loading cursors on first use via xcb-cursor can be disabled for offline
+    //! replay and simulation.
+    static bool initialize(bool use_cursors);
+
+    //! Output per-phase timing breakdown of the startup sequence.
+    static void dump();
+
+    //! Return the list of finished phases.
+    static const phaselist_type& phases()
+    {
+        return s_phaselist;
+    }
+};
+
+#endif // !TILEWM_STARTUP_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,187 @@
+/******************************************************************************/
+/*! \file src/stats.cpp
+ *
+ * Latency histograms and throughput statistics of event handling.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "stats.h"
+#include "log.h"
+#include "tools.h"
+
+#include <algorithm>
+#include <sstream>
+#include <xcb/xcb_event.h>
+
+//! Return upper bound of bucket containing the p-th percentile.
+uint64_t LatencyHistogram::percentile(double p) const
+{
+    uint64_t rank = (uint64_t)(p * count);
+    uint64_t sum = 0;
+
+    for (size_t b = 0; b < num_buckets; ++b)
+    {
+        sum += bucket[b];
+        if (sum > rank)
+            return std::min<uint64_t>(2llu << b, max_ns);
+    }
+
+    return max_ns;
+}
+
+//! Return a one-line summary: count, avg, percentiles and max.
+std::string LatencyHistogram::str() const
+{
+    std::ostringstream os;
+
+    os << count << " calls, avg " << (count ? total_ns / count / 1000 : 0)
+       << " us, p50 < " << percentile(0.50) / 1000
+       << " us, p99 < " << percentile(0.99) / 1000
+       << " us, max " << max_ns / 1000 << " us";
+
+    return os.str();
+}
+
+// -----------------------------------------------------------------------------
+
+//! latency histograms per event response type
+EventStats::histlist_type EventStats::s_event_hist;
+
+//! handlers taking longer than this are logged, zero to disable.
+uint64_t EventStats::s_slow_threshold_ns = 20 * 1000000;
+
+//! start of current rate measurement second
+uint64_t EventStats::s_rate_start = 0;
+
+//! number of events in the current rate measurement second
+uint64_t EventStats::s_rate_count = 0;
+
+//! events per second in the last complete second
+uint64_t EventStats::s_rate_last = 0;
+
+//! maximum events per second observed
+uint64_t EventStats::s_rate_max = 0;
+
+//! X protocol usage per event response type
+EventStats::usagelist_type EventStats::s_event_usage;
+
+//! X usage of the events handled since the last flush
+EventStats::XcbUsage EventStats::s_unflushed;
+
+//! response type of the last event handled since the last flush, or -1.
+int EventStats::s_unflushed_type = -1;
+
+//! total bytes written to the X connection at the last flush
+uint64_t EventStats::s_written = 0;
+
+//! Record the latency and X requests of a processed event.
+void EventStats::record_event(const xcb_generic_event_t* event,
+                              uint64_t start,
+                              const XcbConnection::Accounting& xstart,
+                              uint64_t end)
+{
+    uint8_t evtype = XCB_EVENT_RESPONSE_TYPE(event);
+    uint64_t ns = end - start;
+
+    s_event_hist[evtype].add(ns);
+
+    // account X requests and round trips of the handler
+    const XcbConnection::Accounting& xend = g_xcb.accounting_total;
+
+    XcbUsage& u = s_event_usage[evtype];
+    u.requests += xend.requests - xstart.requests;
+    u.replies += xend.replies - xstart.replies;
+    u.wait_ns += xend.wait_ns - xstart.wait_ns;
+
+    s_unflushed.requests += xend.requests - xstart.requests;
+    s_unflushed.replies += xend.replies - xstart.replies;
+    s_unflushed.wait_ns += xend.wait_ns - xstart.wait_ns;
+    s_unflushed_type = evtype;
+
+    // count events per second
+    if (end - s_rate_start >= 1000000000llu)
+    {
+        s_rate_last = s_rate_count;
+        if (s_rate_last > s_rate_max) s_rate_max = s_rate_last;
+
+        s_rate_start = end;
+        s_rate_count = 0;
+    }
+    s_rate_count++;
+
+    if (s_slow_threshold_ns && ns >= s_slow_threshold_ns)
+    {
+        const char* label = xcb_event_get_label(evtype);
+
+        WARN << "slow handler for event " << uint32_t(evtype)
+             << " (" << (label ? label : "unknown") << "): "
+             << ns / 1000 << " us, event "
+             << string_hexdump(event, sizeof(xcb_generic_event_t));
+    }
+}
+
+//! Record the bytes written by a flush of the X connection.
+void EventStats::record_flush()
+{
+    uint64_t written = g_xcb.total_written();
+    uint64_t bytes = written - s_written;
+    s_written = written;
+
+    if (s_unflushed_type < 0) return;
+
+    s_unflushed.bytes = bytes;
+    s_event_usage[s_unflushed_type].bytes += bytes;
+
+    const char* label = xcb_event_get_label(s_unflushed_type);
+
+    DEBUG << "X usage of event " << s_unflushed_type
+          << " (" << (label ? label : "unknown") << "): "
+          << s_unflushed.requests << " requests, "
+          << s_unflushed.replies << " round trips, "
+          << s_unflushed.wait_ns / 1000 << " us waiting, "
+          << s_unflushed.bytes << " bytes";
+
+    s_unflushed = XcbUsage();
+    s_unflushed_type = -1;
+}
+
+//! Output all event statistics to the log.
+void EventStats::dump()
+{
+    INFO << "event statistics: " << s_rate_last << " events/s in last second,"
+         << " max " << s_rate_max << " events/s";
+
+    for (size_t i = 0; i < s_event_hist.size(); ++i)
+    {
+        const LatencyHistogram& h = s_event_hist[i];
+        if (!h.count) continue;
+
+        const char* label = xcb_event_get_label(i);
+
+        INFO << "event " << i << " (" << (label ? label : "unknown") << "): "
+             << h.str();
+
+        const XcbUsage& u = s_event_usage[i];
+
+        INFO << "event " << i << " (" << (label ? label : "unknown") << "): "
+             << u.requests << " requests, " << u.replies << " round trips, "
+             << u.wait_ns / 1000 << " us waiting, " << u.bytes << " bytes";
+    }
+}
+
+/******************************************************************************/
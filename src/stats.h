@@ -0,0 +1,166 @@
+/******************************************************************************/
+/*! \file src/stats.h
+ *
+ * Latency histograms and throughput statistics of event handling.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TILEWM_STATS_HEADER
+#define TILEWM_STATS_HEADER
+
+#include <array>
+#include <string>
+#include <stdint.h>
+#include <xcb/xcb.h>
+
+#include "xcb.h"
+
+/*!
+ * A latency histogram with logarithmic buckets: bucket i counts latencies in
+ * the range [2^i, 2^(i+1)) nanoseconds.
+ */
+struct LatencyHistogram
+{
+    //! number of log2 buckets, enough for 2^40 ns = 18 minutes.
+    static const size_t num_buckets = 40;
+
+    //! number of latencies recorded
+    uint64_t count;
+
+    //! sum of all latencies in nanoseconds
+    uint64_t total_ns;
+
+    //! maximum latency in nanoseconds
+    uint64_t max_ns;
+
+    //! log2 bucket counters
+    std::array<uint32_t, num_buckets> bucket;
+
+    //! Construct empty histogram
+    LatencyHistogram()
+        : count(0), total_ns(0), max_ns(0)
+    {
+        bucket.fill(0);
+    }
+
+    //! Add a latency to the histogram.
+    void add(uint64_t ns)
+    {
+        count++;
+        total_ns += ns;
+        if (ns > max_ns) max_ns = ns;
+
+        size_t b = (ns == 0) ? 0 : 63 - __builtin_clzll(ns);
+        if (b >= num_buckets) b = num_buckets - 1;
+        bucket[b]++;
+    }
+
+    //! Return upper bound of bucket containing the p-th percentile.
+    uint64_t percentile(double p) const;
+
+    //! Return a one-line summary: count, avg, percentiles and max.
+    std::string str() const;
+};
+
+/*!
+ * EventStats collects always-on statistics about the event loop: a latency
+ * histogram of the handlers of each X event type and the event rate. Handlers
+ * exceeding a configurable threshold are logged with the event contents.
+ *
+ * Additionally, the X requests, blocking round trips and bytes written while
+ * handling each event are accounted per event type.
+ */
+class EventStats
+{
+protected:
+    //! typedef of array of histograms per event type
+    typedef std::array<LatencyHistogram, XCB_NO_OPERATION + 1> histlist_type;
+
+    //! latency histograms per event response type
+    static histlist_type s_event_hist;
+
+    //! handlers taking longer than this are logged, zero to disable.
+    static uint64_t s_slow_threshold_ns;
+
+    //! start of current rate measurement second
+    static uint64_t s_rate_start;
+
+    //! number of events in the current rate measurement second
+    static uint64_t s_rate_count;
+
+    //! events per second in the last complete second
+    static uint64_t s_rate_last;
+
+    //! maximum events per second observed
+    static uint64_t s_rate_max;
+
+public:
+    //! X protocol usage caused by handling events.
+    struct XcbUsage
+    {
+        //! number of requests issued
+        uint64_t requests;
+        //! number of blocking waits for replies
+        uint64_t replies;
+        //! total time spent waiting for replies in nanoseconds
+        uint64_t wait_ns;
+        //! bytes written to the X connection
+        uint64_t bytes;
+    };
+
+protected:
+    //! typedef of array of X usage per event type
+    typedef std::array<XcbUsage, XCB_NO_OPERATION + 1> usagelist_type;
+
+    //! X protocol usage per event response type
+    static usagelist_type s_event_usage;
+
+    //! X usage of the events handled since the last flush
+    static XcbUsage s_unflushed;
+
+    //! response type of the last event handled since the last flush, or -1.
+    static int s_unflushed_type;
+
+    //! total bytes written to the X connection at the last flush
+    static uint64_t s_written;
+
+public:
+    //! Set threshold above which handlers are logged as slow.
+    static void set_slow_threshold(uint64_t us)
+    {
+        s_slow_threshold_ns = us * 1000;
+    }
+
+    //! Record the latency and X requests of a processed event. The X
+    //! accounting counters at the start of the handler are passed in xstart.
+    static void record_event(const xcb_generic_event_t* event,
+                             uint64_t start,
+                             const XcbConnection::Accounting& xstart,
+                             uint64_t end);
+
+    //! Record the bytes written by a flush of the X connection and attribute
+    //! them to the events handled since the previous flush.
+    static void record_flush();
+
+    //! Output all event statistics to the log.
+    static void dump();
+};
+
+#endif // !TILEWM_STATS_HEADER
+
+/******************************************************************************/
@@ -26,6 +26,8 @@
 #include <sstream>
 #include <string>
 #include <limits>
+#include <stdint.h>
+#include <time.h>
 
 /*!
  * Template transformation function which uses std::ostringstream to serialize
@@ -106,6 +108,28 @@ add_limit_overflow(const UnsignedType& a, const SignedType& b)
     return a + b;
 }
 
+/*!
+ * Return a timestamp in nanoseconds from the monotonic system clock, which is
+ * used to measure latencies.
+ */
+static inline uint64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000llu + ts.tv_nsec;
+}
+
+/*!
+ * Return the CPU time consumed by the calling thread in nanoseconds, which is
+ * used to measure pure processing cost without waiting times.
+ */
+static inline uint64_t thread_cpu_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000llu + ts.tv_nsec;
+}
+
 #endif // !TILEWM_TOOLS_HEADER
 
 /******************************************************************************/
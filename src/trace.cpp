@@ -0,0 +1,198 @@
+/******************************************************************************/
+/*! \file src/trace.cpp
+ *
+ * Optional recording of event handling spans for trace viewers.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "trace.h"
+#include "log.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <xcb/xcb_event.h>
+
+//! whether spans are currently recorded
+bool Tracer::s_enabled = false;
+
+//! preallocated record buffer
+Tracer::Record* Tracer::s_buffer = NULL;
+
+//! capacity of record buffer
+size_t Tracer::s_capacity = 0;
+
+//! number of records in buffer
+size_t Tracer::s_size = 0;
+
+//! number of begun spans not yet ended, for which space is reserved.
+size_t Tracer::s_open = 0;
+
+//! number of spans dropped because the buffer was full
+uint64_t Tracer::s_dropped = 0;
+
+//! output path of trace file
+std::string Tracer::s_path;
+
+//! Allocate buffer of capacity records and enable tracing into path.
+bool Tracer::start(const std::string& path, size_t capacity)
+{
+    ASSERT(!s_buffer);
+
+    s_buffer = new Record[capacity];
+    s_capacity = capacity;
+    s_size = s_open = 0;
+    s_dropped = 0;
+    s_path = path;
+
+    // touch buffer now instead of faulting pages in while tracing
+    memset(s_buffer, 0, capacity * sizeof(Record));
+
+    // check that the output file can be created
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) {
+        ERROR << "Could not open trace file " << path << ": "
+              << strerror(errno);
+        delete[] s_buffer;
+        s_buffer = NULL;
+        return false;
+    }
+    fclose(f);
+
+    INFO << "Tracing up to " << capacity << " records into " << path;
+
+    s_enabled = true;
+    return true;
+}
+
+//! Disable tracing, write trace file and free buffer.
+void Tracer::stop()
+{
+    if (!s_buffer) return;
+
+    s_enabled = false;
+
+    write();
+
+    delete[] s_buffer;
+    s_buffer = NULL;
+    s_capacity = s_size = 0;
+}
+
+//! Write all records as Chrome trace JSON to the output path.
+bool Tracer::write()
+{
+    FILE* f = fopen(s_path.c_str(), "w");
+    if (!f) {
+        ERROR << "Could not write trace file " << s_path << ": "
+              << strerror(errno);
+        return false;
+    }
+
+    int pid = getpid();
+    uint64_t t0 = s_size ? s_buffer[0].time : 0;
+
+    fprintf(f, "{\"traceEvents\":[\n");
+
+    for (size_t i = 0; i < s_size; ++i)
+    {
+        const Record& r = s_buffer[i];
+        uint64_t ts = r.time - t0;
+
+        fprintf(f, "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,"
+                "\"pid\":%d,\"tid\":1",
+                r.name, r.phase, (unsigned long long)(ts / 1000),
+                unsigned(ts % 1000), pid);
+
+        if (r.phase == 'B' && (r.window || r.evtype >= 0))
+        {
+            fprintf(f, ",\"args\":{");
+            if (r.window)
+                fprintf(f, "\"window\":\"0x%x\"", r.window);
+            if (r.window && r.evtype >= 0)
+                fprintf(f, ",");
+            if (r.evtype >= 0) {
+                const char* label = xcb_event_get_label(r.evtype);
+                fprintf(f, "\"event\":\"%s (%d)\"",
+                        label ? label : "unknown", r.evtype);
+            }
+            fprintf(f, "}");
+        }
+
+        fprintf(f, "}%s\n", i + 1 < s_size ? "," : "");
+    }
+
+    fprintf(f, "],\n\"displayTimeUnit\":\"ns\",\n"
+            "\"otherData\":{\"dropped_spans\":\"%llu\"}}\n",
+            (unsigned long long)s_dropped);
+
+    fclose(f);
+
+    INFO << "Wrote " << s_size << " trace records to " << s_path
+         << ", dropped " << s_dropped << " spans";
+
+    return true;
+}
+
+//! Return the window an X event refers to, or zero if unknown.
+uint32_t Tracer::event_window(const xcb_generic_event_t* event)
+{
+    switch (XCB_EVENT_RESPONSE_TYPE(event))
+    {
+    case XCB_KEY_PRESS:
+    case XCB_KEY_RELEASE:
+    case XCB_BUTTON_PRESS:
+    case XCB_BUTTON_RELEASE:
+    case XCB_MOTION_NOTIFY:
+        return ((const xcb_key_press_event_t*)event)->event;
+    case XCB_ENTER_NOTIFY:
+    case XCB_LEAVE_NOTIFY:
+        return ((const xcb_enter_notify_event_t*)event)->event;
+    case XCB_FOCUS_IN:
+    case XCB_FOCUS_OUT:
+        return ((const xcb_focus_in_event_t*)event)->event;
+    case XCB_EXPOSE:
+        return ((const xcb_expose_event_t*)event)->window;
+    case XCB_CREATE_NOTIFY:
+        return ((const xcb_create_notify_event_t*)event)->window;
+    case XCB_DESTROY_NOTIFY:
+        return ((const xcb_destroy_notify_event_t*)event)->window;
+    case XCB_UNMAP_NOTIFY:
+        return ((const xcb_unmap_notify_event_t*)event)->window;
+    case XCB_MAP_NOTIFY:
+        return ((const xcb_map_notify_event_t*)event)->window;
+    case XCB_MAP_REQUEST:
+        return ((const xcb_map_request_event_t*)event)->window;
+    case XCB_REPARENT_NOTIFY:
+        return ((const xcb_reparent_notify_event_t*)event)->window;
+    case XCB_CONFIGURE_NOTIFY:
+        return ((const xcb_configure_notify_event_t*)event)->window;
+    case XCB_CONFIGURE_REQUEST:
+        return ((const xcb_configure_request_event_t*)event)->window;
+    case XCB_PROPERTY_NOTIFY:
+        return ((const xcb_property_notify_event_t*)event)->window;
+    case XCB_CLIENT_MESSAGE:
+        return ((const xcb_client_message_event_t*)event)->window;
+    default:
+        return 0;
+    }
+}
+
+/******************************************************************************/
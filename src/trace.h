@@ -0,0 +1,178 @@
+/******************************************************************************/
+/*! \file src/trace.h
+ *
+ * Optional recording of event handling spans for trace viewers.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#ifndef TILEWM_TRACE_HEADER
+#define TILEWM_TRACE_HEADER
+
+#include <string>
+#include <stdint.h>
+#include <xcb/xcb.h>
+
+#include "tools.h"
+
+/*!
+ * The Tracer records begin/end spans of event handling into a preallocated
+ * buffer and writes them as Chrome trace JSON when stopped, which can be
+ * loaded into chrome://tracing or the Perfetto UI. When tracing is disabled,
+ * each span costs only a test of a static flag. When the buffer is full, new
+ * spans are dropped, while spans already begun are always closed.
+ */
+class Tracer
+{
+public:
+    //! default number of span records in buffer
+    static const size_t default_capacity = 256 * 1024;
+
+    //! A begin or end record of a span.
+    struct Record
+    {
+        //! monotonic timestamp in nanoseconds
+        uint64_t time;
+        //! name of the span, must be a string literal.
+        const char* name;
+        //! window id argument, or zero.
+        uint32_t window;
+        //! X event type argument, or -1.
+        int16_t evtype;
+        //! 'B' for begin or 'E' for end record
+        char phase;
+    };
+
+protected:
+    //! whether spans are currently recorded
+    static bool s_enabled;
+
+    //! preallocated record buffer
+    static Record* s_buffer;
+
+    //! capacity of record buffer
+    static size_t s_capacity;
+
+    //! number of records in buffer
+    static size_t s_size;
+
+    //! number of begun spans not yet ended, for which space is reserved.
+    static size_t s_open;
+
+    //! number of spans dropped because the buffer was full
+    static uint64_t s_dropped;
+
+    //! output path of trace file
+    static std::string s_path;
+
+    //! Write all records as Chrome trace JSON to the output path.
+    static bool write();
+
+public:
+    //! Allocate buffer of capacity records and enable tracing into path.
+    static bool start(const std::string& path,
+                      size_t capacity = default_capacity);
+
+    //! Disable tracing, write trace file and free buffer.
+    static void stop();
+
+    //! Check whether tracing is enabled.
+    static bool enabled()
+    {
+        return s_enabled;
+    }
+
+    //! Record the begin of a span, returns false if dropped.
+    static bool begin(const char* name, uint32_t window, int evtype)
+    {
+        // keep space for the end records of all open spans
+        if (s_size + s_open + 2 > s_capacity) {
+            s_dropped++;
+            return false;
+        }
+
+        Record& r = s_buffer[s_size++];
+        r.time = monotonic_ns();
+        r.name = name;
+        r.window = window;
+        r.evtype = evtype;
+        r.phase = 'B';
+
+        s_open++;
+        return true;
+    }
+
+    //! Record the end of a span whose begin was recorded.
+    static void end(const char* name)
+    {
+        Record& r = s_buffer[s_size++];
+        r.time = monotonic_ns();
+        r.name = name;
+        r.window = 0;
+        r.evtype = -1;
+        r.phase = 'E';
+
+        s_open--;
+    }
+
+    //! Return the window an X event refers to, or zero if unknown.
+    static uint32_t event_window(const xcb_generic_event_t* event);
+};
+
+/*!
+ * A scoped span recorded by the Tracer from construction to destruction, if
+ * tracing is enabled.
+ */
+class TraceSpan
+{
+protected:
+    //! name of the span, must be a string literal.
+    const char* m_name;
+
+    //! whether the begin record was written
+    bool m_active;
+
+public:
+    //! Begin span with optional window id and event type arguments.
+    explicit TraceSpan(const char* name, uint32_t window = 0, int evtype = -1)
+        : m_name(name),
+          m_active(Tracer::enabled() && Tracer::begin(name, window, evtype))
+    { }
+
+    //! Begin span for handling an X event.
+    TraceSpan(const char* name, const xcb_generic_event_t* event)
+        : m_name(name),
+          m_active(Tracer::enabled() &&
+                   Tracer::begin(name, Tracer::event_window(event),
+                                 event->response_type & ~0x80))
+    { }
+
+    //! End span.
+    ~TraceSpan()
+    {
+        if (m_active) Tracer::end(m_name);
+    }
+
+private:
+    TraceSpan(const TraceSpan&);              //!< non-copyable
+    TraceSpan& operator = (const TraceSpan&); //!< non-copyable
+};
+
+#endif // !TILEWM_TRACE_HEADER
+
+/******************************************************************************/
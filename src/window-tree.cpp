@@ -0,0 +1,479 @@
+/******************************************************************************/
+/*! \file src/window-tree.cpp
+ *
+ * Local mirror of all top-level windows and their stacking order.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "window-tree.h"
+#include "log.h"
+#include "xcb.h"
+#include "tools.h"
+
+#include <algorithm>
+#include <xcb/xcbext.h>
+
+//! map window id -> node of all top-level windows
+WindowTree::nodemap_type WindowTree::s_nodemap;
+
+//! top-level windows in stacking order, bottom first.
+WindowTree::stacking_type WindowTree::s_stacking;
+
+//! spatial index of mapped windows
+SpatialGrid WindowTree::s_grid;
+
+//! spacing of stacking keys after renumbering
+static const uint64_t stack_key_gap = 1llu << 32;
+
+//! interval between consistency checks, zero disables them.
+uint64_t WindowTree::s_verify_interval = default_verify_interval;
+
+//! time of the last consistency check
+uint64_t WindowTree::s_verify_last = 0;
+
+//! sequence number of the outstanding QueryTree, zero if none.
+unsigned int WindowTree::s_verify_sequence = 0;
+
+//! collected reply of the outstanding QueryTree
+xcb_query_tree_reply_t* WindowTree::s_verify_reply = NULL;
+
+//! number of consistency checks done and failed
+unsigned int WindowTree::s_verify_count = 0;
+unsigned int WindowTree::s_verify_mismatch = 0;
+
+//! whether the mirror was changed ahead of the server while a consistency
+//! check was outstanding
+bool WindowTree::s_verify_expected = false;
+
+//! Query attributes and geometry of windows in one round trip and add nodes
+//! for all which still exist.
+void WindowTree::load(const xcb_window_t* list, size_t size)
+{
+    std::vector<xcb_get_window_attributes_cookie_t> gwac(size);
+    std::vector<xcb_get_geometry_cookie_t> ggc(size);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        gwac[i] = g_xcb.req(xcb_get_window_attributes(g_xcb.connection,
+                                                      list[i]));
+        ggc[i] = g_xcb.req(xcb_get_geometry(g_xcb.connection, list[i]));
+    }
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        autofree_ptr<xcb_get_window_attributes_reply_t> gwar(
+            g_xcb.reply(xcb_get_window_attributes_reply, gwac[i], NULL)
+            );
+        autofree_ptr<xcb_get_geometry_reply_t> ggr(
+            g_xcb.reply(xcb_get_geometry_reply, ggc[i], NULL)
+            );
+
+        if (!gwar || !ggr) {
+            DEBUG << "window tree: window " << list[i] << " vanished";
+            continue;
+        }
+
+        Node& n = s_nodemap[list[i]];
+        n.window = list[i];
+        n.geometry = Rectangle(ggr->x, ggr->y, ggr->width, ggr->height);
+        n.border_width = ggr->border_width;
+        n.override_redirect = gwar->override_redirect;
+        n.mapped = (gwar->map_state != XCB_MAP_STATE_UNMAPPED);
+    }
+}
+
+//! Replace stacking order with a QueryTree reply, drop vanished windows and
+//! load new ones.
+void WindowTree::synchronize(const xcb_query_tree_reply_t* qtr)
+{
+    const xcb_window_t* child = xcb_query_tree_children(qtr);
+    int len = xcb_query_tree_children_length(qtr);
+
+    s_stacking.assign(child, child + len);
+
+    // drop nodes of windows which are gone
+    std::vector<xcb_window_t> sorted = s_stacking;
+    std::sort(sorted.begin(), sorted.end());
+
+    for (nodemap_type::iterator it = s_nodemap.begin(); it != s_nodemap.end(); )
+    {
+        if (std::binary_search(sorted.begin(), sorted.end(), it->first))
+            ++it;
+        else {
+            s_grid.erase(it->first);
+            s_nodemap.erase(it++);
+        }
+    }
+
+    // load new windows in one round trip
+    std::vector<xcb_window_t> missing;
+
+    for (xcb_window_t w : s_stacking)
+    {
+        if (!s_nodemap.count(w)) missing.push_back(w);
+    }
+
+    load(missing.data(), missing.size());
+
+    // windows which vanished while loading are dropped from the stack
+    stacking_type::iterator it = s_stacking.begin();
+
+    while (it != s_stacking.end())
+    {
+        if (s_nodemap.count(*it))
+            ++it;
+        else
+            it = s_stacking.erase(it);
+    }
+
+    renumber();
+}
+
+//! Compare mirror with a QueryTree reply, resynchronize on mismatch.
+void WindowTree::compare(const xcb_query_tree_reply_t* qtr)
+{
+    const xcb_window_t* child = xcb_query_tree_children(qtr);
+    int len = xcb_query_tree_children_length(qtr);
+
+    ++s_verify_count;
+
+    if ((size_t)len == s_stacking.size() &&
+        std::equal(s_stacking.begin(), s_stacking.end(), child))
+    {
+        DEBUG << "window tree: consistent with server, "
+              << len << " windows";
+        return;
+    }
+
+    ++s_verify_mismatch;
+
+    WARN << "window tree: mirror of " << s_stacking.size()
+         << " windows differs from server with " << len
+         << " windows, resynchronizing.";
+
+    synchronize(qtr);
+}
+
+//! Move window in stacking order directly above sibling, or to the bottom if
+//! sibling is XCB_WINDOW_NONE.
+void WindowTree::restack(xcb_window_t win, xcb_window_t sibling)
+{
+    stacking_type::iterator it =
+        std::find(s_stacking.begin(), s_stacking.end(), win);
+
+    if (it == s_stacking.end()) return;
+
+    s_stacking.erase(it);
+
+    if (sibling == XCB_WINDOW_NONE) {
+        it = s_stacking.insert(s_stacking.begin(), win);
+    }
+    else if ((it = std::find(s_stacking.begin(), s_stacking.end(), sibling))
+             != s_stacking.end()) {
+        it = s_stacking.insert(it + 1, win);
+    }
+    else {
+        WARN << "window tree: unknown sibling " << sibling
+             << " of window " << win;
+        it = s_stacking.insert(s_stacking.end(), win);
+    }
+
+    place_key(it - s_stacking.begin());
+}
+
+//! Remove window from mirror.
+void WindowTree::remove(xcb_window_t win)
+{
+    if (!s_nodemap.erase(win)) return;
+
+    s_stacking.erase(std::find(s_stacking.begin(), s_stacking.end(), win));
+    s_grid.erase(win);
+}
+
+//! Assign stacking key to the window at position i in the stacking order,
+//! between the keys of its neighbours.
+void WindowTree::place_key(size_t i)
+{
+    uint64_t lo = 0, hi = UINT64_MAX;
+
+    if (i > 0)
+        lo = s_nodemap[s_stacking[i - 1]].stack_key;
+    if (i + 1 < s_stacking.size())
+        hi = s_nodemap[s_stacking[i + 1]].stack_key;
+
+    if (hi - lo < 2) {
+        // no gap left between the neighbours
+        renumber();
+        return;
+    }
+
+    Node& n = s_nodemap[s_stacking[i]];
+    n.stack_key = lo + std::min(stack_key_gap, (hi - lo) / 2);
+
+    s_grid.set_z(n.window, n.stack_key);
+}
+
+//! Reassign evenly spaced stacking keys to all windows.
+void WindowTree::renumber()
+{
+    uint64_t key = 0;
+
+    for (xcb_window_t w : s_stacking)
+    {
+        Node& n = s_nodemap[w];
+        n.stack_key = (key += stack_key_gap);
+        update_grid(n);
+    }
+}
+
+//! Insert mapped window into spatial index, or remove unmapped one.
+void WindowTree::update_grid(const Node& n)
+{
+    if (n.mapped)
+        s_grid.insert(n.window, n.outer(), n.stack_key);
+    else
+        s_grid.erase(n.window);
+}
+
+//! Issue QueryTree on root for loading the mirror.
+xcb_query_tree_cookie_t WindowTree::query_tree()
+{
+    return g_xcb.req(xcb_query_tree(g_xcb.connection, g_xcb.root));
+}
+
+//! Load the mirror from the QueryTree reply.
+void WindowTree::process_tree(xcb_query_tree_cookie_t qtc)
+{
+    autofree_ptr<xcb_query_tree_reply_t> qtr(
+        g_xcb.reply(xcb_query_tree_reply, qtc, NULL)
+        );
+
+    if (!qtr) {
+        ERROR << "window tree: could not query window list.";
+        return;
+    }
+
+    TRACE << *qtr;
+
+    s_nodemap.clear();
+    s_grid.clear();
+    s_grid.set_extent(Rectangle(0, 0, g_xcb.screen->width_in_pixels,
+                                g_xcb.screen->height_in_pixels));
+
+    synchronize(qtr.get());
+
+    s_verify_last = monotonic_ns();
+
+    DEBUG << "window tree: loaded " << s_nodemap.size() << " windows";
+}
+
+//! Return the top-most mapped window containing the point, or NULL.
+const WindowTree::Node* WindowTree::window_at(const Point& p)
+{
+    xcb_window_t win = s_grid.topmost(p);
+    return (win ? find(win) : NULL);
+}
+
+//! Add a new child of root on top of the stack.
+void WindowTree::create_notify(const xcb_create_notify_event_t& ev)
+{
+    if (ev.parent != g_xcb.root) return;
+
+    // the window may already be known from the startup QueryTree
+    bool known = s_nodemap.count(ev.window);
+
+    Node& n = s_nodemap[ev.window];
+    n.window = ev.window;
+    n.geometry = Rectangle(ev.x, ev.y, ev.width, ev.height);
+    n.border_width = ev.border_width;
+    n.override_redirect = ev.override_redirect;
+
+    if (known) {
+        update_grid(n);
+        return;
+    }
+
+    n.mapped = false;
+    s_stacking.push_back(ev.window);
+    place_key(s_stacking.size() - 1);
+}
+
+//! Remove a destroyed top-level window.
+void WindowTree::destroy_notify(const xcb_destroy_notify_event_t& ev)
+{
+    remove(ev.window);
+}
+
+//! Mark a top-level window as mapped.
+void WindowTree::map_notify(const xcb_map_notify_event_t& ev)
+{
+    nodemap_type::iterator it = s_nodemap.find(ev.window);
+    if (it == s_nodemap.end()) return;
+
+    it->second.mapped = true;
+    it->second.override_redirect = ev.override_redirect;
+
+    update_grid(it->second);
+}
+
+//! Mark a top-level window as unmapped.
+void WindowTree::unmap_notify(const xcb_unmap_notify_event_t& ev)
+{
+    nodemap_type::iterator it = s_nodemap.find(ev.window);
+    if (it == s_nodemap.end()) return;
+
+    it->second.mapped = false;
+
+    update_grid(it->second);
+}
+
+//! Update geometry and stacking position of a top-level window.
+void WindowTree::configure_notify(const xcb_configure_notify_event_t& ev)
+{
+    if (ev.window == g_xcb.root) {
+        s_grid.set_extent(Rectangle(0, 0, ev.width, ev.height));
+        return;
+    }
+
+    nodemap_type::iterator it = s_nodemap.find(ev.window);
+    if (it == s_nodemap.end()) return;
+
+    Node& n = it->second;
+    n.geometry = Rectangle(ev.x, ev.y, ev.width, ev.height);
+    n.border_width = ev.border_width;
+    n.override_redirect = ev.override_redirect;
+
+    restack(ev.window, ev.above_sibling);
+    update_grid(n);
+}
+
+//! Add windows reparented into root, remove those reparented away.
+void WindowTree::reparent_notify(const xcb_reparent_notify_event_t& ev)
+{
+    if (ev.parent != g_xcb.root) {
+        remove(ev.window);
+        return;
+    }
+
+    if (s_nodemap.count(ev.window)) return;
+
+    // the event lacks the size and map state, hence query them
+    load(&ev.window, 1);
+
+    nodemap_type::iterator it = s_nodemap.find(ev.window);
+    if (it == s_nodemap.end()) return;
+
+    s_stacking.push_back(ev.window);
+    place_key(s_stacking.size() - 1);
+    update_grid(it->second);
+}
+
+//! Move a top-level window to the top or bottom of the stack.
+void WindowTree::circulate_notify(const xcb_circulate_notify_event_t& ev)
+{
+    if (!s_nodemap.count(ev.window)) return;
+
+    if (ev.place == XCB_PLACE_ON_BOTTOM)
+        restack(ev.window, XCB_WINDOW_NONE);
+    else if (s_stacking.back() != ev.window)
+        restack(ev.window, s_stacking.back());
+}
+
+//! Apply a sibling-relative restack request to the mirror ahead of its
+//! ConfigureNotify, such that further planning sees the new order.
+void WindowTree::expect_stack(xcb_window_t win, xcb_window_t sibling,
+                              xcb_stack_mode_t mode)
+{
+    if (!s_nodemap.count(win) || win == sibling) return;
+
+    if (mode == XCB_STACK_MODE_BELOW)
+    {
+        // below sibling is directly above the window under sibling
+        stacking_type::iterator it =
+            std::find(s_stacking.begin(), s_stacking.end(), sibling);
+        if (it == s_stacking.end()) return;
+
+        sibling = XCB_WINDOW_NONE;
+        if (it != s_stacking.begin()) sibling = *(it - 1);
+        if (sibling == win) return;
+    }
+
+    restack(win, sibling);
+
+    // the outstanding QueryTree reply does not contain this change yet
+    if (s_verify_sequence) s_verify_expected = true;
+}
+
+//! Drive consistency checks from the event loop.
+void WindowTree::verify(const xcb_generic_event_t* next)
+{
+    if (!s_verify_sequence)
+    {
+        if (!s_verify_interval ||
+            monotonic_ns() - s_verify_last < s_verify_interval) return;
+
+        s_verify_sequence = query_tree().sequence;
+        return;
+    }
+
+    if (!s_verify_reply)
+    {
+        void* r = NULL;
+        xcb_generic_error_t* e = NULL;
+
+        if (!xcb_poll_for_reply(g_xcb.connection, s_verify_sequence, &r, &e))
+            return;
+
+        if (!r) {
+            ERROR << "window tree: consistency check QueryTree failed.";
+            free(e);
+            s_verify_sequence = 0;
+            s_verify_expected = false;
+            s_verify_last = monotonic_ns();
+            return;
+        }
+
+        s_verify_reply = (xcb_query_tree_reply_t*)r;
+    }
+
+    // events generated before the QueryTree was processed are reflected in
+    // its reply, they must be applied to the mirror first.
+    if (next && (int)(next->full_sequence - s_verify_sequence) < 0) return;
+
+    if (s_verify_expected)
+        DEBUG << "window tree: skipping check, changes are in flight.";
+    else
+        compare(s_verify_reply);
+
+    s_verify_expected = false;
+
+    free(s_verify_reply);
+    s_verify_reply = NULL;
+    s_verify_sequence = 0;
+    s_verify_last = monotonic_ns();
+}
+
+//! Output consistency check statistics.
+void WindowTree::dump_stats()
+{
+    INFO << "window tree: " << s_nodemap.size() << " windows, "
+         << s_verify_count << " consistency checks, "
+         << s_verify_mismatch << " mismatches";
+}
+
+/******************************************************************************/
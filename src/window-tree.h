@@ -0,0 +1,225 @@
+/******************************************************************************/
+/*! \file src/window-tree.h
+ *
+ * Local mirror of all top-level windows and their stacking order.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TILEWM_WINDOW_TREE_HEADER
+#define TILEWM_WINDOW_TREE_HEADER
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include <xcb/xcb.h>
+
+#include "geometry.h"
+#include "spatial-grid.h"
+
+/*!
+ * The WindowTree keeps a shadow copy of all children of the root window, not
+ * only the managed clients: geometry, map state, override-redirect flag and
+ * the stacking order. It is loaded once at startup and then updated from the
+ * structure notify events on root, such that queries like "which window is
+ * under this point" or "what is stacked above" are memory lookups instead of
+ * server round trips.
+ *
+ * Mapped windows are additionally kept in a SpatialGrid keyed by their outer
+ * rectangle and a stacking key, such that window-at-point and
+ * windows-in-area queries scan only the overlapping grid cells. Stacking keys
+ * are spaced apart, so restacking a window usually changes only its own key.
+ *
+ * Periodically, the mirror is checked against a QueryTree of the server. The
+ * request is issued and collected without blocking, and the comparison is
+ * done once all events preceding the reply have been processed, hence
+ * in-flight changes do not cause false alarms. On mismatch, the mirror is
+ * resynchronized.
+ */
+class WindowTree
+{
+public:
+    //! Mirrored state of a top-level window.
+    struct Node
+    {
+        //! window id
+        xcb_window_t window;
+        //! geometry without border
+        Rectangle geometry;
+        //! border width
+        uint16_t border_width;
+        //! override-redirect windows are never managed
+        bool override_redirect;
+        //! whether the window is mapped
+        bool mapped;
+        //! ordered key of position in stacking, higher is on top
+        uint64_t stack_key;
+
+        //! Return the area covered by the window including its border.
+        Rectangle outer() const
+        {
+            return Rectangle(geometry.x, geometry.y,
+                             geometry.w + 2 * border_width,
+                             geometry.h + 2 * border_width);
+        }
+    };
+
+    //! typedef of window ids in stacking order, bottom first.
+    typedef std::vector<xcb_window_t> stacking_type;
+
+    //! default interval of consistency checks
+    static const uint64_t default_verify_interval = 60 * 1000000000llu;
+
+protected:
+    //! typedef of map window id -> node
+    typedef std::map<xcb_window_t, Node> nodemap_type;
+
+    //! map window id -> node of all top-level windows
+    static nodemap_type s_nodemap;
+
+    //! top-level windows in stacking order, bottom first.
+    static stacking_type s_stacking;
+
+    //! spatial index of mapped windows
+    static SpatialGrid s_grid;
+
+    //! interval between consistency checks, zero disables them.
+    static uint64_t s_verify_interval;
+
+    //! time of the last consistency check
+    static uint64_t s_verify_last;
+
+    //! sequence number of the outstanding QueryTree, zero if none.
+    static unsigned int s_verify_sequence;
+
+    //! collected reply of the outstanding QueryTree
+    static xcb_query_tree_reply_t* s_verify_reply;
+
+    //! number of consistency checks done and failed
+    static unsigned int s_verify_count, s_verify_mismatch;
+
+    //! whether the mirror was changed ahead of the server while a
+    //! consistency check was outstanding
+    static bool s_verify_expected;
+
+    //! Query attributes and geometry of windows in one round trip and add
+    //! nodes for all which still exist.
+    static void load(const xcb_window_t* list, size_t size);
+
+    //! Replace stacking order with a QueryTree reply, drop vanished windows
+    //! and load new ones.
+    static void synchronize(const xcb_query_tree_reply_t* qtr);
+
+    //! Compare mirror with a QueryTree reply, resynchronize on mismatch.
+    static void compare(const xcb_query_tree_reply_t* qtr);
+
+    //! Move window in stacking order directly above sibling, or to the
+    //! bottom if sibling is XCB_WINDOW_NONE.
+    static void restack(xcb_window_t win, xcb_window_t sibling);
+
+    //! Remove window from mirror.
+    static void remove(xcb_window_t win);
+
+    //! Assign stacking key to the window at position i in the stacking
+    //! order, between the keys of its neighbours.
+    static void place_key(size_t i);
+
+    //! Reassign evenly spaced stacking keys to all windows.
+    static void renumber();
+
+    //! Insert mapped window into spatial index, or remove unmapped one.
+    static void update_grid(const Node& n);
+
+public:
+    //! Issue QueryTree on root for loading the mirror.
+    static xcb_query_tree_cookie_t query_tree();
+
+    //! Load the mirror from the QueryTree reply.
+    static void process_tree(xcb_query_tree_cookie_t qtc);
+
+    //! Return mirrored state of a top-level window, or NULL.
+    static const Node * find(xcb_window_t win)
+    {
+        nodemap_type::const_iterator i = s_nodemap.find(win);
+        return (i != s_nodemap.end() ? &i->second : NULL);
+    }
+
+    //! Return top-level windows in stacking order, bottom first.
+    static const stacking_type & stacking()
+    {
+        return s_stacking;
+    }
+
+    //! Return number of top-level windows.
+    static size_t size()
+    {
+        return s_nodemap.size();
+    }
+
+    //! Return the top-most mapped window containing the point, or NULL.
+    static const Node * window_at(const Point& p);
+
+    //! Collect mapped windows intersecting the area, bottom first.
+    static void windows_in(const Rectangle& r, std::vector<xcb_window_t>& out)
+    {
+        s_grid.intersecting(r, out);
+    }
+
+    //! Add a new child of root on top of the stack.
+    static void create_notify(const xcb_create_notify_event_t& ev);
+
+    //! Remove a destroyed top-level window.
+    static void destroy_notify(const xcb_destroy_notify_event_t& ev);
+
+    //! Mark a top-level window as mapped.
+    static void map_notify(const xcb_map_notify_event_t& ev);
+
+    //! Mark a top-level window as unmapped.
+    static void unmap_notify(const xcb_unmap_notify_event_t& ev);
+
+    //! Update geometry and stacking position of a top-level window.
+    static void configure_notify(const xcb_configure_notify_event_t& ev);
+
+    //! Add windows reparented into root, remove those reparented away.
+    static void reparent_notify(const xcb_reparent_notify_event_t& ev);
+
+    //! Move a top-level window to the top or bottom of the stack.
+    static void circulate_notify(const xcb_circulate_notify_event_t& ev);
+
+    //! Apply a sibling-relative restack request to the mirror ahead of its
+    //! ConfigureNotify, such that further planning sees the new order.
+    static void expect_stack(xcb_window_t win, xcb_window_t sibling,
+                             xcb_stack_mode_t mode);
+
+    //! Set interval of consistency checks in nanoseconds, zero disables.
+    static void set_verify_interval(uint64_t ns)
+    {
+        s_verify_interval = ns;
+    }
+
+    //! Drive consistency checks from the event loop: issues a QueryTree when
+    //! due, collects its reply without blocking, and compares it before the
+    //! first event following the reply (or NULL) is processed.
+    static void verify(const xcb_generic_event_t* next);
+
+    //! Output consistency check statistics.
+    static void dump_stats();
+};
+
+#endif // !TILEWM_WINDOW_TREE_HEADER
+
+/******************************************************************************/
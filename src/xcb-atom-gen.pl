@@ -63,11 +63,12 @@ print <<EOF;
 
 EOF
 
+my $index = 0;
 foreach my $atom (@atomlist)
 {
     print "//! Cached value of $atom atom\n";
     print "XcbConnection::XcbAtom XcbConnection::$atom =\n";
-    print "{ \"$atom\", XCB_ATOM_NONE \};\n";
+    print "{ \"$atom\", XCB_ATOM_NONE, ".$index++." \};\n";
 }
 
 my $ewmhnum = scalar grep(/^_NET/, @atomlist);
@@ -24,110 +24,119 @@
 
 //! Cached value of WM_STATE atom
 XcbConnection::XcbAtom XcbConnection::WM_STATE =
-{ "WM_STATE", XCB_ATOM_NONE };
+{ "WM_STATE", XCB_ATOM_NONE, 0 };
 //! Cached value of WM_CHANGE_STATE atom
 XcbConnection::XcbAtom XcbConnection::WM_CHANGE_STATE =
-{ "WM_CHANGE_STATE", XCB_ATOM_NONE };
+{ "WM_CHANGE_STATE", XCB_ATOM_NONE, 1 };
 //! Cached value of WM_PROTOCOLS atom
 XcbConnection::XcbAtom XcbConnection::WM_PROTOCOLS =
-{ "WM_PROTOCOLS", XCB_ATOM_NONE };
+{ "WM_PROTOCOLS", XCB_ATOM_NONE, 2 };
 //! Cached value of WM_DELETE_WINDOW atom
 XcbConnection::XcbAtom XcbConnection::WM_DELETE_WINDOW =
-{ "WM_DELETE_WINDOW", XCB_ATOM_NONE };
+{ "WM_DELETE_WINDOW", XCB_ATOM_NONE, 3 };
 //! Cached value of WM_TAKE_FOCUS atom
 XcbConnection::XcbAtom XcbConnection::WM_TAKE_FOCUS =
-{ "WM_TAKE_FOCUS", XCB_ATOM_NONE };
+{ "WM_TAKE_FOCUS", XCB_ATOM_NONE, 4 };
 //! Cached value of UTF8_STRING atom
 XcbConnection::XcbAtom XcbConnection::UTF8_STRING =
-{ "UTF8_STRING", XCB_ATOM_NONE };
+{ "UTF8_STRING", XCB_ATOM_NONE, 5 };
 //! Cached value of _NET_SUPPORTED atom
 XcbConnection::XcbAtom XcbConnection::_NET_SUPPORTED =
-{ "_NET_SUPPORTED", XCB_ATOM_NONE };
+{ "_NET_SUPPORTED", XCB_ATOM_NONE, 6 };
 //! Cached value of _NET_SUPPORTING_WM_CHECK atom
 XcbConnection::XcbAtom XcbConnection::_NET_SUPPORTING_WM_CHECK =
-{ "_NET_SUPPORTING_WM_CHECK", XCB_ATOM_NONE };
+{ "_NET_SUPPORTING_WM_CHECK", XCB_ATOM_NONE, 7 };
 //! Cached value of _NET_WM_NAME atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_NAME =
-{ "_NET_WM_NAME", XCB_ATOM_NONE };
+{ "_NET_WM_NAME", XCB_ATOM_NONE, 8 };
 //! Cached value of _NET_ACTIVE_WINDOW atom
 XcbConnection::XcbAtom XcbConnection::_NET_ACTIVE_WINDOW =
-{ "_NET_ACTIVE_WINDOW", XCB_ATOM_NONE };
+{ "_NET_ACTIVE_WINDOW", XCB_ATOM_NONE, 9 };
 //! Cached value of _NET_CLIENT_LIST atom
 XcbConnection::XcbAtom XcbConnection::_NET_CLIENT_LIST =
-{ "_NET_CLIENT_LIST", XCB_ATOM_NONE };
+{ "_NET_CLIENT_LIST", XCB_ATOM_NONE, 10 };
 //! Cached value of _NET_NUMBER_OF_DESKTOPS atom
 XcbConnection::XcbAtom XcbConnection::_NET_NUMBER_OF_DESKTOPS =
-{ "_NET_NUMBER_OF_DESKTOPS", XCB_ATOM_NONE };
+{ "_NET_NUMBER_OF_DESKTOPS", XCB_ATOM_NONE, 11 };
 //! Cached value of _NET_DESKTOP_NAMES atom
 XcbConnection::XcbAtom XcbConnection::_NET_DESKTOP_NAMES =
-{ "_NET_DESKTOP_NAMES", XCB_ATOM_NONE };
+{ "_NET_DESKTOP_NAMES", XCB_ATOM_NONE, 12 };
 //! Cached value of _NET_DESKTOP_LAYOUT atom
 XcbConnection::XcbAtom XcbConnection::_NET_DESKTOP_LAYOUT =
-{ "_NET_DESKTOP_LAYOUT", XCB_ATOM_NONE };
+{ "_NET_DESKTOP_LAYOUT", XCB_ATOM_NONE, 13 };
 //! Cached value of _NET_WM_STATE atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_STATE =
-{ "_NET_WM_STATE", XCB_ATOM_NONE };
+{ "_NET_WM_STATE", XCB_ATOM_NONE, 14 };
 //! Cached value of _NET_WM_STATE_HIDDEN atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_STATE_HIDDEN =
-{ "_NET_WM_STATE_HIDDEN", XCB_ATOM_NONE };
+{ "_NET_WM_STATE_HIDDEN", XCB_ATOM_NONE, 15 };
 //! Cached value of _NET_WM_STATE_STICKY atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_STATE_STICKY =
-{ "_NET_WM_STATE_STICKY", XCB_ATOM_NONE };
+{ "_NET_WM_STATE_STICKY", XCB_ATOM_NONE, 16 };
 //! Cached value of _NET_WM_STATE_ABOVE atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_STATE_ABOVE =
-{ "_NET_WM_STATE_ABOVE", XCB_ATOM_NONE };
+{ "_NET_WM_STATE_ABOVE", XCB_ATOM_NONE, 17 };
+//! Cached value of _NET_WM_STATE_BELOW atom
+XcbConnection::XcbAtom XcbConnection::_NET_WM_STATE_BELOW =
+{ "_NET_WM_STATE_BELOW", XCB_ATOM_NONE, 18 };
 //! Cached value of _NET_WM_STATE_FULLSCREEN atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_STATE_FULLSCREEN =
-{ "_NET_WM_STATE_FULLSCREEN", XCB_ATOM_NONE };
+{ "_NET_WM_STATE_FULLSCREEN", XCB_ATOM_NONE, 19 };
 //! Cached value of _NET_WM_STATE_MAXIMIZED_VERT atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_STATE_MAXIMIZED_VERT =
-{ "_NET_WM_STATE_MAXIMIZED_VERT", XCB_ATOM_NONE };
+{ "_NET_WM_STATE_MAXIMIZED_VERT", XCB_ATOM_NONE, 20 };
 //! Cached value of _NET_WM_STATE_MAXIMIZED_HORZ atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_STATE_MAXIMIZED_HORZ =
-{ "_NET_WM_STATE_MAXIMIZED_HORZ", XCB_ATOM_NONE };
+{ "_NET_WM_STATE_MAXIMIZED_HORZ", XCB_ATOM_NONE, 21 };
 //! Cached value of _NET_WM_STATE_SKIP_TASKBAR atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_STATE_SKIP_TASKBAR =
-{ "_NET_WM_STATE_SKIP_TASKBAR", XCB_ATOM_NONE };
+{ "_NET_WM_STATE_SKIP_TASKBAR", XCB_ATOM_NONE, 22 };
 //! Cached value of _NET_WM_STATE_SKIP_PAGER atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_STATE_SKIP_PAGER =
-{ "_NET_WM_STATE_SKIP_PAGER", XCB_ATOM_NONE };
+{ "_NET_WM_STATE_SKIP_PAGER", XCB_ATOM_NONE, 23 };
 //! Cached value of _NET_WM_STRUT atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_STRUT =
-{ "_NET_WM_STRUT", XCB_ATOM_NONE };
+{ "_NET_WM_STRUT", XCB_ATOM_NONE, 24 };
 //! Cached value of _NET_WM_STRUT_PARTIAL atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_STRUT_PARTIAL =
-{ "_NET_WM_STRUT_PARTIAL", XCB_ATOM_NONE };
+{ "_NET_WM_STRUT_PARTIAL", XCB_ATOM_NONE, 25 };
+//! Cached value of _NET_WM_PID atom
+XcbConnection::XcbAtom XcbConnection::_NET_WM_PID =
+{ "_NET_WM_PID", XCB_ATOM_NONE, 26 };
+//! Cached value of _NET_STARTUP_ID atom
+XcbConnection::XcbAtom XcbConnection::_NET_STARTUP_ID =
+{ "_NET_STARTUP_ID", XCB_ATOM_NONE, 27 };
 //! Cached value of _NET_WM_WINDOW_TYPE atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_WINDOW_TYPE =
-{ "_NET_WM_WINDOW_TYPE", XCB_ATOM_NONE };
+{ "_NET_WM_WINDOW_TYPE", XCB_ATOM_NONE, 28 };
 //! Cached value of _NET_WM_WINDOW_TYPE_NORMAL atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_WINDOW_TYPE_NORMAL =
-{ "_NET_WM_WINDOW_TYPE_NORMAL", XCB_ATOM_NONE };
+{ "_NET_WM_WINDOW_TYPE_NORMAL", XCB_ATOM_NONE, 29 };
 //! Cached value of _NET_WM_WINDOW_TYPE_DESKTOP atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_WINDOW_TYPE_DESKTOP =
-{ "_NET_WM_WINDOW_TYPE_DESKTOP", XCB_ATOM_NONE };
+{ "_NET_WM_WINDOW_TYPE_DESKTOP", XCB_ATOM_NONE, 30 };
 //! Cached value of _NET_WM_WINDOW_TYPE_DOCK atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_WINDOW_TYPE_DOCK =
-{ "_NET_WM_WINDOW_TYPE_DOCK", XCB_ATOM_NONE };
+{ "_NET_WM_WINDOW_TYPE_DOCK", XCB_ATOM_NONE, 31 };
 //! Cached value of _NET_WM_WINDOW_TYPE_TOOLBAR atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_WINDOW_TYPE_TOOLBAR =
-{ "_NET_WM_WINDOW_TYPE_TOOLBAR", XCB_ATOM_NONE };
+{ "_NET_WM_WINDOW_TYPE_TOOLBAR", XCB_ATOM_NONE, 32 };
 //! Cached value of _NET_WM_WINDOW_TYPE_MENU atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_WINDOW_TYPE_MENU =
-{ "_NET_WM_WINDOW_TYPE_MENU", XCB_ATOM_NONE };
+{ "_NET_WM_WINDOW_TYPE_MENU", XCB_ATOM_NONE, 33 };
 //! Cached value of _NET_WM_WINDOW_TYPE_UTILITY atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_WINDOW_TYPE_UTILITY =
-{ "_NET_WM_WINDOW_TYPE_UTILITY", XCB_ATOM_NONE };
+{ "_NET_WM_WINDOW_TYPE_UTILITY", XCB_ATOM_NONE, 34 };
 //! Cached value of _NET_WM_WINDOW_TYPE_SPLASH atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_WINDOW_TYPE_SPLASH =
-{ "_NET_WM_WINDOW_TYPE_SPLASH", XCB_ATOM_NONE };
+{ "_NET_WM_WINDOW_TYPE_SPLASH", XCB_ATOM_NONE, 35 };
 //! Cached value of _NET_WM_WINDOW_TYPE_DIALOG atom
 XcbConnection::XcbAtom XcbConnection::_NET_WM_WINDOW_TYPE_DIALOG =
-{ "_NET_WM_WINDOW_TYPE_DIALOG", XCB_ATOM_NONE };
+{ "_NET_WM_WINDOW_TYPE_DIALOG", XCB_ATOM_NONE, 36 };
 
 std::vector<xcb_atom_t> XcbConnection::get_ewmh_atomlist()
 {
-    std::vector<xcb_atom_t> atomlist(28);
+    std::vector<xcb_atom_t> atomlist(31);
 
     atomlist[0] = _NET_SUPPORTED.atom;
     atomlist[1] = _NET_SUPPORTING_WM_CHECK.atom;
@@ -141,22 +150,25 @@ std::vector<xcb_atom_t> XcbConnection::get_ewmh_atomlist()
     atomlist[9] = _NET_WM_STATE_HIDDEN.atom;
     atomlist[10] = _NET_WM_STATE_STICKY.atom;
     atomlist[11] = _NET_WM_STATE_ABOVE.atom;
-    atomlist[12] = _NET_WM_STATE_FULLSCREEN.atom;
-    atomlist[13] = _NET_WM_STATE_MAXIMIZED_VERT.atom;
-    atomlist[14] = _NET_WM_STATE_MAXIMIZED_HORZ.atom;
-    atomlist[15] = _NET_WM_STATE_SKIP_TASKBAR.atom;
-    atomlist[16] = _NET_WM_STATE_SKIP_PAGER.atom;
-    atomlist[17] = _NET_WM_STRUT.atom;
-    atomlist[18] = _NET_WM_STRUT_PARTIAL.atom;
-    atomlist[19] = _NET_WM_WINDOW_TYPE.atom;
-    atomlist[20] = _NET_WM_WINDOW_TYPE_NORMAL.atom;
-    atomlist[21] = _NET_WM_WINDOW_TYPE_DESKTOP.atom;
-    atomlist[22] = _NET_WM_WINDOW_TYPE_DOCK.atom;
-    atomlist[23] = _NET_WM_WINDOW_TYPE_TOOLBAR.atom;
-    atomlist[24] = _NET_WM_WINDOW_TYPE_MENU.atom;
-    atomlist[25] = _NET_WM_WINDOW_TYPE_UTILITY.atom;
-    atomlist[26] = _NET_WM_WINDOW_TYPE_SPLASH.atom;
-    atomlist[27] = _NET_WM_WINDOW_TYPE_DIALOG.atom;
+    atomlist[12] = _NET_WM_STATE_BELOW.atom;
+    atomlist[13] = _NET_WM_STATE_FULLSCREEN.atom;
+    atomlist[14] = _NET_WM_STATE_MAXIMIZED_VERT.atom;
+    atomlist[15] = _NET_WM_STATE_MAXIMIZED_HORZ.atom;
+    atomlist[16] = _NET_WM_STATE_SKIP_TASKBAR.atom;
+    atomlist[17] = _NET_WM_STATE_SKIP_PAGER.atom;
+    atomlist[18] = _NET_WM_STRUT.atom;
+    atomlist[19] = _NET_WM_STRUT_PARTIAL.atom;
+    atomlist[20] = _NET_WM_PID.atom;
+    atomlist[21] = _NET_STARTUP_ID.atom;
+    atomlist[22] = _NET_WM_WINDOW_TYPE.atom;
+    atomlist[23] = _NET_WM_WINDOW_TYPE_NORMAL.atom;
+    atomlist[24] = _NET_WM_WINDOW_TYPE_DESKTOP.atom;
+    atomlist[25] = _NET_WM_WINDOW_TYPE_DOCK.atom;
+    atomlist[26] = _NET_WM_WINDOW_TYPE_TOOLBAR.atom;
+    atomlist[27] = _NET_WM_WINDOW_TYPE_MENU.atom;
+    atomlist[28] = _NET_WM_WINDOW_TYPE_UTILITY.atom;
+    atomlist[29] = _NET_WM_WINDOW_TYPE_SPLASH.atom;
+    atomlist[30] = _NET_WM_WINDOW_TYPE_DIALOG.atom;
 
     return atomlist;
 }
@@ -180,6 +192,7 @@ struct XcbConnection::XcbAtom* XcbConnection::atomlist[] = {
     &_NET_WM_STATE_HIDDEN,
     &_NET_WM_STATE_STICKY,
     &_NET_WM_STATE_ABOVE,
+    &_NET_WM_STATE_BELOW,
     &_NET_WM_STATE_FULLSCREEN,
     &_NET_WM_STATE_MAXIMIZED_VERT,
     &_NET_WM_STATE_MAXIMIZED_HORZ,
@@ -187,6 +200,8 @@ struct XcbConnection::XcbAtom* XcbConnection::atomlist[] = {
     &_NET_WM_STATE_SKIP_PAGER,
     &_NET_WM_STRUT,
     &_NET_WM_STRUT_PARTIAL,
+    &_NET_WM_PID,
+    &_NET_STARTUP_ID,
     &_NET_WM_WINDOW_TYPE,
     &_NET_WM_WINDOW_TYPE_NORMAL,
     &_NET_WM_WINDOW_TYPE_DESKTOP,
@@ -0,0 +1,308 @@
+/******************************************************************************/
+/*! \file src/xcb-format.cpp
+ *
+ * Formatter and packer of XCB structures driven by field descriptor tables.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "xcb-format.h"
+#include "xcb.h"
+
+#include <cstring>
+
+/*!
+ * Bounded output cursor into a caller buffer, which silently truncates and
+ * keeps one byte for the terminating NUL.
+ */
+class FormatBuffer
+{
+protected:
+    //! current output position
+    char* m_pos;
+    //! last usable position, reserved for NUL
+    char* m_end;
+
+public:
+    //! Construct cursor into buffer of given size, which must be positive.
+    FormatBuffer(char* buf, size_t size)
+        : m_pos(buf), m_end(buf + size - 1)
+    { }
+
+    //! Append a character.
+    void put(char c)
+    {
+        if (m_pos < m_end) *m_pos++ = c;
+    }
+
+    //! Append a NUL-terminated string.
+    void put(const char* s)
+    {
+        while (*s && m_pos < m_end) *m_pos++ = *s++;
+    }
+
+    //! Append an unsigned integer in decimal.
+    void put_uint(uint64_t v)
+    {
+        char tmp[20];
+        int n = 0;
+        do {
+            tmp[n++] = '0' + v % 10;
+            v /= 10;
+        } while (v);
+        while (n) put(tmp[--n]);
+    }
+
+    //! Append a signed integer in decimal.
+    void put_int(int64_t v)
+    {
+        if (v < 0) {
+            put('-');
+            put_uint(-(uint64_t)v);
+        }
+        else {
+            put_uint(v);
+        }
+    }
+
+    //! Append a hexdump of bytes, like string_hexdump().
+    void put_hex(const uint8_t* data, size_t size)
+    {
+        static const char xdigits[16] = {
+            '0', '1', '2', '3', '4', '5', '6', '7',
+            '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+        };
+
+        for (size_t i = 0; i < size; ++i) {
+            put(xdigits[data[i] >> 4]);
+            put(xdigits[data[i] & 0x0F]);
+        }
+    }
+
+    //! Terminate output with NUL and return end position.
+    char * finish()
+    {
+        *m_pos = 0;
+        return m_pos;
+    }
+};
+
+//! Load an unsigned integer field of 1, 2, 4 or 8 bytes.
+static uint64_t field_load(const XcbField& f, const uint8_t* p)
+{
+    switch (f.size)
+    {
+    case 1: return *p;
+    case 2: { uint16_t v; memcpy(&v, p, 2); return v; }
+    case 4: { uint32_t v; memcpy(&v, p, 4); return v; }
+    case 8: { uint64_t v; memcpy(&v, p, 8); return v; }
+    default: return 0;
+    }
+}
+
+//! Load a signed integer field of 1, 2, 4 or 8 bytes.
+static int64_t field_load_signed(const XcbField& f, const uint8_t* p)
+{
+    uint64_t v = field_load(f, p);
+
+    switch (f.size)
+    {
+    case 1: return (int8_t)v;
+    case 2: return (int16_t)v;
+    case 4: return (int32_t)v;
+    default: return (int64_t)v;
+    }
+}
+
+//! Store an integer into a field of 1, 2, 4 or 8 bytes, truncating it.
+static void field_store(const XcbField& f, uint8_t* p, uint64_t v)
+{
+    switch (f.size)
+    {
+    case 1: *p = (uint8_t)v; break;
+    case 2: { uint16_t x = (uint16_t)v; memcpy(p, &x, 2); break; }
+    case 4: { uint32_t x = (uint32_t)v; memcpy(p, &x, 4); break; }
+    case 8: memcpy(p, &v, 8); break;
+    }
+}
+
+//! Format "[name: field=value ...]" into a caller buffer without allocating
+//! memory.
+size_t xcb_format(char* buf, size_t size,
+                  const XcbStruct& desc, const void* data)
+{
+    if (size == 0) return 0;
+
+    const uint8_t* base = (const uint8_t*)data;
+    FormatBuffer fb(buf, size);
+
+    fb.put('[');
+    fb.put(desc.name);
+    fb.put(':');
+
+    for (const XcbField* f = desc.fields; f != desc.fields + desc.count; ++f)
+    {
+        const uint8_t* p = base + f->offset;
+
+        fb.put(' ');
+        fb.put(f->name);
+        fb.put('=');
+
+        switch (f->kind)
+        {
+        case XcbField::UNSIGNED:
+            fb.put_uint(field_load(*f, p));
+            break;
+        case XcbField::SIGNED:
+            fb.put_int(field_load_signed(*f, p));
+            break;
+        case XcbField::ATOM:
+            fb.put(g_xcb.find_atom_name(field_load(*f, p)));
+            fb.put(" (");
+            fb.put_uint(field_load(*f, p));
+            fb.put(')');
+            break;
+        case XcbField::GRAVITY:
+            fb.put(GravityFormatter::name(field_load(*f, p)));
+            break;
+        case XcbField::BYTES:
+            fb.put('[');
+            fb.put_hex(p, f->size);
+            fb.put(']');
+            break;
+        }
+    }
+
+    fb.put(']');
+    return fb.finish() - buf;
+}
+
+//! Format a structure into a stack buffer and write it to os in one call.
+std::ostream& xcb_format_ostream(std::ostream& os,
+                                 const XcbStruct& desc, const void* data)
+{
+    char buf[1024];
+    size_t len = xcb_format(buf, sizeof(buf), desc, data);
+    return os.write(buf, len);
+}
+
+//! Pack all fields of a structure as variable-length integers.
+size_t xcb_pack(uint8_t* out, size_t size,
+                const XcbStruct& desc, const void* data)
+{
+    const uint8_t* base = (const uint8_t*)data;
+    uint8_t* o = out, * end = out + size;
+
+    for (const XcbField* f = desc.fields; f != desc.fields + desc.count; ++f)
+    {
+        const uint8_t* p = base + f->offset;
+
+        if (f->kind == XcbField::BYTES)
+        {
+            if (end - o < f->size) return 0;
+            memcpy(o, p, f->size);
+            o += f->size;
+            continue;
+        }
+
+        uint64_t v;
+        if (f->kind == XcbField::SIGNED) {
+            // zig-zag encoding keeps small negative values short
+            int64_t s = field_load_signed(*f, p);
+            v = ((uint64_t)s << 1) ^ (uint64_t)(s >> 63);
+        }
+        else {
+            v = field_load(*f, p);
+        }
+
+        do {
+            if (o == end) return 0;
+            *o++ = (v & 0x7F) | (v >= 0x80 ? 0x80 : 0);
+            v >>= 7;
+        } while (v);
+    }
+
+    return o - out;
+}
+
+//! Unpack fields written by xcb_pack() into a zeroed structure.
+size_t xcb_unpack(const uint8_t* in, size_t size,
+                  const XcbStruct& desc, void* data)
+{
+    uint8_t* base = (uint8_t*)data;
+    const uint8_t* i = in, * end = in + size;
+
+    memset(base, 0, desc.size);
+
+    for (const XcbField* f = desc.fields; f != desc.fields + desc.count; ++f)
+    {
+        uint8_t* p = base + f->offset;
+
+        if (f->kind == XcbField::BYTES)
+        {
+            if (end - i < f->size) return 0;
+            memcpy(p, i, f->size);
+            i += f->size;
+            continue;
+        }
+
+        uint64_t v = 0;
+        unsigned int shift = 0;
+        do {
+            if (i == end || shift >= 64) return 0;
+            v |= (uint64_t)(*i & 0x7F) << shift;
+            shift += 7;
+        } while (*i++ & 0x80);
+
+        if (f->kind == XcbField::SIGNED)
+            v = (v >> 1) ^ (0 - (v & 1));
+
+        field_store(*f, p, v);
+    }
+
+    return i - in;
+}
+
+//! Pack a core event for tracing, the response type comes first.
+size_t xcb_pack_event(uint8_t* out, size_t size,
+                      const xcb_generic_event_t* event)
+{
+    const XcbStruct* desc = xcb_event_struct(event->response_type);
+    if (!desc) return 0;
+
+    return xcb_pack(out, size, *desc, event);
+}
+
+//! Unpack an event packed by xcb_pack_event() into the 32 bytes of a wire
+//! event.
+size_t xcb_unpack_event(const uint8_t* in, size_t size,
+                        xcb_generic_event_t* event)
+{
+    // the response type is the first field, its varint may be two bytes due
+    // to the send_event flag.
+    if (size == 0) return 0;
+    uint8_t response_type = in[0] & 0x7F;
+    if ((in[0] & 0x80) && size >= 2) response_type |= in[1] << 7;
+
+    const XcbStruct* desc = xcb_event_struct(response_type);
+    if (!desc) return 0;
+
+    memset(event, 0, sizeof(*event));
+    return xcb_unpack(in, size, *desc, event);
+}
+
+/******************************************************************************/
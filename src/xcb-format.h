@@ -0,0 +1,110 @@
+/******************************************************************************/
+/*! \file src/xcb-format.h
+ *
+ * Field descriptor tables driving formatting and packing of XCB structures.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TILEWM_XCB_FORMAT_HEADER
+#define TILEWM_XCB_FORMAT_HEADER
+
+#include <xcb/xcb.h>
+#include <cstddef>
+#include <ostream>
+#include <stdint.h>
+
+/*!
+ * Descriptor of a single field of an XCB structure. Tables of these are
+ * generated by xcb-ostream-gen.pl from the xcb-proto XML protocol
+ * descriptions, while offsets and sizes are taken from the C structures
+ * themselves.
+ */
+struct XcbField
+{
+    //! how a field's value is interpreted
+    enum kind_t {
+        UNSIGNED, SIGNED, ATOM, GRAVITY, BYTES
+    };
+
+    //! name of the field in the C structure
+    const char* name;
+    //! byte offset in the C structure
+    uint16_t offset;
+    //! size of the field in bytes
+    uint16_t size;
+    //! interpretation of the field's value
+    uint8_t kind;
+};
+
+//! Descriptor of an XCB structure: its name and list of fields.
+struct XcbStruct
+{
+    //! name used in the output, the C type without _t suffix
+    const char* name;
+    //! array of field descriptors
+    const XcbField* fields;
+    //! number of field descriptors
+    uint16_t count;
+    //! size of the C structure
+    uint16_t size;
+};
+
+//! Construct a field descriptor entry of a C structure type.
+#define XCB_FIELD(type, field, kind)                                    \
+    { #field, offsetof(type, field), sizeof(type::field), XcbField::kind }
+
+//! Construct a structure descriptor from an array of field descriptors.
+#define XCB_STRUCT(type, name, fields)                                  \
+    { name, fields, sizeof(fields) / sizeof(fields[0]), sizeof(type) }
+
+//! Format "[name: field=value ...]" into a caller buffer without allocating
+//! memory. The output is truncated to size-1 and always NUL-terminated,
+//! returns the number of characters written.
+size_t xcb_format(char* buf, size_t size,
+                  const XcbStruct& desc, const void* data);
+
+//! Format a structure into a stack buffer and write it to os in one call.
+std::ostream& xcb_format_ostream(std::ostream& os,
+                                 const XcbStruct& desc, const void* data);
+
+//! Pack all fields of a structure as variable-length integers (zig-zag for
+//! signed fields) into out. Returns the packed size or 0 if out is too small.
+size_t xcb_pack(uint8_t* out, size_t size,
+                const XcbStruct& desc, const void* data);
+
+//! Unpack fields written by xcb_pack() into a zeroed structure. Returns the
+//! number of bytes consumed or 0 if the input is truncated.
+size_t xcb_unpack(const uint8_t* in, size_t size,
+                  const XcbStruct& desc, void* data);
+
+//! Return the descriptor of a core event by response type, NULL if unknown.
+const XcbStruct* xcb_event_struct(uint8_t response_type);
+
+//! Pack a core event for tracing, the response type comes first. Returns 0
+//! for events without descriptor, which must be stored verbatim.
+size_t xcb_pack_event(uint8_t* out, size_t size,
+                      const xcb_generic_event_t* event);
+
+//! Unpack an event packed by xcb_pack_event() into the 32 bytes of a wire
+//! event. Returns the number of bytes consumed or 0 on error.
+size_t xcb_unpack_event(const uint8_t* in, size_t size,
+                        xcb_generic_event_t* event);
+
+#endif // !TILEWM_XCB_FORMAT_HEADER
+
+/******************************************************************************/
@@ -25,6 +25,7 @@
 #define TILEWM_XCB_ICCCM_HEADER
 
 #include "xcb.h"
+#include "size-solver.h"
 
 /*!
  * Class abstracting from xcb_size_hints_t containing window sizing hints and
@@ -82,7 +83,7 @@ struct IcccmSizeHints
     int32_t get_max_height() const
     {
         if (has_max_size())
-            return std::min<int32_t>(get_min_height(),
+            return std::max<int32_t>(get_min_height(),
                                      m_data.max_height);
         else
             return std::numeric_limits<int32_t>::max();
@@ -216,6 +217,52 @@ struct IcccmSizeHints
         }
     }
 
+    //! Convert size hints into integer hints for the batch SizeSolver.
+    SizeSolver::Hints solver_hints(uint16_t border) const
+    {
+        SizeSolver::Hints h;
+        h.border = border;
+
+        // base and min size substitute each other if only one is given
+        if (m_data.flags & XCB_ICCCM_SIZE_HINT_BASE_SIZE) {
+            h.base_w = std::max<int32_t>(0, m_data.base_width);
+            h.base_h = std::max<int32_t>(0, m_data.base_height);
+            h.aspect_base_w = h.base_w;
+            h.aspect_base_h = h.base_h;
+        }
+        else if (has_min_size()) {
+            h.base_w = get_min_width();
+            h.base_h = get_min_height();
+        }
+
+        if (has_min_size()) {
+            h.min_w = get_min_width();
+            h.min_h = get_min_height();
+        }
+        else {
+            h.min_w = h.base_w;
+            h.min_h = h.base_h;
+        }
+
+        // zero maximum sizes are ignored like in apply()
+        if (has_max_size() && m_data.max_width > 0)
+            h.max_w = get_max_width();
+        if (has_max_size() && m_data.max_height > 0)
+            h.max_h = get_max_height();
+
+        h.inc_w = get_width_inc();
+        h.inc_h = get_height_inc();
+
+        if (m_data.flags & XCB_ICCCM_SIZE_HINT_P_ASPECT) {
+            h.min_aspect_num = m_data.min_aspect_num;
+            h.min_aspect_den = m_data.min_aspect_den;
+            h.max_aspect_num = m_data.max_aspect_num;
+            h.max_aspect_den = m_data.max_aspect_den;
+        }
+
+        return h;
+    }
+
     //! \}
 };
 
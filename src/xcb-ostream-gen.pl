@@ -2,11 +2,20 @@
 ################################################################################
 # src/xcb-ostream-gen.pl
 #
-# Script to auto generate ostream operator << implementation for xcb structures
+# Script to auto generate field descriptor tables and ostream operator <<
+# implementations for xcb structures.
 #
-# The script uses gccxml to "compile" xcb-ostream-stub.cpp into an XML file,
-# which contains information about the fields in all XCB structs. TODO: A
-# better solution may be to read the Xorg XML protocol definition.
+# The script reads the xcb-proto XML protocol descriptions of the core protocol,
+# RandR and Xinerama and the modules they import, which are located via
+# pkg-config or given as the first argument. Only the flat XML elements used by
+# xcb-proto are parsed, hence no XML module is required. Fields of types which
+# cannot be resolved, e.g. from an import that is missing, end the known part
+# of a structure like variable-sized fields do.
+#
+# For each structure whose operator << is declared in an "Auto-generated"
+# block of the sources, and for every core event, a constexpr table of field
+# descriptors is emitted. The C offsets and sizes are filled in by the
+# compiler using offsetof() and sizeof().
 #
 # Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
 #
@@ -27,130 +36,261 @@
 use strict;
 use warnings;
 
-use IO::File;
-use XML::Simple qw(:strict);
-use Data::Dumper;
+my $protodir = $ARGV[0] || `pkg-config --variable=xcbincludedir xcb-proto`;
+chomp($protodir);
+$protodir ||= "/usr/share/xcb";
+
+my @modules = qw(xproto randr xinerama);
+
+# map basic XML type name -> [ field kind, size in bytes ]
+my %types = (
+    CARD8 => [ "UNSIGNED", 1 ], CARD16 => [ "UNSIGNED", 2 ],
+    CARD32 => [ "UNSIGNED", 4 ], CARD64 => [ "UNSIGNED", 8 ],
+    INT8 => [ "SIGNED", 1 ], INT16 => [ "SIGNED", 2 ],
+    INT32 => [ "SIGNED", 4 ], INT64 => [ "SIGNED", 8 ],
+    BYTE => [ "UNSIGNED", 1 ], BOOL => [ "UNSIGNED", 1 ],
+    char => [ "UNSIGNED", 1 ], void => [ "UNSIGNED", 1 ],
+    float => [ "BYTES", 4 ], double => [ "BYTES", 8 ],
+    );
+
+# map module -> XML type name -> [ field kind, size in bytes ]
+my %modtypes;
 
-my $fh = IO::File->new("gccxml xcb-ostream-stub.cpp -fxml=/dev/stdout |")
-    or die("Cannot run gccxml: $!");
+# map module -> list of modules imported by it
+my %imports;
 
-my $ref = XMLin($fh, ForceArray => 1, KeyAttr => [])
-    or die("Could not parse XML output of gccxml: $!");
+# map C type name -> hash describing the structure
+my %cstructs;
 
-if ($ARGV[0] and $ARGV[0] eq "dump") {
-    print Dumper($ref);
-    exit;
+# list of core events: [ number, C type name ]
+my @core_events;
+
+# C++ keywords which the C binding prefixes with an underscore
+my %keywords = map { $_ => 1 } qw(class new delete);
+
+# parse attributes of an XML tag into a hash
+sub attrs {
+    my ($str) = @_;
+    my %a;
+    while ($str =~ m!(\S+?)="([^"]*)"!g) { $a{$1} = $2; }
+    return \%a;
 }
 
-my $trace = 0;
+# convert a CamelCase XML name to the lower case C name, like c_client.py
+sub cname {
+    my ($name) = @_;
+    return $name if $name =~ /^[a-z0-9_]+$/;
+    my @parts = ($name =~ m{([A-Z0-9][a-z]+|[A-Z0-9]+(?![a-z])|[a-z]+)}g);
+    return lc(join("_", @parts));
+}
 
-sub find_typeid {
-    my ($typeid) = @_;
+# resolve an XML type name (possibly with module prefix) as seen from a module
+# to [ kind, size ], or undef if it is unknown.
+sub resolve_type {
+    my ($type, $module) = @_;
 
-    foreach my $ftype (@{$$ref{Typedef}})
-    {
-        $$ftype{id} or next;
-        $$ftype{id} eq $typeid or next;
+    if ($type =~ m!^(\w+):(\w+)$!) {
+        return $modtypes{$1}{$2} || $types{$2};
+    }
+    return $types{$type} if $types{$type};
 
-        print STDERR "type: $$ftype{id} - $$ftype{name}\n" if $trace;
-        return $$ftype{name};
+    foreach my $m ($module, @{$imports{$module} || []}) {
+        return $modtypes{$m}{$type} if $modtypes{$m}{$type};
     }
-    return "undef";
+    return undef;
 }
 
-sub find_field {
-    my ($fieldid) = @_;
+# collect the fixed fields of a struct, event or reply body. Collection stops
+# at the first variable-sized element, which the C binding does not place
+# into the structure, or at a field of unknown type. Returns a reference to
+# the fields and whether the structure is complete.
+sub parse_fields {
+    my ($body, $module) = @_;
 
-    foreach my $key (qw(Field Constructor Destructor Method OperatorMethod))
+    my @fields;
+    while ($body =~ m!<(field|pad|list|exprfield|switch|fd)\b([^>]*?)
+                      (?:/>|>(.*?)</\1>)!gsx)
     {
-        foreach my $field (@{$$ref{$key}})
+        my ($tag, $attr, $inner) = ($1, attrs($2), $3);
+
+        if ($tag eq "pad") {
+            push(@fields, { pad => 1, size => $$attr{bytes} || 0 });
+            next;
+        }
+        if ($tag eq "list" and defined $inner
+            and $inner =~ m!^\s*<value>(\d+)</value>\s*$!)
         {
-            $$field{id} or next;
-            $$field{id} eq $fieldid or next;
+            # fixed-size list is an array in the C structure
+            my $t = resolve_type($$attr{type}, $module) or return (\@fields, 0);
+            push(@fields, { name => $$attr{name}, kind => "BYTES",
+                            size => $$t[1] * $1 });
+            next;
+        }
+        return (\@fields, 0) if $tag ne "field";
 
-            print STDERR "$$field{id} - $$field{name}\n" if $trace;
-            print STDERR Dumper($field) if $trace;
+        my $t = resolve_type($$attr{type}, $module) or return (\@fields, 0);
+        my ($kind, $size) = @$t;
+        $kind = "ATOM" if $$attr{type} =~ /^(xproto:)?ATOM$/;
+        $kind = "GRAVITY" if ($$attr{enum} || "") eq "Gravity";
 
-            return $field;
-        }
+        push(@fields, { name => $$attr{name}, kind => $kind, size => $size });
     }
-
-    return undef;
+    return (\@fields, 1);
 }
 
-sub process {
-    my ($name,$shname,$extra,$trace) = @_;
+# arrange fields of events and replies like the C binding: the first one byte
+# field is placed into the header after response_type.
+sub header_fields {
+    my ($fields, $sequence, $length) = @_;
 
-    my $out = "";
-
-    foreach my $str (@{$$ref{Struct}})
-    {
-        $$str{name} or next;
-        $$str{name} eq $name or next;
+    my @out = ({ name => "response_type", kind => "UNSIGNED", size => 1 });
+    my @rest = @$fields;
 
-        print STDERR $$str{name}."\n" if $trace;
-        print STDERR Dumper($str) if $trace;
+    push(@out, shift(@rest)) if @rest && $rest[0]{size} == 1;
+    push(@out, { name => "sequence", kind => "UNSIGNED", size => 2 })
+        if $sequence;
+    push(@out, { name => "length", kind => "UNSIGNED", size => 4 })
+        if $length;
 
-        my $pname = $$str{name};
-        $pname =~ s/_t$//;
+    return (@out, @rest);
+}
 
-        $out .= "//! automaticatically generated ostream output function for\n";
-        $out .= "//! $$str{name}\n";
-        $out .= "std::ostream&\n";
-        $out .= "operator << (std::ostream& os, const $extra$$str{name}& $shname)\n";
-        $out .= "{\n";
-        $out .= "    os << \"[$pname:\"\n";
+# parse a module after the ones it imports, once
+sub load_module {
+    my ($module) = @_;
+    return if exists $modtypes{$module};
+    $modtypes{$module} = {};
+
+    my $file = "$protodir/$module.xml";
+    if (!open(F, $file)) {
+        # types of this module remain unknown
+        warn("Could not open $file: $!, skipping module $module.\n");
+        return;
+    }
+    my $xml = join("", <F>);
+    close(F);
 
-        foreach my $id (split(/ /,$$str{members}))
-        {
-            print "id: $id\n" if $trace;
+    $xml =~ s/<!--.*?-->//gs;
+    $xml =~ s!<doc>.*?</doc>!!gs;
 
-            my $field = find_field($id) or die("Could not find field $id");
+    $xml =~ m!<xcb\s+([^>]*)>! or die("No <xcb> element in $file");
+    my $header = ${attrs($1)}{header};
+    my $prefix = ($header eq "xproto") ? "xcb_" : "xcb_${header}_";
 
-            next if !$$field{type};
-            next if $$field{name} =~ /^pad[0-9]$/;
+    $imports{$module} = [ $xml =~ m!<import>\s*(\w+)\s*</import>!g ];
+    load_module($_) foreach @{$imports{$module}};
 
-            my $type = find_typeid($$field{type});
+    my $mtypes = $modtypes{$module};
 
-            $out .= "       << \" $$field{name}=\" << ";
+    while ($xml =~ m!<(xidtype|xidunion|typedef|struct|union|event|eventcopy
+                       |request)\b([^>]*?)(?:/>|>(.*?)</\1>)!gsx)
+    {
+        my ($tag, $attr, $body) = ($1, attrs($2), $3);
 
-            if ($type eq "int8_t")
-            {
-                $out .= "int32_t($shname.$$field{name})\n";
-            }
-            elsif ($type eq "uint8_t" or $type eq "xcb_keycode_t")
-            {
-                $out .= "uint32_t($shname.$$field{name})\n";
-            }
-            elsif ($type eq "xcb_atom_t")
-            {
-                $out .= "AtomFormatter($shname.$$field{name})\n";
-            }
-            elsif ($type eq "xcb_gravity_t")
-            {
-                $out .= "GravityFormatter($shname.$$field{name})\n";
-            }
-            else
-            {
-                $out .= "$shname.$$field{name}\n";
+        if ($tag eq "xidtype" or $tag eq "xidunion") {
+            $$mtypes{$$attr{name}} = [ "UNSIGNED", 4 ];
+        }
+        elsif ($tag eq "typedef") {
+            my $t = resolve_type($$attr{oldname}, $module) or next;
+            $$mtypes{$$attr{newname}} = $t;
+        }
+        elsif ($tag eq "struct" or $tag eq "union") {
+            my ($fields, $complete) = parse_fields($body, $module);
+            $cstructs{$prefix.cname($$attr{name})."_t"} =
+                [ grep { !$$_{pad} } @$fields ];
+
+            # structures of unknown size cannot be embedded in others
+            next unless $complete;
+
+            # structures embedded in others are printed as bytes
+            my $size = 0;
+            foreach my $f (@$fields) {
+                if ($tag eq "struct") {
+                    $size += $$f{size};
+                }
+                elsif ($$f{size} > $size) {
+                    $size = $$f{size};
+                }
             }
+            $$mtypes{$$attr{name}} = [ "BYTES", $size ];
         }
+        elsif ($tag eq "event") {
+            # generic events carry more than 32 bytes, skip them
+            next if ($$attr{xge} || "") eq "true";
+
+            my $ctype = $prefix.cname($$attr{name})."_event_t";
+            my $nosequence = ($$attr{"no-sequence-number"} || "") eq "true";
+            my ($fields) = parse_fields($body, $module);
+            $cstructs{$ctype} =
+                [ grep { !$$_{pad} }
+                  header_fields($fields, !$nosequence, 0) ];
+            push(@core_events, [ $$attr{number}, $ctype ])
+                if $header eq "xproto";
+        }
+        elsif ($tag eq "eventcopy") {
+            push(@core_events, [ $$attr{number},
+                                 $prefix.cname($$attr{ref})."_event_t" ])
+                if $header eq "xproto";
+        }
+        elsif ($tag eq "request") {
+            $body =~ m!<reply>(.*?)</reply>!s or next;
+            my $ctype = $prefix.cname($$attr{name})."_reply_t";
+            my ($fields) = parse_fields($1, $module);
+            $cstructs{$ctype} =
+                [ grep { !$$_{pad} } header_fields($fields, 1, 1) ];
+        }
+    }
+}
+
+load_module($_) foreach @modules;
+
+# the core protocol is required
+die("Could not load xproto module from $protodir")
+    unless %{$modtypes{xproto}};
+
+# emit field descriptor table of a C structure
+sub emit_table {
+    my ($ctype) = @_;
 
-        $out .= "       << \"]\";\n";
-        $out .= "    return os;\n";
-        $out .= "}\n\n";
+    my $fields = $cstructs{$ctype} or die("Could not find $ctype structure.");
+
+    my $pname = $ctype;
+    $pname =~ s/_t$//;
+
+    my $out = "";
+    $out .= "//! automatically generated field descriptors of\n";
+    $out .= "//! $ctype\n";
+    my $line = "static constexpr XcbField ${pname}_fields[] = {";
+    $line =~ s/ (\S+_fields)/\n    $1/ if length($line) > 80;
+    $out .= "$line\n";
+
+    my @lines;
+    foreach my $f (@$fields)
+    {
+        my $name = $$f{name};
+        $name = "_$name" if $keywords{$name};
+
+        $line = "    XCB_FIELD($ctype, $name, $$f{kind})";
+        $line = "    XCB_FIELD($ctype,\n              $name, $$f{kind})"
+            if length($line) + 1 > 80;
+        push(@lines, $line);
     }
+    $out .= join(",\n", @lines)."\n};\n\n";
 
-    die("Could not find $name structure.") unless $out;
+    $out .= "static constexpr XcbStruct ${pname}_desc =\n";
+    $out .= "    XCB_STRUCT($ctype,\n";
+    $out .= "               \"$pname\",\n";
+    $out .= "               ${pname}_fields);\n\n";
 
-    print $out;
+    return $out;
 }
 
 print <<EOF;
 /******************************************************************************/
 /*! \\file src/xcb-ostream.cpp
  *
- * Auto-generated ostream operators for many XCB structures.
+ * Auto-generated field descriptor tables and ostream operators for many XCB
+ * structures.
  */
 /*******************************************************************************
  * Copyright (C) 2014 Timo Bingmann <tb\@panthema.net>
@@ -170,14 +310,16 @@ print <<EOF;
  ******************************************************************************/
 
 #include "xcb.h"
+#include "xcb-format.h"
 #include <ostream>
 #include <xcb/xinerama.h>
 #include <xcb/randr.h>
-#include <xcb/xcb_icccm.h>
-#include "xcb-ewmh.h"
 
 EOF
 
+my %emitted;
+
+# operators declared in Auto-generated blocks of the sources
 foreach my $header (glob("*.{h,cpp}"))
 {
     open(F, $header) or die("Could not open $header: $!");
@@ -191,10 +333,67 @@ foreach my $header (glob("*.{h,cpp}"))
                         const\s*(?<extra>(struct|class)\s*)?
                         (?<struct>\S+?)&\s*(?<name>\S+?)\)!gx)
     {
-        process($+{struct}, $+{name}, $+{extra} || "");
+        my ($ctype, $name) = ($+{struct}, $+{name});
+        my $pname = $ctype;
+        $pname =~ s/_t$//;
+
+        print emit_table($ctype) unless $emitted{$ctype}++;
+
+        print "//! automatically generated ostream output function for\n";
+        print "//! $ctype\n";
+        print "std::ostream&\n";
+        my $line = "operator << (std::ostream& os, const $ctype& $name)";
+        $line =~ s/, /,\n             / if length($line) > 80;
+        print "$line\n";
+        print "{\n";
+        $line = "    return xcb_format_ostream(os, ${pname}_desc, &$name);";
+        $line =~ s/\(/(\n        / if length($line) > 80;
+        print "$line\n";
+        print "}\n\n";
     }
 }
 
+# descriptors of all remaining core events, and table by response type
+my $max_event = 0;
+my %event_by_number;
+
+foreach my $ev (@core_events)
+{
+    my ($number, $ctype) = @$ev;
+    print emit_table($ctype) unless $emitted{$ctype}++;
+
+    $event_by_number{$number} = $ctype;
+    $max_event = $number if $number > $max_event;
+}
+
+print "//! automatically generated table of core event descriptors\n";
+print "static constexpr const XcbStruct* core_event_desc[".($max_event + 1)
+    ."] = {\n";
+
+my @entries;
+foreach my $number (0..$max_event)
+{
+    my $ctype = $event_by_number{$number};
+    if ($ctype) {
+        $ctype =~ s/_t$//;
+        push(@entries, "    &${ctype}_desc, // $number");
+    }
+    else {
+        push(@entries, "    NULL, // $number");
+    }
+}
+# the last entry has no comma, keep comments aligned
+$entries[-1] =~ s/, \/\//   \/\//;
+print join("\n", @entries)."\n};\n\n";
+
 print <<EOF;
+//! Return the descriptor of a core event by response type, NULL if unknown.
+const XcbStruct* xcb_event_struct(uint8_t response_type)
+{
+    response_type &= ~0x80;
+    if (response_type > $max_event) return NULL;
+    return core_event_desc[response_type];
+}
+
 /******************************************************************************/
 EOF
@@ -1,36 +0,0 @@
-/******************************************************************************/
-/*! \file src/xcb-ostream-stub.cpp
- *
- * Stub file, which is compiled by gccxml in xcb-ostream-gen.pl to generate
- * structures.
- */
-/*******************************************************************************
- * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
- *
- * This program is free software: you can redistribute it and/or modify it
- * under the terms of the GNU General Public License as published by the Free
- * Software Foundation, either version 3 of the License, or (at your option)
- * any later version.
- *
- * This program is distributed in the hope that it will be useful, but WITHOUT
- * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
- * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
- * more details.
- *
- * You should have received a copy of the GNU General Public License along with
- * this program.  If not, see <http://www.gnu.org/licenses/>.
- ******************************************************************************/
-
-#include <X11/Xlib-xcb.h>
-#include <xcb/xcb.h>
-#include <xcb/xinerama.h>
-#include <xcb/randr.h>
-#include <xcb/xcb_icccm.h>
-#include "xcb-ewmh.h"
-
-int main(int argc, char* argv[])
-{
-    return 0;
-}
-
-/******************************************************************************/
@@ -1,7 +1,8 @@
 /******************************************************************************/
 /*! \file src/xcb-ostream.cpp
  *
- * Auto-generated ostream operators for many XCB structures.
+ * Auto-generated field descriptor tables and ostream operators for many XCB
+ * structures.
  */
 /*******************************************************************************
  * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
@@ -21,739 +22,1266 @@
  ******************************************************************************/
 
 #include "xcb.h"
+#include "xcb-format.h"
 #include <ostream>
 #include <xcb/xinerama.h>
 #include <xcb/randr.h>
-#include <xcb/xcb_icccm.h>
-#include "xcb-ewmh.h"
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_screen_t
+static constexpr XcbField xcb_screen_fields[] = {
+    XCB_FIELD(xcb_screen_t, root, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, default_colormap, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, white_pixel, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, black_pixel, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, current_input_masks, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, width_in_pixels, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, height_in_pixels, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, width_in_millimeters, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, height_in_millimeters, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, min_installed_maps, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, max_installed_maps, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, root_visual, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, backing_stores, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, save_unders, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, root_depth, UNSIGNED),
+    XCB_FIELD(xcb_screen_t, allowed_depths_len, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_screen_desc =
+    XCB_STRUCT(xcb_screen_t,
+               "xcb_screen",
+               xcb_screen_fields);
+
+//! automatically generated ostream output function for
 //! xcb_screen_t
 std::ostream&
 operator << (std::ostream& os, const xcb_screen_t& s)
 {
-    os << "[xcb_screen:"
-       << " root=" << s.root
-       << " default_colormap=" << s.default_colormap
-       << " white_pixel=" << s.white_pixel
-       << " black_pixel=" << s.black_pixel
-       << " current_input_masks=" << s.current_input_masks
-       << " width_in_pixels=" << s.width_in_pixels
-       << " height_in_pixels=" << s.height_in_pixels
-       << " width_in_millimeters=" << s.width_in_millimeters
-       << " height_in_millimeters=" << s.height_in_millimeters
-       << " min_installed_maps=" << s.min_installed_maps
-       << " max_installed_maps=" << s.max_installed_maps
-       << " root_visual=" << s.root_visual
-       << " backing_stores=" << uint32_t(s.backing_stores)
-       << " save_unders=" << uint32_t(s.save_unders)
-       << " root_depth=" << uint32_t(s.root_depth)
-       << " allowed_depths_len=" << uint32_t(s.allowed_depths_len)
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_screen_desc, &s);
+}
+
+//! automatically generated field descriptors of
+//! xcb_key_press_event_t
+static constexpr XcbField xcb_key_press_event_fields[] = {
+    XCB_FIELD(xcb_key_press_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_key_press_event_t, detail, UNSIGNED),
+    XCB_FIELD(xcb_key_press_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_key_press_event_t, time, UNSIGNED),
+    XCB_FIELD(xcb_key_press_event_t, root, UNSIGNED),
+    XCB_FIELD(xcb_key_press_event_t, event, UNSIGNED),
+    XCB_FIELD(xcb_key_press_event_t, child, UNSIGNED),
+    XCB_FIELD(xcb_key_press_event_t, root_x, SIGNED),
+    XCB_FIELD(xcb_key_press_event_t, root_y, SIGNED),
+    XCB_FIELD(xcb_key_press_event_t, event_x, SIGNED),
+    XCB_FIELD(xcb_key_press_event_t, event_y, SIGNED),
+    XCB_FIELD(xcb_key_press_event_t, state, UNSIGNED),
+    XCB_FIELD(xcb_key_press_event_t, same_screen, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_key_press_event_desc =
+    XCB_STRUCT(xcb_key_press_event_t,
+               "xcb_key_press_event",
+               xcb_key_press_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_key_press_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_key_press_event_t& e)
 {
-    os << "[xcb_key_press_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " detail=" << uint32_t(e.detail)
-       << " sequence=" << e.sequence
-       << " time=" << e.time
-       << " root=" << e.root
-       << " event=" << e.event
-       << " child=" << e.child
-       << " root_x=" << e.root_x
-       << " root_y=" << e.root_y
-       << " event_x=" << e.event_x
-       << " event_y=" << e.event_y
-       << " state=" << e.state
-       << " same_screen=" << uint32_t(e.same_screen)
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_key_press_event_desc, &e);
+}
+
+//! automatically generated field descriptors of
+//! xcb_button_press_event_t
+static constexpr XcbField xcb_button_press_event_fields[] = {
+    XCB_FIELD(xcb_button_press_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_button_press_event_t, detail, UNSIGNED),
+    XCB_FIELD(xcb_button_press_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_button_press_event_t, time, UNSIGNED),
+    XCB_FIELD(xcb_button_press_event_t, root, UNSIGNED),
+    XCB_FIELD(xcb_button_press_event_t, event, UNSIGNED),
+    XCB_FIELD(xcb_button_press_event_t, child, UNSIGNED),
+    XCB_FIELD(xcb_button_press_event_t, root_x, SIGNED),
+    XCB_FIELD(xcb_button_press_event_t, root_y, SIGNED),
+    XCB_FIELD(xcb_button_press_event_t, event_x, SIGNED),
+    XCB_FIELD(xcb_button_press_event_t, event_y, SIGNED),
+    XCB_FIELD(xcb_button_press_event_t, state, UNSIGNED),
+    XCB_FIELD(xcb_button_press_event_t, same_screen, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_button_press_event_desc =
+    XCB_STRUCT(xcb_button_press_event_t,
+               "xcb_button_press_event",
+               xcb_button_press_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_button_press_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_button_press_event_t& e)
 {
-    os << "[xcb_button_press_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " detail=" << e.detail
-       << " sequence=" << e.sequence
-       << " time=" << e.time
-       << " root=" << e.root
-       << " event=" << e.event
-       << " child=" << e.child
-       << " root_x=" << e.root_x
-       << " root_y=" << e.root_y
-       << " event_x=" << e.event_x
-       << " event_y=" << e.event_y
-       << " state=" << e.state
-       << " same_screen=" << uint32_t(e.same_screen)
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_button_press_event_desc, &e);
+}
+
+//! automatically generated field descriptors of
+//! xcb_motion_notify_event_t
+static constexpr XcbField xcb_motion_notify_event_fields[] = {
+    XCB_FIELD(xcb_motion_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_motion_notify_event_t, detail, UNSIGNED),
+    XCB_FIELD(xcb_motion_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_motion_notify_event_t, time, UNSIGNED),
+    XCB_FIELD(xcb_motion_notify_event_t, root, UNSIGNED),
+    XCB_FIELD(xcb_motion_notify_event_t, event, UNSIGNED),
+    XCB_FIELD(xcb_motion_notify_event_t, child, UNSIGNED),
+    XCB_FIELD(xcb_motion_notify_event_t, root_x, SIGNED),
+    XCB_FIELD(xcb_motion_notify_event_t, root_y, SIGNED),
+    XCB_FIELD(xcb_motion_notify_event_t, event_x, SIGNED),
+    XCB_FIELD(xcb_motion_notify_event_t, event_y, SIGNED),
+    XCB_FIELD(xcb_motion_notify_event_t, state, UNSIGNED),
+    XCB_FIELD(xcb_motion_notify_event_t, same_screen, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_motion_notify_event_desc =
+    XCB_STRUCT(xcb_motion_notify_event_t,
+               "xcb_motion_notify_event",
+               xcb_motion_notify_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_motion_notify_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_motion_notify_event_t& e)
 {
-    os << "[xcb_motion_notify_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " detail=" << uint32_t(e.detail)
-       << " sequence=" << e.sequence
-       << " time=" << e.time
-       << " root=" << e.root
-       << " event=" << e.event
-       << " child=" << e.child
-       << " root_x=" << e.root_x
-       << " root_y=" << e.root_y
-       << " event_x=" << e.event_x
-       << " event_y=" << e.event_y
-       << " state=" << e.state
-       << " same_screen=" << uint32_t(e.same_screen)
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_motion_notify_event_desc, &e);
+}
+
+//! automatically generated field descriptors of
+//! xcb_enter_notify_event_t
+static constexpr XcbField xcb_enter_notify_event_fields[] = {
+    XCB_FIELD(xcb_enter_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, detail, UNSIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, time, UNSIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, root, UNSIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, event, UNSIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, child, UNSIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, root_x, SIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, root_y, SIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, event_x, SIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, event_y, SIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, state, UNSIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, mode, UNSIGNED),
+    XCB_FIELD(xcb_enter_notify_event_t, same_screen_focus, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_enter_notify_event_desc =
+    XCB_STRUCT(xcb_enter_notify_event_t,
+               "xcb_enter_notify_event",
+               xcb_enter_notify_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_enter_notify_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_enter_notify_event_t& e)
 {
-    os << "[xcb_enter_notify_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " detail=" << uint32_t(e.detail)
-       << " sequence=" << e.sequence
-       << " time=" << e.time
-       << " root=" << e.root
-       << " event=" << e.event
-       << " child=" << e.child
-       << " root_x=" << e.root_x
-       << " root_y=" << e.root_y
-       << " event_x=" << e.event_x
-       << " event_y=" << e.event_y
-       << " state=" << e.state
-       << " mode=" << uint32_t(e.mode)
-       << " same_screen_focus=" << uint32_t(e.same_screen_focus)
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_enter_notify_event_desc, &e);
+}
+
+//! automatically generated field descriptors of
+//! xcb_focus_in_event_t
+static constexpr XcbField xcb_focus_in_event_fields[] = {
+    XCB_FIELD(xcb_focus_in_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_focus_in_event_t, detail, UNSIGNED),
+    XCB_FIELD(xcb_focus_in_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_focus_in_event_t, event, UNSIGNED),
+    XCB_FIELD(xcb_focus_in_event_t, mode, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_focus_in_event_desc =
+    XCB_STRUCT(xcb_focus_in_event_t,
+               "xcb_focus_in_event",
+               xcb_focus_in_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_focus_in_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_focus_in_event_t& e)
 {
-    os << "[xcb_focus_in_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " detail=" << uint32_t(e.detail)
-       << " sequence=" << e.sequence
-       << " event=" << e.event
-       << " mode=" << uint32_t(e.mode)
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_focus_in_event_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_expose_event_t
+static constexpr XcbField xcb_expose_event_fields[] = {
+    XCB_FIELD(xcb_expose_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_expose_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_expose_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_expose_event_t, x, UNSIGNED),
+    XCB_FIELD(xcb_expose_event_t, y, UNSIGNED),
+    XCB_FIELD(xcb_expose_event_t, width, UNSIGNED),
+    XCB_FIELD(xcb_expose_event_t, height, UNSIGNED),
+    XCB_FIELD(xcb_expose_event_t, count, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_expose_event_desc =
+    XCB_STRUCT(xcb_expose_event_t,
+               "xcb_expose_event",
+               xcb_expose_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_expose_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_expose_event_t& e)
 {
-    os << "[xcb_expose_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " window=" << e.window
-       << " x=" << e.x
-       << " y=" << e.y
-       << " width=" << e.width
-       << " height=" << e.height
-       << " count=" << e.count
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_expose_event_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_graphics_exposure_event_t
+static constexpr XcbField xcb_graphics_exposure_event_fields[] = {
+    XCB_FIELD(xcb_graphics_exposure_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_graphics_exposure_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_graphics_exposure_event_t, drawable, UNSIGNED),
+    XCB_FIELD(xcb_graphics_exposure_event_t, x, UNSIGNED),
+    XCB_FIELD(xcb_graphics_exposure_event_t, y, UNSIGNED),
+    XCB_FIELD(xcb_graphics_exposure_event_t, width, UNSIGNED),
+    XCB_FIELD(xcb_graphics_exposure_event_t, height, UNSIGNED),
+    XCB_FIELD(xcb_graphics_exposure_event_t, minor_opcode, UNSIGNED),
+    XCB_FIELD(xcb_graphics_exposure_event_t, count, UNSIGNED),
+    XCB_FIELD(xcb_graphics_exposure_event_t, major_opcode, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_graphics_exposure_event_desc =
+    XCB_STRUCT(xcb_graphics_exposure_event_t,
+               "xcb_graphics_exposure_event",
+               xcb_graphics_exposure_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_graphics_exposure_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_graphics_exposure_event_t& e)
 {
-    os << "[xcb_graphics_exposure_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " drawable=" << e.drawable
-       << " x=" << e.x
-       << " y=" << e.y
-       << " width=" << e.width
-       << " height=" << e.height
-       << " minor_opcode=" << e.minor_opcode
-       << " count=" << e.count
-       << " major_opcode=" << uint32_t(e.major_opcode)
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_graphics_exposure_event_desc, &e);
+}
+
+//! automatically generated field descriptors of
+//! xcb_no_exposure_event_t
+static constexpr XcbField xcb_no_exposure_event_fields[] = {
+    XCB_FIELD(xcb_no_exposure_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_no_exposure_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_no_exposure_event_t, drawable, UNSIGNED),
+    XCB_FIELD(xcb_no_exposure_event_t, minor_opcode, UNSIGNED),
+    XCB_FIELD(xcb_no_exposure_event_t, major_opcode, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_no_exposure_event_desc =
+    XCB_STRUCT(xcb_no_exposure_event_t,
+               "xcb_no_exposure_event",
+               xcb_no_exposure_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_no_exposure_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_no_exposure_event_t& e)
 {
-    os << "[xcb_no_exposure_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " drawable=" << e.drawable
-       << " minor_opcode=" << e.minor_opcode
-       << " major_opcode=" << uint32_t(e.major_opcode)
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_no_exposure_event_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_visibility_notify_event_t
+static constexpr XcbField xcb_visibility_notify_event_fields[] = {
+    XCB_FIELD(xcb_visibility_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_visibility_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_visibility_notify_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_visibility_notify_event_t, state, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_visibility_notify_event_desc =
+    XCB_STRUCT(xcb_visibility_notify_event_t,
+               "xcb_visibility_notify_event",
+               xcb_visibility_notify_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_visibility_notify_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_visibility_notify_event_t& e)
 {
-    os << "[xcb_visibility_notify_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " window=" << e.window
-       << " state=" << uint32_t(e.state)
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_visibility_notify_event_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_create_notify_event_t
+static constexpr XcbField xcb_create_notify_event_fields[] = {
+    XCB_FIELD(xcb_create_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_create_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_create_notify_event_t, parent, UNSIGNED),
+    XCB_FIELD(xcb_create_notify_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_create_notify_event_t, x, SIGNED),
+    XCB_FIELD(xcb_create_notify_event_t, y, SIGNED),
+    XCB_FIELD(xcb_create_notify_event_t, width, UNSIGNED),
+    XCB_FIELD(xcb_create_notify_event_t, height, UNSIGNED),
+    XCB_FIELD(xcb_create_notify_event_t, border_width, UNSIGNED),
+    XCB_FIELD(xcb_create_notify_event_t, override_redirect, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_create_notify_event_desc =
+    XCB_STRUCT(xcb_create_notify_event_t,
+               "xcb_create_notify_event",
+               xcb_create_notify_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_create_notify_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_create_notify_event_t& e)
 {
-    os << "[xcb_create_notify_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " parent=" << e.parent
-       << " window=" << e.window
-       << " x=" << e.x
-       << " y=" << e.y
-       << " width=" << e.width
-       << " height=" << e.height
-       << " border_width=" << e.border_width
-       << " override_redirect=" << uint32_t(e.override_redirect)
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_create_notify_event_desc, &e);
+}
+
+//! automatically generated field descriptors of
+//! xcb_destroy_notify_event_t
+static constexpr XcbField xcb_destroy_notify_event_fields[] = {
+    XCB_FIELD(xcb_destroy_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_destroy_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_destroy_notify_event_t, event, UNSIGNED),
+    XCB_FIELD(xcb_destroy_notify_event_t, window, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_destroy_notify_event_desc =
+    XCB_STRUCT(xcb_destroy_notify_event_t,
+               "xcb_destroy_notify_event",
+               xcb_destroy_notify_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_destroy_notify_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_destroy_notify_event_t& e)
 {
-    os << "[xcb_destroy_notify_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " event=" << e.event
-       << " window=" << e.window
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_destroy_notify_event_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_unmap_notify_event_t
+static constexpr XcbField xcb_unmap_notify_event_fields[] = {
+    XCB_FIELD(xcb_unmap_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_unmap_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_unmap_notify_event_t, event, UNSIGNED),
+    XCB_FIELD(xcb_unmap_notify_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_unmap_notify_event_t, from_configure, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_unmap_notify_event_desc =
+    XCB_STRUCT(xcb_unmap_notify_event_t,
+               "xcb_unmap_notify_event",
+               xcb_unmap_notify_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_unmap_notify_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_unmap_notify_event_t& e)
 {
-    os << "[xcb_unmap_notify_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " event=" << e.event
-       << " window=" << e.window
-       << " from_configure=" << uint32_t(e.from_configure)
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_unmap_notify_event_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_map_notify_event_t
+static constexpr XcbField xcb_map_notify_event_fields[] = {
+    XCB_FIELD(xcb_map_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_map_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_map_notify_event_t, event, UNSIGNED),
+    XCB_FIELD(xcb_map_notify_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_map_notify_event_t, override_redirect, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_map_notify_event_desc =
+    XCB_STRUCT(xcb_map_notify_event_t,
+               "xcb_map_notify_event",
+               xcb_map_notify_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_map_notify_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_map_notify_event_t& e)
 {
-    os << "[xcb_map_notify_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " event=" << e.event
-       << " window=" << e.window
-       << " override_redirect=" << uint32_t(e.override_redirect)
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_map_notify_event_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_map_request_event_t
+static constexpr XcbField xcb_map_request_event_fields[] = {
+    XCB_FIELD(xcb_map_request_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_map_request_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_map_request_event_t, parent, UNSIGNED),
+    XCB_FIELD(xcb_map_request_event_t, window, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_map_request_event_desc =
+    XCB_STRUCT(xcb_map_request_event_t,
+               "xcb_map_request_event",
+               xcb_map_request_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_map_request_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_map_request_event_t& e)
 {
-    os << "[xcb_map_request_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " parent=" << e.parent
-       << " window=" << e.window
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_map_request_event_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_reparent_notify_event_t
+static constexpr XcbField xcb_reparent_notify_event_fields[] = {
+    XCB_FIELD(xcb_reparent_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_reparent_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_reparent_notify_event_t, event, UNSIGNED),
+    XCB_FIELD(xcb_reparent_notify_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_reparent_notify_event_t, parent, UNSIGNED),
+    XCB_FIELD(xcb_reparent_notify_event_t, x, SIGNED),
+    XCB_FIELD(xcb_reparent_notify_event_t, y, SIGNED),
+    XCB_FIELD(xcb_reparent_notify_event_t, override_redirect, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_reparent_notify_event_desc =
+    XCB_STRUCT(xcb_reparent_notify_event_t,
+               "xcb_reparent_notify_event",
+               xcb_reparent_notify_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_reparent_notify_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_reparent_notify_event_t& e)
 {
-    os << "[xcb_reparent_notify_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " event=" << e.event
-       << " window=" << e.window
-       << " parent=" << e.parent
-       << " x=" << e.x
-       << " y=" << e.y
-       << " override_redirect=" << uint32_t(e.override_redirect)
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_reparent_notify_event_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_configure_notify_event_t
+static constexpr XcbField xcb_configure_notify_event_fields[] = {
+    XCB_FIELD(xcb_configure_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_configure_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_configure_notify_event_t, event, UNSIGNED),
+    XCB_FIELD(xcb_configure_notify_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_configure_notify_event_t, above_sibling, UNSIGNED),
+    XCB_FIELD(xcb_configure_notify_event_t, x, SIGNED),
+    XCB_FIELD(xcb_configure_notify_event_t, y, SIGNED),
+    XCB_FIELD(xcb_configure_notify_event_t, width, UNSIGNED),
+    XCB_FIELD(xcb_configure_notify_event_t, height, UNSIGNED),
+    XCB_FIELD(xcb_configure_notify_event_t, border_width, UNSIGNED),
+    XCB_FIELD(xcb_configure_notify_event_t, override_redirect, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_configure_notify_event_desc =
+    XCB_STRUCT(xcb_configure_notify_event_t,
+               "xcb_configure_notify_event",
+               xcb_configure_notify_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_configure_notify_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_configure_notify_event_t& e)
 {
-    os << "[xcb_configure_notify_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " event=" << e.event
-       << " window=" << e.window
-       << " above_sibling=" << e.above_sibling
-       << " x=" << e.x
-       << " y=" << e.y
-       << " width=" << e.width
-       << " height=" << e.height
-       << " border_width=" << e.border_width
-       << " override_redirect=" << uint32_t(e.override_redirect)
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_configure_notify_event_desc, &e);
+}
+
+//! automatically generated field descriptors of
+//! xcb_circulate_notify_event_t
+static constexpr XcbField xcb_circulate_notify_event_fields[] = {
+    XCB_FIELD(xcb_circulate_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_circulate_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_circulate_notify_event_t, event, UNSIGNED),
+    XCB_FIELD(xcb_circulate_notify_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_circulate_notify_event_t, place, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_circulate_notify_event_desc =
+    XCB_STRUCT(xcb_circulate_notify_event_t,
+               "xcb_circulate_notify_event",
+               xcb_circulate_notify_event_fields);
+
+//! automatically generated ostream output function for
+//! xcb_circulate_notify_event_t
+std::ostream&
+operator << (std::ostream& os, const xcb_circulate_notify_event_t& e)
+{
+    return xcb_format_ostream(os, xcb_circulate_notify_event_desc, &e);
+}
+
+//! automatically generated field descriptors of
+//! xcb_configure_request_event_t
+static constexpr XcbField xcb_configure_request_event_fields[] = {
+    XCB_FIELD(xcb_configure_request_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_configure_request_event_t, stack_mode, UNSIGNED),
+    XCB_FIELD(xcb_configure_request_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_configure_request_event_t, parent, UNSIGNED),
+    XCB_FIELD(xcb_configure_request_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_configure_request_event_t, sibling, UNSIGNED),
+    XCB_FIELD(xcb_configure_request_event_t, x, SIGNED),
+    XCB_FIELD(xcb_configure_request_event_t, y, SIGNED),
+    XCB_FIELD(xcb_configure_request_event_t, width, UNSIGNED),
+    XCB_FIELD(xcb_configure_request_event_t, height, UNSIGNED),
+    XCB_FIELD(xcb_configure_request_event_t, border_width, UNSIGNED),
+    XCB_FIELD(xcb_configure_request_event_t, value_mask, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_configure_request_event_desc =
+    XCB_STRUCT(xcb_configure_request_event_t,
+               "xcb_configure_request_event",
+               xcb_configure_request_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_configure_request_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_configure_request_event_t& e)
 {
-    os << "[xcb_configure_request_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " stack_mode=" << uint32_t(e.stack_mode)
-       << " sequence=" << e.sequence
-       << " parent=" << e.parent
-       << " window=" << e.window
-       << " sibling=" << e.sibling
-       << " x=" << e.x
-       << " y=" << e.y
-       << " width=" << e.width
-       << " height=" << e.height
-       << " border_width=" << e.border_width
-       << " value_mask=" << e.value_mask
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_configure_request_event_desc, &e);
+}
+
+//! automatically generated field descriptors of
+//! xcb_property_notify_event_t
+static constexpr XcbField xcb_property_notify_event_fields[] = {
+    XCB_FIELD(xcb_property_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_property_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_property_notify_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_property_notify_event_t, atom, ATOM),
+    XCB_FIELD(xcb_property_notify_event_t, time, UNSIGNED),
+    XCB_FIELD(xcb_property_notify_event_t, state, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_property_notify_event_desc =
+    XCB_STRUCT(xcb_property_notify_event_t,
+               "xcb_property_notify_event",
+               xcb_property_notify_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_property_notify_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_property_notify_event_t& e)
 {
-    os << "[xcb_property_notify_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " window=" << e.window
-       << " atom=" << AtomFormatter(e.atom)
-       << " time=" << e.time
-       << " state=" << uint32_t(e.state)
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_property_notify_event_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_client_message_event_t
+static constexpr XcbField xcb_client_message_event_fields[] = {
+    XCB_FIELD(xcb_client_message_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_client_message_event_t, format, UNSIGNED),
+    XCB_FIELD(xcb_client_message_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_client_message_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_client_message_event_t, type, ATOM),
+    XCB_FIELD(xcb_client_message_event_t, data, BYTES)
+};
+
+static constexpr XcbStruct xcb_client_message_event_desc =
+    XCB_STRUCT(xcb_client_message_event_t,
+               "xcb_client_message_event",
+               xcb_client_message_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_client_message_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_client_message_event_t& e)
 {
-    os << "[xcb_client_message_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " format=" << uint32_t(e.format)
-       << " sequence=" << e.sequence
-       << " window=" << e.window
-       << " type=" << AtomFormatter(e.type)
-       << " data=" << e.data
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_client_message_event_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_mapping_notify_event_t
+static constexpr XcbField xcb_mapping_notify_event_fields[] = {
+    XCB_FIELD(xcb_mapping_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_mapping_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_mapping_notify_event_t, request, UNSIGNED),
+    XCB_FIELD(xcb_mapping_notify_event_t, first_keycode, UNSIGNED),
+    XCB_FIELD(xcb_mapping_notify_event_t, count, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_mapping_notify_event_desc =
+    XCB_STRUCT(xcb_mapping_notify_event_t,
+               "xcb_mapping_notify_event",
+               xcb_mapping_notify_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_mapping_notify_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_mapping_notify_event_t& e)
 {
-    os << "[xcb_mapping_notify_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " request=" << uint32_t(e.request)
-       << " first_keycode=" << uint32_t(e.first_keycode)
-       << " count=" << uint32_t(e.count)
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_mapping_notify_event_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_query_extension_reply_t
+static constexpr XcbField xcb_query_extension_reply_fields[] = {
+    XCB_FIELD(xcb_query_extension_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_query_extension_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_query_extension_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_query_extension_reply_t, present, UNSIGNED),
+    XCB_FIELD(xcb_query_extension_reply_t, major_opcode, UNSIGNED),
+    XCB_FIELD(xcb_query_extension_reply_t, first_event, UNSIGNED),
+    XCB_FIELD(xcb_query_extension_reply_t, first_error, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_query_extension_reply_desc =
+    XCB_STRUCT(xcb_query_extension_reply_t,
+               "xcb_query_extension_reply",
+               xcb_query_extension_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_query_extension_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_query_extension_reply_t& e)
 {
-    os << "[xcb_query_extension_reply:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " sequence=" << e.sequence
-       << " length=" << e.length
-       << " present=" << uint32_t(e.present)
-       << " major_opcode=" << uint32_t(e.major_opcode)
-       << " first_event=" << uint32_t(e.first_event)
-       << " first_error=" << uint32_t(e.first_error)
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_query_extension_reply_desc, &e);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_get_property_reply_t
+static constexpr XcbField xcb_get_property_reply_fields[] = {
+    XCB_FIELD(xcb_get_property_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_get_property_reply_t, format, UNSIGNED),
+    XCB_FIELD(xcb_get_property_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_get_property_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_get_property_reply_t, type, ATOM),
+    XCB_FIELD(xcb_get_property_reply_t, bytes_after, UNSIGNED),
+    XCB_FIELD(xcb_get_property_reply_t, value_len, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_get_property_reply_desc =
+    XCB_STRUCT(xcb_get_property_reply_t,
+               "xcb_get_property_reply",
+               xcb_get_property_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_get_property_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_get_property_reply_t& p)
 {
-    os << "[xcb_get_property_reply:"
-       << " response_type=" << uint32_t(p.response_type)
-       << " format=" << uint32_t(p.format)
-       << " sequence=" << p.sequence
-       << " length=" << p.length
-       << " type=" << AtomFormatter(p.type)
-       << " bytes_after=" << p.bytes_after
-       << " value_len=" << p.value_len
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_get_property_reply_desc, &p);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_get_window_attributes_reply_t
+static constexpr XcbField xcb_get_window_attributes_reply_fields[] = {
+    XCB_FIELD(xcb_get_window_attributes_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, backing_store, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, visual, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, _class, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, bit_gravity, GRAVITY),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, win_gravity, GRAVITY),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, backing_planes, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, backing_pixel, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, save_under, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, map_is_installed, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, map_state, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, override_redirect, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, colormap, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, all_event_masks, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t, your_event_mask, UNSIGNED),
+    XCB_FIELD(xcb_get_window_attributes_reply_t,
+              do_not_propagate_mask, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_get_window_attributes_reply_desc =
+    XCB_STRUCT(xcb_get_window_attributes_reply_t,
+               "xcb_get_window_attributes_reply",
+               xcb_get_window_attributes_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_get_window_attributes_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_get_window_attributes_reply_t& a)
 {
-    os << "[xcb_get_window_attributes_reply:"
-       << " response_type=" << uint32_t(a.response_type)
-       << " backing_store=" << uint32_t(a.backing_store)
-       << " sequence=" << a.sequence
-       << " length=" << a.length
-       << " visual=" << a.visual
-       << " _class=" << a._class
-       << " bit_gravity=" << uint32_t(a.bit_gravity)
-       << " win_gravity=" << uint32_t(a.win_gravity)
-       << " backing_planes=" << a.backing_planes
-       << " backing_pixel=" << a.backing_pixel
-       << " save_under=" << uint32_t(a.save_under)
-       << " map_is_installed=" << uint32_t(a.map_is_installed)
-       << " map_state=" << uint32_t(a.map_state)
-       << " override_redirect=" << uint32_t(a.override_redirect)
-       << " colormap=" << a.colormap
-       << " all_event_masks=" << a.all_event_masks
-       << " your_event_mask=" << a.your_event_mask
-       << " do_not_propagate_mask=" << a.do_not_propagate_mask
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_get_window_attributes_reply_desc, &a);
+}
+
+//! automatically generated field descriptors of
+//! xcb_get_geometry_reply_t
+static constexpr XcbField xcb_get_geometry_reply_fields[] = {
+    XCB_FIELD(xcb_get_geometry_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_get_geometry_reply_t, depth, UNSIGNED),
+    XCB_FIELD(xcb_get_geometry_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_get_geometry_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_get_geometry_reply_t, root, UNSIGNED),
+    XCB_FIELD(xcb_get_geometry_reply_t, x, SIGNED),
+    XCB_FIELD(xcb_get_geometry_reply_t, y, SIGNED),
+    XCB_FIELD(xcb_get_geometry_reply_t, width, UNSIGNED),
+    XCB_FIELD(xcb_get_geometry_reply_t, height, UNSIGNED),
+    XCB_FIELD(xcb_get_geometry_reply_t, border_width, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_get_geometry_reply_desc =
+    XCB_STRUCT(xcb_get_geometry_reply_t,
+               "xcb_get_geometry_reply",
+               xcb_get_geometry_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_get_geometry_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_get_geometry_reply_t& g)
 {
-    os << "[xcb_get_geometry_reply:"
-       << " response_type=" << uint32_t(g.response_type)
-       << " depth=" << uint32_t(g.depth)
-       << " sequence=" << g.sequence
-       << " length=" << g.length
-       << " root=" << g.root
-       << " x=" << g.x
-       << " y=" << g.y
-       << " width=" << g.width
-       << " height=" << g.height
-       << " border_width=" << g.border_width
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_get_geometry_reply_desc, &g);
 }
 
-//! automaticatically generated ostream output function for
-//! xcb_icccm_get_wm_class_reply_t
-std::ostream&
-operator << (std::ostream& os, const xcb_icccm_get_wm_class_reply_t& i)
-{
-    os << "[xcb_icccm_get_wm_class_reply:"
-       << " instance_name=" << i.instance_name
-       << " class_name=" << i.class_name
-       << " _reply=" << i._reply
-       << "]";
-    return os;
-}
+//! automatically generated field descriptors of
+//! xcb_get_modifier_mapping_reply_t
+static constexpr XcbField xcb_get_modifier_mapping_reply_fields[] = {
+    XCB_FIELD(xcb_get_modifier_mapping_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_get_modifier_mapping_reply_t,
+              keycodes_per_modifier, UNSIGNED),
+    XCB_FIELD(xcb_get_modifier_mapping_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_get_modifier_mapping_reply_t, length, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_get_modifier_mapping_reply_desc =
+    XCB_STRUCT(xcb_get_modifier_mapping_reply_t,
+               "xcb_get_modifier_mapping_reply",
+               xcb_get_modifier_mapping_reply_fields);
 
-//! automaticatically generated ostream output function for
+//! automatically generated ostream output function for
 //! xcb_get_modifier_mapping_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_get_modifier_mapping_reply_t& m)
 {
-    os << "[xcb_get_modifier_mapping_reply:"
-       << " response_type=" << uint32_t(m.response_type)
-       << " keycodes_per_modifier=" << uint32_t(m.keycodes_per_modifier)
-       << " sequence=" << m.sequence
-       << " length=" << m.length
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_get_modifier_mapping_reply_desc, &m);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_alloc_color_reply_t
+static constexpr XcbField xcb_alloc_color_reply_fields[] = {
+    XCB_FIELD(xcb_alloc_color_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_alloc_color_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_alloc_color_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_alloc_color_reply_t, red, UNSIGNED),
+    XCB_FIELD(xcb_alloc_color_reply_t, green, UNSIGNED),
+    XCB_FIELD(xcb_alloc_color_reply_t, blue, UNSIGNED),
+    XCB_FIELD(xcb_alloc_color_reply_t, pixel, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_alloc_color_reply_desc =
+    XCB_STRUCT(xcb_alloc_color_reply_t,
+               "xcb_alloc_color_reply",
+               xcb_alloc_color_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_alloc_color_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_alloc_color_reply_t& c)
 {
-    os << "[xcb_alloc_color_reply:"
-       << " response_type=" << uint32_t(c.response_type)
-       << " sequence=" << c.sequence
-       << " length=" << c.length
-       << " red=" << c.red
-       << " green=" << c.green
-       << " blue=" << c.blue
-       << " pixel=" << c.pixel
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_alloc_color_reply_desc, &c);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_query_tree_reply_t
+static constexpr XcbField xcb_query_tree_reply_fields[] = {
+    XCB_FIELD(xcb_query_tree_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_query_tree_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_query_tree_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_query_tree_reply_t, root, UNSIGNED),
+    XCB_FIELD(xcb_query_tree_reply_t, parent, UNSIGNED),
+    XCB_FIELD(xcb_query_tree_reply_t, children_len, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_query_tree_reply_desc =
+    XCB_STRUCT(xcb_query_tree_reply_t,
+               "xcb_query_tree_reply",
+               xcb_query_tree_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_query_tree_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_query_tree_reply_t& q)
 {
-    os << "[xcb_query_tree_reply:"
-       << " response_type=" << uint32_t(q.response_type)
-       << " sequence=" << q.sequence
-       << " length=" << q.length
-       << " root=" << q.root
-       << " parent=" << q.parent
-       << " children_len=" << q.children_len
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
-//! ewmh_strut_t
-std::ostream&
-operator << (std::ostream& os, const struct ewmh_strut_t& q)
-{
-    os << "[ewmh_strut:"
-       << " valid=" << q.valid
-       << " left=" << q.left
-       << " right=" << q.right
-       << " top=" << q.top
-       << " bottom=" << q.bottom
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
-//! ewmh_strut_partial_t
-std::ostream&
-operator << (std::ostream& os, const struct ewmh_strut_partial_t& q)
-{
-    os << "[ewmh_strut_partial:"
-       << " valid=" << q.valid
-       << " left=" << q.left
-       << " right=" << q.right
-       << " top=" << q.top
-       << " bottom=" << q.bottom
-       << " left_start_y=" << q.left_start_y
-       << " left_end_y=" << q.left_end_y
-       << " right_start_y=" << q.right_start_y
-       << " right_end_y=" << q.right_end_y
-       << " top_start_x=" << q.top_start_x
-       << " top_end_x=" << q.top_end_x
-       << " bottom_start_x=" << q.bottom_start_x
-       << " bottom_end_x=" << q.bottom_end_x
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_query_tree_reply_desc, &q);
+}
+
+//! automatically generated field descriptors of
+//! xcb_get_input_focus_reply_t
+static constexpr XcbField xcb_get_input_focus_reply_fields[] = {
+    XCB_FIELD(xcb_get_input_focus_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_get_input_focus_reply_t, revert_to, UNSIGNED),
+    XCB_FIELD(xcb_get_input_focus_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_get_input_focus_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_get_input_focus_reply_t, focus, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_get_input_focus_reply_desc =
+    XCB_STRUCT(xcb_get_input_focus_reply_t,
+               "xcb_get_input_focus_reply",
+               xcb_get_input_focus_reply_fields);
+
+//! automatically generated ostream output function for
+//! xcb_get_input_focus_reply_t
+std::ostream&
+operator << (std::ostream& os, const xcb_get_input_focus_reply_t& f)
+{
+    return xcb_format_ostream(os, xcb_get_input_focus_reply_desc, &f);
+}
+
+//! automatically generated field descriptors of
+//! xcb_grab_pointer_reply_t
+static constexpr XcbField xcb_grab_pointer_reply_fields[] = {
+    XCB_FIELD(xcb_grab_pointer_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_grab_pointer_reply_t, status, UNSIGNED),
+    XCB_FIELD(xcb_grab_pointer_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_grab_pointer_reply_t, length, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_grab_pointer_reply_desc =
+    XCB_STRUCT(xcb_grab_pointer_reply_t,
+               "xcb_grab_pointer_reply",
+               xcb_grab_pointer_reply_fields);
+
+//! automatically generated ostream output function for
+//! xcb_grab_pointer_reply_t
+std::ostream&
+operator << (std::ostream& os, const xcb_grab_pointer_reply_t& g)
+{
+    return xcb_format_ostream(os, xcb_grab_pointer_reply_desc, &g);
+}
+
+//! automatically generated field descriptors of
+//! xcb_intern_atom_reply_t
+static constexpr XcbField xcb_intern_atom_reply_fields[] = {
+    XCB_FIELD(xcb_intern_atom_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_intern_atom_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_intern_atom_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_intern_atom_reply_t, atom, ATOM)
+};
+
+static constexpr XcbStruct xcb_intern_atom_reply_desc =
+    XCB_STRUCT(xcb_intern_atom_reply_t,
+               "xcb_intern_atom_reply",
+               xcb_intern_atom_reply_fields);
+
+//! automatically generated ostream output function for
+//! xcb_intern_atom_reply_t
+std::ostream&
+operator << (std::ostream& os, const xcb_intern_atom_reply_t& i)
+{
+    return xcb_format_ostream(os, xcb_intern_atom_reply_desc, &i);
+}
+
+//! automatically generated field descriptors of
+//! xcb_get_atom_name_reply_t
+static constexpr XcbField xcb_get_atom_name_reply_fields[] = {
+    XCB_FIELD(xcb_get_atom_name_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_get_atom_name_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_get_atom_name_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_get_atom_name_reply_t, name_len, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_get_atom_name_reply_desc =
+    XCB_STRUCT(xcb_get_atom_name_reply_t,
+               "xcb_get_atom_name_reply",
+               xcb_get_atom_name_reply_fields);
+
+//! automatically generated ostream output function for
+//! xcb_get_atom_name_reply_t
+std::ostream&
+operator << (std::ostream& os, const xcb_get_atom_name_reply_t& a)
+{
+    return xcb_format_ostream(os, xcb_get_atom_name_reply_desc, &a);
+}
+
+//! automatically generated field descriptors of
+//! xcb_xinerama_is_active_reply_t
+static constexpr XcbField xcb_xinerama_is_active_reply_fields[] = {
+    XCB_FIELD(xcb_xinerama_is_active_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_xinerama_is_active_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_xinerama_is_active_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_xinerama_is_active_reply_t, state, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_xinerama_is_active_reply_desc =
+    XCB_STRUCT(xcb_xinerama_is_active_reply_t,
+               "xcb_xinerama_is_active_reply",
+               xcb_xinerama_is_active_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_xinerama_is_active_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_xinerama_is_active_reply_t& x)
 {
-    os << "[xcb_xinerama_is_active_reply:"
-       << " response_type=" << uint32_t(x.response_type)
-       << " sequence=" << x.sequence
-       << " length=" << x.length
-       << " state=" << x.state
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_xinerama_is_active_reply_desc, &x);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_xinerama_query_screens_reply_t
+static constexpr XcbField xcb_xinerama_query_screens_reply_fields[] = {
+    XCB_FIELD(xcb_xinerama_query_screens_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_xinerama_query_screens_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_xinerama_query_screens_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_xinerama_query_screens_reply_t, number, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_xinerama_query_screens_reply_desc =
+    XCB_STRUCT(xcb_xinerama_query_screens_reply_t,
+               "xcb_xinerama_query_screens_reply",
+               xcb_xinerama_query_screens_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_xinerama_query_screens_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_xinerama_query_screens_reply_t& x)
 {
-    os << "[xcb_xinerama_query_screens_reply:"
-       << " response_type=" << uint32_t(x.response_type)
-       << " sequence=" << x.sequence
-       << " length=" << x.length
-       << " number=" << x.number
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_xinerama_query_screens_reply_desc, &x);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_xinerama_screen_info_t
+static constexpr XcbField xcb_xinerama_screen_info_fields[] = {
+    XCB_FIELD(xcb_xinerama_screen_info_t, x_org, SIGNED),
+    XCB_FIELD(xcb_xinerama_screen_info_t, y_org, SIGNED),
+    XCB_FIELD(xcb_xinerama_screen_info_t, width, UNSIGNED),
+    XCB_FIELD(xcb_xinerama_screen_info_t, height, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_xinerama_screen_info_desc =
+    XCB_STRUCT(xcb_xinerama_screen_info_t,
+               "xcb_xinerama_screen_info",
+               xcb_xinerama_screen_info_fields);
+
+//! automatically generated ostream output function for
 //! xcb_xinerama_screen_info_t
 std::ostream&
 operator << (std::ostream& os, const xcb_xinerama_screen_info_t& x)
 {
-    os << "[xcb_xinerama_screen_info:"
-       << " x_org=" << x.x_org
-       << " y_org=" << x.y_org
-       << " width=" << x.width
-       << " height=" << x.height
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_xinerama_screen_info_desc, &x);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_randr_query_version_reply_t
+static constexpr XcbField xcb_randr_query_version_reply_fields[] = {
+    XCB_FIELD(xcb_randr_query_version_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_randr_query_version_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_randr_query_version_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_randr_query_version_reply_t, major_version, UNSIGNED),
+    XCB_FIELD(xcb_randr_query_version_reply_t, minor_version, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_randr_query_version_reply_desc =
+    XCB_STRUCT(xcb_randr_query_version_reply_t,
+               "xcb_randr_query_version_reply",
+               xcb_randr_query_version_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_randr_query_version_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_randr_query_version_reply_t& r)
 {
-    os << "[xcb_randr_query_version_reply:"
-       << " response_type=" << uint32_t(r.response_type)
-       << " sequence=" << r.sequence
-       << " length=" << r.length
-       << " major_version=" << r.major_version
-       << " minor_version=" << r.minor_version
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_randr_query_version_reply_desc, &r);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_randr_get_crtc_info_reply_t
+static constexpr XcbField xcb_randr_get_crtc_info_reply_fields[] = {
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, status, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, timestamp, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, x, SIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, y, SIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, width, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, height, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, mode, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, rotation, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, rotations, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, num_outputs, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_crtc_info_reply_t, num_possible_outputs, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_randr_get_crtc_info_reply_desc =
+    XCB_STRUCT(xcb_randr_get_crtc_info_reply_t,
+               "xcb_randr_get_crtc_info_reply",
+               xcb_randr_get_crtc_info_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_randr_get_crtc_info_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_randr_get_crtc_info_reply_t& r)
 {
-    os << "[xcb_randr_get_crtc_info_reply:"
-       << " response_type=" << uint32_t(r.response_type)
-       << " status=" << uint32_t(r.status)
-       << " sequence=" << r.sequence
-       << " length=" << r.length
-       << " timestamp=" << r.timestamp
-       << " x=" << r.x
-       << " y=" << r.y
-       << " width=" << r.width
-       << " height=" << r.height
-       << " mode=" << r.mode
-       << " rotation=" << r.rotation
-       << " rotations=" << r.rotations
-       << " num_outputs=" << r.num_outputs
-       << " num_possible_outputs=" << r.num_possible_outputs
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_randr_get_crtc_info_reply_desc, &r);
+}
+
+//! automatically generated field descriptors of
+//! xcb_randr_get_output_primary_reply_t
+static constexpr XcbField xcb_randr_get_output_primary_reply_fields[] = {
+    XCB_FIELD(xcb_randr_get_output_primary_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_primary_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_primary_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_primary_reply_t, output, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_randr_get_output_primary_reply_desc =
+    XCB_STRUCT(xcb_randr_get_output_primary_reply_t,
+               "xcb_randr_get_output_primary_reply",
+               xcb_randr_get_output_primary_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_randr_get_output_primary_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_randr_get_output_primary_reply_t& r)
 {
-    os << "[xcb_randr_get_output_primary_reply:"
-       << " response_type=" << uint32_t(r.response_type)
-       << " sequence=" << r.sequence
-       << " length=" << r.length
-       << " output=" << r.output
-       << "]";
-    return os;
+    return xcb_format_ostream(os, xcb_randr_get_output_primary_reply_desc, &r);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_randr_get_screen_resources_current_reply_t
+static constexpr XcbField
+    xcb_randr_get_screen_resources_current_reply_fields[] = {
+    XCB_FIELD(xcb_randr_get_screen_resources_current_reply_t,
+              response_type, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_screen_resources_current_reply_t,
+              sequence, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_screen_resources_current_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_screen_resources_current_reply_t,
+              timestamp, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_screen_resources_current_reply_t,
+              config_timestamp, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_screen_resources_current_reply_t,
+              num_crtcs, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_screen_resources_current_reply_t,
+              num_outputs, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_screen_resources_current_reply_t,
+              num_modes, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_screen_resources_current_reply_t,
+              names_len, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_randr_get_screen_resources_current_reply_desc =
+    XCB_STRUCT(xcb_randr_get_screen_resources_current_reply_t,
+               "xcb_randr_get_screen_resources_current_reply",
+               xcb_randr_get_screen_resources_current_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_randr_get_screen_resources_current_reply_t
 std::ostream&
-operator << (std::ostream& os, const xcb_randr_get_screen_resources_current_reply_t& r)
+operator << (std::ostream& os,
+             const xcb_randr_get_screen_resources_current_reply_t& r)
 {
-    os << "[xcb_randr_get_screen_resources_current_reply:"
-       << " response_type=" << uint32_t(r.response_type)
-       << " sequence=" << r.sequence
-       << " length=" << r.length
-       << " timestamp=" << r.timestamp
-       << " config_timestamp=" << r.config_timestamp
-       << " num_crtcs=" << r.num_crtcs
-       << " num_outputs=" << r.num_outputs
-       << " num_modes=" << r.num_modes
-       << " names_len=" << r.names_len
-       << "]";
-    return os;
+    return xcb_format_ostream(
+        os, xcb_randr_get_screen_resources_current_reply_desc, &r);
 }
 
-//! automaticatically generated ostream output function for
+//! automatically generated field descriptors of
+//! xcb_randr_get_output_info_reply_t
+static constexpr XcbField xcb_randr_get_output_info_reply_fields[] = {
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, status, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, length, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, timestamp, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, crtc, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, mm_width, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, mm_height, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, connection, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, subpixel_order, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, num_crtcs, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, num_modes, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, num_preferred, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, num_clones, UNSIGNED),
+    XCB_FIELD(xcb_randr_get_output_info_reply_t, name_len, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_randr_get_output_info_reply_desc =
+    XCB_STRUCT(xcb_randr_get_output_info_reply_t,
+               "xcb_randr_get_output_info_reply",
+               xcb_randr_get_output_info_reply_fields);
+
+//! automatically generated ostream output function for
 //! xcb_randr_get_output_info_reply_t
 std::ostream&
 operator << (std::ostream& os, const xcb_randr_get_output_info_reply_t& r)
 {
-    os << "[xcb_randr_get_output_info_reply:"
-       << " response_type=" << uint32_t(r.response_type)
-       << " status=" << uint32_t(r.status)
-       << " sequence=" << r.sequence
-       << " length=" << r.length
-       << " timestamp=" << r.timestamp
-       << " crtc=" << r.crtc
-       << " mm_width=" << r.mm_width
-       << " mm_height=" << r.mm_height
-       << " connection=" << uint32_t(r.connection)
-       << " subpixel_order=" << uint32_t(r.subpixel_order)
-       << " num_crtcs=" << r.num_crtcs
-       << " num_modes=" << r.num_modes
-       << " num_preferred=" << r.num_preferred
-       << " num_clones=" << r.num_clones
-       << " name_len=" << r.name_len
-       << "]";
-    return os;
-}
-
-//! automaticatically generated ostream output function for
+    return xcb_format_ostream(os, xcb_randr_get_output_info_reply_desc, &r);
+}
+
+//! automatically generated field descriptors of
+//! xcb_randr_screen_change_notify_event_t
+static constexpr XcbField xcb_randr_screen_change_notify_event_fields[] = {
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t, rotation, UNSIGNED),
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t, timestamp, UNSIGNED),
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t,
+              config_timestamp, UNSIGNED),
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t, root, UNSIGNED),
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t, request_window, UNSIGNED),
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t, sizeID, UNSIGNED),
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t, subpixel_order, UNSIGNED),
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t, width, UNSIGNED),
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t, height, UNSIGNED),
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t, mwidth, UNSIGNED),
+    XCB_FIELD(xcb_randr_screen_change_notify_event_t, mheight, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_randr_screen_change_notify_event_desc =
+    XCB_STRUCT(xcb_randr_screen_change_notify_event_t,
+               "xcb_randr_screen_change_notify_event",
+               xcb_randr_screen_change_notify_event_fields);
+
+//! automatically generated ostream output function for
 //! xcb_randr_screen_change_notify_event_t
 std::ostream&
 operator << (std::ostream& os, const xcb_randr_screen_change_notify_event_t& e)
 {
-    os << "[xcb_randr_screen_change_notify_event:"
-       << " response_type=" << uint32_t(e.response_type)
-       << " rotation=" << uint32_t(e.rotation)
-       << " sequence=" << e.sequence
-       << " timestamp=" << e.timestamp
-       << " config_timestamp=" << e.config_timestamp
-       << " root=" << e.root
-       << " request_window=" << e.request_window
-       << " sizeID=" << e.sizeID
-       << " subpixel_order=" << e.subpixel_order
-       << " width=" << e.width
-       << " height=" << e.height
-       << " mwidth=" << e.mwidth
-       << " mheight=" << e.mheight
-       << "]";
-    return os;
+    return xcb_format_ostream(
+        os, xcb_randr_screen_change_notify_event_desc, &e);
+}
+
+//! automatically generated field descriptors of
+//! xcb_keymap_notify_event_t
+static constexpr XcbField xcb_keymap_notify_event_fields[] = {
+    XCB_FIELD(xcb_keymap_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_keymap_notify_event_t, keys, BYTES)
+};
+
+static constexpr XcbStruct xcb_keymap_notify_event_desc =
+    XCB_STRUCT(xcb_keymap_notify_event_t,
+               "xcb_keymap_notify_event",
+               xcb_keymap_notify_event_fields);
+
+//! automatically generated field descriptors of
+//! xcb_gravity_notify_event_t
+static constexpr XcbField xcb_gravity_notify_event_fields[] = {
+    XCB_FIELD(xcb_gravity_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_gravity_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_gravity_notify_event_t, event, UNSIGNED),
+    XCB_FIELD(xcb_gravity_notify_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_gravity_notify_event_t, x, SIGNED),
+    XCB_FIELD(xcb_gravity_notify_event_t, y, SIGNED)
+};
+
+static constexpr XcbStruct xcb_gravity_notify_event_desc =
+    XCB_STRUCT(xcb_gravity_notify_event_t,
+               "xcb_gravity_notify_event",
+               xcb_gravity_notify_event_fields);
+
+//! automatically generated field descriptors of
+//! xcb_resize_request_event_t
+static constexpr XcbField xcb_resize_request_event_fields[] = {
+    XCB_FIELD(xcb_resize_request_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_resize_request_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_resize_request_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_resize_request_event_t, width, UNSIGNED),
+    XCB_FIELD(xcb_resize_request_event_t, height, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_resize_request_event_desc =
+    XCB_STRUCT(xcb_resize_request_event_t,
+               "xcb_resize_request_event",
+               xcb_resize_request_event_fields);
+
+//! automatically generated field descriptors of
+//! xcb_selection_clear_event_t
+static constexpr XcbField xcb_selection_clear_event_fields[] = {
+    XCB_FIELD(xcb_selection_clear_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_selection_clear_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_selection_clear_event_t, time, UNSIGNED),
+    XCB_FIELD(xcb_selection_clear_event_t, owner, UNSIGNED),
+    XCB_FIELD(xcb_selection_clear_event_t, selection, ATOM)
+};
+
+static constexpr XcbStruct xcb_selection_clear_event_desc =
+    XCB_STRUCT(xcb_selection_clear_event_t,
+               "xcb_selection_clear_event",
+               xcb_selection_clear_event_fields);
+
+//! automatically generated field descriptors of
+//! xcb_selection_request_event_t
+static constexpr XcbField xcb_selection_request_event_fields[] = {
+    XCB_FIELD(xcb_selection_request_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_selection_request_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_selection_request_event_t, time, UNSIGNED),
+    XCB_FIELD(xcb_selection_request_event_t, owner, UNSIGNED),
+    XCB_FIELD(xcb_selection_request_event_t, requestor, UNSIGNED),
+    XCB_FIELD(xcb_selection_request_event_t, selection, ATOM),
+    XCB_FIELD(xcb_selection_request_event_t, target, ATOM),
+    XCB_FIELD(xcb_selection_request_event_t, property, ATOM)
+};
+
+static constexpr XcbStruct xcb_selection_request_event_desc =
+    XCB_STRUCT(xcb_selection_request_event_t,
+               "xcb_selection_request_event",
+               xcb_selection_request_event_fields);
+
+//! automatically generated field descriptors of
+//! xcb_selection_notify_event_t
+static constexpr XcbField xcb_selection_notify_event_fields[] = {
+    XCB_FIELD(xcb_selection_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_selection_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_selection_notify_event_t, time, UNSIGNED),
+    XCB_FIELD(xcb_selection_notify_event_t, requestor, UNSIGNED),
+    XCB_FIELD(xcb_selection_notify_event_t, selection, ATOM),
+    XCB_FIELD(xcb_selection_notify_event_t, target, ATOM),
+    XCB_FIELD(xcb_selection_notify_event_t, property, ATOM)
+};
+
+static constexpr XcbStruct xcb_selection_notify_event_desc =
+    XCB_STRUCT(xcb_selection_notify_event_t,
+               "xcb_selection_notify_event",
+               xcb_selection_notify_event_fields);
+
+//! automatically generated field descriptors of
+//! xcb_colormap_notify_event_t
+static constexpr XcbField xcb_colormap_notify_event_fields[] = {
+    XCB_FIELD(xcb_colormap_notify_event_t, response_type, UNSIGNED),
+    XCB_FIELD(xcb_colormap_notify_event_t, sequence, UNSIGNED),
+    XCB_FIELD(xcb_colormap_notify_event_t, window, UNSIGNED),
+    XCB_FIELD(xcb_colormap_notify_event_t, colormap, UNSIGNED),
+    XCB_FIELD(xcb_colormap_notify_event_t, _new, UNSIGNED),
+    XCB_FIELD(xcb_colormap_notify_event_t, state, UNSIGNED)
+};
+
+static constexpr XcbStruct xcb_colormap_notify_event_desc =
+    XCB_STRUCT(xcb_colormap_notify_event_t,
+               "xcb_colormap_notify_event",
+               xcb_colormap_notify_event_fields);
+
+//! automatically generated table of core event descriptors
+static constexpr const XcbStruct* core_event_desc[35] = {
+    NULL, // 0
+    NULL, // 1
+    &xcb_key_press_event_desc, // 2
+    &xcb_key_press_event_desc, // 3
+    &xcb_button_press_event_desc, // 4
+    &xcb_button_press_event_desc, // 5
+    &xcb_motion_notify_event_desc, // 6
+    &xcb_enter_notify_event_desc, // 7
+    &xcb_enter_notify_event_desc, // 8
+    &xcb_focus_in_event_desc, // 9
+    &xcb_focus_in_event_desc, // 10
+    &xcb_keymap_notify_event_desc, // 11
+    &xcb_expose_event_desc, // 12
+    &xcb_graphics_exposure_event_desc, // 13
+    &xcb_no_exposure_event_desc, // 14
+    &xcb_visibility_notify_event_desc, // 15
+    &xcb_create_notify_event_desc, // 16
+    &xcb_destroy_notify_event_desc, // 17
+    &xcb_unmap_notify_event_desc, // 18
+    &xcb_map_notify_event_desc, // 19
+    &xcb_map_request_event_desc, // 20
+    &xcb_reparent_notify_event_desc, // 21
+    &xcb_configure_notify_event_desc, // 22
+    &xcb_configure_request_event_desc, // 23
+    &xcb_gravity_notify_event_desc, // 24
+    &xcb_resize_request_event_desc, // 25
+    &xcb_circulate_notify_event_desc, // 26
+    &xcb_circulate_notify_event_desc, // 27
+    &xcb_property_notify_event_desc, // 28
+    &xcb_selection_clear_event_desc, // 29
+    &xcb_selection_request_event_desc, // 30
+    &xcb_selection_notify_event_desc, // 31
+    &xcb_colormap_notify_event_desc, // 32
+    &xcb_client_message_event_desc, // 33
+    &xcb_mapping_notify_event_desc   // 34
+};
+
+//! Return the descriptor of a core event by response type, NULL if unknown.
+const XcbStruct* xcb_event_struct(uint8_t response_type)
+{
+    response_type &= ~0x80;
+    if (response_type > 34) return NULL;
+    return core_event_desc[response_type];
 }
 
 /******************************************************************************/
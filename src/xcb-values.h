@@ -0,0 +1,139 @@
+/******************************************************************************/
+/*! \file src/xcb-values.h
+ *
+ * Compile-time typed value lists for XCB window requests.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#ifndef TILEWM_XCB_VALUES_HEADER
+#define TILEWM_XCB_VALUES_HEADER
+
+#include <xcb/xcb.h>
+#include <stdint.h>
+
+//! Count the set bits of a value mask at compile time.
+constexpr unsigned int xcb_mask_popcount(uint32_t mask)
+{
+    return mask ? (mask & 1u) + xcb_mask_popcount(mask >> 1) : 0;
+}
+
+//! Position of the value of bit in a value list selected by mask. X requests
+//! expect the values ordered by increasing bit.
+constexpr unsigned int xcb_mask_index(uint32_t mask, uint32_t bit)
+{
+    return xcb_mask_popcount(mask & (bit - 1));
+}
+
+//! Value list tag for ConfigureWindow: XCB_CONFIG_WINDOW_* bits.
+struct XcbConfigureWindow
+{
+    //! all valid value bits
+    static const uint32_t valid_mask = 0x007F;
+};
+
+//! Value list tag for CreateWindow and ChangeWindowAttributes: XCB_CW_* bits.
+struct XcbWindowAttributes
+{
+    //! all valid value bits
+    static const uint32_t valid_mask = 0x7FFF;
+};
+
+/*!
+ * A value list for XCB requests, in which the set of fields is fixed at
+ * compile time. The value mask is a constant, and the position of each field
+ * in the value array is calculated by the compiler, hence filling the list is
+ * a sequence of stores into a fixed-size buffer without any branches. The
+ * Request tag prevents sending e.g. XCB_CW_* bits with ConfigureWindow.
+ */
+template <typename Request, uint32_t Mask>
+class XcbValueList
+{
+    static_assert((Mask & ~Request::valid_mask) == 0,
+                  "value mask contains bits invalid for this request");
+
+public:
+    //! the constant value mask
+    static const uint32_t mask = Mask;
+
+    //! number of values in the list
+    static const unsigned int size = xcb_mask_popcount(Mask);
+
+protected:
+    //! values ordered by increasing bit of mask
+    uint32_t m_values[size ? size : 1];
+
+public:
+    //! Set the value of a field, the position is calculated at compile time.
+    template <uint32_t Bit>
+    void set(uint32_t value)
+    {
+        static_assert(Bit != 0 && (Bit & (Bit - 1)) == 0,
+                      "set() requires a single value bit");
+        static_assert((Mask & Bit) != 0, "value bit is not in the mask");
+
+        m_values[xcb_mask_index(Mask, Bit)] = value;
+    }
+
+    //! Return the value of a field.
+    template <uint32_t Bit>
+    uint32_t get() const
+    {
+        static_assert((Mask & Bit) != 0, "value bit is not in the mask");
+
+        return m_values[xcb_mask_index(Mask, Bit)];
+    }
+
+    //! Return pointer to the ordered value array.
+    const uint32_t * data() const
+    {
+        return m_values;
+    }
+
+    //! Copy the values of the fields in submask, which is only known at run
+    //! time, into the ordered array out, which needs room for size values.
+    //! Returns the actual value mask. The copy is branch-free: each value is
+    //! stored and the output position advanced only if its bit is selected.
+    uint32_t select(uint32_t submask, uint32_t* out) const
+    {
+        unsigned int i = 0, n = 0;
+
+        for (unsigned int bit = 0; bit < 32; ++bit)
+        {
+            // condition is constant, loop is unrolled for Mask.
+            if (!(Mask & (1u << bit))) continue;
+
+            out[n] = m_values[i++];
+            n += (submask >> bit) & 1;
+        }
+
+        return submask & Mask;
+    }
+};
+
+//! Typed value list for ConfigureWindow.
+template <uint32_t Mask>
+using XcbConfigureValues = XcbValueList<XcbConfigureWindow, Mask>;
+
+//! Typed value list for CreateWindow and ChangeWindowAttributes.
+template <uint32_t Mask>
+using XcbAttributeValues = XcbValueList<XcbWindowAttributes, Mask>;
+
+#endif // !TILEWM_XCB_VALUES_HEADER
+
+/******************************************************************************/
@@ -24,6 +24,7 @@
 #define TILEWM_XCB_WINDOW_HEADER
 
 #include "xcb.h"
+#include "xcb-values.h"
 #include "geometry.h"
 
 /*!
@@ -48,15 +49,42 @@ public:
         return m_window;
     }
 
+    //! Create a new input-output child window of parent, with attributes
+    //! given by a typed value list.
+    template <uint32_t Mask>
+    static XcbWindow create(xcb_window_t parent, const Rectangle& r,
+                            uint16_t border_width,
+                            const XcbAttributeValues<Mask>& values)
+    {
+        xcb_window_t win = g_xcb.generate_id();
+
+        g_xcb.req(xcb_create_window(g_xcb.connection, XCB_COPY_FROM_PARENT,
+                                    win, parent, r.x, r.y, r.w, r.h,
+                                    border_width,
+                                    XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                                    XCB_COPY_FROM_PARENT,
+                                    values.mask, values.data()));
+        return XcbWindow(win);
+    }
+
     // *** xcb_configure_window()
 
+    //! Configure the window with a typed value list.
+    template <uint32_t Mask>
+    void configure(const XcbConfigureValues<Mask>& values)
+    {
+        g_xcb.req(xcb_configure_window(g_xcb.connection, m_window,
+                                       values.mask, values.data()),
+                  XcbConnection::OP_WINDOW, m_window);
+    }
+
     //! Move a window to (x,y).
     void move(int16_t x, int16_t y)
     {
-        uint32_t values[2] = { (uint32_t)x, (uint32_t)y };
-        xcb_configure_window(g_xcb.connection, m_window,
-                             XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y,
-                             values);
+        XcbConfigureValues<XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y> v;
+        v.set<XCB_CONFIG_WINDOW_X>(x);
+        v.set<XCB_CONFIG_WINDOW_Y>(y);
+        configure(v);
     }
 
     //! Move a window to point p.
@@ -68,20 +96,24 @@ public:
     //! Resize a window to to (w,h).
     void resize(uint16_t w, uint16_t h)
     {
-        uint32_t values[2] = { w, h };
-        xcb_configure_window(g_xcb.connection, m_window,
-                             XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT,
-                             values);
+        XcbConfigureValues<XCB_CONFIG_WINDOW_WIDTH |
+                           XCB_CONFIG_WINDOW_HEIGHT> v;
+        v.set<XCB_CONFIG_WINDOW_WIDTH>(w);
+        v.set<XCB_CONFIG_WINDOW_HEIGHT>(h);
+        configure(v);
     }
 
     //! Move a window to (x,y) and resize to (w,h).
     void move_resize(int16_t x, int16_t y, uint16_t w, uint16_t h)
     {
-        uint32_t values[4] = { (uint32_t)x, (uint32_t)y, w, h };
-        xcb_configure_window(g_xcb.connection, m_window,
-                             XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y |
-                             XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT,
-                             values);
+        XcbConfigureValues<XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y |
+                           XCB_CONFIG_WINDOW_WIDTH |
+                           XCB_CONFIG_WINDOW_HEIGHT> v;
+        v.set<XCB_CONFIG_WINDOW_X>(x);
+        v.set<XCB_CONFIG_WINDOW_Y>(y);
+        v.set<XCB_CONFIG_WINDOW_WIDTH>(w);
+        v.set<XCB_CONFIG_WINDOW_HEIGHT>(h);
+        configure(v);
     }
 
     //! Move and resize a window to the given Rectangle.
@@ -93,26 +125,27 @@ public:
     //! Set the windows border width.
     void set_border_width(uint32_t b)
     {
-        xcb_configure_window(g_xcb.connection, m_window,
-                             XCB_CONFIG_WINDOW_BORDER_WIDTH,
-                             &b);
+        XcbConfigureValues<XCB_CONFIG_WINDOW_BORDER_WIDTH> v;
+        v.set<XCB_CONFIG_WINDOW_BORDER_WIDTH>(b);
+        configure(v);
     }
 
-    //! Set the windows border pixel.
-    void set_border_pixel(uint32_t p)
+    //! Change window stacking order.
+    void stack(xcb_stack_mode_t stack)
     {
-        xcb_change_window_attributes(g_xcb.connection, m_window,
-                                     XCB_CW_BORDER_PIXEL,
-                                     &p);
+        XcbConfigureValues<XCB_CONFIG_WINDOW_STACK_MODE> v;
+        v.set<XCB_CONFIG_WINDOW_STACK_MODE>(stack);
+        configure(v);
     }
 
-    //! Change window stacking order.
-    void stack(xcb_stack_mode_t stack)
+    //! Change window stacking order relative to a sibling window.
+    void stack(xcb_window_t sibling, xcb_stack_mode_t stack)
     {
-        uint32_t value = stack;
-        xcb_configure_window(g_xcb.connection, m_window,
-                             XCB_CONFIG_WINDOW_STACK_MODE,
-                             &value);
+        XcbConfigureValues<XCB_CONFIG_WINDOW_SIBLING |
+                           XCB_CONFIG_WINDOW_STACK_MODE> v;
+        v.set<XCB_CONFIG_WINDOW_SIBLING>(sibling);
+        v.set<XCB_CONFIG_WINDOW_STACK_MODE>(stack);
+        configure(v);
     }
 
     //! Change window stacking order: raise this window to the top.
@@ -127,18 +160,47 @@ public:
         stack(XCB_STACK_MODE_BELOW);
     }
 
+    // *** xcb_change_window_attributes()
+
+    //! Change window attributes with a typed value list.
+    template <uint32_t Mask>
+    void change_attributes(const XcbAttributeValues<Mask>& values)
+    {
+        g_xcb.req(xcb_change_window_attributes(g_xcb.connection, m_window,
+                                               values.mask, values.data()),
+                  XcbConnection::OP_WINDOW, m_window);
+    }
+
+    //! Set the windows border pixel.
+    void set_border_pixel(uint32_t p)
+    {
+        XcbAttributeValues<XCB_CW_BORDER_PIXEL> v;
+        v.set<XCB_CW_BORDER_PIXEL>(p);
+        change_attributes(v);
+    }
+
+    //! Set the event mask of the window.
+    void set_event_mask(uint32_t event_mask)
+    {
+        XcbAttributeValues<XCB_CW_EVENT_MASK> v;
+        v.set<XCB_CW_EVENT_MASK>(event_mask);
+        change_attributes(v);
+    }
+
     // *** xcb_map/unmap_window()
 
     //! Map the window to the screen.
     void map_window()
     {
-        xcb_map_window(g_xcb.connection, m_window);
+        g_xcb.req(xcb_map_window(g_xcb.connection, m_window),
+                  XcbConnection::OP_WINDOW, m_window);
     }
 
     //! Unmap the window from the screen.
     void unmap_window()
     {
-        xcb_unmap_window(g_xcb.connection, m_window);
+        g_xcb.req(xcb_unmap_window(g_xcb.connection, m_window),
+                  XcbConnection::OP_WINDOW, m_window);
     }
 
     // *** other window functions
@@ -147,7 +209,7 @@ public:
     //! X connection.
     void kill_client()
     {
-        xcb_kill_client(g_xcb.connection, m_window);
+        g_xcb.req(xcb_kill_client(g_xcb.connection, m_window));
     }
 
     // *** ICCCM properties
@@ -159,8 +221,9 @@ public:
 
         INFO << "setting ICCCM WM_STATE to " << IcccmWmStateFormatter(state);
 
-        g_xcb.change_property(m_window, g_xcb.WM_STATE.atom,
-                              g_xcb.WM_STATE.atom, 32, 2, values);
+        g_xcb.tag(g_xcb.change_property(m_window, g_xcb.WM_STATE.atom,
+                                        g_xcb.WM_STATE.atom, 32, 2, values),
+                  XcbConnection::OP_WINDOW, m_window);
     }
 
     //! Send a ICCCM WM_DELETE_WINDOW client message.
@@ -179,8 +242,9 @@ public:
 
         TRACE << "Sending " << ev;
 
-        xcb_send_event(g_xcb.connection, 0, m_window,
-                       XCB_EVENT_MASK_NO_EVENT, (char*)&ev);
+        g_xcb.req(xcb_send_event(g_xcb.connection, 0, m_window,
+                                 XCB_EVENT_MASK_NO_EVENT, (char*)&ev),
+                  XcbConnection::OP_WINDOW, m_window);
     }
 };
 
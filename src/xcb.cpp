@@ -1,7 +1,7 @@
 /******************************************************************************/
 /*! \file src/xcb.cpp
  *
- * Crude C++ abstraction of a XCB/Xlib connection to the X window server.
+ * Crude C++ abstraction of an XCB connection to the X window server.
  */
 /*******************************************************************************
  * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
@@ -21,15 +21,15 @@
  ******************************************************************************/
 
 #include "xcb.h"
+#include "xcb-format.h"
+#include "xcb-ewmh.h"
 #include "log.h"
 #include "tools.h"
 
-#include <X11/Xlib-xcb.h>
+#include <xcb/xcbext.h>
+#include <algorithm>
 #include <cstring>
 
-//! Xlib connection to the X window server.
-Display* XcbConnection::display = NULL;
-
 //! XCB connection to the X display server
 xcb_connection_t* XcbConnection::connection = NULL;
 
@@ -39,33 +39,69 @@ xcb_screen_t* XcbConnection::screen = NULL;
 //! the root window id on the default screen
 xcb_window_t XcbConnection::root = XCB_WINDOW_NONE;
 
-//! cache of xcb_atom_t -> name mapping
-XcbConnection::atom_name_cache_type XcbConnection::atom_name_cache;
+//! subsystem currently issuing requests
+XcbConnection::subsystem_t XcbConnection::subsystem = SUB_OTHER;
+
+//! accounting counters per subsystem
+XcbConnection::Accounting XcbConnection::accounting[SUB_MAX];
+
+//! accounting counters summed over all subsystems
+XcbConnection::Accounting XcbConnection::accounting_total;
+
+//! Output accounting counters per subsystem to the log.
+void XcbConnection::dump_accounting()
+{
+    static const char* const name[SUB_MAX] = {
+        "other", "manage", "focus", "binding", "screen", "ewmh", "stacking",
+        "layout"
+    };
+
+    for (unsigned int i = 0; i < SUB_MAX; ++i)
+    {
+        const Accounting& a = accounting[i];
+
+        INFO << "X accounting " << name[i] << ": "
+             << a.requests << " requests, " << a.replies << " round trips, "
+             << a.wait_ns / 1000 << " us waiting";
+    }
+}
 
 //! Open a new connection to X server (called early by main)
 void XcbConnection::open_connection(const char* display_name)
 {
-    // create connection to X display server
-    display = XOpenDisplay(display_name);
+    // create connection to X display server, which also parses the preferred
+    // screen number from the display name or $DISPLAY.
+    int default_screen = 0;
+    connection = xcb_connect(display_name, &default_screen);
 
-    if (display == NULL) {
+    if (connection_has_error()) {
         FATAL << "Could not open display.";
         exit(EXIT_FAILURE);
     }
 
-    // get XCB connection from X display
-    connection = XGetXCBConnection(display);
+    setup_screen(default_screen);
+}
+
+//! Open an XCB connection on an already connected socket.
+void XcbConnection::open_connection_fd(int fd)
+{
+    connection = xcb_connect_to_fd(fd, NULL);
 
     if (connection_has_error()) {
-        FATAL << "Could not get XCB connection to display";
+        FATAL << "Could not set up XCB connection on socket";
         exit(EXIT_FAILURE);
     }
 
-    // we will be using xcb to handle the event queue
-    XSetEventQueueOwner(display, XCBOwnsEventQueue);
+    setup_screen(0);
+}
+
+//! Select the default screen and root window after connecting.
+void XcbConnection::setup_screen(unsigned int default_screen)
+{
+    if (EventRecorder::enabled())
+        EventRecorder::record_setup(xcb_get_setup(connection));
 
     // find the default screen information
-    int default_screen = DefaultScreen(display);
     screen = get_screen(default_screen);
 
     if (!screen) {
@@ -86,7 +122,8 @@ void XcbConnection::open_connection(const char* display_name)
 //! Release connection to X server
 void XcbConnection::close_connection()
 {
-    XCloseDisplay(display);
+    xcb_disconnect(connection);
+    connection = NULL;
 }
 
 //! Return the corresponding screen data structure
@@ -101,8 +138,81 @@ xcb_screen_t* XcbConnection::get_screen(unsigned int screen)
     return NULL;
 }
 
-//! Set us up as window manager on the X server
-bool XcbConnection::setup_wm()
+//! Return cached extension query result (and record it).
+const xcb_query_extension_reply_t *
+XcbConnection::get_extension_data(xcb_extension_t* ext)
+{
+    const xcb_query_extension_reply_t* qer =
+        xcb_get_extension_data(connection, ext);
+
+    if (EventRecorder::enabled())
+        EventRecorder::record_extension(ext->name, qer);
+
+    return qer;
+}
+
+//! number of recent tagged requests kept for matching errors
+const unsigned int XcbConnection::request_ring_size;
+
+//! ring buffer of recent tagged requests
+XcbConnection::RequestTag
+XcbConnection::request_ring[XcbConnection::request_ring_size];
+
+//! total number of tagged requests
+unsigned int XcbConnection::request_ring_count = 0;
+
+//! error handler per operation
+XcbConnection::error_handler_type XcbConnection::error_handler[OP_MAX];
+
+//! Find the tag of a recent request by its full sequence number.
+const XcbConnection::RequestTag*
+XcbConnection::find_request(unsigned int sequence)
+{
+    unsigned int n = std::min(request_ring_count, request_ring_size);
+
+    // search backwards from the most recent request
+    for (unsigned int i = 1; i <= n; ++i)
+    {
+        const RequestTag& t =
+            request_ring[(request_ring_count - i) % request_ring_size];
+
+        if (t.sequence == sequence) return &t;
+
+        // sequence numbers in the ring are increasing
+        if (int(t.sequence - sequence) < 0) break;
+    }
+
+    return NULL;
+}
+
+//! Route an asynchronous error to the handler of its operation.
+bool XcbConnection::route_error(const xcb_generic_error_t* e)
+{
+    const RequestTag* t = find_request(e->full_sequence);
+    if (!t) return false;
+
+    DEBUG << "X error " << uint32_t(e->error_code)
+          << " of request " << t->sequence << " op " << t->op
+          << " window " << t->window;
+
+    if (!error_handler[t->op]) return false;
+
+    error_handler[t->op](e, *t);
+    return true;
+}
+
+//! flag set by the error handler of the WM setup request
+bool XcbConnection::setup_wm_failed = false;
+
+//! Error handler of the WM setup request.
+void XcbConnection::error_setup_wm(const xcb_generic_error_t*,
+                                   const RequestTag&)
+{
+    setup_wm_failed = true;
+}
+
+//! Issue unchecked request to select the window manager's events on root.
+void XcbConnection::query_setup_wm()
 {
     const uint32_t eventmask =
         XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT |
@@ -110,95 +220,236 @@ bool XcbConnection::setup_wm()
         XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY |
         XCB_EVENT_MASK_PROPERTY_CHANGE;
 
-    xcb_void_cookie_t cwac =
-        xcb_change_window_attributes_checked(connection, root,
-                                             XCB_CW_EVENT_MASK, &eventmask);
+    setup_wm_failed = false;
+    register_error_handler(OP_SETUP_WM, error_setup_wm);
 
-    xcb_generic_error_t* e = xcb_request_check(connection, cwac);
-    if (e) {
+    req(xcb_change_window_attributes(connection, root, XCB_CW_EVENT_MASK,
+                                     &eventmask),
+        OP_SETUP_WM, root);
+}
+
+//! Check whether we could set us up as window manager on the X server.
+bool XcbConnection::process_setup_wm()
+{
+    if (setup_wm_failed) {
         FATAL << "Another window manger is already running.";
-        free(e);
         return false;
     }
 
     return true;
 }
 
-//! Query X server for cached named atoms.
-void XcbConnection::load_atomlist()
+//! Issue intern requests for all cached named atoms.
+std::vector<xcb_intern_atom_cookie_t> XcbConnection::query_atomlist()
 {
-    // *** issue all atom requests at once
-
     std::vector<xcb_intern_atom_cookie_t> atomreq(atomlist_size);
     for (unsigned int ai = 0; ai < atomlist_size; ++ai)
     {
         atomreq[ai] =
-            xcb_intern_atom(connection, 0,
-                            strlen(atomlist[ai]->name), atomlist[ai]->name);
+            req(xcb_intern_atom(connection, 0,
+                                strlen(atomlist[ai]->name),
+                                atomlist[ai]->name));
     }
+    return atomreq;
+}
 
-    // *** collect all responses
+//! Collect replies of the intern requests for cached named atoms.
+void XcbConnection::process_atomlist(
+    const std::vector<xcb_intern_atom_cookie_t>& atomreq)
+{
+    ASSERT(atomreq.size() == atomlist_size);
 
     for (unsigned int ai = 0; ai < atomlist_size; ++ai)
     {
         autofree_ptr<xcb_intern_atom_reply_t> ar(
-            xcb_intern_atom_reply(connection, atomreq[ai], NULL)
+            reply(xcb_intern_atom_reply, atomreq[ai], NULL)
             );
 
         if (ar) {
             atomlist[ai]->atom = ar->atom;
             TRACE << "Cached atom " << atomlist[ai]->name << " = " << ar->atom;
-
-            atom_name_cache.insert(
-                std::make_pair(ar->atom, atomlist[ai]->name)
-                );
         }
         else {
             ERROR << "query_cached_atoms: could not query atom "
                   << atomlist[ai]->name;
         }
     }
+
+    build_atom_hash();
+}
+
+//! Query X server for cached named atoms.
+void XcbConnection::load_atomlist()
+{
+    process_atomlist(query_atomlist());
+}
+
+//! Names of the predefined atoms of the X protocol, indexed by atom.
+const char* const XcbConnection::predefined_atom_names[] = {
+    "NONE", "PRIMARY", "SECONDARY", "ARC", "ATOM", "BITMAP", "CARDINAL",
+    "COLORMAP", "CURSOR", "CUT_BUFFER0", "CUT_BUFFER1", "CUT_BUFFER2",
+    "CUT_BUFFER3", "CUT_BUFFER4", "CUT_BUFFER5", "CUT_BUFFER6", "CUT_BUFFER7",
+    "DRAWABLE", "FONT", "INTEGER", "PIXMAP", "POINT", "RECTANGLE",
+    "RESOURCE_MANAGER", "RGB_COLOR_MAP", "RGB_BEST_MAP", "RGB_BLUE_MAP",
+    "RGB_DEFAULT_MAP", "RGB_GRAY_MAP", "RGB_GREEN_MAP", "RGB_RED_MAP",
+    "STRING", "VISUALID", "WINDOW", "WM_COMMAND", "WM_HINTS",
+    "WM_CLIENT_MACHINE", "WM_ICON_NAME", "WM_ICON_SIZE", "WM_NAME",
+    "WM_NORMAL_HINTS", "WM_SIZE_HINTS", "WM_ZOOM_HINTS", "MIN_SPACE",
+    "NORM_SPACE", "MAX_SPACE", "END_SPACE", "SUPERSCRIPT_X", "SUPERSCRIPT_Y",
+    "SUBSCRIPT_X", "SUBSCRIPT_Y", "UNDERLINE_POSITION", "UNDERLINE_THICKNESS",
+    "STRIKEOUT_ASCENT", "STRIKEOUT_DESCENT", "ITALIC_ANGLE", "X_HEIGHT",
+    "QUAD_WIDTH", "WEIGHT", "POINT_SIZE", "RESOLUTION", "COPYRIGHT", "NOTICE",
+    "FONT_NAME", "FAMILY_NAME", "FULL_NAME", "CAP_HEIGHT", "WM_CLASS",
+    "WM_TRANSIENT_FOR"
+};
+
+//! Number of predefined atoms including XCB_ATOM_NONE.
+const unsigned int XcbConnection::predefined_atom_count
+    = sizeof(predefined_atom_names) / sizeof(*predefined_atom_names);
+
+//! perfect hash table atom -> index in atomlist
+std::vector<uint16_t> XcbConnection::atom_hash;
+
+//! marker of unused slots in the perfect hash table
+const uint16_t XcbConnection::atom_hash_empty;
+
+//! multiplier of the perfect hash function
+uint32_t XcbConnection::atom_hash_mult = 0;
+
+//! shift of the perfect hash function
+uint32_t XcbConnection::atom_hash_shift = 32;
+
+//! Construct the collision-free hash table of the cached atoms. The atom
+//! identifiers are only known after interning them, hence multiplicative hash
+//! functions are tried until one maps all atoms to distinct slots.
+void XcbConnection::build_atom_hash()
+{
+    ASSERT(atomlist_size < atom_hash_empty);
+
+    // start with a table of at least twice the number of atoms
+    unsigned int bits = 1;
+    while ((1u << bits) < 2 * atomlist_size) ++bits;
+
+    uint32_t mult = 0x9E3779B1; // golden ratio
+
+    for ( ; bits < 16; ++bits)
+    {
+        atom_hash_shift = 32 - bits;
+
+        for (unsigned int attempt = 0; attempt < 256; ++attempt)
+        {
+            atom_hash_mult = mult | 1;
+            mult = mult * 1664525 + 1013904223; // next candidate
+
+            atom_hash.assign(1u << bits, atom_hash_empty);
+
+            unsigned int ai;
+            for (ai = 0; ai < atomlist_size; ++ai)
+            {
+                if (atomlist[ai]->atom == XCB_ATOM_NONE) continue;
+
+                uint16_t& slot = atom_hash[atom_hash_slot(atomlist[ai]->atom)];
+                if (slot != atom_hash_empty) break;
+                slot = ai;
+            }
+
+            if (ai == atomlist_size) {
+                DEBUG << "build_atom_hash: " << atomlist_size << " atoms in "
+                      << atom_hash.size() << " slots after "
+                      << attempt + 1 << " attempts";
+                return;
+            }
+        }
+    }
+
+    ERROR << "build_atom_hash: could not find perfect hash function";
+    atom_hash.clear();
 }
 
-//! Find the name of an atom (usually for unknown atoms)
-std::string XcbConnection::find_atom_name(xcb_atom_t atom)
+//! cache of resolved names of other atoms
+XcbConnection::atom_name_cache_type XcbConnection::atom_name_cache;
+
+//! outstanding GetAtomName requests for other atoms
+XcbConnection::atom_name_pending_type XcbConnection::atom_name_pending;
+
+//! Find the name of an atom for logging, without waiting for the X server.
+const char * XcbConnection::find_atom_name(xcb_atom_t atom)
 {
+    if (atom < predefined_atom_count)
+        return predefined_atom_names[atom];
+
+    const XcbAtom* a = find_atom(atom);
+    if (a) return a->name;
+
     atom_name_cache_type::const_iterator ci = atom_name_cache.find(atom);
     if (ci != atom_name_cache.end())
-        return ci->second;
+        return ci->second.c_str();
+
+    for (const atom_name_pending_type::value_type& p : atom_name_pending)
+    {
+        if (p.first == atom) return "<pending atom>";
+    }
 
-    xcb_get_atom_name_cookie_t ganc = xcb_get_atom_name(connection, atom);
+    // request the name, the reply is collected by process_atom_names()
+    xcb_get_atom_name_cookie_t ganc =
+        req(xcb_get_atom_name(connection, atom));
 
-    autofree_ptr<xcb_get_atom_name_reply_t> ganr(
-        xcb_get_atom_name_reply(connection, ganc, NULL)
-        );
+    atom_name_pending.push_back(std::make_pair(atom, ganc.sequence));
 
-    if (!ganr) {
-        return "<unknown atom>";
-    }
+    return "<pending atom>";
+}
+
+//! Collect replies of asynchronous atom name requests without blocking.
+void XcbConnection::process_atom_names()
+{
+    atom_name_pending_type::iterator it = atom_name_pending.begin();
+
+    while (it != atom_name_pending.end())
+    {
+        void* r = NULL;
+        xcb_generic_error_t* e = NULL;
+
+        if (!xcb_poll_for_reply(connection, it->second, &r, &e)) {
+            ++it;
+            continue;
+        }
+
+        autofree_ptr<xcb_get_atom_name_reply_t> ganr(
+            (xcb_get_atom_name_reply_t*)r
+            );
+        autofree_ptr<xcb_generic_error_t> error(e);
+
+        std::string atom_name =
+            ganr ? std::string(xcb_get_atom_name_name(ganr.get()),
+                               xcb_get_atom_name_name_length(ganr.get()))
+            : std::string("<unknown atom>");
 
-    std::string atom_name(xcb_get_atom_name_name(ganr.get()),
-                          xcb_get_atom_name_name_length(ganr.get()));
+        TRACE << "Resolved atom " << it->first << " = " << atom_name;
 
-    atom_name_cache.insert(std::make_pair(atom, atom_name));
+        atom_name_cache.insert(std::make_pair(it->first, atom_name));
 
-    return atom_name;
+        it = atom_name_pending.erase(it);
+    }
 }
 
-//! Allocate a color in the default color map.
-uint32_t XcbConnection::allocate_color(uint16_t r, uint16_t g, uint16_t b)
+//! Issue request to allocate a color in the default color map.
+xcb_alloc_color_cookie_t
+XcbConnection::query_allocate_color(uint16_t r, uint16_t g, uint16_t b)
 {
     xcb_colormap_t map = screen->default_colormap;
 
-    xcb_alloc_color_cookie_t acc =
-        xcb_alloc_color(connection, map, r, g, b);
+    return req(xcb_alloc_color(connection, map, r, g, b));
+}
 
+//! Return pixel value of allocated color, or white on error.
+uint32_t XcbConnection::process_allocate_color(xcb_alloc_color_cookie_t acc)
+{
     autofree_ptr<xcb_alloc_color_reply_t> acr(
-        xcb_alloc_color_reply(connection, acc, NULL)
+        reply(xcb_alloc_color_reply, acc, NULL)
         );
 
     if (!acr) {
-        WARN << "cannot allocate color (" << r << ',' << g << ',' << b << ")";
+        WARN << "cannot allocate color";
         return screen->white_pixel;
     }
 
@@ -207,44 +458,60 @@ uint32_t XcbConnection::allocate_color(uint16_t r, uint16_t g, uint16_t b)
     return acr->pixel;
 }
 
-//! XCB cursor loading context
+//! XCB cursor loading context, created on first cursor use.
 xcb_cursor_context_t* XcbConnection::cursor_context = NULL;
 
-//! Query X server for cached cursors.
-void XcbConnection::load_cursorlist()
+//! Whether cursors may be loaded from the theme.
+bool XcbConnection::cursor_enabled = true;
+
+//! Cache of all cursors loaded so far, keyed by name.
+XcbConnection::cursormap_type XcbConnection::cursormap;
+
+//! Return cursor of given name, loading it from the theme on first use.
+xcb_cursor_t XcbConnection::get_cursor(const char* name)
 {
-    ASSERT(cursor_context == NULL);
+    cursormap_type::const_iterator it = cursormap.find(name);
+    if (it != cursormap.end()) return it->second;
+
+    if (!cursor_enabled) return XCB_CURSOR_NONE;
 
-    if (xcb_cursor_context_new(connection, screen, &cursor_context) != 0) {
+    if (!cursor_context &&
+        xcb_cursor_context_new(connection, screen, &cursor_context) != 0)
+    {
         ERROR << "Could not allocate xcb_cursor_context.";
-        return;
+        cursor_context = NULL;
+        cursor_enabled = false;
+        return XCB_CURSOR_NONE;
     }
 
-    for (unsigned int ci = 0; ci < cursorlist_size; ++ci)
-    {
-        XcbCursor& c = *cursorlist[ci];
+    xcb_cursor_t cursor = xcb_cursor_load_cursor(cursor_context, name);
+    INFO << "load_cursor: " << name << " -> " << cursor;
 
-        c.cursor = xcb_cursor_load_cursor(cursor_context, c.name);
-        INFO << "load_cursor: " << c.name << " -> " << c.cursor;
-    }
+    // failed loads are cached as well and not retried
+    cursormap[name] = cursor;
+    return cursor;
 }
 
 //! Free cached cursor resources.
 void XcbConnection::unload_cursorlist()
 {
-    ASSERT(cursor_context != NULL);
-
-    for (unsigned int ci = 0; ci < cursorlist_size; ++ci)
+    for (cursormap_type::value_type& ci : cursormap)
     {
-        XcbCursor& c = *cursorlist[ci];
+        if (ci.second == XCB_CURSOR_NONE) continue;
 
-        xcb_free_cursor(g_xcb.connection, c.cursor);
-        INFO << "cursor: " << c.cursor;
+        g_xcb.req(xcb_free_cursor(g_xcb.connection, ci.second));
+        INFO << "cursor: " << ci.second;
     }
 
-    xcb_cursor_context_free(cursor_context);
+    cursormap.clear();
+
+    for (unsigned int ci = 0; ci < cursorlist_size; ++ci)
+        cursorlist[ci]->cursor = XCB_CURSOR_NONE;
 
-    cursor_context = NULL;
+    if (cursor_context) {
+        xcb_cursor_context_free(cursor_context);
+        cursor_context = NULL;
+    }
 }
 
 //! Output string "name (id)" as description of an atom
@@ -253,38 +520,100 @@ std::ostream& operator << (std::ostream& os, const AtomFormatter& a)
     return os << g_xcb.find_atom_name(a.atom) << " (" << a.atom << ')';
 }
 
-//! Output description string of an window gravity value.
-std::ostream& operator << (std::ostream& os, const GravityFormatter& g)
+//! Return description string of an window gravity value.
+const char * GravityFormatter::name(uint32_t gravity)
 {
-    switch (g.gravity)
+    switch (gravity)
     {
     case XCB_GRAVITY_WIN_UNMAP:
-        return os << "GRAVITY_NULL";
+        return "GRAVITY_NULL";
     case XCB_GRAVITY_NORTH_WEST:
-        return os << "GRAVITY_NORTH_WEST";
+        return "GRAVITY_NORTH_WEST";
     case XCB_GRAVITY_NORTH:
-        return os << "GRAVITY_NORTH";
+        return "GRAVITY_NORTH";
     case XCB_GRAVITY_NORTH_EAST:
-        return os << "GRAVITY_NORTH_EAST";
+        return "GRAVITY_NORTH_EAST";
     case XCB_GRAVITY_WEST:
-        return os << "GRAVITY_WEST";
+        return "GRAVITY_WEST";
     case XCB_GRAVITY_CENTER:
-        return os << "GRAVITY_CENTER";
+        return "GRAVITY_CENTER";
     case XCB_GRAVITY_EAST:
-        return os << "GRAVITY_EAST";
+        return "GRAVITY_EAST";
     case XCB_GRAVITY_SOUTH_WEST:
-        return os << "GRAVITY_SOUTH_WEST";
+        return "GRAVITY_SOUTH_WEST";
     case XCB_GRAVITY_SOUTH:
-        return os << "GRAVITY_SOUTH";
+        return "GRAVITY_SOUTH";
     case XCB_GRAVITY_SOUTH_EAST:
-        return os << "GRAVITY_SOUTH_EAST";
+        return "GRAVITY_SOUTH_EAST";
     case XCB_GRAVITY_STATIC:
-        return os << "GRAVITY_STATIC";
+        return "GRAVITY_STATIC";
     default:
-        return os << "GRAVITY_INVALID";
+        return "GRAVITY_INVALID";
     }
 }
 
+//! Output description string of an window gravity value.
+std::ostream& operator << (std::ostream& os, const GravityFormatter& g)
+{
+    return os << GravityFormatter::name(g.gravity);
+}
+
+//! Output WM_CLASS strings of ICCCM reply.
+std::ostream& operator << (std::ostream& os,
+                           const xcb_icccm_get_wm_class_reply_t& i)
+{
+    return os << "[xcb_icccm_get_wm_class_reply:"
+              << " instance_name=" << i.instance_name
+              << " class_name=" << i.class_name
+              << "]";
+}
+
+//! field descriptors of _NET_WM_STRUT data structure
+static constexpr XcbField ewmh_strut_fields[] = {
+    XCB_FIELD(ewmh_strut_t, valid, UNSIGNED),
+    XCB_FIELD(ewmh_strut_t, left, UNSIGNED),
+    XCB_FIELD(ewmh_strut_t, right, UNSIGNED),
+    XCB_FIELD(ewmh_strut_t, top, UNSIGNED),
+    XCB_FIELD(ewmh_strut_t, bottom, UNSIGNED)
+};
+
+//! Output _NET_WM_STRUT data structure.
+std::ostream& operator << (std::ostream& os, const struct ewmh_strut_t& q)
+{
+    static constexpr XcbStruct desc =
+        XCB_STRUCT(ewmh_strut_t, "ewmh_strut", ewmh_strut_fields);
+
+    return xcb_format_ostream(os, desc, &q);
+}
+
+//! field descriptors of _NET_WM_STRUT_PARTIAL data structure
+static constexpr XcbField ewmh_strut_partial_fields[] = {
+    XCB_FIELD(ewmh_strut_partial_t, valid, UNSIGNED),
+    XCB_FIELD(ewmh_strut_partial_t, left, UNSIGNED),
+    XCB_FIELD(ewmh_strut_partial_t, right, UNSIGNED),
+    XCB_FIELD(ewmh_strut_partial_t, top, UNSIGNED),
+    XCB_FIELD(ewmh_strut_partial_t, bottom, UNSIGNED),
+    XCB_FIELD(ewmh_strut_partial_t, left_start_y, UNSIGNED),
+    XCB_FIELD(ewmh_strut_partial_t, left_end_y, UNSIGNED),
+    XCB_FIELD(ewmh_strut_partial_t, right_start_y, UNSIGNED),
+    XCB_FIELD(ewmh_strut_partial_t, right_end_y, UNSIGNED),
+    XCB_FIELD(ewmh_strut_partial_t, top_start_x, UNSIGNED),
+    XCB_FIELD(ewmh_strut_partial_t, top_end_x, UNSIGNED),
+    XCB_FIELD(ewmh_strut_partial_t, bottom_start_x, UNSIGNED),
+    XCB_FIELD(ewmh_strut_partial_t, bottom_end_x, UNSIGNED)
+};
+
+//! Output _NET_WM_STRUT_PARTIAL data structure.
+std::ostream& operator << (std::ostream& os,
+                           const struct ewmh_strut_partial_t& q)
+{
+    static constexpr XcbStruct desc =
+        XCB_STRUCT(ewmh_strut_partial_t, "ewmh_strut_partial",
+                   ewmh_strut_partial_fields);
+
+    return xcb_format_ostream(os, desc, &q);
+}
+
 //! Output client message data as hexdump
 std::ostream& operator << (std::ostream& os, const xcb_client_message_data_t& d)
 {
@@ -1,7 +1,7 @@
 /******************************************************************************/
 /*! \file src/xcb.h
  *
- * Crude C++ abstraction of a XCB/Xlib connection to the X window server.
+ * Crude C++ abstraction of an XCB connection to the X window server.
  */
 /*******************************************************************************
  * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
@@ -32,20 +32,18 @@
 #include <xcb/xcb_icccm.h>
 #include <xcb/xcb_cursor.h>
 
-//! forward declaration of Display, as we do not want to globally include Xlib.
-typedef struct _XDisplay Display;
+#include "tools.h"
+#include "trace.h"
+#include "recorder.h"
 
 /*!
- * This is the XCB/Xlib connection to the X window server. The class contains
+ * This is the XCB connection to the X window server. The class contains
  * only static functions and attributes, which can conveniently be accessed
  * using the (otherwise empty) g_xcb object.
  */
 class XcbConnection
 {
 public:
-    //! Xlib connection to the X window server.
-    static Display* display;
-
     //! XCB connection to the X display server
     static xcb_connection_t* connection;
 
@@ -59,6 +57,10 @@ public:
     //! Open a new connection to X server (called early by main)
     static void open_connection(const char* display_name = NULL);
 
+    //! Open an XCB connection on an already connected socket.
+    //! Used to connect to the stub server of tilewm-replay.
+    static void open_connection_fd(int fd);
+
     //! Release connection to X server
     static void close_connection();
 
@@ -71,6 +73,7 @@ public:
     //! Forces any buffered output to be written to the server.
     static int flush()
     {
+        TraceSpan span("flush");
         return xcb_flush(connection);
     }
 
@@ -89,8 +92,174 @@ public:
     //! Return the corresponding screen data structure
     static xcb_screen_t * get_screen(unsigned int screen);
 
-    //! Set us up as window manager on the X server
-    static bool setup_wm();
+    //! Select the default screen and root window after connecting.
+    static void setup_screen(unsigned int screen_num);
+
+    //! Return cached extension query result (and record it).
+    static const xcb_query_extension_reply_t *
+    get_extension_data(xcb_extension_t* ext);
+
+    //! Issue unchecked request to select the window manager's events on
+    //! root, an error is routed via the request ring.
+    static void query_setup_wm();
+
+    //! Check whether we could set us up as window manager on the X server.
+    //! Errors received before must have been processed, which is the case
+    //! after any later reply was collected and the event queue drained.
+    static bool process_setup_wm();
+
+public:
+    //! Subsystems of the WM for accounting X requests and round trips.
+    enum subsystem_t {
+        SUB_OTHER, SUB_MANAGE, SUB_FOCUS, SUB_BINDING, SUB_SCREEN, SUB_EWMH,
+        SUB_STACKING, SUB_LAYOUT, SUB_MAX
+    };
+
+    //! Counters of X protocol usage.
+    struct Accounting
+    {
+        //! number of requests issued
+        uint64_t requests;
+        //! number of blocking waits for replies
+        uint64_t replies;
+        //! total time spent waiting for replies in nanoseconds
+        uint64_t wait_ns;
+    };
+
+    //! subsystem currently issuing requests
+    static subsystem_t subsystem;
+
+    //! accounting counters per subsystem
+    static Accounting accounting[SUB_MAX];
+
+    //! accounting counters summed over all subsystems
+    static Accounting accounting_total;
+
+    //! Account a request issued, returns the cookie.
+    template <typename Cookie>
+    static Cookie req(Cookie cookie)
+    {
+        accounting[subsystem].requests++;
+        accounting_total.requests++;
+        return cookie;
+    }
+
+    //! Account the time spent in a blocking reply wait.
+    static void account_reply(uint64_t start)
+    {
+        uint64_t ns = monotonic_ns() - start;
+
+        accounting[subsystem].replies++;
+        accounting[subsystem].wait_ns += ns;
+        accounting_total.replies++;
+        accounting_total.wait_ns += ns;
+    }
+
+    //! Wait for the reply of a request and account the round trip.
+    template <typename Reply, typename Cookie>
+    static Reply *
+    reply(Reply* (*func)(xcb_connection_t*, Cookie, xcb_generic_error_t**),
+          Cookie cookie, xcb_generic_error_t** e)
+    {
+        TraceSpan span("reply");
+        uint64_t start = monotonic_ns();
+        Reply* r = func(connection, cookie, e);
+        account_reply(start);
+
+        if (EventRecorder::enabled())
+            EventRecorder::record_reply(r);
+
+        return r;
+    }
+
+    //! Return the total number of bytes written to the X connection, or zero
+    //! if libxcb does not count them.
+    static uint64_t total_written()
+    {
+#if HAVE_XCB_TOTAL_WRITTEN
+        return xcb_total_written(connection);
+#else
+        return 0;
+#endif
+    }
+
+    //! Output accounting counters per subsystem to the log.
+    static void dump_accounting();
+
+public:
+    //! Operations of tagged requests, each may have an error handler.
+    enum request_op_t {
+        OP_OTHER, OP_SETUP_WM, OP_WINDOW, OP_MAX
+    };
+
+    //! Tag of a recently issued request
+    struct RequestTag
+    {
+        //! full sequence number of the request
+        unsigned int sequence;
+        //! operation the request belongs to
+        request_op_t op;
+        //! window the request operates on
+        xcb_window_t window;
+    };
+
+    //! Handler called for asynchronous errors of tagged requests.
+    typedef void (* error_handler_type)(const xcb_generic_error_t* e,
+                                        const RequestTag& tag);
+
+protected:
+    //! number of recent tagged requests kept for matching errors
+    static const unsigned int request_ring_size = 256;
+
+    //! ring buffer of recent tagged requests
+    static RequestTag request_ring[request_ring_size];
+
+    //! total number of tagged requests, the ring position is derived
+    static unsigned int request_ring_count;
+
+    //! error handler per operation
+    static error_handler_type error_handler[OP_MAX];
+
+    //! flag set by the error handler of the WM setup request
+    static bool setup_wm_failed;
+
+    //! Error handler of the WM setup request.
+    static void error_setup_wm(const xcb_generic_error_t* e,
+                               const RequestTag& tag);
+
+public:
+    //! Remember the operation and window of an issued request, such that
+    //! asynchronous errors can be routed back to the operation.
+    template <typename Cookie>
+    static Cookie tag(Cookie cookie, request_op_t op, xcb_window_t window)
+    {
+        RequestTag& t = request_ring[request_ring_count++ % request_ring_size];
+        t.sequence = cookie.sequence;
+        t.op = op;
+        t.window = window;
+        return cookie;
+    }
+
+    //! Account and tag a request issued, returns the cookie.
+    template <typename Cookie>
+    static Cookie req(Cookie cookie, request_op_t op, xcb_window_t window)
+    {
+        return tag(req(cookie), op, window);
+    }
+
+    //! Register the handler for errors of an operation.
+    static void register_error_handler(request_op_t op, error_handler_type h)
+    {
+        error_handler[op] = h;
+    }
+
+    //! Find the tag of a recent request by its full sequence number, or
+    //! return NULL if it was not tagged or is too old.
+    static const RequestTag* find_request(unsigned int sequence);
+
+    //! Route an asynchronous error to the handler of its operation. Returns
+    //! false if the request is unknown or has no handler.
+    static bool route_error(const xcb_generic_error_t* e);
 
 public:
     //! Struct to keep information about cached named atoms
@@ -100,6 +269,8 @@ public:
         const char* name;
         //! identifier of the atom as fetched from the X server
         xcb_atom_t atom;
+        //! fixed index of the atom in atomlist, assigned by the generator
+        unsigned int index;
     };
 
     // *** List of cached named atoms
@@ -125,6 +296,7 @@ public:
     static XcbAtom _NET_WM_STATE_HIDDEN;
     static XcbAtom _NET_WM_STATE_STICKY;
     static XcbAtom _NET_WM_STATE_ABOVE;
+    static XcbAtom _NET_WM_STATE_BELOW;
     static XcbAtom _NET_WM_STATE_FULLSCREEN;
     static XcbAtom _NET_WM_STATE_MAXIMIZED_VERT;
     static XcbAtom _NET_WM_STATE_MAXIMIZED_HORZ;
@@ -134,6 +306,9 @@ public:
     static XcbAtom _NET_WM_STRUT;
     static XcbAtom _NET_WM_STRUT_PARTIAL;
 
+    static XcbAtom _NET_WM_PID;
+    static XcbAtom _NET_STARTUP_ID;
+
     static XcbAtom _NET_WM_WINDOW_TYPE;
     static XcbAtom _NET_WM_WINDOW_TYPE_NORMAL;
     static XcbAtom _NET_WM_WINDOW_TYPE_DESKTOP;
@@ -150,22 +325,99 @@ public:
     //! Number of named atoms for caching.
     static const unsigned int atomlist_size;
 
+    //! Issue intern requests for all cached named atoms.
+    static std::vector<xcb_intern_atom_cookie_t> query_atomlist();
+
+    //! Collect replies of the intern requests for cached named atoms.
+    static void process_atomlist(
+        const std::vector<xcb_intern_atom_cookie_t>& atomreq);
+
     //! Query X server for cached named atoms.
     static void load_atomlist();
 
     //! Retrieve list of all cached EWMH _NET items.
     static std::vector<xcb_atom_t> get_ewmh_atomlist();
 
+    //! Names of the predefined atoms of the X protocol, indexed by atom.
+    static const char* const predefined_atom_names[];
+
+    //! Number of predefined atoms including XCB_ATOM_NONE.
+    static const unsigned int predefined_atom_count;
+
+protected:
+    //! perfect hash table atom -> index in atomlist, or atom_hash_empty
+    static std::vector<uint16_t> atom_hash;
+
+    //! marker of unused slots in the perfect hash table
+    static const uint16_t atom_hash_empty = 0xFFFF;
+
+    //! multiplier and shift of the perfect hash function
+    static uint32_t atom_hash_mult, atom_hash_shift;
+
+    //! Calculate slot of an atom in the perfect hash table.
+    static uint32_t atom_hash_slot(xcb_atom_t atom)
+    {
+        return uint32_t(atom * atom_hash_mult) >> atom_hash_shift;
+    }
+
+    //! Construct the collision-free hash table of the cached atoms.
+    static void build_atom_hash();
+
+public:
+    //! Find a cached named atom by its identifier, or return NULL.
+    static const XcbAtom* find_atom(xcb_atom_t atom)
+    {
+        if (atom_hash.empty()) return NULL;
+        uint16_t i = atom_hash[atom_hash_slot(atom)];
+        if (i == atom_hash_empty || atomlist[i]->atom != atom) return NULL;
+        return atomlist[i];
+    }
+
+    //! Number of atom slots for dispatch tables: all predefined atoms
+    //! followed by all cached named atoms.
+    static unsigned int atom_slot_count()
+    {
+        return predefined_atom_count + atomlist_size;
+    }
+
+    //! Return dispatch slot of a cached named atom.
+    static unsigned int atom_slot(const XcbAtom& a)
+    {
+        return predefined_atom_count + a.index;
+    }
+
+    //! Return dispatch slot of a predefined or cached atom, or
+    //! atom_slot_count() for any other atom.
+    static unsigned int atom_slot(xcb_atom_t atom)
+    {
+        if (atom < predefined_atom_count) return atom;
+        const XcbAtom* a = find_atom(atom);
+        return a ? atom_slot(*a) : atom_slot_count();
+    }
+
 protected:
     //! typedef cache of xcb_atom_t -> name mapping
     typedef std::map<xcb_atom_t, std::string> atom_name_cache_type;
 
-    //! cache of xcb_atom_t -> name mapping
+    //! cache of resolved names of other atoms
     static atom_name_cache_type atom_name_cache;
 
+    //! typedef of list of (atom, sequence) of outstanding name requests
+    typedef std::vector<std::pair<xcb_atom_t, unsigned int> >
+        atom_name_pending_type;
+
+    //! outstanding GetAtomName requests for other atoms
+    static atom_name_pending_type atom_name_pending;
+
 public:
-    //! Find the name of an atom (usually for unknown atoms)
-    static std::string find_atom_name(xcb_atom_t atom);
+    //! Find the name of an atom for logging. This never waits for the X
+    //! server: names of unknown atoms are requested asynchronously and a
+    //! placeholder is returned until the reply was collected. The string
+    //! stays valid while the connection is open.
+    static const char * find_atom_name(xcb_atom_t atom);
+
+    //! Collect replies of asynchronous atom name requests without blocking.
+    static void process_atom_names();
 
 public:
     //! Replace the value of a window property.
@@ -173,8 +425,9 @@ public:
     change_property(xcb_window_t win, xcb_atom_t property, xcb_atom_t type,
                     uint8_t format, uint32_t data_len, const void* data)
     {
-        return xcb_change_property(connection, XCB_PROP_MODE_REPLACE,
-                                   win, property, type, format, data_len, data);
+        return req(xcb_change_property(connection, XCB_PROP_MODE_REPLACE,
+                                       win, property, type,
+                                       format, data_len, data));
     }
 
     //! Replace the value of a window property
@@ -190,7 +443,7 @@ public:
     static xcb_void_cookie_t
     delete_property(xcb_window_t win, xcb_atom_t property)
     {
-        return xcb_delete_property(connection, win, property);
+        return req(xcb_delete_property(connection, win, property));
     }
 
     //! Delete a property on a window.
@@ -219,8 +472,18 @@ public:
     }
 
 public:
+    //! Issue request to allocate a color in the default color map.
+    static xcb_alloc_color_cookie_t
+    query_allocate_color(uint16_t r, uint16_t g, uint16_t b);
+
+    //! Return pixel value of allocated color, or white on error.
+    static uint32_t process_allocate_color(xcb_alloc_color_cookie_t acc);
+
     //! Allocate a color in the default color map.
-    static uint32_t allocate_color(uint16_t r, uint16_t g, uint16_t b);
+    static uint32_t allocate_color(uint16_t r, uint16_t g, uint16_t b)
+    {
+        return process_allocate_color(query_allocate_color(r, g, b));
+    }
 
 public:
     //! Struct to keep information about cached cursors
@@ -232,9 +495,19 @@ public:
         xcb_cursor_t cursor;
     };
 
-    //! XCB cursor loading context
+    //! XCB cursor loading context, created on first cursor use.
     static xcb_cursor_context_t* cursor_context;
 
+    //! Whether cursors may be loaded from the theme, disabled for offline
+    //! replay and simulation.
+    static bool cursor_enabled;
+
+    //! typedef of map cursor name -> loaded cursor
+    typedef std::map<std::string, xcb_cursor_t> cursormap_type;
+
+    //! Cache of all cursors loaded so far, keyed by name.
+    static cursormap_type cursormap;
+
     // *** List of cached cursors
 
     static XcbCursor CR_fleur;
@@ -249,8 +522,16 @@ public:
     //! Number of cursors for caching.
     static const unsigned int cursorlist_size;
 
-    //! Query X server for cached cursors.
-    static void load_cursorlist();
+    //! Return cursor of given name, loading it from the theme on first use.
+    static xcb_cursor_t get_cursor(const char* name);
+
+    //! Return a cached named cursor, loading it on first use.
+    static xcb_cursor_t get_cursor(XcbCursor& c)
+    {
+        if (c.cursor == XCB_CURSOR_NONE)
+            c.cursor = get_cursor(c.name);
+        return c.cursor;
+    }
 
     //! Free cached cursor resources.
     static void unload_cursorlist();
@@ -271,6 +552,31 @@ struct autofree_ptr_freer
 template <typename Type>
 using autofree_ptr = std::unique_ptr<Type, autofree_ptr_freer<Type> >;
 
+/*!
+ * Scope object attributing all X requests and round trips within its lifetime
+ * to a subsystem of the WM.
+ */
+class XcbAccountScope
+{
+protected:
+    //! subsystem active before this scope
+    XcbConnection::subsystem_t m_saved;
+
+public:
+    //! Switch accounting to subsystem s.
+    explicit XcbAccountScope(XcbConnection::subsystem_t s)
+        : m_saved(XcbConnection::subsystem)
+    {
+        XcbConnection::subsystem = s;
+    }
+
+    //! Restore previous subsystem.
+    ~XcbAccountScope()
+    {
+        XcbConnection::subsystem = m_saved;
+    }
+};
+
 // *** BEGIN Auto-generated ostream operators for XCB structures ***
 
 extern std::ostream& operator << (
@@ -341,6 +647,10 @@ extern std::ostream& operator << (
     std::ostream& os,
     const xcb_configure_notify_event_t& e);
 
+extern std::ostream& operator << (
+    std::ostream& os,
+    const xcb_circulate_notify_event_t& e);
+
 extern std::ostream& operator << (
     std::ostream& os,
     const xcb_configure_request_event_t& e);
@@ -373,10 +683,6 @@ extern std::ostream& operator << (
     std::ostream& os,
     const xcb_get_geometry_reply_t& g);
 
-extern std::ostream& operator << (
-    std::ostream& os,
-    const xcb_icccm_get_wm_class_reply_t& i);
-
 extern std::ostream& operator << (
     std::ostream& os,
     const xcb_get_modifier_mapping_reply_t& m);
@@ -391,11 +697,19 @@ extern std::ostream& operator << (
 
 extern std::ostream& operator << (
     std::ostream& os,
-    const struct ewmh_strut_t& q);
+    const xcb_get_input_focus_reply_t& f);
+
+extern std::ostream& operator << (
+    std::ostream& os,
+    const xcb_grab_pointer_reply_t& g);
+
+extern std::ostream& operator << (
+    std::ostream& os,
+    const xcb_intern_atom_reply_t& i);
 
 extern std::ostream& operator << (
     std::ostream& os,
-    const struct ewmh_strut_partial_t& q);
+    const xcb_get_atom_name_reply_t& a);
 
 // *** END Auto-generated ostream operators for XCB structures ***
 
@@ -425,12 +739,27 @@ struct GravityFormatter
     //! constructor for temporary formatting object.
     GravityFormatter(uint32_t g) : gravity((xcb_gravity_t)g) { }
 
+    //! Return description string of an window gravity value.
+    static const char * name(uint32_t gravity);
+
     //! Output description string of an window gravity value.
     friend std::ostream& operator << (
         std::ostream& os,
         const GravityFormatter& g);
 };
 
+//! Output WM_CLASS strings of ICCCM reply.
+extern std::ostream& operator << (
+    std::ostream& os, const xcb_icccm_get_wm_class_reply_t& i);
+
+//! Output _NET_WM_STRUT data structure.
+extern std::ostream& operator << (
+    std::ostream& os, const struct ewmh_strut_t& q);
+
+//! Output _NET_WM_STRUT_PARTIAL data structure.
+extern std::ostream& operator << (
+    std::ostream& os, const struct ewmh_strut_partial_t& q);
+
 //! Output client message data as hexdump
 extern std::ostream& operator << (
     std::ostream& os, const xcb_client_message_data_t& d);
@@ -0,0 +1,203 @@
+/******************************************************************************/
+/*! \file unittests/test_fake_server.cpp
+ *
+ * Test managing and unmanaging windows against the in-process fake X server.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "fake-server.h"
+#include "log.h"
+#include "xcb.h"
+#include "event.h"
+#include "binding.h"
+#include "client.h"
+#include "startup.h"
+#include "stacking.h"
+#include "window-tree.h"
+
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+static const unsigned int num_windows = 50;
+
+void test_manage(FakeXServer& server)
+{
+    uint64_t cpu_ns = 0;
+    std::vector<xcb_window_t> windows;
+
+    for (unsigned int i = 0; i < num_windows; ++i)
+    {
+        xcb_window_t win = server.create_window(
+            Rectangle(10 * i, 10 * i, 200, 100));
+        server.map_window(win);
+        windows.push_back(win);
+    }
+
+    ASSERT(server.settle(cpu_ns) >= num_windows);
+    ASSERT(ClientList::size() == num_windows);
+
+    for (xcb_window_t win : windows) {
+        ASSERT(server.is_mapped(win));
+        ASSERT(ClientList::find_window(win));
+
+        const WindowTree::Node* node = WindowTree::find(win);
+        ASSERT(node && node->mapped && !node->override_redirect);
+    }
+
+    for (xcb_window_t win : windows)
+        server.destroy_window(win);
+
+    server.settle(cpu_ns);
+    ASSERT(ClientList::size() == 0);
+
+    for (xcb_window_t win : windows)
+        ASSERT(!WindowTree::find(win));
+}
+
+//! A restack relative to a sibling destroyed in the meantime fails with
+//! BadWindow for the sibling, which must not drop the moved client.
+void test_sibling_error(FakeXServer& server)
+{
+    uint64_t cpu_ns = 0;
+    std::vector<xcb_window_t> windows;
+
+    for (unsigned int i = 0; i < 5; ++i)
+    {
+        xcb_window_t win = server.create_window(Rectangle(0, 0, 200, 100));
+        server.map_window(win);
+        windows.push_back(win);
+    }
+
+    server.settle(cpu_ns);
+    ASSERT(ClientList::size() == windows.size());
+
+    // raise the bottom window above the top one, which is destroyed before
+    // the WM sees its DestroyNotify.
+    server.destroy_window(windows.back());
+
+    Stacking::raise(*ClientList::find_window(windows.front()));
+    Stacking::restack();
+
+    server.settle(cpu_ns);
+    ASSERT(ClientList::size() == windows.size() - 1);
+    ASSERT(ClientList::find_window(windows.front()));
+
+    windows.pop_back();
+    for (xcb_window_t win : windows)
+        server.destroy_window(win);
+
+    server.settle(cpu_ns);
+    ASSERT(ClientList::size() == 0);
+}
+
+//! A _NET_WM_STATE client message must change the state and the layer.
+void test_state_message(FakeXServer& server)
+{
+    uint64_t cpu_ns = 0;
+    std::vector<xcb_window_t> windows;
+
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        xcb_window_t win = server.create_window(Rectangle(0, 0, 200, 100));
+        server.map_window(win);
+        windows.push_back(win);
+    }
+
+    server.settle(cpu_ns);
+
+    xcb_window_t bottom = windows.front();
+    ASSERT(WindowTree::stacking().back() != bottom);
+
+    uint32_t data[5] = {
+        EWMH_STATE_ADD, server.intern_atom("_NET_WM_STATE_ABOVE"), 0, 0, 0
+    };
+    server.send_client_message(
+        bottom, server.intern_atom("_NET_WM_STATE"), data);
+
+    server.settle(cpu_ns);
+    ASSERT(ClientList::find_window(bottom)->m_state_above);
+    ASSERT(WindowTree::stacking().back() == bottom);
+
+    data[0] = EWMH_STATE_TOGGLE;
+    server.send_client_message(
+        bottom, server.intern_atom("_NET_WM_STATE"), data);
+
+    server.settle(cpu_ns);
+    ASSERT(!ClientList::find_window(bottom)->m_state_above);
+
+    for (xcb_window_t win : windows)
+        server.destroy_window(win);
+
+    server.settle(cpu_ns);
+    ASSERT(ClientList::size() == 0);
+}
+
+//! A synthetic UnmapNotify sent by a client does not unmap its window, hence
+//! must not change the window tree mirror.
+void test_synthetic_unmap(FakeXServer& server)
+{
+    uint64_t cpu_ns = 0;
+
+    xcb_window_t win = server.create_window(Rectangle(0, 0, 200, 100));
+    server.map_window(win);
+
+    server.settle(cpu_ns);
+    ASSERT(WindowTree::find(win) && WindowTree::find(win)->mapped);
+
+    server.send_unmap_notify(win);
+
+    server.settle(cpu_ns);
+    ASSERT(server.is_mapped(win));
+    ASSERT(WindowTree::find(win) && WindowTree::find(win)->mapped);
+
+    server.destroy_window(win);
+
+    server.settle(cpu_ns);
+    ASSERT(ClientList::size() == 0);
+}
+
+int main()
+{
+    int sv[2];
+    ASSERT(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) == 0);
+
+    FakeXServer server(sv[1]);
+    std::thread server_thread(&FakeXServer::run, &server);
+
+    g_xcb.open_connection_fd(sv[0]);
+
+    ASSERT(Startup::initialize(false));
+
+    test_manage(server);
+    test_sibling_error(server);
+    test_state_message(server);
+    test_synthetic_unmap(server);
+
+    BindingList::deinitialize();
+    g_xcb.close_connection();
+
+    server_thread.join();
+    close(sv[1]);
+
+    return 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,133 @@
+/******************************************************************************/
+/*! \file unittests/test_layout.cpp
+ *
+ * Test tiling layout trees and their incremental re-layout.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "layout.h"
+#include "log.h"
+
+#include <map>
+
+typedef Layout::placementlist_type placementlist_type;
+
+//! Collect placements of a layout run into a map window -> area.
+static std::map<xcb_window_t, Rectangle> run(Layout& l)
+{
+    placementlist_type out;
+    l.layout(out);
+
+    std::map<xcb_window_t, Rectangle> m;
+    for (const Layout::Placement& p : out) {
+        ASSERT(m.count(p.window) == 0);
+        m[p.window] = p.area;
+    }
+    return m;
+}
+
+void test_simple()
+{
+    Layout l;
+    l.set_area(Rectangle(0, 0, 1000, 500));
+
+    l.insert(1), l.insert(2), l.insert(3);
+
+    std::map<xcb_window_t, Rectangle> m = run(l);
+    ASSERT(m.size() == 3);
+    ASSERT(m[1] == Rectangle(0, 0, 334, 500));
+    ASSERT(m[2] == Rectangle(334, 0, 333, 500));
+    ASSERT(m[3] == Rectangle(667, 0, 333, 500));
+
+    // nothing changed, nothing to place
+    ASSERT(!l.dirty());
+    ASSERT(run(l).empty());
+
+    // splitting the last column places only its windows
+    ASSERT(l.split(3, Layout::SPLIT_V));
+    l.insert(4);
+
+    m = run(l);
+    ASSERT(m.size() == 2);
+    ASSERT(m[3] == Rectangle(667, 0, 333, 250));
+    ASSERT(m[4] == Rectangle(667, 250, 333, 250));
+
+    ASSERT(l.set_container_type(4, Layout::STACK));
+    m = run(l);
+    ASSERT(m.size() == 2);
+    ASSERT(m[3] == Rectangle(667, 0, 333, 500));
+
+    // removing collapses the column container again
+    ASSERT(l.remove(4));
+    ASSERT(run(l).empty());
+
+    ASSERT(l.remove(3));
+    ASSERT(!l.remove(3));
+
+    m = run(l);
+    ASSERT(m.size() == 2);
+    ASSERT(m[1] == Rectangle(0, 0, 500, 500));
+    ASSERT(m[2] == Rectangle(500, 0, 500, 500));
+
+    // new windows go next to the focused one
+    l.set_focus(1);
+    l.insert(5);
+
+    m = run(l);
+    ASSERT(m[5] == Rectangle(334, 0, 333, 500));
+    ASSERT(l.size() == 3);
+}
+
+//! Changes in a small subtree must not touch the large rest of the tree.
+void test_incremental()
+{
+    Layout l;
+    l.set_area(Rectangle(0, 0, 2000, 1000));
+
+    // a column of many windows and a column with a few windows
+    l.insert(1), l.insert(2);
+
+    ASSERT(l.split(1, Layout::SPLIT_V));
+    for (xcb_window_t w = 3; w <= 200; ++w) l.insert(w);
+
+    ASSERT(l.split(2, Layout::SPLIT_V));
+    l.insert(300);
+
+    std::map<xcb_window_t, Rectangle> m = run(l);
+    ASSERT(m.size() == 201);
+
+    // inserting into the small column touches only it
+    l.insert(301);
+
+    m = run(l);
+    ASSERT(m.size() == 3);
+    ASSERT(m.count(2) && m.count(300) && m.count(301));
+
+    // resizing the area rearranges everything
+    l.set_area(Rectangle(0, 20, 2000, 980));
+    ASSERT(run(l).size() == 202);
+}
+
+int main()
+{
+    test_simple();
+    test_incremental();
+    return 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,204 @@
+/******************************************************************************/
+/*! \file unittests/test_size_solver.cpp
+ *
+ * Test and benchmark the batch size-hint solver.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "size-solver.h"
+#include "log.h"
+#include "tools.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+typedef SizeSolver::Item Item;
+typedef SizeSolver::itemlist_type itemlist_type;
+
+//! Sum of assigned sizes.
+static int64_t total(const itemlist_type& items)
+{
+    int64_t sum = 0;
+    for (const Item& it : items) sum += it.size;
+    return sum;
+}
+
+//! Check whether the assigned size satisfies the item's hints. If no valid
+//! size is below the maximum, the smallest valid size is expected.
+static bool valid(const Item& it)
+{
+    int32_t lo = std::max(it.min, it.base);
+    lo = it.base + (lo - it.base + it.inc - 1) / it.inc * it.inc;
+
+    return (it.size >= lo && (it.size <= it.max || it.size == lo) &&
+            (it.size - it.base) % it.inc == 0);
+}
+
+void test_simple()
+{
+    // unconstrained: equal shares, remainder to the first
+    itemlist_type items(3);
+    ASSERT(SizeSolver::solve(1000, items));
+    ASSERT(items[0].size == 334 && items[1].size == 333 &&
+           items[2].size == 333);
+
+    // minimum size takes space from the others
+    items[0] = Item(200, SizeSolver::unlimited, 0, 1);
+    ASSERT(SizeSolver::solve(300, items));
+    ASSERT(items[0].size == 200 && items[1].size == 50 &&
+           items[2].size == 50);
+
+    // maximum size gives space to the others
+    items[0] = Item(0, 100, 0, 1);
+    ASSERT(SizeSolver::solve(900, items));
+    ASSERT(items[0].size == 100 && items[1].size == 400 &&
+           items[2].size == 400);
+
+    // all at maximum leaves the rest of the span unused
+    items[1] = items[2] = items[0];
+    ASSERT(SizeSolver::solve(900, items));
+    ASSERT(total(items) == 300);
+
+    // increments: pixels lost by snapping go to the free window
+    items.assign(2, Item());
+    items[0] = Item(0, SizeSolver::unlimited, 4, 10);
+    ASSERT(SizeSolver::solve(100, items));
+    ASSERT(items[0].size == 44 && items[1].size == 56);
+
+    // too small for all minimums: shrink evenly
+    items.assign(3, Item(50, 80, 0, 1));
+    ASSERT(!SizeSolver::solve(100, items));
+    ASSERT(items[0].size == 34 && items[1].size == 33 &&
+           items[2].size == 33);
+
+    // conflicting hints: minimum wins
+    items.assign(1, Item(60, 40, 0, 1));
+    ASSERT(SizeSolver::solve(100, items));
+    ASSERT(items[0].size == 60);
+}
+
+void test_aspect()
+{
+    // square windows with a border of 1 in a column of outer width 102
+    SizeSolver::Hints h;
+    h.min_aspect_num = h.min_aspect_den = 1;
+    h.max_aspect_num = h.max_aspect_den = 1;
+    h.border = 1;
+
+    Item it = h.item(false, 102);
+    ASSERT(it.min == 102 && it.max == 102);
+
+    // aspect 4:3 .. 16:9 in a row of outer height 90
+    h.min_aspect_num = 4, h.min_aspect_den = 3;
+    h.max_aspect_num = 16, h.max_aspect_den = 9;
+    h.border = 0;
+
+    it = h.item(true, 90);
+    ASSERT(it.min == 120 && it.max == 160);
+
+    itemlist_type items(2, it);
+    ASSERT(SizeSolver::solve(1000, items));
+    ASSERT(items[0].size == 160 && items[1].size == 160);
+}
+
+//! Check random hint sets against the solution properties.
+void test_random()
+{
+    srand(1);
+
+    for (unsigned int round = 0; round < 1000; ++round)
+    {
+        size_t n = 1 + rand() % 20;
+        itemlist_type items(n);
+
+        for (Item& it : items)
+        {
+            it.min = rand() % 100;
+            it.max = (rand() % 4 == 0) ? SizeSolver::unlimited
+                     : it.min + rand() % 200;
+            it.base = rand() % 20;
+            it.inc = (rand() % 2) ? 1 : 1 + rand() % 16;
+        }
+
+        int32_t span = rand() % 3000;
+        itemlist_type result = items;
+
+        if (!SizeSolver::solve(span, result)) {
+            ASSERT(total(result) == span);
+            continue;
+        }
+
+        ASSERT(total(result) <= span);
+
+        bool unit = true;
+        for (size_t i = 0; i < n; ++i) {
+            Item check = items[i];
+            check.size = result[i].size;
+            ASSERT(valid(check));
+            unit = unit && (check.inc == 1);
+        }
+
+        // with unit increments the span is filled unless all are maximal
+        if (unit && total(result) < span) {
+            for (size_t i = 0; i < n; ++i)
+                ASSERT(result[i].size >= items[i].max);
+        }
+    }
+}
+
+//! Measure solver time per window for growing numbers of windows.
+void bench_solve()
+{
+    srand(2);
+
+    for (size_t n = 10; n <= 100000; n *= 10)
+    {
+        itemlist_type items(n), work;
+
+        for (Item& it : items) {
+            it.min = rand() % 50;
+            it.max = it.min + rand() % 500;
+            it.inc = 1 + rand() % 8;
+        }
+
+        size_t reps = 100000 / n;
+        uint64_t start = monotonic_ns();
+
+        for (size_t r = 0; r < reps; ++r) {
+            work = items;
+            SizeSolver::solve((int32_t)(n * 100), work);
+        }
+
+        uint64_t ns = monotonic_ns() - start;
+
+        INFO << "bench_solve: " << n << " windows: "
+             << ns / reps << " ns per solve, "
+             << ns / reps / n << " ns per window";
+    }
+}
+
+int main()
+{
+    test_simple();
+    test_aspect();
+    test_random();
+    bench_solve();
+    return 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,124 @@
+/******************************************************************************/
+/*! \file unittests/test_spatial_grid.cpp
+ *
+ * Test SpatialGrid point and area queries against a linear scan.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "spatial-grid.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+void test_simple()
+{
+    SpatialGrid grid(Rectangle(0, 0, 1024, 768));
+
+    grid.insert(1, Rectangle(0, 0, 500, 500), 10);
+    grid.insert(2, Rectangle(100, 100, 200, 200), 20);
+    grid.insert(3, Rectangle(900, 600, 400, 400), 30);
+
+    ASSERT(grid.size() == 3);
+
+    ASSERT(grid.topmost(Point(50, 50)) == 1);
+    ASSERT(grid.topmost(Point(150, 150)) == 2);
+    ASSERT(grid.topmost(Point(700, 100)) == 0);
+
+    // beyond the extent, stored in the border cells
+    ASSERT(grid.topmost(Point(1200, 900)) == 3);
+    ASSERT(grid.topmost(Point(-10, -10)) == 0);
+
+    // raise window 1 above window 2
+    grid.set_z(1, 40);
+    ASSERT(grid.topmost(Point(150, 150)) == 1);
+
+    std::vector<SpatialGrid::id_type> out;
+    grid.intersecting(Rectangle(200, 200, 1000, 1000), out);
+
+    ASSERT(out.size() == 3);
+    ASSERT(out[0] == 2 && out[1] == 3 && out[2] == 1);
+
+    // move window 2 away
+    grid.insert(2, Rectangle(600, 0, 100, 100), 20);
+    ASSERT(grid.topmost(Point(650, 50)) == 2);
+    ASSERT(grid.size() == 3);
+
+    grid.erase(1);
+    ASSERT(grid.topmost(Point(150, 150)) == 0);
+
+    grid.intersecting(Rectangle(0, 0, 1024, 768), out);
+    ASSERT(out.size() == 2);
+}
+
+//! Compare queries against a linear scan over random rectangles.
+void test_random()
+{
+    static const unsigned int num = 1000;
+
+    srand(1);
+
+    SpatialGrid grid(Rectangle(0, 0, 1920, 1080));
+    std::vector<Rectangle> rects(num + 1);
+
+    for (unsigned int i = 1; i <= num; ++i)
+    {
+        rects[i] = Rectangle(rand() % 2200 - 100, rand() % 1300 - 100,
+                             rand() % 400, rand() % 300);
+        grid.insert(i, rects[i], i);
+    }
+
+    for (unsigned int q = 0; q < 1000; ++q)
+    {
+        Point p(rand() % 2000, rand() % 1200);
+
+        SpatialGrid::id_type top = 0;
+        for (unsigned int i = 1; i <= num; ++i) {
+            if (rects[i].contains(p)) top = i;
+        }
+
+        ASSERT(grid.topmost(p) == top);
+
+        Rectangle r(rand() % 2000, rand() % 1200, rand() % 300, rand() % 300);
+
+        std::vector<SpatialGrid::id_type> out, check;
+        grid.intersecting(r, out);
+
+        for (unsigned int i = 1; i <= num; ++i) {
+            if (rects[i].intersects(r)) check.push_back(i);
+        }
+
+        ASSERT(out == check);
+    }
+
+    // resizing the extent keeps all entries
+    grid.set_extent(Rectangle(0, 0, 800, 600));
+    ASSERT(grid.size() == num);
+    ASSERT(grid.topmost(Point(rects[num].x, rects[num].y)) == num ||
+           rects[num].w == 0 || rects[num].h == 0);
+}
+
+int main()
+{
+    test_simple();
+    test_random();
+    return 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,139 @@
+/******************************************************************************/
+/*! \file unittests/test_stacking.cpp
+ *
+ * Test minimal restack planning of Stacking against a simulated server.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "stacking.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+typedef Stacking::winlist_type winlist_type;
+
+//! Apply restack moves to a simulated stacking order, like the X server.
+static void apply(winlist_type& order, const std::vector<Stacking::Move>& moves)
+{
+    for (const Stacking::Move& m : moves)
+    {
+        order.erase(std::find(order.begin(), order.end(), m.window));
+
+        winlist_type::iterator pos =
+            std::find(order.begin(), order.end(), m.sibling);
+        ASSERT(pos != order.end());
+
+        if (m.mode == XCB_STACK_MODE_ABOVE) ++pos;
+        order.insert(pos, m.window);
+    }
+}
+
+//! Length of a longest increasing subsequence by quadratic dynamic program.
+static size_t lis_length(const winlist_type& seq)
+{
+    std::vector<size_t> len(seq.size(), 1);
+    size_t best = 0;
+
+    for (size_t i = 0; i < seq.size(); ++i)
+    {
+        for (size_t j = 0; j < i; ++j) {
+            if (seq[j] < seq[i]) len[i] = std::max(len[i], len[j] + 1);
+        }
+        best = std::max(best, len[i]);
+    }
+
+    return best;
+}
+
+void test_simple()
+{
+    winlist_type current = { 1, 2, 3, 4, 5 }, want = current;
+    std::vector<Stacking::Move> moves;
+
+    // unchanged order needs no requests
+    Stacking::plan(current, want, moves);
+    ASSERT(moves.empty());
+
+    // raising one window is a single request
+    want = { 1, 3, 4, 5, 2 };
+    Stacking::plan(current, want, moves);
+    ASSERT(moves.size() == 1);
+    ASSERT(moves[0].window == 2 && moves[0].sibling == 5);
+    ASSERT(moves[0].mode == XCB_STACK_MODE_ABOVE);
+
+    // lowering a window to the bottom
+    want = { 4, 1, 2, 3, 5 };
+    Stacking::plan(current, want, moves);
+    ASSERT(moves.size() == 1);
+    ASSERT(moves[0].window == 4 && moves[0].sibling == 1);
+    ASSERT(moves[0].mode == XCB_STACK_MODE_BELOW);
+
+    // reversing keeps one window in place
+    want = { 5, 4, 3, 2, 1 };
+    Stacking::plan(current, want, moves);
+    ASSERT(moves.size() == 4);
+
+    apply(current, moves);
+    ASSERT(current == want);
+}
+
+//! Compare random permutations against simulation and LIS length.
+void test_random()
+{
+    srand(1);
+
+    for (unsigned int n = 1; n < 200; n += 7)
+    {
+        winlist_type current(n), want;
+        for (unsigned int i = 0; i < n; ++i) current[i] = i + 1;
+
+        want = current;
+        std::random_shuffle(want.begin(), want.end());
+
+        // mostly sorted orders are the common case
+        if (n % 2) {
+            want = current;
+            for (unsigned int k = 0; k < n / 10 + 1; ++k)
+                std::swap(want[rand() % n], want[rand() % n]);
+        }
+
+        std::vector<Stacking::Move> moves;
+        Stacking::plan(current, want, moves);
+
+        // intended positions of current order
+        winlist_type seq;
+        for (xcb_window_t w : current)
+            seq.push_back(std::find(want.begin(), want.end(), w)
+                          - want.begin());
+
+        ASSERT(moves.size() == n - lis_length(seq));
+
+        apply(current, moves);
+        ASSERT(current == want);
+    }
+}
+
+int main()
+{
+    test_simple();
+    test_random();
+    return 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,103 @@
+/******************************************************************************/
+/*! \file unittests/test_xcb_format.cpp
+ *
+ * Test formatting and packing of XCB structures via field descriptors.
+ */
+/*******************************************************************************
+ * Copyright (C) 2014 Timo Bingmann <tb@panthema.net>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "xcb-format.h"
+#include "log.h"
+
+#include <cstring>
+#include <string>
+
+void test_format()
+{
+    xcb_configure_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_CONFIGURE_NOTIFY;
+    ev.window = 0x200001;
+    ev.x = -10;
+    ev.width = 640;
+
+    const XcbStruct* desc = xcb_event_struct(XCB_CONFIGURE_NOTIFY);
+    ASSERT(desc);
+
+    char buf[512];
+    size_t len = xcb_format(buf, sizeof(buf), *desc, &ev);
+
+    std::string out(buf, len);
+    ASSERT(out.find("[xcb_configure_notify_event:") == 0);
+    ASSERT(out.find(" window=2097153") != std::string::npos);
+    ASSERT(out.find(" x=-10") != std::string::npos);
+    ASSERT(out.find(" width=640") != std::string::npos);
+    ASSERT(out[len - 1] == ']' && buf[len] == 0);
+
+    // truncated output is still terminated
+    len = xcb_format(buf, 8, *desc, &ev);
+    ASSERT(len == 7 && strcmp(buf, "[xcb_co") == 0);
+}
+
+void test_pack_event()
+{
+    xcb_client_message_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_CLIENT_MESSAGE | 0x80; // send_event
+    ev.format = 32;
+    ev.window = 0x400005;
+    ev.type = 300;
+    for (unsigned int i = 0; i < 20; ++i)
+        ev.data.data8[i] = i * 7;
+
+    uint8_t packed[64];
+    size_t size = xcb_pack_event(packed, sizeof(packed),
+                                 (xcb_generic_event_t*)&ev);
+    ASSERT(size > 0 && size < 32);
+
+    xcb_generic_event_t out;
+    ASSERT(xcb_unpack_event(packed, size, &out) == size);
+    ASSERT(memcmp(&out, &ev, sizeof(ev)) == 0);
+
+    // truncated input and too small output are detected
+    ASSERT(xcb_unpack_event(packed, size - 1, &out) == 0);
+    ASSERT(xcb_pack_event(packed, 4, (xcb_generic_event_t*)&ev) == 0);
+
+    // signed fields are zig-zag encoded
+    xcb_configure_notify_event_t cn;
+    memset(&cn, 0, sizeof(cn));
+    cn.response_type = XCB_CONFIGURE_NOTIFY;
+    cn.x = -1, cn.y = -32768, cn.border_width = 65535;
+
+    size = xcb_pack_event(packed, sizeof(packed), (xcb_generic_event_t*)&cn);
+    ASSERT(xcb_unpack_event(packed, size, &out) == size);
+    ASSERT(memcmp(&out, &cn, sizeof(cn)) == 0);
+
+    // events without descriptor are not packed
+    memset(&out, 0, sizeof(out));
+    out.response_type = 64;
+    ASSERT(xcb_pack_event(packed, sizeof(packed), &out) == 0);
+}
+
+int main()
+{
+    test_format();
+    test_pack_event();
+    return 0;
+}
+
+/******************************************************************************/